@@ -24,14 +24,21 @@
 #include <popart/patterns/patterns.hpp>
 #include <popart/popx/devicex.hpp>
 #include <popart/popx/exporter.hpp>
+#include <popart/popx/planningcache.hpp>
 #include <popart/session.hpp>
 #include <popart/sessionoptions.hpp>
 #include <popart/stepio_generic.hpp>
 #include <popart/stepio_size_assertion.hpp>
+#include <popart/syntheticstepio.hpp>
 #include <popart/tensordata.hpp>
 #include <popart/tensorlocation.hpp>
 #include <popart/tensornames.hpp>
 #include <popart/tensors.hpp>
+#include <popart/transforms/auto_virtual_graph.hpp>
+#include <popart/transforms/mergevarupdates.hpp>
+#include <popart/transforms/pipeline.hpp>
+#include <popart/transforms/replicatedallreducebucketing.hpp>
+#include <popart/transforms/streamingmemory.hpp>
 #include <popart/version.hpp>
 
 #include <stdexcept>
@@ -271,7 +278,9 @@ void exportDataset(Builder &builder,
 void exportInputs(Session &session,
                   std::map<TensorId, py::iterable> inputs,
                   int64_t num_elements,
-                  const std::string &output_filename) {
+                  const std::string &output_filename,
+                  int64_t elements_per_chunk,
+                  bool resume) {
   // Create some iterators for each input
   std::map<TensorId, py::iterator> iterators;
   for (auto &input : inputs) {
@@ -290,7 +299,10 @@ void exportInputs(Session &session,
                           [](std::string) { return py::array{}; },
                           [](std::string) {}};
 
-  session.exportInputs(stepio, num_elements, output_filename);
+  popx::StepIOExportOptions options;
+  options.elementsPerChunk = elements_per_chunk;
+  options.resume           = resume;
+  session.exportInputs(stepio, num_elements, output_filename, options);
 }
 
 class PyWeightsIO : public IWeightsIO {
@@ -502,6 +514,8 @@ PYBIND11_MODULE(popart_core, m) {
 
   m.def("versionString", &popart::core::versionString);
   m.def("exporterIsAvailable", &popart::popx::exporterIsAvailable);
+  m.def("releaseSharedPlanningCaches",
+        &popart::popx::PlanningCaches::releaseShared);
   m.def("packageHash", &popart::core::packageHash);
   {
     py::class_<Logger> cls(m, "Logger");
@@ -611,6 +625,40 @@ PYBIND11_MODULE(popart_core, m) {
               py::arg("output_callback"),
               py::arg("output_complete_callback"));
     }
+    {
+      py::class_<SyntheticInput> cls(m, "SyntheticInput");
+      cls.def_static("uniformInt",
+                     &SyntheticInput::uniformInt,
+                     py::arg("low"),
+                     py::arg("high"),
+                     py::arg("dataType") = DataType::INT32);
+      cls.def_static("normal",
+                     &SyntheticInput::normal,
+                     py::arg("mean"),
+                     py::arg("stddev"),
+                     py::arg("dataType") = DataType::FLOAT);
+      cls.def_static(
+          "replay",
+          [](py::array batch) {
+            if (!isContiguous(batch)) {
+              throw error("SyntheticInput.replay is unable to use the numpy "
+                          "array as it is not c-contiguous");
+            }
+            ConstVoidData data;
+            data.data = batch.request().ptr;
+            data.info = getTensorInfo(batch);
+            return SyntheticInput::replay(data);
+          },
+          py::arg("batch"));
+    }
+    {
+      py::class_<SyntheticStepIO> cls(m, "SyntheticStepIO", stepio);
+      cls.def(
+          py::init<std::map<TensorId, SyntheticInput>, unsigned, uint64_t>(),
+          py::arg("inputs"),
+          py::arg("poolSize") = 16,
+          py::arg("seed") = 0);
+    }
     {
       py::class_<PyWeightsIO> cls(m, "PyWeightsIO", weightsio);
       cls.def(py::init<std::map<TensorId, py::array>>(), py::arg("weights"));
@@ -799,6 +847,54 @@ PYBIND11_MODULE(popart_core, m) {
     en.value("OverlapOnCompute",
              BatchSerializationBatchSchedule::OverlapOnCompute);
   }
+  {
+    py::class_<OptimizerSchedule> cls(m, "OptimizerSchedule");
+    py::enum_<OptimizerSchedule::Decay> en(cls, "Decay");
+    en.value("Off", OptimizerSchedule::Decay::None);
+    en.value("Step", OptimizerSchedule::Decay::Step);
+    en.value("Exponential", OptimizerSchedule::Decay::Exponential);
+    en.value("Cosine", OptimizerSchedule::Decay::Cosine);
+    cls.def(py::init<>());
+    cls.def_readwrite("warmupSteps", &OptimizerSchedule::warmupSteps);
+    cls.def_readwrite("warmupStartFactor",
+                      &OptimizerSchedule::warmupStartFactor);
+    cls.def_readwrite("decay", &OptimizerSchedule::decay);
+    cls.def_readwrite("decaySteps", &OptimizerSchedule::decaySteps);
+    cls.def_readwrite("decayFactor", &OptimizerSchedule::decayFactor);
+    cls.def_readwrite("minFactor", &OptimizerSchedule::minFactor);
+    cls.def("enabled", &OptimizerSchedule::enabled);
+    cls.def("evaluate", &OptimizerSchedule::evaluate, py::arg("t"));
+  }
+  {
+    py::class_<DynamicLossScalingSettings> cls(m,
+                                               "DynamicLossScalingSettings");
+    cls.def(py::init<>());
+    cls.def_readwrite("enabled", &DynamicLossScalingSettings::enabled);
+    cls.def_readwrite("growthInterval",
+                      &DynamicLossScalingSettings::growthInterval);
+    cls.def_readwrite("growthFactor",
+                      &DynamicLossScalingSettings::growthFactor);
+    cls.def_readwrite("backoffFactor",
+                      &DynamicLossScalingSettings::backoffFactor);
+    cls.def_readwrite("minFactor", &DynamicLossScalingSettings::minFactor);
+    cls.def_readwrite("maxFactor", &DynamicLossScalingSettings::maxFactor);
+  }
+  {
+    py::class_<CostModelSettings> cls(m, "CostModelSettings");
+    cls.def(py::init<>());
+    cls.def_readwrite("programCycles", &CostModelSettings::programCycles);
+    cls.def_readwrite("onChipCopyBytesPerCycle",
+                      &CostModelSettings::onChipCopyBytesPerCycle);
+    cls.def_readwrite("macsPerCycle", &CostModelSettings::macsPerCycle);
+    cls.def_readwrite("remoteBytesPerCycle",
+                      &CostModelSettings::remoteBytesPerCycle);
+    cls.def_readwrite("interIpuCopyBytesPerCycle",
+                      &CostModelSettings::interIpuCopyBytesPerCycle);
+    cls.def_readwrite("collectiveLatencyCycles",
+                      &CostModelSettings::collectiveLatencyCycles);
+    cls.def_readwrite("collectiveBytesPerCycle",
+                      &CostModelSettings::collectiveBytesPerCycle);
+  }
   {
     py::class_<BatchSerializationSettings> cls(m, "BatchSerializationSettings");
     cls.def(py::init<>());
@@ -820,6 +916,10 @@ PYBIND11_MODULE(popart_core, m) {
     // This setting is experimental and may change.
     cls.def_readwrite("batchSchedule",
                       &BatchSerializationSettings::batchSchedule);
+    cls.def_readwrite("autoMemoryBudget",
+                      &BatchSerializationSettings::autoMemoryBudget);
+    cls.def_readwrite("maxAutoFactor",
+                      &BatchSerializationSettings::maxAutoFactor);
   }
   {
     py::class_<ExecutionPhaseSettings> cls(m, "ExecutionPhaseSettings");
@@ -849,6 +949,13 @@ PYBIND11_MODULE(popart_core, m) {
     cls.def_readwrite("accumulatorIOSchedule",
                       &ExecutionPhaseSettings::accumulatorIOSchedule);
     cls.def_readwrite("schedule", &ExecutionPhaseSettings::schedule);
+    cls.def_readwrite("onDemandPrefetchPhases",
+                      &ExecutionPhaseSettings::onDemandPrefetchPhases);
+    cls.def_readwrite("onDemandPrefetchMemoryBudget",
+                      &ExecutionPhaseSettings::onDemandPrefetchMemoryBudget);
+    cls.def_readwrite("autoMemoryBudget",
+                      &ExecutionPhaseSettings::autoMemoryBudget);
+    cls.def_readwrite("autoTimeSlack", &ExecutionPhaseSettings::autoTimeSlack);
   }
   {
     py::class_<AccumulateOuterFragmentSettings> cls(
@@ -897,9 +1004,29 @@ PYBIND11_MODULE(popart_core, m) {
                       &SessionOptions::enableNonStableSoftmax);
     cls.def_readwrite("enablePipelining", &SessionOptions::enablePipelining);
     cls.def_readwrite("autoRecomputation", &SessionOptions::autoRecomputation);
+    cls.def_readwrite("autoRecomputationMemoryBudget",
+                      &SessionOptions::autoRecomputationMemoryBudget);
     cls.def_readwrite("mergeVarUpdate", &SessionOptions::mergeVarUpdate);
     cls.def_readwrite("mergeVarUpdateMemThreshold",
                       &SessionOptions::mergeVarUpdateMemThreshold);
+    cls.def_readwrite("costModelSettings",
+                      &SessionOptions::costModelSettings);
+    cls.def_readwrite("replicatedAllReduceBucketSize",
+                      &SessionOptions::replicatedAllReduceBucketSize);
+    cls.def_readwrite("sparseWeightUpdateTensors",
+                      &SessionOptions::sparseWeightUpdateTensors);
+    cls.def_readwrite("sparseWeightUpdateMinElements",
+                      &SessionOptions::sparseWeightUpdateMinElements);
+    cls.def_readwrite("packOptimizerStreams",
+                      &SessionOptions::packOptimizerStreams);
+    cls.def_readwrite("fuseOptimizerUpdates",
+                      &SessionOptions::fuseOptimizerUpdates);
+    cls.def_readwrite("learningRateSchedule",
+                      &SessionOptions::learningRateSchedule);
+    cls.def_readwrite("lossScalingSchedule",
+                      &SessionOptions::lossScalingSchedule);
+    cls.def_readwrite("dynamicLossScalingSettings",
+                      &SessionOptions::dynamicLossScalingSettings);
     cls.def_readwrite("rearrangeAnchorsOnHost",
                       &SessionOptions::rearrangeAnchorsOnHost);
     cls.def_readwrite("executionPhaseSettings",
@@ -935,6 +1062,8 @@ PYBIND11_MODULE(popart_core, m) {
     cls.def_readwrite("firstDotOp", &SessionOptions::firstDotOp);
     cls.def_readwrite("constantWeights", &SessionOptions::constantWeights);
     cls.def_readwrite("cachePath", &SessionOptions::cachePath);
+    cls.def_readwrite("enablePlanningCacheSharing",
+                      &SessionOptions::enablePlanningCacheSharing);
     cls.def_readwrite("enableEngineCaching",
                       &SessionOptions::enableEngineCaching);
     cls.def_readwrite("enableFloatingPointChecks",
@@ -989,6 +1118,8 @@ PYBIND11_MODULE(popart_core, m) {
                       &SessionOptions::accumulatorTensorLocationSettings);
     cls.def_readwrite("tensorLocationSettingsOverride",
                       &SessionOptions::tensorLocationSettingsOverride);
+    cls.def_readwrite("replicatedTensorShardingMemoryBudget",
+                      &SessionOptions::replicatedTensorShardingMemoryBudget);
     cls.def_readwrite("accumulateOuterFragmentSettings",
                       &SessionOptions::accumulateOuterFragmentSettings);
   }
@@ -1013,6 +1144,7 @@ PYBIND11_MODULE(popart_core, m) {
     en.value("Standard", RecomputationType::Standard);
     en.value("NormOnly", RecomputationType::NormOnly);
     en.value("Pipeline", RecomputationType::Pipeline);
+    en.value("Budgeted", RecomputationType::Budgeted);
   }
   {
     py::enum_<RecomputeType> en(m, "RecomputeType");
@@ -1057,6 +1189,8 @@ PYBIND11_MODULE(popart_core, m) {
              AccumulateOuterFragmentSchedule::OverlapCycleOptimized);
     en.value("OverlapMemoryOptimized",
              AccumulateOuterFragmentSchedule::OverlapMemoryOptimized);
+    en.value("OverlapStreamedUpdates",
+             AccumulateOuterFragmentSchedule::OverlapStreamedUpdates);
   }
   {
     py::enum_<SyncPattern> en(m, "SyncPattern");
@@ -1070,6 +1204,7 @@ PYBIND11_MODULE(popart_core, m) {
     en.value("All", MergeVarUpdateType::All);
     en.value("AutoTight", MergeVarUpdateType::AutoTight);
     en.value("AutoLoose", MergeVarUpdateType::AutoLoose);
+    en.value("AutoCost", MergeVarUpdateType::AutoCost);
   }
   {
     py::enum_<VirtualGraphMode> en(m, "VirtualGraphMode");
@@ -1077,6 +1212,151 @@ PYBIND11_MODULE(popart_core, m) {
     en.value("Manual", VirtualGraphMode::Manual);
     en.value("Auto", VirtualGraphMode::Auto);
     en.value("ExecutionPhases", VirtualGraphMode::ExecutionPhases);
+    en.value("Balanced", VirtualGraphMode::Balanced);
+  }
+  {
+    py::class_<AutoVirtualGraphStage> cls(m, "AutoVirtualGraphStage");
+    cls.def_readonly("numOps", &AutoVirtualGraphStage::numOps);
+    cls.def_readonly("weightBytes", &AutoVirtualGraphStage::weightBytes);
+    cls.def_readonly("activationBytes",
+                     &AutoVirtualGraphStage::activationBytes);
+    cls.def_readonly("peakLiveBytes", &AutoVirtualGraphStage::peakLiveBytes);
+    cls.def_readonly("computeCost", &AutoVirtualGraphStage::computeCost);
+    cls.def_readonly("copyInBytes", &AutoVirtualGraphStage::copyInBytes);
+  }
+  {
+    py::class_<AutoVirtualGraphPlan> cls(m, "AutoVirtualGraphPlan");
+    cls.def_readonly("placement", &AutoVirtualGraphPlan::placement);
+    cls.def_readonly("stages", &AutoVirtualGraphPlan::stages);
+    cls.def_readonly("totalCopyBytes", &AutoVirtualGraphPlan::totalCopyBytes);
+  }
+  {
+    py::class_<PipelineStashStage> cls(m, "PipelineStashStage");
+    cls.def_readonly("numCandidates", &PipelineStashStage::numCandidates);
+    cls.def_readonly("candidateBytes", &PipelineStashStage::candidateBytes);
+    cls.def_readonly("numStashes", &PipelineStashStage::numStashes);
+    cls.def_readonly("stashBytes", &PipelineStashStage::stashBytes);
+  }
+  {
+    py::class_<PipelineStashReport> cls(m, "PipelineStashReport");
+    cls.def_readonly("stages", &PipelineStashReport::stages);
+    cls.def_readonly("recomputeCost", &PipelineStashReport::recomputeCost);
+  }
+  {
+    py::class_<MergeVarUpdateGroup> cls(m, "MergeVarUpdateGroup");
+    cls.def_readonly("tensors", &MergeVarUpdateGroup::tensors);
+    cls.def_readonly("bytes", &MergeVarUpdateGroup::bytes);
+    cls.def_readonly("benefit", &MergeVarUpdateGroup::benefit);
+  }
+  {
+    py::class_<MergeVarUpdateReport> cls(m, "MergeVarUpdateReport");
+    cls.def_readonly("groups", &MergeVarUpdateReport::groups);
+    cls.def_readonly("totalBenefit", &MergeVarUpdateReport::totalBenefit);
+  }
+  {
+    py::class_<ExecutionPhaseCost> cls(m, "ExecutionPhaseCost");
+    cls.def_readonly("numOps", &ExecutionPhaseCost::numOps);
+    cls.def_readonly("weightBytes", &ExecutionPhaseCost::weightBytes);
+    cls.def_readonly("activationBytes", &ExecutionPhaseCost::activationBytes);
+    cls.def_readonly("computeCost", &ExecutionPhaseCost::computeCost);
+    cls.def_readonly("remoteBytes", &ExecutionPhaseCost::remoteBytes);
+    cls.def_readonly("copyBytes", &ExecutionPhaseCost::copyBytes);
+  }
+  {
+    py::class_<ExecutionPhasePlan> cls(m, "ExecutionPhasePlan");
+    cls.def_readonly("phases", &ExecutionPhasePlan::phases);
+    cls.def_readonly("costs", &ExecutionPhasePlan::costs);
+    cls.def_readonly("stageComputeCosts",
+                     &ExecutionPhasePlan::stageComputeCosts);
+    cls.def_readonly("totalRemoteBytes", &ExecutionPhasePlan::totalRemoteBytes);
+    cls.def_readonly("totalCopyBytes", &ExecutionPhasePlan::totalCopyBytes);
+  }
+  {
+    py::class_<ReplicatedTensorShardingDecision> cls(
+        m, "ReplicatedTensorShardingDecision");
+    cls.def_readonly("vgid", &ReplicatedTensorShardingDecision::vgid);
+    cls.def_readonly("sharded", &ReplicatedTensorShardingDecision::sharded);
+    cls.def_readonly("bytes", &ReplicatedTensorShardingDecision::bytes);
+    cls.def_readonly("savedBytes",
+                     &ReplicatedTensorShardingDecision::savedBytes);
+    cls.def_readonly("collectiveBytes",
+                     &ReplicatedTensorShardingDecision::collectiveBytes);
+    cls.def_readonly("collectiveCycles",
+                     &ReplicatedTensorShardingDecision::collectiveCycles);
+  }
+  {
+    py::class_<ReplicatedTensorShardingPlan> cls(
+        m, "ReplicatedTensorShardingPlan");
+    cls.def_readonly("tensors", &ReplicatedTensorShardingPlan::tensors);
+    cls.def_readonly("locations", &ReplicatedTensorShardingPlan::locations);
+    cls.def_readonly("bytes", &ReplicatedTensorShardingPlan::bytes);
+    cls.def_readonly("fixedBytes", &ReplicatedTensorShardingPlan::fixedBytes);
+    cls.def_readonly("savedBytes", &ReplicatedTensorShardingPlan::savedBytes);
+    cls.def_readonly("collectiveBytes",
+                     &ReplicatedTensorShardingPlan::collectiveBytes);
+    cls.def_readonly("collectiveCycles",
+                     &ReplicatedTensorShardingPlan::collectiveCycles);
+  }
+  {
+    py::class_<PlanningCacheStatistics> cls(m, "PlanningCacheStatistics");
+    cls.def_readonly("repeatedConvPlans",
+                     &PlanningCacheStatistics::repeatedConvPlans);
+    cls.def_readonly("newConvPlans", &PlanningCacheStatistics::newConvPlans);
+    cls.def_readonly("repeatedMatMulPlans",
+                     &PlanningCacheStatistics::repeatedMatMulPlans);
+    cls.def_readonly("newMatMulPlans",
+                     &PlanningCacheStatistics::newMatMulPlans);
+  }
+  {
+    py::class_<ReplicatedAllReduceBucket> cls(m, "ReplicatedAllReduceBucket");
+    cls.def_readonly("tensors", &ReplicatedAllReduceBucket::tensors);
+    cls.def_readonly("bytes", &ReplicatedAllReduceBucket::bytes);
+    cls.def_readonly("benefit", &ReplicatedAllReduceBucket::benefit);
+  }
+  {
+    py::class_<ReplicatedAllReduceBucketReport> cls(
+        m, "ReplicatedAllReduceBucketReport");
+    cls.def_readonly("buckets", &ReplicatedAllReduceBucketReport::buckets);
+    cls.def_readonly("numAllReducesBefore",
+                     &ReplicatedAllReduceBucketReport::numAllReducesBefore);
+    cls.def_readonly("numAllReducesAfter",
+                     &ReplicatedAllReduceBucketReport::numAllReducesAfter);
+    cls.def_readonly("totalBenefit",
+                     &ReplicatedAllReduceBucketReport::totalBenefit);
+  }
+  {
+    py::class_<VirtualGraphMemoryEstimate> cls(m, "VirtualGraphMemoryEstimate");
+    cls.def_readonly("weightBytes", &VirtualGraphMemoryEstimate::weightBytes);
+    cls.def_readonly("optimizerStateBytes",
+                     &VirtualGraphMemoryEstimate::optimizerStateBytes);
+    cls.def_readonly("stashBytes", &VirtualGraphMemoryEstimate::stashBytes);
+    cls.def_readonly("peakActivationBytes",
+                     &VirtualGraphMemoryEstimate::peakActivationBytes);
+    cls.def_readonly("remoteBufferStagingBytes",
+                     &VirtualGraphMemoryEstimate::remoteBufferStagingBytes);
+    cls.def_readonly("peakLiveBytes",
+                     &VirtualGraphMemoryEstimate::peakLiveBytes);
+    cls.def("totalBytes", &VirtualGraphMemoryEstimate::totalBytes);
+  }
+  {
+    py::class_<MemoryEstimate> cls(m, "MemoryEstimate");
+    cls.def_readonly("virtualGraphs", &MemoryEstimate::virtualGraphs);
+    cls.def("getMaxBytes", &MemoryEstimate::getMaxBytes);
+  }
+  {
+    py::class_<BatchSerializationFactorCandidate> cls(
+        m, "BatchSerializationFactorCandidate");
+    cls.def_readonly("factor", &BatchSerializationFactorCandidate::factor);
+    cls.def_readonly("maxBytes", &BatchSerializationFactorCandidate::maxBytes);
+    cls.def_readonly("rejection",
+                     &BatchSerializationFactorCandidate::rejection);
+  }
+  {
+    py::class_<BatchSerializationFactorChoice> cls(
+        m, "BatchSerializationFactorChoice");
+    cls.def_readonly("factor", &BatchSerializationFactorChoice::factor);
+    cls.def_readonly("candidates",
+                     &BatchSerializationFactorChoice::candidates);
   }
   {
     py::enum_<SyntheticDataMode> en(m, "SyntheticDataMode");
@@ -1119,6 +1399,7 @@ PYBIND11_MODULE(popart_core, m) {
     en.value("MatMulOp", PreAliasPatternType::MatMulOp);
     en.value("MatMulLHSGradOp", PreAliasPatternType::MatMulLHSGradOp);
     en.value("MatMulRHSGradOp", PreAliasPatternType::MatMulRHSGradOp);
+    en.value("FusedElementwise", PreAliasPatternType::FusedElementwise);
   }
   {
     py::class_<Patterns> cls(m, "Patterns");
@@ -1233,13 +1514,26 @@ PYBIND11_MODULE(popart_core, m) {
           }
         },
         py::arg("err").none());
-    cls.def("exportInputs",
-            [](InferenceSession &session,
-               std::map<TensorId, py::iterable> inputs,
-               int64_t num_elements,
-               std::string output_filename) {
-              exportInputs(session, inputs, num_elements, output_filename);
-            });
+    cls.def(
+        "exportInputs",
+        [](InferenceSession &session,
+           std::map<TensorId, py::iterable> inputs,
+           int64_t num_elements,
+           std::string output_filename,
+           int64_t elements_per_chunk,
+           bool resume) {
+          exportInputs(session,
+                       inputs,
+                       num_elements,
+                       output_filename,
+                       elements_per_chunk,
+                       resume);
+        },
+        py::arg("inputs"),
+        py::arg("num_elements"),
+        py::arg("output_filename"),
+        py::arg("elements_per_chunk") = 0,
+        py::arg("resume") = false);
     cls.def("setRandomSeed",
             &InferenceSession::setRandomSeed,
             py::arg("seedValue"));
@@ -1276,6 +1570,30 @@ PYBIND11_MODULE(popart_core, m) {
       return py::bytes(report);
     });
     cls.def("getTensorTileMap", &InferenceSession::getTensorTileMap);
+    cls.def("getAutoVirtualGraphPlan",
+            &InferenceSession::getAutoVirtualGraphPlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getPipelineStashReport",
+            &InferenceSession::getPipelineStashReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getMergeVarUpdateReport",
+            &InferenceSession::getMergeVarUpdateReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getExecutionPhasePlan",
+            &InferenceSession::getExecutionPhasePlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getReplicatedTensorShardingPlan",
+            &InferenceSession::getReplicatedTensorShardingPlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getReplicatedAllReduceBucketReport",
+            &InferenceSession::getReplicatedAllReduceBucketReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getMemoryEstimate", &InferenceSession::getMemoryEstimate);
+    cls.def("getPlanningCacheStatistics",
+            &InferenceSession::getPlanningCacheStatistics);
+    cls.def("getBatchSerializationFactorChoice",
+            &InferenceSession::getBatchSerializationFactorChoice,
+            py::return_value_policy::reference_internal);
     cls.def("resetHostWeights",
             &InferenceSession::resetHostWeights,
             py::arg("modelProtoOrFilename"),
@@ -1339,15 +1657,28 @@ PYBIND11_MODULE(popart_core, m) {
     cls.def("readWeights", &TrainingSession::readWeights);
     cls.def("writeWeights", &TrainingSession::writeWeights);
     cls.def("updateOptimizerFromHost",
-            static_cast<void (TrainingSession::*)(const Optimizer *)>(
-                &TrainingSession::updateOptimizerFromHost));
-    cls.def("exportInputs",
-            [](TrainingSession &session,
-               std::map<TensorId, py::iterable> inputs,
-               int64_t num_elements,
-               std::string outputFilename) {
-              exportInputs(session, inputs, num_elements, outputFilename);
-            });
+            static_cast<std::vector<TensorId> (TrainingSession::*)(
+                const Optimizer *)>(&TrainingSession::updateOptimizerFromHost));
+    cls.def(
+        "exportInputs",
+        [](TrainingSession &session,
+           std::map<TensorId, py::iterable> inputs,
+           int64_t num_elements,
+           std::string outputFilename,
+           int64_t elements_per_chunk,
+           bool resume) {
+          exportInputs(session,
+                       inputs,
+                       num_elements,
+                       outputFilename,
+                       elements_per_chunk,
+                       resume);
+        },
+        py::arg("inputs"),
+        py::arg("num_elements"),
+        py::arg("output_filename"),
+        py::arg("elements_per_chunk") = 0,
+        py::arg("resume") = false);
     cls.def("run",
             &TrainingSession::run,
             py::arg("stepio"),
@@ -1377,6 +1708,30 @@ PYBIND11_MODULE(popart_core, m) {
       return py::bytes(report);
     });
     cls.def("getTensorTileMap", &TrainingSession::getTensorTileMap);
+    cls.def("getAutoVirtualGraphPlan",
+            &TrainingSession::getAutoVirtualGraphPlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getPipelineStashReport",
+            &TrainingSession::getPipelineStashReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getMergeVarUpdateReport",
+            &TrainingSession::getMergeVarUpdateReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getExecutionPhasePlan",
+            &TrainingSession::getExecutionPhasePlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getReplicatedTensorShardingPlan",
+            &TrainingSession::getReplicatedTensorShardingPlan,
+            py::return_value_policy::reference_internal);
+    cls.def("getReplicatedAllReduceBucketReport",
+            &TrainingSession::getReplicatedAllReduceBucketReport,
+            py::return_value_policy::reference_internal);
+    cls.def("getMemoryEstimate", &TrainingSession::getMemoryEstimate);
+    cls.def("getPlanningCacheStatistics",
+            &TrainingSession::getPlanningCacheStatistics);
+    cls.def("getBatchSerializationFactorChoice",
+            &TrainingSession::getBatchSerializationFactorChoice,
+            py::return_value_policy::reference_internal);
     cls.def("resetHostWeights",
             &TrainingSession::resetHostWeights,
             py::arg("modelProtoOrFilename"),
@@ -2052,6 +2407,7 @@ PYBIND11_MODULE(popart_core, m) {
   m.def("reservedRestoredPrefix", &reservedRestoredPrefix);
   m.def("reservedLossScalingPrefix", &reservedLossScalingPrefix);
   m.def("reservedRandomSeedPrefix", &reservedRandomSeedPrefix);
+  m.def("reservedGradientOverflowPrefix", &reservedGradientOverflowPrefix);
 
   m.def("reservedRemoteArgPrefix", &reservedRemoteArgPrefix);
 
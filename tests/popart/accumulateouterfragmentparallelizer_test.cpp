@@ -6,6 +6,8 @@
 #include <test_runner.hpp>
 
 #include <popart/names.hpp>
+#include <popart/op/init.hpp>
+#include <popart/op/multitensorupdate.hpp>
 #include <popart/op/remote.hpp>
 #include <popart/transforms/accumulateouterfragmentparallelizer.hpp>
 #include <popart/transforms/transform.hpp>
@@ -19,7 +21,8 @@ using OpGroups = std::vector<OpGroup>;
 
 void runTest(AccumulateOuterFragmentSettings settings,
              std::function<void(Builder &, TensorId &)> build,
-             std::function<void(const std::vector<Op *> &ops)> checker) {
+             std::function<void(const std::vector<Op *> &ops)> checker,
+             bool fuseOptimizerUpdates = false) {
 
   // Pipeline with two IPUs and two replicas. We should end up with
   // 8 independent weight updates in the accumulate outer fragment
@@ -46,6 +49,7 @@ void runTest(AccumulateOuterFragmentSettings settings,
     runner.opts.enableOutlining                 = false;
     runner.opts.accumulateOuterFragmentSettings = settings;
     runner.opts.outlineThreshold                = 10.0f;
+    runner.opts.fuseOptimizerUpdates            = fuseOptimizerUpdates;
     runner.opts.enableGradientAccumulation      = true;
     runner.opts.accumulationFactor              = 4;
     runner.opts.enableReplicatedGraphs          = true;
@@ -183,6 +187,72 @@ void checkRemoteExchangeOp(Op *op,
   }
 };
 
+void buildStreamedUpdates(Builder &builder, TensorId &x) {
+  addMatMul(builder, x, 10, 40, 0, "weight0"); // VGID:0, Size: 400
+  addMatMul(builder, x, 40, 20, 0, "weight1"); // VGID:0, Size: 800
+  addMatMul(builder, x, 20, 25, 0, "weight2"); // VGID:0, Size: 500
+  addMatMul(builder, x, 25, 10, 0, "weight3"); // VGID:0, Size: 250
+  addMatMul(builder, x, 10, 40, 1, "weight0"); // VGID:1, Size: 400
+  addMatMul(builder, x, 40, 20, 1, "weight1"); // VGID:1, Size: 800
+  addMatMul(builder, x, 20, 25, 1, "weight2"); // VGID:1, Size: 500
+  addMatMul(builder, x, 25, 10, 1, "weight3"); // VGID:1, Size: 250
+}
+
+bool hasTensor(const std::vector<Tensor *> &tensors,
+               const std::string &weightName) {
+  return std::any_of(tensors.begin(), tensors.end(), [&](Tensor *t) {
+    return t->id.find(weightName) != std::string::npos;
+  });
+}
+
+bool isRemoteOp(Op *op) {
+  return op->isConvertibleTo<RemoteLoadOp>() ||
+         op->isConvertibleTo<RemoteStoreOp>() ||
+         op->isConvertibleTo<RemoteExchangeOp>();
+}
+
+// Check that the optimizer state of the next weight is loaded before the
+// current weight is updated, and that the optimizer state of the weight after
+// next is only loaded once the current one is stored.
+void checkStreamedUpdates(const std::vector<Op *> &ops) {
+  auto aofOps = filterOps(ops, [](Op *) { return true; });
+
+  // Schedule positions of the first load, the first store and the last
+  // update of each weight's optimizer state.
+  std::map<std::string, size_t> firstLoad;
+  std::map<std::string, size_t> firstStore;
+  std::map<std::string, size_t> lastUpdate;
+  for (size_t i = 0; i < aofOps.size(); ++i) {
+    Op *op = aofOps.at(i);
+    for (std::string name : {"weight0", "weight1", "weight2", "weight3"}) {
+      bool in  = hasTensor(op->input->tensors(), name);
+      bool out = hasTensor(op->output->tensors(), name);
+      if (isRemoteOp(op)) {
+        if (out && !firstLoad.count(name)) {
+          firstLoad[name] = i;
+        }
+        if (in && !out && !firstStore.count(name)) {
+          firstStore[name] = i;
+        }
+      } else if (in && !op->isConvertibleTo<InitOp>()) {
+        lastUpdate[name] = i;
+      }
+    }
+  }
+
+  // Weights are streamed in ascending order of size.
+  std::vector<std::string> order{"weight3", "weight0", "weight2", "weight1"};
+  for (size_t k = 0; k + 1 < order.size(); ++k) {
+    BOOST_REQUIRE(firstLoad.count(order.at(k + 1)));
+    BOOST_REQUIRE(lastUpdate.count(order.at(k)));
+    BOOST_CHECK(firstLoad.at(order.at(k + 1)) < lastUpdate.at(order.at(k)));
+    if (k + 2 < order.size()) {
+      BOOST_REQUIRE(firstStore.count(order.at(k)));
+      BOOST_CHECK(firstStore.at(order.at(k)) < firstLoad.at(order.at(k + 2)));
+    }
+  }
+}
+
 } // anonymous namespace
 
 BOOST_AUTO_TEST_CASE(
@@ -404,3 +474,28 @@ BOOST_AUTO_TEST_CASE(
 
   runTest(config, build, checker);
 }
+
+BOOST_AUTO_TEST_CASE(
+    AccumulateOuterFragmentParallelizer_OverlapStreamedUpdates) {
+  auto config = AccumulateOuterFragmentSettings(
+      AccumulateOuterFragmentSchedule::OverlapStreamedUpdates, {});
+  runTest(config, buildStreamedUpdates, checkStreamedUpdates);
+}
+
+BOOST_AUTO_TEST_CASE(
+    AccumulateOuterFragmentParallelizer_OverlapStreamedUpdates_Fused) {
+  // Test that FuseOptimizerUpdates does not fuse the streamed updates of
+  // different weights, which would put them all in one cluster
+
+  auto config = AccumulateOuterFragmentSettings(
+      AccumulateOuterFragmentSchedule::OverlapStreamedUpdates, {});
+
+  auto checker = [](const std::vector<Op *> &ops) {
+    auto fusedOps = filterOps(
+        ops, [](Op *op) { return op->isConvertibleTo<MultiVarUpdateOp>(); });
+    BOOST_CHECK_EQUAL(fusedOps.size(), 0);
+    checkStreamedUpdates(ops);
+  };
+
+  runTest(config, buildStreamedUpdates, checker, true);
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE AutoVirtualGraphBalancedTest0
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/error.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/session.hpp>
+#include <popart/tensorinfo.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/transforms/auto_virtual_graph.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace popart;
+
+namespace {
+
+// A chain of matmul layers with large weights in the first layers and small
+// weights in the last, so that an even split of the Ops is unbalanced.
+std::unique_ptr<TrainingSession> createSession(VirtualGraphMode mode,
+                                               int numIpus) {
+  auto builder = Builder::create();
+  auto aiOnnx  = builder->aiOnnxOpset9();
+
+  const int64_t batchSize = 4;
+  std::vector<int64_t> hiddenSizes{256, 256, 128, 64, 32, 16, 16, 16};
+
+  TensorInfo inInfo{"FLOAT", std::vector<int64_t>{batchSize, 256}};
+  auto act = builder->addInputTensor(inInfo);
+
+  std::vector<std::vector<float>> weightData;
+  int64_t inSize = 256;
+  for (auto outSize : hiddenSizes) {
+    TensorInfo wInfo{"FLOAT", std::vector<int64_t>{inSize, outSize}};
+    weightData.emplace_back(inSize * outSize, 0.01f);
+    auto w = builder->addInitializedInputTensor(
+        ConstVoidData{weightData.back().data(), wInfo});
+    act    = aiOnnx.matmul({act, w});
+    act    = aiOnnx.relu({act});
+    inSize = outSize;
+  }
+  auto loss = builder->aiGraphcoreOpset1().l1loss({act}, 0.1);
+
+  auto proto     = builder->getModelProto();
+  // Enough batches to fill the pipeline
+  auto dataFlow  = DataFlow(2 * numIpus, {{act, AnchorReturnType("Final")}});
+  auto optimizer = ConstSGD(0.01);
+  auto device    = createTestDevice(TEST_TARGET, numIpus);
+
+  SessionOptions opts;
+  opts.virtualGraphMode = mode;
+  opts.enablePipelining = mode != VirtualGraphMode::Off;
+
+  return TrainingSession::createFromOnnxModel(proto,
+                                              dataFlow,
+                                              loss,
+                                              optimizer,
+                                              device,
+                                              InputShapeInfo(),
+                                              opts,
+                                              Patterns(PatternsLevel::Default));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(AutoVirtualGraphBalanced_DryRun) {
+  const int numIpus = 4;
+
+  // The plan is available without calling prepareDevice
+  auto session = createSession(VirtualGraphMode::Balanced, numIpus);
+  auto &plan   = session->getAutoVirtualGraphPlan();
+
+  BOOST_CHECK_EQUAL(plan.stages.size(), numIpus);
+  BOOST_CHECK(!plan.placement.empty());
+
+  int64_t numOps    = 0;
+  int64_t copyBytes = 0;
+  for (auto &stage : plan.stages) {
+    BOOST_CHECK(stage.numOps > 0);
+    BOOST_CHECK(stage.computeCost > 0.0);
+    numOps += stage.numOps;
+    copyBytes += stage.copyInBytes;
+  }
+  BOOST_CHECK_EQUAL(numOps, plan.placement.size());
+  BOOST_CHECK_EQUAL(copyBytes, plan.totalCopyBytes);
+  BOOST_CHECK(plan.stages.front().copyInBytes == 0);
+  BOOST_CHECK(plan.totalCopyBytes > 0);
+
+  for (auto &id_vgid : plan.placement) {
+    BOOST_CHECK(id_vgid.second >= 0 && id_vgid.second < numIpus);
+  }
+
+  // The greedy partitioner also reports its estimates
+  auto autoSession = createSession(VirtualGraphMode::Auto, numIpus);
+  BOOST_CHECK_EQUAL(autoSession->getAutoVirtualGraphPlan().stages.size(),
+                    numIpus);
+
+  // Without automatic virtual graphs there is no plan
+  auto offSession = createSession(VirtualGraphMode::Off, 1);
+  BOOST_CHECK_THROW(offSession->getAutoVirtualGraphPlan(), error);
+}
+
+BOOST_AUTO_TEST_CASE(AutoVirtualGraphBalanced_ComparedToAuto) {
+  const int numIpus = 4;
+
+  auto balancedSession = createSession(VirtualGraphMode::Balanced, numIpus);
+  auto autoSession     = createSession(VirtualGraphMode::Auto, numIpus);
+  auto &balanced       = balancedSession->getAutoVirtualGraphPlan();
+  auto &greedy         = autoSession->getAutoVirtualGraphPlan();
+
+  // The stage costs of both plans, memory and compute each relative to the
+  // whole graph as placed by Balanced
+  double memoryScale  = 0.0;
+  double computeScale = 0.0;
+  for (auto &stage : balanced.stages) {
+    memoryScale +=
+        stage.weightBytes + stage.activationBytes + stage.peakLiveBytes;
+    computeScale += stage.computeCost;
+  }
+  BOOST_REQUIRE(memoryScale > 0.0 && computeScale > 0.0);
+  auto maxStageCost = [&](const AutoVirtualGraphPlan &plan) {
+    double result = 0.0;
+    for (auto &stage : plan.stages) {
+      double memory =
+          stage.weightBytes + stage.activationBytes + stage.peakLiveBytes;
+      result = std::max(result,
+                        memory / memoryScale +
+                            stage.computeCost / computeScale);
+    }
+    return result;
+  };
+
+  BOOST_TEST_MESSAGE("Balanced: largest stage cost "
+                     << maxStageCost(balanced) << ", "
+                     << balanced.totalCopyBytes
+                     << " bytes copied. Auto: largest stage cost "
+                     << maxStageCost(greedy) << ", " << greedy.totalCopyBytes
+                     << " bytes copied.");
+  BOOST_CHECK(maxStageCost(balanced) < maxStageCost(greedy) ||
+              balanced.totalCopyBytes < greedy.totalCopyBytes);
+}
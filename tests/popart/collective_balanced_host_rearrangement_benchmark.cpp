@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE CollectiveBalancedHostRearrangementBenchmark
+
+#include <boost/test/unit_test.hpp>
+#include <popart/popx/op/collectives/collectivebalancedhostrearrangement.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace popart;
+using namespace popart::popx;
+
+namespace {
+
+// The segments of a CollectiveBalancedReorder of a tensor which is spread
+// evenly over numTiles tiles (see collective_balanced_host_rearrangement_test)
+std::vector<HostRearrangementSegment>
+getTileSegments(int64_t numTiles, int64_t elemsPerTile, int64_t numShards) {
+  int64_t elemsPerShard = (elemsPerTile + numShards - 1) / numShards;
+  std::vector<HostRearrangementSegment> segments;
+  for (int64_t tile = 0; tile < numTiles; ++tile) {
+    for (int64_t shard = 0; shard < numShards; ++shard) {
+      int64_t size =
+          std::min(elemsPerShard, elemsPerTile - shard * elemsPerShard);
+      if (size > 0) {
+        segments.emplace_back(tile * elemsPerTile + shard * elemsPerShard,
+                              (shard * numTiles + tile) * elemsPerShard,
+                              size);
+      }
+    }
+  }
+  return segments;
+}
+
+} // namespace
+
+// A benchmark of the weight rearrangements of remoteBufferWeightsFromHost
+// and remoteBufferWeightsToHost, for a 64 MiB weight on 1216 tiles
+BOOST_AUTO_TEST_CASE(HostRearrangementBenchmark) {
+  using namespace std::chrono;
+
+  int64_t numTiles     = 1216;
+  int64_t elemsPerTile = (int64_t{16} << 20) / numTiles;
+  int64_t numElems     = numTiles * elemsPerTile;
+
+  std::vector<float> in(numElems);
+  std::iota(in.begin(), in.end(), 0.0f);
+  std::vector<float> original(numElems);
+
+  for (int64_t numShards : {2, 4, 8, 16, 32, 64}) {
+    auto segments = getTileSegments(numTiles, elemsPerTile, numShards);
+    int64_t numRElems =
+        numTiles * numShards * ((elemsPerTile + numShards - 1) / numShards);
+    std::vector<float> rearranged(numRElems);
+
+    for (unsigned maxThreads : {1U, 0U}) {
+      auto t0 = steady_clock::now();
+      CollectiveBalancedHostRearrangement plan(segments, maxThreads);
+      auto t1 = steady_clock::now();
+      plan.rearrangeForCollective(reinterpret_cast<const char *>(in.data()),
+                                  reinterpret_cast<char *>(rearranged.data()),
+                                  sizeof(float));
+      auto t2 = steady_clock::now();
+      plan.undoRearrangeForCollective(
+          reinterpret_cast<const char *>(rearranged.data()),
+          reinterpret_cast<char *>(original.data()),
+          sizeof(float));
+      auto t3 = steady_clock::now();
+
+      BOOST_CHECK(original == in);
+
+      auto ms = [](steady_clock::time_point a, steady_clock::time_point b) {
+        return duration_cast<duration<double, std::milli>>(b - a).count();
+      };
+      std::cout << "shards: " << numShards
+                << ", segments: " << plan.getSegments().size()
+                << ", threads: " << plan.getNumThreads(sizeof(float))
+                << ", plan: " << ms(t0, t1) << " ms"
+                << ", rearrange: " << ms(t1, t2) << " ms"
+                << ", undo: " << ms(t2, t3) << " ms" << std::endl;
+    }
+  }
+}
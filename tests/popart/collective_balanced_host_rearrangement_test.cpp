@@ -0,0 +1,110 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE CollectiveBalancedHostRearrangementTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/error.hpp>
+#include <popart/popx/op/collectives/collectivebalancedhostrearrangement.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+using namespace popart;
+using namespace popart::popx;
+
+namespace {
+
+// The segments of a CollectiveBalancedReorder of a tensor which is spread
+// evenly over numTiles tiles: the elements of each tile are split into
+// numShards equally sized (padded) regions, and replica r holds region r of
+// every tile.
+std::vector<HostRearrangementSegment>
+getTileSegments(int64_t numTiles, int64_t elemsPerTile, int64_t numShards) {
+  int64_t elemsPerShard = (elemsPerTile + numShards - 1) / numShards;
+  std::vector<HostRearrangementSegment> segments;
+  for (int64_t tile = 0; tile < numTiles; ++tile) {
+    for (int64_t shard = 0; shard < numShards; ++shard) {
+      int64_t size =
+          std::min(elemsPerShard, elemsPerTile - shard * elemsPerShard);
+      if (size > 0) {
+        segments.emplace_back(tile * elemsPerTile + shard * elemsPerShard,
+                              (shard * numTiles + tile) * elemsPerShard,
+                              size);
+      }
+    }
+  }
+  return segments;
+}
+
+int64_t getNumRearrangedElems(int64_t numTiles,
+                              int64_t elemsPerTile,
+                              int64_t numShards) {
+  return numTiles * numShards * ((elemsPerTile + numShards - 1) / numShards);
+}
+
+// Copy the segments one by one
+std::vector<float>
+referenceRearrange(const std::vector<float> &in,
+                   const std::vector<HostRearrangementSegment> &segments,
+                   int64_t numRearrangedElems) {
+  std::vector<float> out(numRearrangedElems, 0.0f);
+  for (auto &s : segments) {
+    for (int64_t i = 0; i < s.size; ++i) {
+      out[s.rearrangedOffset + i] = in[s.offset + i];
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(HostRearrangementMergeTest) {
+  std::vector<HostRearrangementSegment> segments{
+      {0, 10, 4}, {4, 14, 2}, {6, 0, 3}, {9, 3, 0}, {9, 3, 1}};
+  CollectiveBalancedHostRearrangement plan(segments);
+
+  BOOST_CHECK_EQUAL(plan.getSegments().size(), 2);
+  BOOST_CHECK_EQUAL(plan.getSegments().at(0).size, 6);
+  BOOST_CHECK_EQUAL(plan.getSegments().at(1).size, 4);
+  BOOST_CHECK_EQUAL(plan.getNumElems(), 10);
+
+  BOOST_CHECK_THROW(CollectiveBalancedHostRearrangement({{-1, 0, 1}}),
+                    popart::error);
+}
+
+BOOST_AUTO_TEST_CASE(HostRearrangementThreadsTest) {
+  // 8 MiB of float elements
+  int64_t numTiles     = 64;
+  int64_t elemsPerTile = 32771;
+  int64_t numShards    = 4;
+
+  auto segments     = getTileSegments(numTiles, elemsPerTile, numShards);
+  int64_t numElems  = numTiles * elemsPerTile;
+  int64_t numRElems = getNumRearrangedElems(numTiles, elemsPerTile, numShards);
+
+  std::vector<float> in(numElems);
+  std::iota(in.begin(), in.end(), 0.0f);
+  auto expected = referenceRearrange(in, segments, numRElems);
+
+  for (unsigned maxThreads : {1U, 3U, 8U}) {
+    CollectiveBalancedHostRearrangement plan(segments, maxThreads);
+    BOOST_CHECK_EQUAL(plan.getNumThreads(sizeof(float)), maxThreads);
+
+    std::vector<float> rearranged(numRElems, 0.0f);
+    plan.rearrangeForCollective(reinterpret_cast<const char *>(in.data()),
+                                reinterpret_cast<char *>(rearranged.data()),
+                                sizeof(float));
+    BOOST_CHECK(rearranged == expected);
+
+    std::vector<float> original(numElems, -1.0f);
+    plan.undoRearrangeForCollective(
+        reinterpret_cast<const char *>(rearranged.data()),
+        reinterpret_cast<char *>(original.data()),
+        sizeof(float));
+    BOOST_CHECK(original == in);
+  }
+
+  // Small tensors are not worth the threads
+  CollectiveBalancedHostRearrangement small(getTileSegments(4, 100, 2), 8);
+  BOOST_CHECK_EQUAL(small.getNumThreads(sizeof(float)), 1);
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE MemoryEstimateTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/error.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/memoryestimate.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/session.hpp>
+#include <popart/tensorinfo.hpp>
+#include <popart/testdevice.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t hiddenSize = 16;
+constexpr int64_t numLayers  = 3;
+
+// A chain of MatMuls with a float weight of hiddenSize x hiddenSize each,
+// trained with or without momentum. If wideSize is positive, the input first
+// goes through two MatMuls with constant weights, which widen it to wideSize
+// and back. They have no gradients, so their wide activations are only live
+// in the forward pass, and shrink with the batch.
+std::unique_ptr<TrainingSession>
+createSession(int64_t batchSize,
+              bool withMomentum,
+              const SessionOptions &options = SessionOptions(),
+              int64_t wideSize              = 0) {
+  test_graphs::MatMulChain chain(batchSize, hiddenSize);
+  auto aiOnnx = chain.builder->aiOnnxOpset9();
+
+  if (wideSize > 0) {
+    TensorInfo upInfo{"FLOAT", std::vector<int64_t>{hiddenSize, wideSize}};
+    TensorInfo downInfo{"FLOAT", std::vector<int64_t>{wideSize, hiddenSize}};
+    std::vector<float> wideVals(hiddenSize * wideSize, 0.01f);
+    ConstVoidData upData   = {wideVals.data(), upInfo};
+    ConstVoidData downData = {wideVals.data(), downInfo};
+    auto up                = aiOnnx.constant(upData);
+    auto down              = aiOnnx.constant(downData);
+    auto act               = aiOnnx.matmul({chain.output, up});
+    act                    = aiOnnx.relu({act});
+    chain.output           = aiOnnx.matmul({act, down});
+  }
+  chain.addLayers(numLayers, true);
+  auto loss = chain.addL1Loss();
+
+  auto proto    = chain.builder->getModelProto();
+  auto dataFlow = DataFlow(1, {{loss, AnchorReturnType("All")}});
+  auto device   = createTestDevice(TEST_TARGET);
+
+  std::unique_ptr<Optimizer> optimizer;
+  if (withMomentum) {
+    optimizer = std::make_unique<SGD>(
+        std::map<std::string, std::pair<float, bool>>{
+            {"defaultLearningRate", {0.01f, true}},
+            {"defaultMomentum", {0.9f, true}}});
+  } else {
+    optimizer = std::make_unique<ConstSGD>(0.01);
+  }
+
+  return TrainingSession::createFromOnnxModel(proto,
+                                             dataFlow,
+                                             loss,
+                                             *optimizer,
+                                             device,
+                                             InputShapeInfo(),
+                                             options,
+                                             Patterns(PatternsLevel::Default));
+}
+
+MemoryEstimate estimate(int64_t batchSize, bool withMomentum) {
+  return createSession(batchSize, withMomentum)->getMemoryEstimate();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MemoryEstimate_Categories) {
+  const int64_t weightBytes = numLayers * hiddenSize * hiddenSize * 4;
+
+  auto plain = estimate(4, false);
+  BOOST_REQUIRE_EQUAL(plain.virtualGraphs.size(), 1);
+  auto &vg = plain.virtualGraphs.at(unusedVGraphId);
+  // The weights, and a few scalar constants
+  BOOST_CHECK(vg.weightBytes >= weightBytes);
+  BOOST_CHECK(vg.weightBytes < weightBytes + 64);
+  BOOST_CHECK_EQUAL(vg.stashBytes, 0);
+  BOOST_CHECK_EQUAL(vg.remoteBufferStagingBytes, 0);
+  BOOST_CHECK(vg.peakActivationBytes > 0);
+  BOOST_CHECK_EQUAL(vg.peakLiveBytes, vg.peakActivationBytes);
+  BOOST_CHECK_EQUAL(plain.getMaxBytes(), vg.totalBytes());
+
+  // Momentum adds an accumulator per weight.
+  auto momentum = estimate(4, true);
+  auto &vgm     = momentum.virtualGraphs.at(unusedVGraphId);
+  BOOST_CHECK_EQUAL(vgm.weightBytes, vg.weightBytes);
+  BOOST_CHECK(vgm.optimizerStateBytes >= vg.optimizerStateBytes + weightBytes);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryEstimate_BatchSizeSweep) {
+  int64_t previousActivations = 0;
+  int64_t weightBytes         = -1;
+  for (int64_t batchSize : {1, 4, 16}) {
+    auto memoryEstimate = estimate(batchSize, false);
+    auto &vg            = memoryEstimate.virtualGraphs.at(unusedVGraphId);
+    BOOST_CHECK(vg.peakActivationBytes > previousActivations);
+    previousActivations = vg.peakActivationBytes;
+    if (weightBytes >= 0) {
+      BOOST_CHECK_EQUAL(vg.weightBytes, weightBytes);
+    }
+    weightBytes = vg.weightBytes;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MemoryEstimate_AutoBatchSerializationFactor) {
+  const int64_t batchSize = 8;
+  const int64_t wideSize  = 4096;
+
+  // Without auto batch serialisation there is no choice to report.
+  auto plainSession = createSession(batchSize, false, {}, wideSize);
+  BOOST_CHECK_THROW(plainSession->getBatchSerializationFactorChoice(), error);
+  auto unserializedBytes = plainSession->getMemoryEstimate().getMaxBytes();
+
+  // A budget the unserialised model fits in needs no serialisation.
+  SessionOptions options;
+  options.batchSerializationSettings.autoMemoryBudget = unserializedBytes;
+  auto session = createSession(batchSize, false, options, wideSize);
+  auto &choice = session->getBatchSerializationFactorChoice();
+  BOOST_CHECK_EQUAL(choice.factor, 1);
+  BOOST_REQUIRE_EQUAL(choice.candidates.size(), 1);
+  BOOST_CHECK_EQUAL(choice.candidates.back().maxBytes, unserializedBytes);
+  BOOST_CHECK(choice.candidates.back().rejection.empty());
+
+  // No factor fits a budget of one byte.
+  options.batchSerializationSettings.autoMemoryBudget = 1;
+  BOOST_CHECK_THROW(createSession(batchSize, false, options, wideSize),
+                    error);
+
+  // Only divisors of the batch size are candidates, and the chosen factor is
+  // the first which fits.
+  options.batchSerializationSettings.autoMemoryBudget = unserializedBytes - 1;
+  auto smallerSession = createSession(batchSize, false, options, wideSize);
+  auto &smallerChoice = smallerSession->getBatchSerializationFactorChoice();
+  BOOST_CHECK(smallerChoice.factor > 1);
+  BOOST_CHECK_EQUAL(batchSize % smallerChoice.factor, 0);
+  BOOST_REQUIRE(smallerChoice.candidates.size() > 1);
+  for (auto &candidate : smallerChoice.candidates) {
+    BOOST_CHECK_EQUAL(batchSize % candidate.factor, 0);
+    BOOST_CHECK_EQUAL(candidate.rejection.empty(),
+                      candidate.factor == smallerChoice.factor);
+  }
+  BOOST_CHECK_EQUAL(smallerChoice.candidates.front().factor, 1);
+  auto chosenBytes = smallerChoice.candidates.back().maxBytes;
+  BOOST_CHECK(chosenBytes < unserializedBytes);
+
+  // The session uses the Ir prepared for the chosen candidate
+  BOOST_CHECK_EQUAL(
+      smallerSession->getIr().getSessionOptions().batchSerializationSettings
+          .factor,
+      smallerChoice.factor);
+  BOOST_CHECK_EQUAL(smallerSession->getMemoryEstimate().getMaxBytes(),
+                    chosenBytes);
+}
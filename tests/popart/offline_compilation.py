@@ -179,6 +179,48 @@ class TestOfflineCompilation:
             ) == 1, "Expected a single 'data.bin' file containing input data"
             assert os.path.basename(files[0]) == "data.bin"
 
+    def test_exportInputs_chunked(self):
+        if not popart.exporterIsAvailable():
+            pytest.skip("Exporter support needs to be compiled in")
+
+        self._init_session()
+
+        with tempfile.TemporaryDirectory() as tmpdataset:
+            filename = os.path.join(tmpdataset, "data.bin")
+
+            self._init_data()
+            self.session.exportInputs(
+                {
+                    self.input_a: self.data_a,
+                    self.input_b: self.data_b
+                },
+                3,
+                filename,
+                elements_per_chunk=2)
+
+            files = sorted(
+                os.path.basename(f) for f in glob.glob("%s/*" % tmpdataset))
+            assert files == ["data.bin.0", "data.bin.1"]
+
+            # Resuming must not rewrite existing chunks.
+            os.remove(filename + ".1")
+            mtime = os.path.getmtime(filename + ".0")
+            self._init_data()
+            self.session.exportInputs(
+                {
+                    self.input_a: self.data_a,
+                    self.input_b: self.data_b
+                },
+                3,
+                filename,
+                elements_per_chunk=2,
+                resume=True)
+
+            files = sorted(
+                os.path.basename(f) for f in glob.glob("%s/*" % tmpdataset))
+            assert files == ["data.bin.0", "data.bin.1"]
+            assert os.path.getmtime(filename + ".0") == mtime
+
     def test_compileAndExport_model(self):
         self._init_builder()
         device = popart.DeviceManager().createIpuModelDevice({})
@@ -0,0 +1,124 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import json
+import numpy as np
+import popart
+import pytest
+from op_tester import op_tester
+
+
+# The tanh approximation of popnn, which the fused Gelu uses too
+def np_gelu(x):
+    return 0.5 * x * (1. + np.tanh(0.7978845608 * (x + 0.044715 * x**3)))
+
+
+def np_sigmoid(x):
+    return 1. / (1. + np.exp(-x))
+
+
+def get_ops(session):
+    ir = json.loads(session._serializeIr(popart.IrSerializationFormat.JSON))
+    return ir['maingraph']
+
+
+def get_op_types(session):
+    return [op['type'] for op in get_ops(session)]
+
+
+def set_patterns(op_tester, fused, inplacing):
+    patterns = ['OpToIdentity']
+    if fused:
+        patterns.append('FusedElementwise')
+    op_tester.setPatterns(patterns, enableRuntimeAsserts=False)
+    op_tester.inplacing = inplacing
+
+
+# Mul, Gelu and Add, with inputs broadcast along either dimension. The fused
+# Ops are collected in post-order, from the Mul, whose broadcast input comes
+# before the full one, so that the fused Op has to move the full input to
+# index 0 for the inplace variant.
+@pytest.mark.parametrize("fused", [False, True])
+@pytest.mark.parametrize("inplacing", [False, True])
+def test_fused_elementwise_gelu_broadcast(op_tester, fused, inplacing):
+    x = np.random.uniform(-4, 4, (4, 8)).astype(np.float32)
+    row = np.random.uniform(-1, 1, (8, )).astype(np.float32)
+    column = np.random.uniform(-1, 1, (4, 1)).astype(np.float32)
+    inputIds = {}
+
+    def init_builder(builder):
+        i0 = builder.addInputTensor(x)
+        i1 = builder.addInputTensor(row)
+        i2 = builder.addInputTensor(column)
+        m = builder.aiOnnx.mul([i1, i0])
+        g = builder.aiGraphcore.gelu([m])
+        o = builder.aiOnnx.add([i2, g])
+        builder.addOutputTensor(o)
+        inputIds['x'] = i0
+        return [o]
+
+    def reference(ref_data):
+        return [column + np_gelu(row * x)]
+
+    op_tester.rtol = 1e-5
+    op_tester.atol = 1e-5
+    set_patterns(op_tester, fused, inplacing)
+    session = op_tester.run(init_builder, reference, 'infer')
+
+    types = get_op_types(session)
+    if fused:
+        assert not any(t.startswith('Gelu') for t in types)
+        fusedType = 'FusedElementwise'
+        if inplacing:
+            fusedType = 'FusedElementwiseInplace'
+        fusedOps = [op for op in get_ops(session) if op['type'] == fusedType]
+        assert len(fusedOps) == 1
+        # The full input, which the inplace variant updates, is input 0
+        input0 = [
+            i['name'] for i in fusedOps[0]['inputs'] if int(i['index']) == 0
+        ]
+        assert input0 == [inputIds['x']]
+    else:
+        assert not any(t.startswith('FusedElementwise') for t in types)
+
+
+# The gradients of Sigmoid, Relu and Tanh form a chain which is fused into a
+# single Op, whose ReluGrad is a Select on the Relu output
+@pytest.mark.parametrize("fused", [False, True])
+@pytest.mark.parametrize("inplacing", [False, True])
+def test_fused_elementwise_grads(op_tester, fused, inplacing):
+    x = np.random.uniform(-3, 3, (4, 8)).astype(np.float32)
+
+    def init_builder(builder):
+        i0 = builder.addInputTensor(x)
+        t = builder.aiOnnx.tanh([i0])
+        r = builder.aiOnnx.relu([t])
+        o = builder.aiOnnx.sigmoid([r])
+        builder.addOutputTensor(o)
+        return [
+            o,
+            popart.reservedGradientPrefix() + i0,
+            popart.reservedGradientPrefix() + o,
+        ]
+
+    def reference(ref_data):
+        t = np.tanh(x)
+        r = np.maximum(t, 0)
+        o = np_sigmoid(r)
+        d__o = ref_data.getOutputTensorGrad(0)
+        d__r = d__o * o * (1 - o)
+        d__t = np.where(r > 0, d__r, 0)
+        d__x = d__t * (1 - t * t)
+        return [o, d__x.astype(np.float32), None]
+
+    op_tester.rtol = 1e-5
+    op_tester.atol = 1e-6
+    set_patterns(op_tester, fused, inplacing)
+    session = op_tester.run(init_builder, reference, 'train')
+
+    types = get_op_types(session)
+    grads = ('SigmoidGrad', 'ReluGrad', 'TanhGrad')
+    if fused:
+        assert not any(t in grads for t in types)
+        assert sum(t.startswith('FusedElementwise') for t in types) == 1
+    else:
+        assert all(t in types for t in grads)
+        assert not any(t.startswith('FusedElementwise') for t in types)
@@ -179,3 +179,28 @@ def test_gather_example2(op_tester):
     op_tester.lossReduction = popart.ReductionType.Sum
     op_tester.setPatterns(['PreUniRepl'], enableRuntimeAsserts=False)
     op_tester.run(init_builder, reference, 'train')
+
+
+def test_gather_available_memory_proportion(op_tester):
+    d1 = np.random.rand(3, 16, 4).astype(np.float32)
+    d2 = np.array([[0, 5, 5], [15, 1, 0]]).astype(np.int32)
+    axis = 1
+
+    def init_builder(builder):
+        i1 = builder.addInputTensor(d1)
+        i2 = builder.addInputTensor(d2)
+        o = builder.aiOnnx.gather([i1, i2], axis)
+        builder.setAvailableMemoryProportion(o, 0.3)
+        builder.addOutputTensor(o)
+        return [o, popart.reservedGradientPrefix() + i1]
+
+    def reference(ref_data):
+        out = np.take(d1, d2, axis=axis)
+        # Repeated indices accumulate their gradients
+        d_d1 = np.zeros_like(d1)
+        np.add.at(d_d1, (slice(None), d2.flatten()), 1.0)
+        return [out, d_d1]
+
+    op_tester.lossReduction = popart.ReductionType.Sum
+    op_tester.setPatterns(['PreUniRepl'], enableRuntimeAsserts=False)
+    op_tester.run(init_builder, reference, 'train')
@@ -0,0 +1,204 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import numpy as np
+import pytest
+import popart
+
+# `import test_util` requires adding to sys.path
+import sys
+from pathlib import Path
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+import test_util as tu
+
+dsize = 8
+overflowId = popart.reservedGradientOverflowPrefix() + "flag"
+
+
+def sgd(lossScaling, constLossScaling=False):
+    return popart.SGD({
+        "defaultLearningRate": (0.1, False),
+        "lossScaling": (lossScaling, constLossScaling)
+    })
+
+
+def adam(lossScaling):
+    return popart.Adam({
+        "defaultLearningRate": (0.01, False),
+        "lossScaling": (lossScaling, False)
+    })
+
+
+class Model:
+    """A MatMul trained with dynamic loss scaling, one weight update per
+    run, whose overflow flag is anchored. Without dynamic loss scaling, the
+    same MatMul is trained as a reference"""
+
+    def __init__(self,
+                 dtype,
+                 optimizer,
+                 growthInterval=1000,
+                 accumulationFactor=1,
+                 dynamic=True):
+        builder = popart.Builder()
+        typeName = "FLOAT" if dtype == np.float32 else "FLOAT16"
+        self.ip = builder.addInputTensor(
+            popart.TensorInfo(typeName, [dsize, dsize]))
+        init = np.random.rand(dsize, dsize).astype(dtype)
+        self.w = builder.addInitializedInputTensor(init, "w")
+        x = builder.aiOnnx.matmul([self.ip, self.w])
+        loss = builder.aiGraphcore.l1loss([x], 1.0)
+
+        opts = popart.SessionOptions()
+        opts.dynamicLossScalingSettings.enabled = dynamic
+        opts.dynamicLossScalingSettings.growthInterval = growthInterval
+        if accumulationFactor > 1:
+            opts.enableGradientAccumulation = True
+            opts.accumulationFactor = accumulationFactor
+
+        anchors = {}
+        if dynamic:
+            anchors[overflowId] = popart.AnchorReturnType("All")
+        self.session = popart.TrainingSession(
+            fnModel=builder.getModelProto(),
+            dataFlow=popart.DataFlow(1, anchors),
+            loss=loss,
+            optimizer=optimizer,
+            userOptions=opts,
+            deviceInfo=tu.create_test_device())
+        self.session.prepareDevice()
+        self.session.weightsFromHost()
+        self.anchors = self.session.initAnchorArrays()
+        self.dtype = dtype
+        self.dynamic = dynamic
+
+    def run(self, data):
+        """Run a weight update, and return whether it overflowed and the
+        updated weight. With gradient accumulation, data has the
+        micro-batches as its outer dimension"""
+        self.session.run(popart.PyStepIO({self.ip: data}, self.anchors))
+        weights = {self.w: np.zeros((dsize, dsize), dtype=self.dtype)}
+        self.session.weightsToHost()
+        self.session.readWeights(popart.PyWeightsIO(weights))
+        overflow = self.dynamic and np.any(self.anchors[overflowId])
+        return bool(overflow), weights[self.w]
+
+
+def test_skip_update_on_overflow():
+    np.random.seed(0)
+    model = Model(np.float32, sgd(1.0))
+    data = np.random.rand(dsize, dsize).astype(np.float32)
+
+    overflow, w0 = model.run(data)
+    assert not overflow
+
+    # A gradient which is not finite skips the update
+    bad = np.copy(data)
+    bad[0, 0] = np.inf
+    overflow, w1 = model.run(bad)
+    assert overflow
+    assert np.array_equal(w0, w1)
+
+    overflow, w2 = model.run(data)
+    assert not overflow
+    assert not np.allclose(w1, w2)
+
+
+def test_backoff_until_finite():
+    # The fp16 gradients overflow with the initial loss scaling, which is
+    # halved until they do not
+    np.random.seed(0)
+    model = Model(np.float16, sgd(2.0**15))
+    data = np.random.rand(dsize, dsize).astype(np.float16)
+
+    overflows = []
+    w = None
+    for _ in range(16):
+        overflow, updated = model.run(data)
+        if overflow and w is not None:
+            assert np.array_equal(w, updated)
+        overflows.append(overflow)
+        w = updated
+
+    assert overflows[0]
+    # The loss scaling does not grow back within the growth interval
+    firstFinite = overflows.index(False)
+    assert not any(overflows[firstFinite:])
+
+
+def test_growth():
+    # The loss scaling grows after every update without an overflow, until
+    # the gradients overflow
+    np.random.seed(0)
+    model = Model(np.float16, sgd(1.0), growthInterval=1)
+    data = np.random.rand(dsize, dsize).astype(np.float16)
+
+    overflows = [model.run(data)[0] for _ in range(32)]
+    assert not overflows[0]
+    assert any(overflows)
+
+
+def test_const_loss_scaling():
+    with pytest.raises(popart.popart_exception) as e_info:
+        Model(np.float32, sgd(1.0, constLossScaling=True))
+    assert e_info.value.args[0].startswith(
+        "Dynamic loss scaling requires a non-const loss scaling")
+
+
+def test_reference():
+    # Without an overflow, the loss scaling is compensated exactly in the
+    # weight update, after it has grown and after it has backed off
+    np.random.seed(0)
+    model = Model(np.float32, sgd(1.0), growthInterval=1)
+    np.random.seed(0)
+    reference = Model(np.float32, sgd(1.0), dynamic=False)
+    data = np.random.rand(dsize, dsize).astype(np.float32)
+    bad = np.copy(data)
+    bad[0, 0] = np.inf
+
+    for d in [data, data, data, bad, data, data]:
+        overflow, w = model.run(d)
+        assert overflow == (d is bad)
+        if not overflow:
+            _, expected = reference.run(d)
+            assert np.allclose(w, expected, rtol=1e-5, atol=1e-6)
+
+
+def test_gradient_accumulation():
+    # The accumulators are reset after a skipped weight update, so that the
+    # following weight updates are those of the reference, which never saw
+    # the overflowing micro-batch
+    accumulationFactor = 2
+    np.random.seed(0)
+    model = Model(np.float32, adam(1.0), accumulationFactor=accumulationFactor)
+    np.random.seed(0)
+    reference = Model(np.float32,
+                      adam(1.0),
+                      accumulationFactor=accumulationFactor,
+                      dynamic=False)
+    data = np.random.rand(accumulationFactor, dsize, dsize).astype(np.float32)
+    bad = np.copy(data)
+    bad[1, 0, 0] = np.inf
+
+    overflow, w0 = model.run(data)
+    assert not overflow
+    _, expected = reference.run(data)
+    assert np.allclose(w0, expected, rtol=1e-5, atol=1e-6)
+
+    overflow, w1 = model.run(bad)
+    assert overflow
+    assert np.array_equal(w0, w1)
+
+    for _ in range(2):
+        overflow, w = model.run(data)
+        assert not overflow
+        _, expected = reference.run(data)
+        assert np.allclose(w, expected, rtol=1e-5, atol=1e-6)
+
+
+def test_sgd_gradient_accumulation():
+    # SGD accumulates the gradients into its velocity, which can not be
+    # restored when the update is skipped
+    with pytest.raises(popart.popart_exception) as e_info:
+        Model(np.float32, sgd(1.0), accumulationFactor=2)
+    assert e_info.value.args[0].startswith(
+        "Dynamic loss scaling with gradient accumulation is not supported "
+        "by SGD")
@@ -0,0 +1,121 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import numpy as np
+import pytest
+import popart
+import json
+
+# `import test_util` requires adding to sys.path
+import sys
+from pathlib import Path
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+import test_util as tu
+
+dsize = 8
+numLayers = 3
+
+
+def sgd():
+    return popart.SGD({
+        "defaultLearningRate": (0.1, False),
+        "defaultMomentum": (0.9, False),
+        "defaultWeightDecay": (0.01, False)
+    })
+
+
+def sgd0():
+    # No momentum: the weights are updated by SGD0VarUpdates
+    return popart.SGD({
+        "defaultLearningRate": (0.1, False),
+        "defaultWeightDecay": (0.01, False)
+    })
+
+
+def adam():
+    return popart.Adam({
+        "defaultLearningRate": (0.01, False),
+        "defaultWeightDecay": (0.01, True)
+    })
+
+
+def lamb():
+    return popart.Adam(
+        {
+            "defaultLearningRate": (0.01, False),
+            "maxWeightNorm": (10.0, True)
+        },
+        mode=popart.AdamMode.Lamb)
+
+
+def run(optimizer, fuseOptimizerUpdates, steps=4):
+    """Train a chain of MatMuls, and return the trained weights and the types
+    of the Ops in the main graph"""
+    np.random.seed(0)
+    builder = popart.Builder()
+    ip = builder.addInputTensor(popart.TensorInfo("FLOAT", [dsize, dsize]))
+    x = ip
+    weights = {}
+    for i in range(numLayers):
+        init = np.random.rand(dsize, dsize).astype(np.float32)
+        w = builder.addInitializedInputTensor(init, "w_" + str(i))
+        weights[w] = np.zeros_like(init)
+        x = builder.aiOnnx.matmul([x, w])
+    loss = builder.aiGraphcore.l1loss([x], 0.1)
+
+    opts = popart.SessionOptions()
+    opts.fuseOptimizerUpdates = fuseOptimizerUpdates
+
+    session = popart.TrainingSession(fnModel=builder.getModelProto(),
+                                     dataFlow=popart.DataFlow(1, {}),
+                                     loss=loss,
+                                     optimizer=optimizer,
+                                     userOptions=opts,
+                                     deviceInfo=tu.create_test_device())
+
+    ir = json.loads(session._serializeIr(popart.IrSerializationFormat.JSON))
+    types = [op["type"] for op in ir["maingraph"]]
+
+    session.prepareDevice()
+    session.weightsFromHost()
+    anchors = session.initAnchorArrays()
+
+    data = np.random.rand(dsize, dsize).astype(np.float32)
+    for _ in range(steps):
+        session.run(popart.PyStepIO({ip: data}, anchors))
+
+    session.weightsToHost()
+    session.readWeights(popart.PyWeightsIO(weights))
+    return weights, types
+
+
+@pytest.mark.parametrize("optimizer,fusedTypes", [
+    (sgd0, ["MultiSGD0VarUpdate"]),
+    (sgd, ["MultiSGD1VarUpdate"]),
+    (adam, ["MultiAdamUpdater", "MultiAdamVarUpdate"]),
+    (lamb, ["MultiAdamUpdater", "MultiAdamVarUpdate", "MultiLambSquare"]),
+])
+def test_fused_optimizer_updates(optimizer, fusedTypes):
+    unfused, unfusedTypes = run(optimizer(), False)
+    fused, types = run(optimizer(), True)
+
+    for t in fusedTypes:
+        assert t not in unfusedTypes
+        # All the weights are updated by a single Op
+        assert types.count(t) == 1
+        assert t[len("Multi"):] not in types
+
+    for w in unfused:
+        assert np.allclose(unfused[w], fused[w], rtol=1e-5, atol=1e-6)
+
+
+def test_fused_optimizer_updates_hyper_parameters():
+    # Only the weights with the same hyper parameters are fused
+    opt = sgd()
+    opt.insertSpecific("w_0", {"learningRate": (0.05, False)})
+    unfused, _ = run(opt, False)
+    fused, types = run(opt, True)
+
+    assert types.count("MultiSGD1VarUpdate") == 1
+    assert types.count("SGD1VarUpdate") == 1
+
+    for w in unfused:
+        assert np.allclose(unfused[w], fused[w], rtol=1e-5, atol=1e-6)
@@ -0,0 +1,189 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import math
+import numpy as np
+import pytest
+import popart
+
+# `import test_util` requires adding to sys.path
+import sys
+from pathlib import Path
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+import test_util as tu
+
+dsize = 8
+numUpdates = 8
+lr = 0.1
+
+
+def sgd(factor=1.0, lossScaling=1.0):
+    return popart.SGD({
+        "defaultLearningRate": (lr * factor, False),
+        "defaultMomentum": (0.9, False),
+        "defaultWeightDecay": (0.01, False),
+        "lossScaling": (lossScaling, False)
+    })
+
+
+def adam(factor=1.0, lossScaling=1.0):
+    return popart.Adam({
+        "defaultLearningRate": (0.01 * factor, False),
+        "lossScaling": (lossScaling, False)
+    })
+
+
+def warmupAndStepDecay():
+    schedule = popart.OptimizerSchedule()
+    schedule.warmupSteps = 3
+    schedule.warmupStartFactor = 0.1
+    schedule.decay = popart.OptimizerSchedule.Decay.Step
+    schedule.decaySteps = 2
+    schedule.decayFactor = 0.5
+    return schedule
+
+
+def cosineDecay():
+    schedule = popart.OptimizerSchedule()
+    schedule.decay = popart.OptimizerSchedule.Decay.Cosine
+    schedule.decaySteps = numUpdates
+    schedule.minFactor = 0.1
+    return schedule
+
+
+def train(optimizer,
+          batchesPerStep,
+          opts=None,
+          lrFactors=None,
+          accumulationFactor=1):
+    """Train a chain of MatMuls for numUpdates weight updates, in runs of
+    batchesPerStep. If lrFactors is given, the optimizer is updated from the
+    host before every run"""
+    np.random.seed(0)
+    builder = popart.Builder()
+    ip = builder.addInputTensor(popart.TensorInfo("FLOAT", [dsize, dsize]))
+    x = ip
+    weights = {}
+    for i in range(2):
+        init = np.random.rand(dsize, dsize).astype(np.float32)
+        w = builder.addInitializedInputTensor(init)
+        weights[w] = np.zeros_like(init)
+        x = builder.aiOnnx.matmul([x, w])
+    loss = builder.aiGraphcore.l1loss([x], 0.1)
+
+    opts = opts or popart.SessionOptions()
+    if accumulationFactor > 1:
+        opts.enableGradientAccumulation = True
+        opts.accumulationFactor = accumulationFactor
+
+    session = popart.TrainingSession(fnModel=builder.getModelProto(),
+                                     dataFlow=popart.DataFlow(
+                                         batchesPerStep, {}),
+                                     loss=loss,
+                                     optimizer=optimizer(),
+                                     userOptions=opts,
+                                     deviceInfo=tu.create_test_device())
+    session.prepareDevice()
+    session.weightsFromHost()
+    anchors = session.initAnchorArrays()
+
+    sample = np.random.rand(dsize, dsize).astype(np.float32)
+    shape = [batchesPerStep, accumulationFactor, dsize, dsize]
+    data = np.broadcast_to(sample, shape).squeeze().copy()
+    for run in range(numUpdates // batchesPerStep):
+        if lrFactors:
+            session.updateOptimizerFromHost(optimizer(lrFactors(run)))
+        session.run(popart.PyStepIO({ip: data}, anchors))
+
+    session.weightsToHost()
+    session.readWeights(popart.PyWeightsIO(weights))
+    return weights
+
+
+def check(a, b):
+    for w in a:
+        assert np.allclose(a[w], b[w], rtol=1e-4, atol=1e-6)
+
+
+def test_schedule_evaluate():
+    schedule = warmupAndStepDecay()
+    assert schedule.enabled()
+    expected = [0.1, 0.4, 0.7, 1.0, 1.0, 0.5, 0.5, 0.25]
+    for t, e in enumerate(expected):
+        assert schedule.evaluate(t) == pytest.approx(e)
+
+    schedule = cosineDecay()
+    assert schedule.evaluate(0) == pytest.approx(1.0)
+    assert schedule.evaluate(numUpdates // 2) == pytest.approx(0.55)
+    assert schedule.evaluate(2 * numUpdates) == pytest.approx(0.1)
+
+    schedule = popart.OptimizerSchedule()
+    schedule.decay = popart.OptimizerSchedule.Decay.Exponential
+    schedule.decaySteps = 4
+    schedule.decayFactor = 0.5
+    assert schedule.evaluate(2) == pytest.approx(math.sqrt(0.5))
+
+    assert not popart.OptimizerSchedule().enabled()
+
+
+@pytest.mark.parametrize("optimizer,schedule",
+                         [(sgd, warmupAndStepDecay), (adam, cosineDecay)])
+@pytest.mark.parametrize("accumulationFactor", [1, 2])
+def test_learning_rate_schedule(optimizer, schedule, accumulationFactor):
+    opts = popart.SessionOptions()
+    opts.learningRateSchedule = schedule()
+    # All updates in one run
+    scheduled = train(optimizer,
+                      numUpdates,
+                      opts,
+                      accumulationFactor=accumulationFactor)
+
+    # One update per run, with the learning rate set by the host
+    expected = train(optimizer,
+                     1,
+                     lrFactors=schedule().evaluate,
+                     accumulationFactor=accumulationFactor)
+    check(scheduled, expected)
+
+
+def test_learning_rate_schedule_across_runs():
+    # The schedule continues from one run to the next
+    opts = popart.SessionOptions()
+    opts.learningRateSchedule = warmupAndStepDecay()
+    inRuns = train(sgd, 2, opts)
+
+    opts = popart.SessionOptions()
+    opts.learningRateSchedule = warmupAndStepDecay()
+    check(inRuns, train(sgd, numUpdates, opts))
+
+
+@pytest.mark.parametrize("optimizer", [sgd, adam])
+def test_loss_scaling_schedule(optimizer):
+    # The loss scaling does not change the updates
+    opts = popart.SessionOptions()
+    opts.lossScalingSchedule = warmupAndStepDecay()
+    scheduled = train(lambda f=1.0: optimizer(f, lossScaling=8.0), numUpdates,
+                      opts)
+    check(scheduled, train(optimizer, numUpdates))
+
+
+@pytest.mark.parametrize("optimizer", [
+    lambda: popart.ConstSGD(lr),
+    lambda: popart.Adam({"defaultLearningRate": (0.01, True)}),
+])
+def test_const_learning_rate_schedule(optimizer):
+    opts = popart.SessionOptions()
+    opts.learningRateSchedule = cosineDecay()
+    with pytest.raises(popart.popart_exception) as e_info:
+        train(optimizer, numUpdates, opts)
+    assert "Only non-const learning rates" in e_info.value.args[0]
+
+
+def test_const_loss_scaling_schedule():
+    opts = popart.SessionOptions()
+    opts.lossScalingSchedule = warmupAndStepDecay()
+    optimizer = lambda: popart.SGD({
+        "defaultLearningRate": (lr, False),
+        "lossScaling": (8.0, True)
+    })
+    with pytest.raises(popart.popart_exception) as e_info:
+        train(optimizer, numUpdates, opts)
+    assert "Only a non-const loss scaling" in e_info.value.args[0]
@@ -0,0 +1,102 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import numpy as np
+import pytest
+import popart
+
+# `import test_util` requires adding to sys.path
+import sys
+from pathlib import Path
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+import test_util as tu
+
+dsize = 8
+numLayers = 3
+
+
+def sgd(lr):
+    # Non-const values, some of them specific to the weights, so that there
+    # are many optimizer tensors
+    opt = popart.SGD({
+        "defaultLearningRate": (lr, False),
+        "defaultMomentum": (0.9, False),
+        "defaultWeightDecay": (0.01, False),
+        "lossScaling": (2.0, False)
+    })
+    for i in range(numLayers):
+        opt.insertSpecific("w_" + str(i), {
+            "learningRate": (lr / (i + 1), False),
+            "weightDecay": (0.001 * i, False)
+        })
+    return opt
+
+
+def run(optimizers, packOptimizerStreams, steps=6, changed=None):
+    """Train a chain of MatMuls, replacing the optimizer at the steps which are
+    keys of optimizers, and return the trained weights. If changed is a dict,
+    the optimizer tensors changed by each replacement are stored in it"""
+    np.random.seed(0)
+    builder = popart.Builder()
+    ip = builder.addInputTensor(popart.TensorInfo("FLOAT", [dsize, dsize]))
+    x = ip
+    weights = {}
+    for i in range(numLayers):
+        init = np.random.rand(dsize, dsize).astype(np.float32)
+        w = builder.addInitializedInputTensor(init, "w_" + str(i))
+        weights[w] = np.zeros_like(init)
+        x = builder.aiOnnx.matmul([x, w])
+    loss = builder.aiGraphcore.l1loss([x], 0.1)
+
+    opts = popart.SessionOptions()
+    opts.packOptimizerStreams = packOptimizerStreams
+
+    session = popart.TrainingSession(fnModel=builder.getModelProto(),
+                                     dataFlow=popart.DataFlow(1, {}),
+                                     loss=loss,
+                                     optimizer=optimizers[0],
+                                     userOptions=opts,
+                                     deviceInfo=tu.create_test_device())
+    session.prepareDevice()
+    session.weightsFromHost()
+    anchors = session.initAnchorArrays()
+
+    data = np.random.rand(dsize, dsize).astype(np.float32)
+    for step in range(steps):
+        if step in optimizers and step > 0:
+            ids = session.updateOptimizerFromHost(optimizers[step])
+            if changed is not None:
+                changed[step] = ids
+        session.run(popart.PyStepIO({ip: data}, anchors))
+
+    session.weightsToHost()
+    session.readWeights(popart.PyWeightsIO(weights))
+    return weights
+
+
+# Step 2 only changes the learning rates, step 4 changes nothing
+schedule = {0: sgd(0.1), 2: sgd(0.05), 4: sgd(0.05)}
+
+
+@pytest.mark.parametrize("packOptimizerStreams", [False, True])
+def test_optimizer_updates(packOptimizerStreams):
+    changed = {}
+    updated = run(schedule, packOptimizerStreams, changed=changed)
+
+    # The learning rates are written at step 2, and nothing at step 4
+    assert any("learningrate" in id.lower() for id in changed[2])
+    assert changed[4] == []
+
+    # Training without the updates which change nothing gives the same weights
+    expected = run({0: sgd(0.1), 2: sgd(0.05)}, packOptimizerStreams)
+    for w in updated:
+        assert np.allclose(updated[w], expected[w])
+
+    # The new learning rates are used
+    unchanged = run({0: sgd(0.1)}, packOptimizerStreams)
+    assert not np.allclose(updated["w_0"], unchanged["w_0"])
+
+
+def test_packed_optimizer_streams():
+    unpacked = run(schedule, packOptimizerStreams=False)
+    packed = run(schedule, packOptimizerStreams=True)
+    for w in unpacked:
+        assert np.allclose(unpacked[w], packed[w])
@@ -0,0 +1,117 @@
+# Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+import numpy as np
+import pytest
+import popart
+import json
+
+# `import test_util` requires adding to sys.path
+import sys
+from pathlib import Path
+sys.path.append(str(Path(__file__).resolve().parent.parent))
+import test_util as tu
+
+numRows = 64
+embeddingSize = 8
+numLookups = 6
+
+
+def run(optimizer, sparseTensors=(), minElements=0, accumFactor=1, steps=3):
+    """Train a lookup of an embedding table, and return the trained table and
+    the types of the Ops in the main graph"""
+    np.random.seed(0)
+    table = np.random.rand(numRows, embeddingSize).astype(np.float32)
+    # Some rows are looked up more than once
+    indices = np.array([3, 7, 3, 60, 0, 7], dtype=np.int32)
+
+    builder = popart.Builder()
+    w = builder.addInitializedInputTensor(table, "table")
+    idx = builder.addInputTensor(popart.TensorInfo("INT32", [numLookups]))
+    x = builder.aiOnnx.gather([w, idx])
+    x = builder.aiOnnx.mul([x, x])
+    loss = builder.aiGraphcore.l1loss([x], 0.1)
+
+    opts = popart.SessionOptions()
+    opts.sparseWeightUpdateTensors = set(sparseTensors)
+    opts.sparseWeightUpdateMinElements = minElements
+    if accumFactor > 1:
+        opts.enableGradientAccumulation = True
+        opts.accumulationFactor = accumFactor
+
+    session = popart.TrainingSession(
+        fnModel=builder.getModelProto(),
+        dataFlow=popart.DataFlow(1, {}),
+        loss=loss,
+        optimizer=optimizer,
+        userOptions=opts,
+        deviceInfo=tu.create_test_device())
+
+    ir = json.loads(session._serializeIr(popart.IrSerializationFormat.JSON))
+    types = [op["type"] for op in ir["maingraph"]]
+
+    session.prepareDevice()
+    session.weightsFromHost()
+    anchors = session.initAnchorArrays()
+
+    data = indices
+    if accumFactor > 1:
+        data = np.stack([indices] * accumFactor)
+    for _ in range(steps):
+        session.run(popart.PyStepIO({idx: data}, anchors))
+
+    session.weightsToHost()
+    result = np.zeros_like(table)
+    session.readWeights(popart.PyWeightsIO({w: result}))
+    return result, types
+
+
+def sgd():
+    return popart.SGD({
+        "defaultLearningRate": (0.1, True),
+        "defaultMomentum": (0.9, True),
+        "defaultDampening": (0.1, True),
+        "defaultWeightDecay": (0.01, True)
+    })
+
+
+def adam():
+    return popart.Adam({
+        "defaultLearningRate": (0.01, True),
+        "defaultBeta1": (0.9, True),
+        "defaultBeta2": (0.999, True),
+    })
+
+
+def test_sparse_sgd_momentum():
+    dense, denseTypes = run(sgd())
+    sparse, sparseTypes = run(sgd(), sparseTensors=["table"])
+
+    assert "SparseAccumulate" not in denseTypes
+    assert "SparseAccumulate" in sparseTypes
+    # The dense gradient of the table is not formed
+    assert "GatherGrad" not in sparseTypes
+
+    assert np.allclose(dense, sparse, rtol=1e-5, atol=1e-6)
+
+
+def test_sparse_adam_gradient_accumulation():
+    dense, _ = run(adam(), accumFactor=2)
+    sparse, sparseTypes = run(adam(), sparseTensors=["table"], accumFactor=2)
+
+    assert "SparseAccumulate" in sparseTypes
+    assert "GatherGrad" not in sparseTypes
+
+    assert np.allclose(dense, sparse, rtol=1e-5, atol=1e-6)
+
+
+def test_sparse_adam_without_accumulation_is_dense():
+    # Without gradient accumulation Adam has no accumulator to update sparsely
+    _, types = run(adam(), sparseTensors=["table"])
+    assert "SparseAccumulate" not in types
+
+
+@pytest.mark.parametrize("minElements,expectSparse",
+                         [(numRows * embeddingSize, True),
+                          (numRows * embeddingSize + 1, False)])
+def test_sparse_weight_update_min_elements(minElements, expectSparse):
+    _, types = run(sgd(), minElements=minElements, steps=1)
+    assert ("SparseAccumulate" in types) == expectSparse
@@ -0,0 +1,127 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE FusedElementwisePatternTest
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/filereader.hpp>
+#include <popart/graph.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/fusedelementwise.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensordata.hpp>
+#include <popart/tensors.hpp>
+#include <popart/testdevice.hpp>
+
+using namespace popart;
+
+BOOST_AUTO_TEST_CASE(FusedElementwise_Inference) {
+  auto builder     = Builder::create();
+  auto aiOnnx      = builder->aiOnnxOpset9();
+  auto aiGraphcore = builder->aiGraphcoreOpset1();
+
+  auto x = builder->addInputTensor(
+      TensorInfo{"FLOAT", std::vector<int64_t>{4, 8}});
+  auto b =
+      builder->addInputTensor(TensorInfo{"FLOAT", std::vector<int64_t>{8}});
+
+  // The bias is broadcast, and x is used by two of the fused Ops
+  auto scaled = aiGraphcore.scale({x}, 0.5f);
+  auto biased = aiOnnx.add({b, scaled});
+  auto gelu   = aiGraphcore.gelu({biased});
+  auto out    = aiOnnx.mul({gelu, x});
+
+  auto proto      = builder->getModelProto();
+  auto modelProto = io::getModelFromString(proto);
+  auto dataFlow   = DataFlow(1, {{out, AnchorReturnType("All")}});
+  auto device     = createTestDevice(TEST_TARGET);
+
+  Ir ir;
+  ir.prepare({modelProto,
+              InputShapeInfo(),
+              dataFlow,
+              {},
+              nullptr,
+              *device,
+              SessionOptions(),
+              Patterns({PreAliasPatternType::FusedElementwise})
+                  .enableRuntimeAsserts(false)});
+
+  auto fused = ir.opsOfType(Onnx::CustomOperators::FusedElementwise);
+  BOOST_REQUIRE_EQUAL(fused.size(), 1);
+
+  auto fusedOp = dynamic_cast<FusedElementwiseOp *>(fused.front());
+  BOOST_REQUIRE(fusedOp);
+  BOOST_CHECK_EQUAL(fusedOp->input->n(), 2);
+  // The input which is not broadcast comes first
+  BOOST_CHECK_EQUAL(fusedOp->inId(0), x);
+  BOOST_CHECK_EQUAL(fusedOp->outId(FusedElementwiseOp::getOutIndex()), out);
+  BOOST_CHECK(fusedOp->outInfo(FusedElementwiseOp::getOutIndex()).shape() ==
+              (Shape{4, 8}));
+
+  using Type  = FusedElementwiseStep::Type;
+  auto &steps = fusedOp->getSteps();
+  BOOST_REQUIRE_EQUAL(steps.size(), 4);
+  BOOST_CHECK(steps.at(0).type == Type::Scale);
+  BOOST_CHECK_EQUAL(steps.at(0).scaleFactor, 0.5f);
+  BOOST_CHECK(steps.at(0).operands == std::vector<int>{0});
+  BOOST_CHECK(steps.at(1).type == Type::Add);
+  BOOST_CHECK(steps.at(1).operands ==
+              (std::vector<int>{1, FusedElementwiseStep::stepOperand(0)}));
+  BOOST_CHECK(steps.at(2).type == Type::Gelu);
+  BOOST_CHECK(steps.at(3).type == Type::Mul);
+  BOOST_CHECK(steps.at(3).operands ==
+              (std::vector<int>{FusedElementwiseStep::stepOperand(2), 0}));
+}
+
+BOOST_AUTO_TEST_CASE(FusedElementwise_Training) {
+  auto builder     = Builder::create();
+  auto aiOnnx      = builder->aiOnnxOpset9();
+  auto aiGraphcore = builder->aiGraphcoreOpset1();
+
+  TensorInfo info{"FLOAT", std::vector<int64_t>{4, 8}};
+  std::vector<float> wVals(4 * 8, 1.0f);
+  ConstVoidData wData = {wVals.data(), info};
+
+  auto x       = builder->addInputTensor(info);
+  auto w       = builder->addInitializedInputTensor(wData);
+  auto product = aiOnnx.mul({x, w});
+  auto sigmoid = aiOnnx.sigmoid({product});
+  auto scaled  = aiGraphcore.scale({sigmoid}, 2.0f);
+  auto out     = aiOnnx.tanh({scaled});
+  auto loss    = aiGraphcore.l1loss({out}, 0.1);
+
+  auto proto      = builder->getModelProto();
+  auto modelProto = io::getModelFromString(proto);
+  auto dataFlow   = DataFlow(1, {{loss, AnchorReturnType("All")}});
+  auto optimizer  = ConstSGD(0.01);
+  auto device     = createTestDevice(TEST_TARGET);
+
+  Ir ir;
+  ir.prepare({modelProto,
+              InputShapeInfo(),
+              dataFlow,
+              loss,
+              &optimizer,
+              *device,
+              SessionOptions(),
+              Patterns(PatternsLevel::Default)
+                  .enablePattern(PreAliasPatternType::FusedElementwise, true)
+                  .enableInPlace(false)});
+
+  auto fused = ir.opsOfType(Onnx::CustomOperators::FusedElementwise);
+  BOOST_CHECK(!fused.empty());
+  for (auto op : fused) {
+    BOOST_CHECK(dynamic_cast<FusedElementwiseOp *>(op)->getSteps().size() >=
+                2);
+  }
+
+  // The outputs of Sigmoid and Tanh are needed by their gradients, so are not
+  // fused away
+  auto &tensors = ir.getMainGraph().getTensors();
+  BOOST_CHECK(tensors.contains(sigmoid));
+  BOOST_CHECK(tensors.contains(out));
+  BOOST_CHECK(!tensors.contains(scaled));
+}
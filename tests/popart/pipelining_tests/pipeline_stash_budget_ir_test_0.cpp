@@ -0,0 +1,168 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE PipelineStashBudgetIrTest0
+
+#include <algorithm>
+#include <memory>
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/filereader.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/stash.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensordata.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/transforms/pipeline.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t nIpus{3};
+
+// Prepare a pipelined model, with recomputable activations on every IPU, and
+// return the number of StashOps on each virtual graph. The report's recompute
+// cost must be that of the Ops left as Recompute.
+std::map<VGraphId, int> prepare(Ir &ir,
+                                RecomputationType recomputationType,
+                                int64_t budget) {
+  auto builder     = Builder::create();
+  auto aiOnnx      = builder->aiOnnxOpset9();
+  auto aiGraphcore = builder->aiGraphcoreOpset1();
+  TensorInfo info{"FLOAT", std::vector<int64_t>{4, 4}};
+  std::vector<float> wVals(4 * 4, 1.0f);
+  ConstVoidData wData = {wVals.data(), info};
+
+  auto input = builder->addInputTensor(info);
+  auto w     = builder->addInitializedInputTensor(wData);
+
+  auto act = aiOnnx.add({input, w});
+  builder->virtualGraph(act, 0);
+
+  for (VGraphId vgid = 0; vgid < nIpus; ++vgid) {
+    act = aiOnnx.sigmoid({act});
+    builder->virtualGraph(act, vgid);
+    auto act0 = aiOnnx.sin({act});
+    builder->virtualGraph(act0, vgid);
+    auto act1 = aiOnnx.cos({act});
+    builder->virtualGraph(act1, vgid);
+    act = aiOnnx.matmul({act0, act1});
+    builder->virtualGraph(act, vgid);
+  }
+
+  act = aiGraphcore.l1loss({act}, 0.1);
+  builder->virtualGraph(act, nIpus - 1);
+
+  auto proto      = builder->getModelProto();
+  auto modelProto = io::getModelFromString(proto);
+  auto dataFlow   = DataFlow(100, {{act, AnchorReturnType("All")}});
+
+  SessionOptions userOptions;
+  userOptions.virtualGraphMode              = VirtualGraphMode::Manual;
+  userOptions.enablePipelining              = true;
+  userOptions.autoRecomputation             = recomputationType;
+  userOptions.autoRecomputationMemoryBudget = budget;
+
+  auto optimizer = ConstSGD(0.01);
+  auto device    = createTestDevice(TEST_TARGET, nIpus);
+
+  ir.prepare({modelProto,
+              InputShapeInfo(),
+              dataFlow,
+              act,
+              &optimizer,
+              *device,
+              userOptions,
+              Patterns(PatternsLevel::Default)});
+
+  std::map<VGraphId, int> numStashes;
+  int numRecomputed = 0;
+  for (auto op : ir.getMainGraph().getOpSchedule({})) {
+    if (op->isConvertibleTo<StashOp>()) {
+      ++numStashes[op->getVirtualGraphId()];
+      // A stashed tensor is restored, not recomputed
+      auto stashed = op->inTensor(StashOp::getInIndex());
+      if (stashed->hasProducer()) {
+        BOOST_CHECK(stashed->getProducer()->settings.recomputeType ==
+                    RecomputeType::Checkpoint);
+      }
+    }
+    if (op->settings.recomputeType == RecomputeType::Recompute) {
+      ++numRecomputed;
+    }
+    // Backwards pass Ops must not be Recompute
+    if (op->fromLoss == PathFromLoss::Yes) {
+      BOOST_CHECK(op->settings.recomputeType == RecomputeType::Checkpoint);
+    }
+  }
+  BOOST_CHECK_EQUAL(numRecomputed == 0,
+                    ir.getPipelineStashReport()->recomputeCost == 0.0);
+  return numStashes;
+}
+
+int64_t totalStashBytes(const PipelineStashReport &report) {
+  int64_t total = 0;
+  for (auto &stage : report.stages) {
+    BOOST_CHECK(stage.second.stashBytes <= stage.second.candidateBytes);
+    total += stage.second.stashBytes;
+  }
+  return total;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PipelineStashBudget_NoBudgetMatchesStandard) {
+  Ir standardIr;
+  auto standardStashes = prepare(standardIr, RecomputationType::Standard, 0);
+
+  Ir budgetedIr;
+  auto budgetedStashes = prepare(budgetedIr, RecomputationType::Budgeted, 0);
+
+  BOOST_CHECK(standardStashes == budgetedStashes);
+  BOOST_REQUIRE(budgetedIr.getPipelineStashReport() != nullptr);
+  BOOST_CHECK_EQUAL(totalStashBytes(*standardIr.getPipelineStashReport()),
+                    totalStashBytes(*budgetedIr.getPipelineStashReport()));
+  BOOST_CHECK(budgetedIr.getPipelineStashReport()->recomputeCost > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(PipelineStashBudget_BudgetReducesRecompute) {
+  Ir noRecomputeIr;
+  prepare(noRecomputeIr, RecomputationType::None, 0);
+  auto &noRecompute = *noRecomputeIr.getPipelineStashReport();
+
+  Ir minimalIr;
+  prepare(minimalIr, RecomputationType::Budgeted, 0);
+  auto &minimal = *minimalIr.getPipelineStashReport();
+
+  // Without recomputation every candidate is stashed.
+  for (auto &stage : noRecompute.stages) {
+    BOOST_CHECK_EQUAL(stage.second.numStashes, stage.second.numCandidates);
+    BOOST_CHECK_EQUAL(stage.second.stashBytes, stage.second.candidateBytes);
+  }
+  BOOST_CHECK_EQUAL(noRecompute.recomputeCost, 0.0);
+  BOOST_CHECK(totalStashBytes(minimal) < totalStashBytes(noRecompute));
+
+  // A budget large enough for every stash removes all recomputation.
+  Ir largeIr;
+  prepare(largeIr, RecomputationType::Budgeted, totalStashBytes(noRecompute));
+  auto &large = *largeIr.getPipelineStashReport();
+  BOOST_CHECK_EQUAL(large.recomputeCost, 0.0);
+  BOOST_CHECK(totalStashBytes(large) > totalStashBytes(minimal));
+
+  // A budget in between, with room for one more 4x4 float stash of the
+  // deepest stash size on every IPU, stashes some recomputable activations.
+  int64_t budget = 0;
+  for (auto &stage : minimal.stages) {
+    budget = std::max(budget, stage.second.stashBytes);
+  }
+  budget += 4 * 4 * 4 * (2 * nIpus - 1);
+  Ir partialIr;
+  prepare(partialIr, RecomputationType::Budgeted, budget);
+  auto &partial = *partialIr.getPipelineStashReport();
+  BOOST_CHECK(partial.recomputeCost < minimal.recomputeCost);
+  BOOST_CHECK(totalStashBytes(partial) >= totalStashBytes(minimal));
+  BOOST_CHECK(totalStashBytes(partial) <= totalStashBytes(large));
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE PlanningCacheTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/popx/planningcache.hpp>
+#include <popart/session.hpp>
+#include <popart/testdevice.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t size = 16;
+
+// Prepare an inference session for a chain of two MatMuls with the same
+// shapes, followed by one with a wider output, and return its planning cache
+// statistics
+PlanningCacheStatistics prepare(bool shared) {
+  test_graphs::MatMulChain chain(size, size);
+  chain.addLayers(2);
+  auto act = chain.addLayer(2 * size);
+
+  auto proto    = chain.builder->getModelProto();
+  auto dataFlow = DataFlow(1, {{act, AnchorReturnType("All")}});
+  auto device   = createTestDevice(TEST_TARGET);
+
+  SessionOptions opts;
+  opts.enablePlanningCacheSharing = shared;
+
+  auto session = InferenceSession::createFromOnnxModel(
+      proto, dataFlow, device, InputShapeInfo(), opts);
+  session->prepareDevice();
+  return session->getPlanningCacheStatistics();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PlanningCache_NotShared) {
+  // The second MatMul has the same plan as the first, the third does not
+  for (int i = 0; i < 2; ++i) {
+    auto statistics = prepare(false);
+    BOOST_CHECK_EQUAL(statistics.newMatMulPlans, 2);
+    BOOST_CHECK_EQUAL(statistics.repeatedMatMulPlans, 1);
+    BOOST_CHECK_EQUAL(statistics.repeatedConvPlans + statistics.newConvPlans,
+                      0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PlanningCache_Shared) {
+  popx::PlanningCaches::releaseShared();
+  auto first = prepare(true);
+  BOOST_CHECK_EQUAL(first.newMatMulPlans, 2);
+  BOOST_CHECK_EQUAL(first.repeatedMatMulPlans, 1);
+
+  // The second session finds the plans of the first one
+  auto second = prepare(true);
+  BOOST_CHECK_EQUAL(second.newMatMulPlans, 0);
+  BOOST_CHECK_EQUAL(second.repeatedMatMulPlans, 3);
+
+  // Once released, the plans are made again
+  popx::PlanningCaches::releaseShared();
+  auto third = prepare(true);
+  BOOST_CHECK_EQUAL(third.newMatMulPlans, 2);
+  BOOST_CHECK_EQUAL(third.repeatedMatMulPlans, 1);
+}
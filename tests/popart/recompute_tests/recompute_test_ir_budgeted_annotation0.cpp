@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE RecomputeTestIrBudgetedAnnotation0
+
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <vector>
+#include <popart/testdevice.hpp>
+
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/filereader.hpp>
+#include <popart/ir.hpp>
+#include <popart/names.hpp>
+#include <popart/op.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/recompute.hpp>
+#include <popart/sessionoptions.hpp>
+#include <popart/tensordata.hpp>
+
+using namespace popart;
+
+namespace {
+
+// Prepare an Ir of 16 conv + relu layers with Budgeted auto-recomputation
+std::unique_ptr<Ir> prepareIr(int64_t memoryBudget) {
+  auto builder = Builder::create();
+  auto aiOnnx  = builder->aiOnnxOpset9();
+
+  TensorInfo input_shape{"FLOAT", std::vector<int64_t>{1, 4, 32, 32}};
+
+  TensorInfo weights_shape{"FLOAT", std::vector<int64_t>{4, 4, 3, 3}};
+  float weight_vals[4 * 4 * 3 * 3] = {0};
+  ConstVoidData weight_data        = {weight_vals, weights_shape};
+
+  auto act = builder->addInputTensor(input_shape);
+
+  for (int i = 0; i < 16; ++i) {
+    auto weights = builder->addInitializedInputTensor(weight_data);
+    act = aiOnnx.conv({act, weights}, {1, 1}, 1, {}, {1, 1, 1, 1}, {1, 1});
+    act = aiOnnx.relu({act});
+  }
+  auto l1 = builder->aiGraphcoreOpset1().l1loss({act}, 0.1);
+
+  auto proto      = builder->getModelProto();
+  auto modelProto = io::getModelFromString(proto);
+
+  auto dataFlow  = DataFlow(1, {{act, AnchorReturnType("All")}});
+  auto optimizer = ConstSGD(0.01);
+  auto device    = createTestDevice(TEST_TARGET);
+
+  SessionOptions opts;
+  opts.autoRecomputation             = RecomputationType::Budgeted;
+  opts.autoRecomputationMemoryBudget = memoryBudget;
+  opts.explicitRecomputation         = false;
+  opts.enableOutlining               = false;
+  opts.mergeVarUpdate                = MergeVarUpdateType::None;
+
+  auto ir = std::make_unique<Ir>();
+  ir->prepare({modelProto,
+               InputShapeInfo(),
+               dataFlow,
+               l1,
+               &optimizer,
+               *device,
+               opts,
+               Patterns({PreAliasPatternType::OptoIdentity,
+                         PreAliasPatternType::PostNRepl})
+                   .enableRuntimeAsserts(false)});
+  return ir;
+}
+
+int countRecompute(Ir &ir) {
+  int nRecompute = 0;
+  for (auto op : ir.getOpSchedule({})) {
+    if (op->settings.recomputeType == RecomputeType::Recompute) {
+      BOOST_CHECK(op->toLoss == PathToLoss::Yes);
+      ++nRecompute;
+    }
+  }
+  return nRecompute;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(BudgetedRecomputeTest) {
+  // With an unlimited budget there is no need to recompute anything
+  auto unlimitedIr = prepareIr(int64_t{1} << 40);
+  BOOST_CHECK_EQUAL(countRecompute(*unlimitedIr), 0);
+
+  // Without a budget, the lowest memory checkpoints are used
+  auto lowestIr = prepareIr(0);
+  BOOST_CHECK(countRecompute(*lowestIr) > 0);
+
+  auto lowestPlans = recompute::planBudgeted(lowestIr->getMainGraph(), 0);
+  BOOST_CHECK_EQUAL(lowestPlans.size(), 1);
+  auto &lowest = lowestPlans.at(0);
+  BOOST_CHECK(lowest.recomputeCost > 0.0);
+  BOOST_CHECK(lowest.estimatedPeakMemory > 0);
+  BOOST_CHECK(lowest.checkpointMemory <= lowest.estimatedPeakMemory);
+
+  // A budget between the lowest and the unlimited peak memory must be met,
+  // and needs less recomputation than the lowest memory plan
+  auto allPlans =
+      recompute::planBudgeted(unlimitedIr->getMainGraph(), int64_t{1} << 40);
+  auto &all = allPlans.at(0);
+  BOOST_CHECK_EQUAL(all.recomputeCost, 0.0);
+  BOOST_CHECK(all.estimatedPeakMemory > lowest.estimatedPeakMemory);
+
+  auto budget =
+      (lowest.estimatedPeakMemory + all.estimatedPeakMemory) / int64_t{2};
+  auto budgetedIr = prepareIr(budget);
+  auto budgetedPlans =
+      recompute::planBudgeted(budgetedIr->getMainGraph(), budget);
+  auto &budgeted = budgetedPlans.at(0);
+  BOOST_CHECK(budgeted.withinBudget);
+  BOOST_CHECK(budgeted.estimatedPeakMemory <= budget);
+  BOOST_CHECK(budgeted.recomputeCost <= lowest.recomputeCost);
+  BOOST_CHECK(countRecompute(*budgetedIr) > 0);
+
+  // An impossible budget falls back to the lowest memory checkpoints
+  auto impossiblePlans = recompute::planBudgeted(lowestIr->getMainGraph(), 1);
+  BOOST_CHECK(!impossiblePlans.at(0).withinBudget);
+  BOOST_CHECK_EQUAL(impossiblePlans.at(0).estimatedPeakMemory,
+                    lowest.estimatedPeakMemory);
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE RunAsyncSessionApiTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/ndarraywrapper.hpp>
+#include <popart/session.hpp>
+#include <popart/stepio.hpp>
+#include <popart/tensorinfo.hpp>
+#include <popart/testdevice.hpp>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace popart;
+
+namespace {
+
+// Forwards to a StepIO and records which step every input and output
+// callback was made for, so the test can check the order in which steps ran.
+class RecordingStepIO : public IStepIO {
+public:
+  RecordingStepIO(StepIO &stepio_, std::vector<int> &history_, std::mutex &m_)
+      : stepio(stepio_), history(history_), m(m_), step(-1) {}
+
+  virtual ConstVoidData in(TensorId id, int64_t numElements, bool prefetch) {
+    record();
+    return stepio.in(id, numElements, prefetch);
+  }
+
+  virtual void inComplete(TensorId id, int64_t numElements) {
+    stepio.inComplete(id, numElements);
+  }
+
+  virtual MutableVoidData out(TensorId id, int64_t numElements) {
+    record();
+    return stepio.out(id, numElements);
+  }
+
+  virtual void outComplete(TensorId id) { stepio.outComplete(id); }
+
+  virtual void assertNumElements(const Ir &ir) const {
+    stepio.assertNumElements(ir);
+  }
+
+  void setStep(int step_) { step = step_; }
+
+private:
+  void record() {
+    std::lock_guard<std::mutex> lock(m);
+    history.push_back(step);
+  }
+
+  StepIO &stepio;
+  std::vector<int> &history;
+  std::mutex &m;
+  int step;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RunAsync_DoubleBufferedOrdering) {
+
+  const int batchesPerStep = 2;
+  const int numSteps       = 6;
+
+  auto builder = Builder::create();
+  auto aiOnnx  = builder->aiOnnxOpset9();
+
+  TensorInfo xInfo{"FLOAT", std::vector<int64_t>{4}};
+  TensorId xId = builder->addInputTensor(xInfo);
+  TensorId yId = aiOnnx.add({xId, xId});
+  builder->addOutputTensor(yId);
+
+  auto proto    = builder->getModelProto();
+  auto dataFlow = DataFlow(batchesPerStep, {{yId, AnchorReturnType("All")}});
+  auto device   = createTestDevice(TEST_TARGET);
+
+  auto session = InferenceSession::createFromOnnxModel(
+      proto,
+      dataFlow,
+      device,
+      InputShapeInfo(),
+      SessionOptions(),
+      Patterns(PatternsLevel::Default));
+
+  session->prepareDevice();
+
+  // Two sets of host buffers, used alternately for consecutive steps.
+  const Shape stepShape{batchesPerStep, 4};
+  std::vector<std::vector<float>> inBuffers(2, std::vector<float>(8));
+  std::vector<std::vector<float>> outBuffers(2, std::vector<float>(8));
+
+  std::vector<std::unique_ptr<NDArrayWrapper<float>>> inArrays;
+  std::vector<std::unique_ptr<NDArrayWrapper<float>>> outArrays;
+  std::vector<std::unique_ptr<StepIO>> stepios;
+  std::vector<std::unique_ptr<RecordingStepIO>> recordingStepios;
+
+  std::vector<int> history;
+  std::mutex historyMutex;
+
+  for (int i = 0; i < 2; ++i) {
+    inArrays.emplace_back(std::make_unique<NDArrayWrapper<float>>(
+        inBuffers[i].data(), stepShape));
+    outArrays.emplace_back(std::make_unique<NDArrayWrapper<float>>(
+        outBuffers[i].data(), stepShape));
+    std::map<TensorId, IArray &> inputs  = {{xId, *inArrays[i]}};
+    std::map<TensorId, IArray &> anchors = {{yId, *outArrays[i]}};
+    stepios.emplace_back(std::make_unique<StepIO>(inputs, anchors));
+    recordingStepios.emplace_back(std::make_unique<RecordingStepIO>(
+        *stepios[i], history, historyMutex));
+  }
+
+  auto checkOutputs = [&](int step) {
+    auto &out = outBuffers[step % 2];
+    for (size_t j = 0; j < out.size(); ++j) {
+      BOOST_CHECK_EQUAL(out[j], 2.0f * (step * 100 + j));
+    }
+  };
+
+  std::vector<SessionRunHandle> handles;
+  for (int step = 0; step < numSteps; ++step) {
+    // Prepare the inputs of this step while the previous step runs. The
+    // buffers of step - 2 are free as that step was waited on below.
+    auto &in = inBuffers[step % 2];
+    for (size_t j = 0; j < in.size(); ++j) {
+      in[j] = static_cast<float>(step * 100 + j);
+    }
+    recordingStepios[step % 2]->setStep(step);
+
+    handles.push_back(session->runAsync(*recordingStepios[step % 2]));
+
+    // Drain the anchors of the previous step while this step runs.
+    if (step > 0) {
+      handles[step - 1].wait();
+      BOOST_CHECK(handles[step - 1].isComplete());
+      checkOutputs(step - 1);
+    }
+  }
+
+  handles.back().wait();
+  checkOutputs(numSteps - 1);
+
+  // Every callback of step N must come before every callback of step N+1.
+  BOOST_CHECK(!history.empty());
+  BOOST_CHECK(std::is_sorted(history.begin(), history.end()));
+  BOOST_CHECK_EQUAL(history.front(), 0);
+  BOOST_CHECK_EQUAL(history.back(), numSteps - 1);
+
+  // A synchronous run waits for outstanding asynchronous steps.
+  recordingStepios[0]->setStep(numSteps);
+  session->runAsync(*recordingStepios[0]);
+  session->run(*recordingStepios[0]);
+  BOOST_CHECK(std::is_sorted(history.begin(), history.end()));
+}
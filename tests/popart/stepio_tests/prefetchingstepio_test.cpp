@@ -0,0 +1,171 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE PrefetchingStepIOTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/error.hpp>
+#include <popart/prefetchingstepio.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace popart;
+
+namespace {
+
+// Upstream IStepIO that returns consecutive values of a float buffer, one
+// element per batch, optionally sleeping to emulate a slow data pipeline.
+class SlowStepIO : public IStepIO {
+public:
+  SlowStepIO(std::vector<float> &buffer_, std::chrono::milliseconds delay_)
+      : buffer(buffer_), delay(delay_), index(0), numInCalls(0) {}
+
+  virtual ConstVoidData in(TensorId, int64_t, bool) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++numInCalls;
+    }
+    called.notify_all();
+    std::this_thread::sleep_for(delay);
+    if (index >= buffer.size()) {
+      throw error("SlowStepIO ran out of data");
+    }
+    return ConstVoidData{&buffer[index], TensorInfo{DataType::FLOAT, {1}}};
+  }
+
+  virtual void inComplete(TensorId, int64_t) { ++index; }
+
+  virtual MutableVoidData out(TensorId, int64_t) { return MutableVoidData{}; }
+
+  virtual void assertNumElements(const Ir &) const {
+    // pass
+  }
+
+  // Block until in has been called n times
+  void waitForInCalls(unsigned n) {
+    std::unique_lock<std::mutex> lock(mutex);
+    called.wait(lock, [&]() { return numInCalls >= n; });
+  }
+
+  unsigned getNumInCalls() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return numInCalls;
+  }
+
+  std::vector<float> &buffer;
+  std::chrono::milliseconds delay;
+  size_t index;
+
+private:
+  std::mutex mutex;
+  std::condition_variable called;
+  unsigned numInCalls;
+};
+
+float readValue(IStepIO &io, const TensorId &id, bool prefetch) {
+  auto data = io.in(id, 1, prefetch);
+  if (data.data == nullptr) {
+    return -1.0f;
+  }
+  return *static_cast<const float *>(data.data);
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchingStepIO_Order) {
+  std::vector<float> buffer{0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+  SlowStepIO upstream(buffer, std::chrono::milliseconds(0));
+
+  PrefetchingStepIOOptions options;
+  options.prefetchDepth       = 3;
+  options.maxFetchesPerTensor = buffer.size();
+  PrefetchingStepIO io(
+      upstream, {{"t", TensorInfo{DataType::FLOAT, {1}}}}, options);
+
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    // Fetching the same batch twice must return the same data.
+    BOOST_CHECK_EQUAL(readValue(io, "t", false), buffer[i]);
+    BOOST_CHECK_EQUAL(readValue(io, "t", false), buffer[i]);
+    io.inComplete("t", 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchingStepIO_PrefetchHits) {
+  // One batch more than is read, so that the worker always fetches the batch
+  // after the one which is read
+  std::vector<float> buffer(17, 0.0f);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<float>(i);
+  }
+  const size_t numBatches = buffer.size() - 1;
+  SlowStepIO upstream(buffer, std::chrono::milliseconds(0));
+
+  PrefetchingStepIOOptions options;
+  options.prefetchDepth       = 4;
+  options.maxFetchesPerTensor = buffer.size();
+  auto io                     = std::make_unique<PrefetchingStepIO>(
+      upstream,
+      std::map<TensorId, TensorInfo>{{"t", TensorInfo{DataType::FLOAT, {1}}}},
+      options);
+
+  for (size_t i = 0; i < numBatches; ++i) {
+    // The worker fetches batch i + 1 only once batch i is in the queue
+    upstream.waitForInCalls(static_cast<unsigned>(i + 2));
+    BOOST_CHECK_EQUAL(readValue(*io, "t", true), buffer[i]);
+    io->inComplete("t", 1);
+  }
+
+  auto stats = io->getStats();
+  BOOST_CHECK_EQUAL(stats.prefetchHits, numBatches);
+  BOOST_CHECK_EQUAL(stats.prefetchMisses, 0);
+  BOOST_CHECK_EQUAL(stats.prefetchHitRate(), 1.0);
+
+  io->resetStats();
+  BOOST_CHECK_EQUAL(io->getStats().prefetchHits, 0);
+
+  // The worker must not read past maxFetchesPerTensor. It has stopped once
+  // the PrefetchingStepIO is destroyed.
+  io.reset();
+  BOOST_CHECK_EQUAL(upstream.getNumInCalls(), buffer.size());
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchingStepIO_BlockingWaitAndError) {
+  std::vector<float> buffer{0.0f, 1.0f};
+  SlowStepIO upstream(buffer, std::chrono::milliseconds(10));
+
+  // Allow one fetch more than the upstream can supply
+  PrefetchingStepIOOptions options;
+  options.maxFetchesPerTensor = buffer.size() + 1;
+  PrefetchingStepIO io(
+      upstream, {{"t", TensorInfo{DataType::FLOAT, {1}}}}, options);
+
+  BOOST_CHECK_EQUAL(readValue(io, "t", false), 0.0f);
+  io.inComplete("t", 1);
+  BOOST_CHECK_EQUAL(readValue(io, "t", false), 1.0f);
+  io.inComplete("t", 1);
+
+  // The upstream error is raised when the data is actually needed.
+  BOOST_CHECK_THROW(readValue(io, "t", false), error);
+
+  // Unknown tensors are an error.
+  BOOST_CHECK_THROW(readValue(io, "u", false), error);
+
+  auto stats = io.getStats();
+  BOOST_CHECK(stats.blockingWaits > 0);
+  BOOST_CHECK(stats.deviceWaitSeconds > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchingStepIO_RequiresMaxFetches) {
+  std::vector<float> buffer{0.0f};
+  SlowStepIO upstream(buffer, std::chrono::milliseconds(0));
+
+  // An unbounded prefetcher would read past the end of the upstream data
+  PrefetchingStepIOOptions options;
+  BOOST_CHECK_THROW(PrefetchingStepIO(upstream,
+                                      {{"t", TensorInfo{DataType::FLOAT, {1}}}},
+                                      options),
+                    error);
+}
+
+} // namespace
@@ -4,6 +4,11 @@
 #include <boost/test/unit_test.hpp>
 #include <popart/stepiosplitter.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+
 using namespace popart;
 
 namespace {
@@ -447,4 +452,222 @@ BOOST_AUTO_TEST_CASE(StepIOSplitter_PrefetchFlag) {
   BOOST_ASSERT(upstreamIo.inCompleteCallHistory[2].numElements == tensorNelms);
 }
 
+// Upstream IStepIO that hands out consecutive elements of a buffer. Calls are
+// serialised by the StepIOSplitter so no locking is needed here.
+class SequentialStepIO : public IStepIO {
+public:
+  SequentialStepIO(std::vector<unsigned> &inBuffer_,
+                   std::vector<unsigned> &outBuffer_,
+                   const TensorInfo &info_)
+      : inBuffer(inBuffer_), outBuffer(outBuffer_), info(info_), inIndex(0),
+        outIndex(0) {}
+
+  virtual ConstVoidData in(TensorId, int64_t, bool) {
+    return ConstVoidData{&inBuffer.at(inIndex), info};
+  }
+
+  virtual void inComplete(TensorId, int64_t) { ++inIndex; }
+
+  virtual MutableVoidData out(TensorId, int64_t) {
+    return MutableVoidData{&outBuffer.at(outIndex), info};
+  }
+
+  virtual void outComplete(TensorId) { ++outIndex; }
+
+  virtual void assertNumElements(const Ir &) const {
+    // pass
+  }
+
+private:
+  std::vector<unsigned> &inBuffer;
+  std::vector<unsigned> &outBuffer;
+  TensorInfo info;
+  size_t inIndex;
+  size_t outIndex;
+};
+
+BOOST_AUTO_TEST_CASE(StepIOSplitter_ConcurrentReplicasStress) {
+
+  // Emulate the Poplar callbacks of every replica running on its own thread
+  // and check that each replica sees exactly its own slice of the upstream
+  // data, in order, while timing the splitter overhead.
+
+  const unsigned NUM_REPLICAS     = 16;
+  const unsigned BATCHES_PER_STEP = 64;
+  const unsigned NUM_STEPS        = 20;
+  const size_t NUM_ELEMENTS       = NUM_REPLICAS * BATCHES_PER_STEP;
+
+  TensorId tensorId{"testTensor1"};
+  TensorInfo tensorInfo{DataType::FLOAT, Shape{1}};
+  int64_t tensorNelms{tensorInfo.nelms()};
+
+  std::vector<unsigned> inDataBuffer(NUM_ELEMENTS, 0u);
+  std::vector<unsigned> outDataBuffer(NUM_ELEMENTS, 0u);
+
+  StepIOSplitter splitter(NUM_REPLICAS, BATCHES_PER_STEP, 1);
+
+  std::vector<IStepIO *> downstreamIos;
+  for (unsigned replicationIndex = 0; replicationIndex < NUM_REPLICAS;
+       ++replicationIndex) {
+    downstreamIos.push_back(
+        splitter.getDownstreamStepIO(tensorId, tensorInfo, replicationIndex));
+  }
+
+  std::atomic<unsigned> numErrors{0};
+  std::chrono::duration<double> totalTime{0};
+
+  for (unsigned step = 0; step < NUM_STEPS; ++step) {
+    SequentialStepIO upstreamIo(inDataBuffer, outDataBuffer, tensorInfo);
+    splitter.setUpstreamIo(&upstreamIo);
+
+    auto replicaFn = [&](unsigned replicationIndex) {
+      auto *io = downstreamIos[replicationIndex];
+      for (unsigned batch = 0; batch < BATCHES_PER_STEP; ++batch) {
+        auto expectedIndex = batch * NUM_REPLICAS + replicationIndex;
+
+        auto inData = io->in(tensorId, tensorNelms, false);
+        if (inData.data != &inDataBuffer[expectedIndex]) {
+          ++numErrors;
+        }
+        io->inComplete(tensorId, tensorNelms);
+
+        auto outData = io->out(tensorId, tensorNelms);
+        if (outData.data != &outDataBuffer[expectedIndex]) {
+          ++numErrors;
+        }
+        io->outComplete(tensorId);
+      }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned replicationIndex = 0; replicationIndex < NUM_REPLICAS;
+         ++replicationIndex) {
+      threads.emplace_back(replicaFn, replicationIndex);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    totalTime += std::chrono::steady_clock::now() - start;
+  }
+
+  BOOST_CHECK(numErrors == 0);
+
+  BOOST_TEST_MESSAGE("StepIOSplitter: " << NUM_STEPS << " steps of "
+                                        << NUM_REPLICAS << " replicas x "
+                                        << BATCHES_PER_STEP << " batches took "
+                                        << totalTime.count() << "s ("
+                                        << totalTime.count() * 1e9 /
+                                               (NUM_STEPS * NUM_ELEMENTS)
+                                        << "ns per in/out pair)");
+}
+
+// Upstream IStepIO for several tensors that, like PyStepIO, is not
+// thread-safe, and counts the calls which overlap with another call.
+class UnsafeStepIO : public IStepIO {
+public:
+  UnsafeStepIO(const std::vector<TensorId> &ids, const TensorInfo &info_)
+      : info(info_), numCalls(0), numOverlaps(0) {
+    for (auto &id : ids) {
+      inIndices[id]  = 0;
+      outIndices[id] = 0;
+    }
+  }
+
+  virtual ConstVoidData in(TensorId, int64_t, bool) {
+    enter();
+    ConstVoidData data{&buffer, info};
+    leave();
+    return data;
+  }
+
+  virtual void inComplete(TensorId id, int64_t) {
+    enter();
+    ++inIndices.at(id);
+    leave();
+  }
+
+  virtual MutableVoidData out(TensorId, int64_t) {
+    enter();
+    MutableVoidData data{&buffer, info};
+    leave();
+    return data;
+  }
+
+  virtual void outComplete(TensorId id) {
+    enter();
+    ++outIndices.at(id);
+    leave();
+  }
+
+  virtual void assertNumElements(const Ir &) const {
+    // pass
+  }
+
+  std::map<TensorId, size_t> inIndices;
+  std::map<TensorId, size_t> outIndices;
+  std::atomic<unsigned> numOverlaps;
+
+private:
+  void enter() {
+    if (numCalls++ != 0) {
+      ++numOverlaps;
+    }
+    // Give the other threads a chance to call in
+    std::this_thread::yield();
+  }
+
+  void leave() { --numCalls; }
+
+  float buffer = 0.0f;
+  TensorInfo info;
+  std::atomic<unsigned> numCalls;
+};
+
+BOOST_AUTO_TEST_CASE(StepIOSplitter_ConcurrentTensors) {
+
+  // Emulate the Poplar callbacks of every replica and tensor running on its
+  // own thread, and check that the upstream IStepIO is never called from two
+  // threads at once.
+
+  const unsigned NUM_REPLICAS     = 4;
+  const unsigned BATCHES_PER_STEP = 64;
+  const std::vector<TensorId> tensorIds{"t0", "t1", "t2", "t3"};
+
+  TensorInfo tensorInfo{DataType::FLOAT, Shape{1}};
+  int64_t tensorNelms{tensorInfo.nelms()};
+
+  StepIOSplitter splitter(NUM_REPLICAS, BATCHES_PER_STEP, 1);
+  UnsafeStepIO upstreamIo(tensorIds, tensorInfo);
+  splitter.setUpstreamIo(&upstreamIo);
+
+  std::vector<std::thread> threads;
+  for (auto &tensorId : tensorIds) {
+    for (unsigned replicationIndex = 0; replicationIndex < NUM_REPLICAS;
+         ++replicationIndex) {
+      auto *io =
+          splitter.getDownstreamStepIO(tensorId, tensorInfo, replicationIndex);
+      threads.emplace_back([io, tensorId, tensorNelms]() {
+        for (unsigned batch = 0; batch < BATCHES_PER_STEP; ++batch) {
+          io->in(tensorId, tensorNelms, false);
+          io->inComplete(tensorId, tensorNelms);
+          io->out(tensorId, tensorNelms);
+          io->outComplete(tensorId);
+        }
+      });
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK_EQUAL(upstreamIo.numOverlaps, 0);
+  for (auto &tensorId : tensorIds) {
+    BOOST_CHECK_EQUAL(upstreamIo.inIndices.at(tensorId),
+                      NUM_REPLICAS * BATCHES_PER_STEP);
+    BOOST_CHECK_EQUAL(upstreamIo.outIndices.at(tensorId),
+                      NUM_REPLICAS * BATCHES_PER_STEP);
+  }
+}
+
 } // namespace
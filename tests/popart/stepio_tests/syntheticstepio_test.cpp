@@ -0,0 +1,124 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE SyntheticStepIOTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/dataflow.hpp>
+#include <popart/error.hpp>
+#include <popart/filereader.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/ir.hpp>
+#include <popart/syntheticstepio.hpp>
+#include <popart/testdevice.hpp>
+
+#include <set>
+
+using namespace popart;
+
+BOOST_AUTO_TEST_CASE(SyntheticStepIO_UniformInt) {
+  const int64_t numElements = 100;
+  const unsigned poolSize   = 4;
+
+  SyntheticStepIO stepio({{"ids", SyntheticInput::uniformInt(3, 10)}},
+                         poolSize);
+
+  std::set<const void *> batches;
+  std::set<int32_t> values;
+  for (unsigned i = 0; i < 2 * poolSize; ++i) {
+    auto data = stepio.in("ids", numElements, false);
+    BOOST_CHECK(data.info.dataType() == DataType::INT32);
+    BOOST_CHECK_EQUAL(data.info.nelms(), numElements);
+    auto ids = static_cast<const int32_t *>(data.data);
+    for (int64_t j = 0; j < numElements; ++j) {
+      BOOST_CHECK(ids[j] >= 3 && ids[j] < 10);
+      values.insert(ids[j]);
+    }
+    batches.insert(data.data);
+    stepio.inComplete("ids", numElements);
+  }
+
+  // The data is not all the same value and the pool is cycled through.
+  BOOST_CHECK(values.size() > 1);
+  BOOST_CHECK_EQUAL(batches.size(), poolSize);
+}
+
+BOOST_AUTO_TEST_CASE(SyntheticStepIO_NormalAndReplay) {
+  const int64_t numElements = 4;
+
+  std::vector<float> recorded{1.0f, 2.0f, 3.0f, 4.0f};
+  ConstVoidData recordedBatch{recorded.data(),
+                              TensorInfo{DataType::FLOAT, {numElements}}};
+
+  SyntheticStepIO stepio({{"x", SyntheticInput::normal(0.0f, 1.0f)},
+                          {"y", SyntheticInput::replay(recordedBatch)}});
+
+  // Replay must not depend on the recorded buffer staying alive.
+  recorded.assign(recorded.size(), 0.0f);
+
+  for (int i = 0; i < 3; ++i) {
+    auto x = stepio.in("x", numElements, false);
+    BOOST_CHECK(x.info.dataType() == DataType::FLOAT);
+    stepio.inComplete("x", numElements);
+
+    auto y      = stepio.in("y", numElements, false);
+    auto values = static_cast<const float *>(y.data);
+    for (int64_t j = 0; j < numElements; ++j) {
+      BOOST_CHECK_EQUAL(values[j], static_cast<float>(j + 1));
+    }
+    stepio.inComplete("y", numElements);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SyntheticStepIO_Outputs) {
+  auto builder = Builder::create();
+  auto aiOnnx  = builder->aiOnnxOpset9();
+
+  TensorInfo info{"FLOAT16", std::vector<int64_t>{4}};
+  auto x = builder->addInputTensor(info);
+  auto y = aiOnnx.add({x, x});
+
+  auto modelProto = io::getModelFromString(builder->getModelProto());
+  auto dataFlow   = DataFlow(1, {{y, AnchorReturnType("All")}});
+  auto device     = createTestDevice(TEST_TARGET);
+
+  Ir ir;
+  ir.prepare({modelProto,
+              InputShapeInfo(),
+              dataFlow,
+              {},
+              nullptr,
+              *device,
+              SessionOptions(),
+              Patterns(PatternsLevel::Default)});
+
+  SyntheticStepIO stepio({{x, SyntheticInput::normal(0.0f, 1.0f)}});
+
+  // The output data types are only known once the Ir has been seen
+  BOOST_CHECK_THROW(stepio.out(y, 4), error);
+
+  stepio.assertNumElements(ir);
+
+  // Outputs are accepted and discarded.
+  auto out = stepio.out(y, 4);
+  BOOST_CHECK(out.data != nullptr);
+  BOOST_CHECK(out.info == TensorInfo(DataType::FLOAT16, {4}));
+}
+
+BOOST_AUTO_TEST_CASE(SyntheticStepIO_Errors) {
+  BOOST_CHECK_THROW(SyntheticInput::uniformInt(5, 5), error);
+  // The range must fit in the data type
+  BOOST_CHECK_THROW(SyntheticInput::uniformInt(0, 257, DataType::UINT8), error);
+  BOOST_CHECK_THROW(SyntheticInput::uniformInt(-1, 10, DataType::UINT32),
+                    error);
+  BOOST_CHECK_THROW(SyntheticInput::uniformInt(0, 10, DataType::FLOAT), error);
+  SyntheticInput::uniformInt(-128, 128, DataType::INT8);
+  BOOST_CHECK_THROW(SyntheticInput::normal(0.0f, 1.0f, DataType::INT32),
+                    error);
+
+  SyntheticStepIO stepio({{"ids", SyntheticInput::uniformInt(0, 10)}});
+  BOOST_CHECK_THROW(stepio.in("unknown", 1, false), error);
+
+  stepio.in("ids", 8, false);
+  // The number of elements must not change between batches.
+  BOOST_CHECK_THROW(stepio.in("ids", 16, false), error);
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE ExecutionPhaseAutoPlanTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/error.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/op.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensor.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/transforms/streamingmemory.hpp>
+
+#include <map>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t size     = 16;
+constexpr int numLayers    = 8;
+constexpr int64_t wBytes   = size * size * 4;
+constexpr int numIpus      = 2;
+constexpr int maxNumPhases = 8;
+
+// Prepare a chain of MatMuls, none of them with an execution phase
+void prepare(Ir &ir,
+             int64_t budget,
+             double timeSlack               = 1.05,
+             const CostModelSettings &costs = {}) {
+  test_graphs::MatMulChain chain(1, size);
+  chain.addLayers(numLayers, true);
+  chain.addL1Loss();
+
+  SessionOptions opts;
+  opts.virtualGraphMode              = VirtualGraphMode::ExecutionPhases;
+  opts.executionPhaseSettings.phases = maxNumPhases;
+  opts.enableOutlining               = false;
+  opts.executionPhaseSettings.autoMemoryBudget = budget;
+  opts.executionPhaseSettings.autoTimeSlack    = timeSlack;
+  opts.costModelSettings                       = costs;
+
+  chain.prepare(
+      ir, createTestDevice(TEST_TARGET, numIpus), opts, ConstSGD(0.01));
+}
+
+// Check the costs of every phase against the budget, and that the phases
+// follow the schedule
+void checkPlan(const Ir &ir, int64_t budget) {
+  auto plan = ir.getExecutionPhasePlan();
+  BOOST_REQUIRE(plan != nullptr);
+  BOOST_REQUIRE(plan->costs.size() > 0);
+  BOOST_CHECK(plan->costs.size() <= maxNumPhases);
+
+  int64_t numOps     = 0;
+  double computeCost = 0.0;
+  for (auto &cost : plan->costs) {
+    BOOST_CHECK(cost.numOps > 0);
+    BOOST_CHECK(cost.weightBytes + cost.activationBytes <= budget);
+    numOps += cost.numOps;
+    computeCost += cost.computeCost;
+  }
+  BOOST_CHECK_EQUAL(numOps, plan->phases.size());
+  BOOST_REQUIRE_EQUAL(plan->stageComputeCosts.size(), 2);
+  BOOST_CHECK_CLOSE(plan->stageComputeCosts[0] + plan->stageComputeCosts[1],
+                    computeCost,
+                    1e-6);
+
+  // The forward Ops which remain keep their planned phases
+  auto &ops = ir.getMainGraph().getOps();
+  for (auto &id_phase : plan->phases) {
+    auto found = ops.find(id_phase.first);
+    if (found != ops.end() &&
+        found->second->settings.executionContext == ExecutionContext::Normal &&
+        !found->second->isIpuCopyOp()) {
+      BOOST_CHECK_EQUAL(found->second->getExecutionPhase(), id_phase.second);
+    }
+  }
+}
+
+// The planned phases of the MatMuls, one per layer, in schedule order
+std::vector<ExecutionPhase> getMatMulPhases(const Ir &ir) {
+  auto &phases = ir.getExecutionPhasePlan()->phases;
+  std::vector<ExecutionPhase> matMulPhases;
+  for (Op *op : ir.getMainGraph().getOpSchedule({})) {
+    auto found = phases.find(op->id);
+    if (found == phases.end()) {
+      continue;
+    }
+    for (Tensor *t : op->input->tensors()) {
+      if (t->tensorType() == TensorType::Variable) {
+        matMulPhases.push_back(found->second);
+        break;
+      }
+    }
+  }
+  return matMulPhases;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ExecutionPhaseAutoPlan_LargeBudget) {
+  const int64_t budget = int64_t(1) << 30;
+  Ir ir;
+  prepare(ir, budget);
+  checkPlan(ir, budget);
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhaseAutoPlan_SmallBudget) {
+  // Room for two weights per phase, and a few activations
+  const int64_t budget = 2 * wBytes + 1024;
+  Ir ir;
+  prepare(ir, budget);
+  checkPlan(ir, budget);
+  for (auto &cost : ir.getExecutionPhasePlan()->costs) {
+    BOOST_CHECK(cost.weightBytes <= 2 * wBytes);
+  }
+  // Eight weights need at least four phases
+  BOOST_CHECK(ir.getExecutionPhasePlan()->costs.size() >= numLayers / 2);
+
+  // The layers are split in order, at most two to a phase
+  auto matMulPhases = getMatMulPhases(ir);
+  BOOST_REQUIRE_EQUAL(matMulPhases.size(), numLayers);
+  std::map<ExecutionPhase, int> matMulsPerPhase;
+  for (int i = 0; i < numLayers; ++i) {
+    if (i > 0) {
+      BOOST_CHECK(matMulPhases[i] >= matMulPhases[i - 1]);
+    }
+    matMulsPerPhase[matMulPhases[i]]++;
+  }
+  for (auto &phase_count : matMulsPerPhase) {
+    BOOST_CHECK(phase_count.second <= 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhaseAutoPlan_TimeSlack) {
+  // With any slowdown allowed, the least traffic is a single phase, which
+  // copies no activations between phases
+  const int64_t budget = int64_t(1) << 30;
+  Ir ir;
+  prepare(ir, budget, 1e9);
+  checkPlan(ir, budget);
+  BOOST_CHECK_EQUAL(ir.getExecutionPhasePlan()->costs.size(), 1);
+  BOOST_CHECK_EQUAL(ir.getExecutionPhasePlan()->costs.at(0).copyBytes, 0);
+  for (auto phase : getMatMulPhases(ir)) {
+    BOOST_CHECK_EQUAL(phase, 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhaseAutoPlan_InvalidCostModel) {
+  const int64_t budget = int64_t(1) << 30;
+  {
+    Ir ir;
+    BOOST_CHECK_THROW(prepare(ir, budget, 0.5), error);
+  }
+  {
+    CostModelSettings costs;
+    costs.macsPerCycle = 0.0;
+    Ir ir;
+    BOOST_CHECK_THROW(prepare(ir, budget, 1.05, costs), error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhaseAutoPlan_Infeasible) {
+  // No phase can hold a single weight
+  Ir ir;
+  BOOST_CHECK_THROW(prepare(ir, wBytes / 2), error);
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE ExecutionPhasePrefetchTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/op.hpp>
+#include <popart/op/remote.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorinfo.hpp>
+#include <popart/testdevice.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t size   = 16;
+constexpr int numLayers  = 6;
+constexpr int64_t wBytes = size * size * 4;
+constexpr int numIpus    = 2;
+
+// A RemoteLoadOp of a weight, and the first phase which consumes it
+struct Load {
+  ExecutionPhase loadPhase;
+  ExecutionPhase usePhase;
+  VGraphId vgid;
+  int64_t bytes;
+};
+
+// Prepare a chain of MatMuls, one per phase, with off-chip weights loaded
+// on demand, and return its RemoteLoadOps
+std::vector<Load> prepare(Ir &ir, int prefetchPhases, int64_t budget) {
+  test_graphs::MatMulChain chain(1, size);
+  for (int i = 0; i < numLayers; ++i) {
+    auto act = chain.addLayer(size);
+    chain.builder->executionPhase(act, i);
+    chain.builder->virtualGraph(act, i % numIpus);
+  }
+  auto l1 = chain.addL1Loss();
+  chain.builder->executionPhase(l1, numLayers - 1);
+  chain.builder->virtualGraph(l1, (numLayers - 1) % numIpus);
+
+  SessionOptions opts;
+  opts.virtualGraphMode              = VirtualGraphMode::ExecutionPhases;
+  opts.executionPhaseSettings.phases = numLayers;
+  opts.enableOutlining               = false;
+  opts.weightTensorLocationSettings.location.storage = TensorStorage::OffChip;
+  opts.executionPhaseSettings.weightIOSchedule =
+      ExecutionPhaseIOSchedule::OnDemand;
+  opts.executionPhaseSettings.onDemandPrefetchPhases       = prefetchPhases;
+  opts.executionPhaseSettings.onDemandPrefetchMemoryBudget = budget;
+
+  chain.prepare(
+      ir, createTestDevice(TEST_TARGET, numIpus), opts, ConstSGD(0.01));
+
+  std::vector<Load> loads;
+  for (auto op : ir.getMainGraph().getOpSchedule({})) {
+    if (!op->isConvertibleTo<RemoteLoadOp>()) {
+      continue;
+    }
+    BOOST_REQUIRE(op->hasExecutionPhase());
+    Tensor *loaded  = op->output->tensor(0);
+    auto firstPhase = std::numeric_limits<ExecutionPhase>::max();
+    for (auto consumer : loaded->consumers.getOps()) {
+      if (consumer->hasExecutionPhase()) {
+        firstPhase = std::min(firstPhase, consumer->getExecutionPhase());
+      }
+    }
+    loads.push_back({op->getExecutionPhase(),
+                     firstPhase,
+                     op->hasVirtualGraphId() ? op->getVirtualGraphId()
+                                             : unusedVGraphId,
+                     loaded->info.nbytes()});
+  }
+  return loads;
+}
+
+// Check that every load is at most prefetchPhases ahead of its use, and
+// return how many are ahead
+int checkLoads(const std::vector<Load> &loads, int prefetchPhases) {
+  int numPrefetched = 0;
+  for (auto &load : loads) {
+    BOOST_CHECK(load.loadPhase <= load.usePhase);
+    BOOST_CHECK(load.loadPhase >= load.usePhase - prefetchPhases);
+    BOOST_CHECK(load.loadPhase >= -1);
+    if (load.loadPhase < load.usePhase) {
+      ++numPrefetched;
+    }
+  }
+  return numPrefetched;
+}
+
+// The loads of the forward weights, indexed by layer (and phase)
+std::vector<Load> getForwardLoads(const std::vector<Load> &loads) {
+  std::vector<Load> forwardLoads;
+  for (auto &load : loads) {
+    if (load.usePhase < numLayers) {
+      forwardLoads.push_back(load);
+    }
+  }
+  std::sort(forwardLoads.begin(),
+            forwardLoads.end(),
+            [](const Load &a, const Load &b) {
+              return a.usePhase < b.usePhase;
+            });
+  return forwardLoads;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ExecutionPhasePrefetch_Disabled) {
+  Ir ir;
+  auto loads = prepare(ir, 0, 0);
+  BOOST_CHECK_EQUAL(checkLoads(loads, 0), 0);
+
+  // Every layer loads its weight in its own phase
+  auto forwardLoads = getForwardLoads(loads);
+  BOOST_REQUIRE_EQUAL(forwardLoads.size(), numLayers);
+  for (int layer = 0; layer < numLayers; ++layer) {
+    BOOST_CHECK_EQUAL(forwardLoads[layer].usePhase, layer);
+    BOOST_CHECK_EQUAL(forwardLoads[layer].loadPhase, layer);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhasePrefetch_Unlimited) {
+  Ir ir;
+  auto loads = prepare(ir, 2, 0);
+  BOOST_CHECK(checkLoads(loads, 2) > 0);
+
+  // Without a budget every weight is loaded two phases ahead, but not before
+  // the phase in which the first phase is loaded
+  auto forwardLoads = getForwardLoads(loads);
+  BOOST_REQUIRE_EQUAL(forwardLoads.size(), numLayers);
+  for (int layer = 0; layer < numLayers; ++layer) {
+    BOOST_CHECK_EQUAL(forwardLoads[layer].usePhase, layer);
+    BOOST_CHECK_EQUAL(forwardLoads[layer].loadPhase, std::max(layer - 2, -1));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionPhasePrefetch_Budget) {
+  // Room for one prefetched weight per virtual graph and phase
+  Ir ir;
+  auto loads = prepare(ir, 4, wBytes);
+  BOOST_CHECK(checkLoads(loads, 4) > 0);
+
+  // The prefetched weights held by each virtual graph in each phase
+  std::map<std::pair<VGraphId, ExecutionPhase>, int64_t> held;
+  for (auto &load : loads) {
+    for (auto phase = load.loadPhase; phase < load.usePhase; ++phase) {
+      held[{load.vgid, phase}] += load.bytes;
+    }
+  }
+  for (auto &vgid_phase_bytes : held) {
+    BOOST_CHECK(vgid_phase_bytes.second <= wBytes);
+  }
+
+  // No weight fits a budget of one byte
+  Ir tinyIr;
+  BOOST_CHECK_EQUAL(checkLoads(prepare(tinyIr, 2, 1), 2), 0);
+}
@@ -0,0 +1,215 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE ReplicatedTensorShardingPlanTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/builder.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/op.hpp>
+#include <popart/op/collectives/replicatedallgather.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensorinfo.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/transforms/streamingmemory.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+// The widths of the activations. Each weight has a different size, so that
+// the larger weights, whose collectives amortise their latency better, are
+// sharded first: w2, w3, w1, w0.
+const std::vector<int64_t> widths{64, 32, 96, 128, 64};
+constexpr int numLayers   = 4;
+constexpr int numReplicas = 2;
+
+int64_t getWeightBytes(int layer) {
+  return widths.at(layer) * widths.at(layer + 1) * 4;
+}
+
+int64_t getAllWeightBytes() {
+  int64_t bytes = 0;
+  for (int layer = 0; layer < numLayers; ++layer) {
+    bytes += getWeightBytes(layer);
+  }
+  return bytes;
+}
+
+// Prepare a chain of MatMuls, one per phase, with off-chip weights, on two
+// replicas, and return the weights. The weight of each layer in overrides is
+// added to SessionOptions::tensorLocationSettingsOverride. Weights with fewer
+// than minElements elements are not sharded.
+std::vector<TensorId>
+prepare(Ir &ir,
+        int64_t budget,
+        const std::map<int, TensorLocation> &overrides = {},
+        int minElements                                = 0) {
+  test_graphs::MatMulChain chain(1, widths.at(0));
+  for (int i = 0; i < numLayers; ++i) {
+    auto act = chain.addLayer(widths.at(i + 1));
+    chain.builder->executionPhase(act, i);
+    chain.builder->virtualGraph(act, 0);
+  }
+  auto l1 = chain.addL1Loss();
+  chain.builder->executionPhase(l1, numLayers - 1);
+  chain.builder->virtualGraph(l1, 0);
+  auto &weights = chain.weights;
+
+  SessionOptions opts;
+  opts.virtualGraphMode              = VirtualGraphMode::ExecutionPhases;
+  opts.executionPhaseSettings.phases = numLayers;
+  opts.executionPhaseSettings.stages = 1;
+  opts.enableOutlining               = false;
+  opts.enableReplicatedGraphs        = true;
+  opts.replicatedGraphCount          = numReplicas;
+  opts.weightTensorLocationSettings.location.storage = TensorStorage::OffChip;
+  opts.weightTensorLocationSettings.minElementsForReplicatedTensorSharding =
+      minElements;
+  opts.replicatedTensorShardingMemoryBudget = budget;
+  for (auto &layer_location : overrides) {
+    opts.tensorLocationSettingsOverride[weights.at(layer_location.first)] =
+        layer_location.second;
+  }
+
+  chain.prepare(
+      ir, createTestDevice(TEST_TARGET, numReplicas), opts, ConstSGD(0.01));
+
+  return weights;
+}
+
+// The number of elements gathered by each ReplicatedAllGatherOp
+std::multiset<int64_t> getAllGathers(const Ir &ir) {
+  std::multiset<int64_t> allGathers;
+  for (auto op : ir.getMainGraph().getOpSchedule({})) {
+    if (op->isConvertibleTo<ReplicatedAllGatherOp>()) {
+      allGathers.insert(op->output->tensor(0)->info.nelms());
+    }
+  }
+  return allGathers;
+}
+
+// Check the plan against its tensors, and return the sharded layers
+std::vector<int> checkPlan(const Ir &ir,
+                           const std::vector<TensorId> &weights,
+                           int64_t fixedBytes = 0) {
+  auto plan = ir.getReplicatedTensorShardingPlan();
+  BOOST_REQUIRE(plan != nullptr);
+  BOOST_CHECK_EQUAL(plan->locations.size(), plan->tensors.size());
+
+  CostModelSettings costs;
+  std::vector<int> sharded;
+  int64_t savedBytes      = 0;
+  int64_t collectiveBytes = 0;
+  for (int layer = 0; layer < numLayers; ++layer) {
+    auto found = plan->tensors.find(weights.at(layer));
+    if (found == plan->tensors.end()) {
+      continue;
+    }
+    auto &decision = found->second;
+    BOOST_CHECK_EQUAL(decision.bytes, getWeightBytes(layer));
+    BOOST_CHECK_EQUAL(decision.savedBytes, decision.bytes / numReplicas);
+    // An all-gather of the weight and a reduce-scatter of its gradient
+    BOOST_CHECK_EQUAL(decision.collectiveBytes, 2 * decision.savedBytes);
+    BOOST_CHECK_CLOSE(decision.collectiveCycles,
+                      2 * costs.collectiveLatencyCycles +
+                          decision.collectiveBytes /
+                              costs.collectiveBytesPerCycle,
+                      1e-6);
+    BOOST_CHECK_EQUAL(
+        plan->locations.at(found->first).replicatedTensorSharding ==
+            ReplicatedTensorSharding::On,
+        decision.sharded);
+    if (decision.sharded) {
+      sharded.push_back(layer);
+      savedBytes += decision.savedBytes;
+      collectiveBytes += decision.collectiveBytes;
+    }
+  }
+  BOOST_CHECK_EQUAL(plan->savedBytes, savedBytes);
+  BOOST_CHECK_EQUAL(plan->collectiveBytes, collectiveBytes);
+  BOOST_REQUIRE_EQUAL(plan->bytes.size(), 1);
+  BOOST_CHECK_EQUAL(plan->bytes.begin()->second,
+                    getAllWeightBytes() - savedBytes);
+  if (fixedBytes > 0) {
+    BOOST_REQUIRE_EQUAL(plan->fixedBytes.size(), 1);
+    BOOST_CHECK_EQUAL(plan->fixedBytes.begin()->second, fixedBytes);
+  } else {
+    BOOST_CHECK(plan->fixedBytes.empty());
+  }
+
+  // Each sharded weight is gathered whole
+  std::multiset<int64_t> allGathers = getAllGathers(ir);
+  for (int layer : sharded) {
+    BOOST_CHECK(allGathers.count(getWeightBytes(layer) / 4) > 0);
+  }
+  return sharded;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ReplicatedTensorShardingPlan_NoPlan) {
+  Ir ir;
+  prepare(ir, 0);
+  BOOST_CHECK(getAllGathers(ir).empty());
+  BOOST_CHECK(ir.getReplicatedTensorShardingPlan() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedTensorShardingPlan_Budgets) {
+  const int64_t allWBytes = getAllWeightBytes();
+
+  // Everything fits without sharding
+  Ir largeIr;
+  auto weights = prepare(largeIr, allWBytes);
+  BOOST_CHECK(checkPlan(largeIr, weights).empty());
+  BOOST_CHECK(getAllGathers(largeIr).empty());
+
+  // Sharding the largest weight is enough
+  Ir partialIr;
+  weights = prepare(partialIr, allWBytes - getWeightBytes(2) / numReplicas);
+  BOOST_CHECK(checkPlan(partialIr, weights) == std::vector<int>{2});
+
+  // The two largest weights are needed
+  Ir twoIr;
+  weights = prepare(twoIr, allWBytes - getWeightBytes(2) / numReplicas - 1);
+  BOOST_CHECK((checkPlan(twoIr, weights) == std::vector<int>{2, 3}));
+
+  // Even sharding every weight does not fit
+  Ir tinyIr;
+  weights = prepare(tinyIr, 1);
+  BOOST_CHECK((checkPlan(tinyIr, weights) == std::vector<int>{0, 1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedTensorShardingPlan_Override) {
+  // The largest weight is kept whole by the override, but still counts
+  // towards the budget, so that the next largest is sharded instead
+  const int64_t allWBytes = getAllWeightBytes();
+  Ir ir;
+  auto weights =
+      prepare(ir,
+              allWBytes - getWeightBytes(3) / numReplicas,
+              {{2, TensorLocation(TensorStorage::OffChip)}});
+  BOOST_CHECK_EQUAL(ir.getReplicatedTensorShardingPlan()->tensors.count(
+                        weights.at(2)),
+                    0);
+  BOOST_CHECK(checkPlan(ir, weights, getWeightBytes(2)) ==
+              std::vector<int>{3});
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedTensorShardingPlan_MinElements) {
+  // Only w2 and w3 have at least 8192 elements. The others are kept whole,
+  // even though the budget is not met, but still count towards it
+  Ir ir;
+  auto weights = prepare(ir, 1, {}, 8192);
+  auto plan    = ir.getReplicatedTensorShardingPlan();
+  BOOST_REQUIRE(plan != nullptr);
+  BOOST_CHECK_EQUAL(plan->tensors.count(weights.at(0)), 0);
+  BOOST_CHECK_EQUAL(plan->tensors.count(weights.at(1)), 0);
+  BOOST_CHECK((checkPlan(ir, weights, getWeightBytes(0) + getWeightBytes(1)) ==
+               std::vector<int>{2, 3}));
+}
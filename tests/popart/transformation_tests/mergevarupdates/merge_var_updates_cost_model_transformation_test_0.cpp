@@ -0,0 +1,177 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE MergeVarUpdatesCostModelTransformation0
+
+#include <boost/test/unit_test.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/transforms/mergevarupdates.hpp>
+
+#include <set>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+// Prepare a chain of MatMuls, where layer i has a float weight of
+// widths[i] x widths[i + 1], and return the weights
+std::vector<TensorId> prepare(Ir &ir,
+                              MergeVarUpdateType mvu,
+                              const std::vector<int64_t> &widths,
+                              const CostModelSettings &costs = {}) {
+  test_graphs::MatMulChain chain(1, widths.front());
+  for (int i = 1; i < widths.size(); ++i) {
+    chain.addLayer(widths[i]);
+  }
+  chain.addL1Loss();
+
+  auto opts                 = SessionOptions();
+  opts.mergeVarUpdate       = mvu;
+  opts.looseThresholdAtPeak = 1 << 30;
+  opts.costModelSettings    = costs;
+
+  auto optimizer = SGD({{"defaultLearningRate", {0.1f, false}}});
+  chain.prepare(ir, createTestDevice(TEST_TARGET), opts, optimizer, Patterns());
+
+  return chain.weights;
+}
+
+// The widths of a chain of nLayers MatMuls with size x size weights
+std::vector<int64_t> getWidths(int64_t size, int nLayers) {
+  return std::vector<int64_t>(nLayers + 1, size);
+}
+
+int getNumVarUpdates(Ir &ir) {
+  return static_cast<int>(
+      ir.opsOfType(Onnx::CustomOperators::SGD0VarUpdate).size());
+}
+
+// The groups of the report, as sets of weights, and check that every weight
+// is in exactly one group
+std::vector<std::set<TensorId>>
+getGroups(Ir &ir, const std::vector<TensorId> &weights) {
+  auto report = ir.getMergeVarUpdateReport();
+  BOOST_REQUIRE(report != nullptr);
+  std::vector<std::set<TensorId>> groups;
+  std::multiset<TensorId> grouped;
+  for (auto &x : report->groups) {
+    groups.push_back({x.second.tensors.begin(), x.second.tensors.end()});
+    grouped.insert(x.second.tensors.begin(), x.second.tensors.end());
+  }
+  BOOST_CHECK_EQUAL(grouped.size(), weights.size());
+  for (auto &w : weights) {
+    BOOST_CHECK_EQUAL(grouped.count(w), 1);
+  }
+  BOOST_CHECK_EQUAL(getNumVarUpdates(ir), groups.size());
+  return groups;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Transformation_MergeCostModel_SmallWeights) {
+  // The VarUpdates of small weights cost more than copying them, so with
+  // plenty of memory they are all merged.
+  constexpr int nLayers = 6;
+  Ir ir;
+  auto weights =
+      prepare(ir, MergeVarUpdateType::AutoCost, getWidths(8, nLayers));
+  auto groups  = getGroups(ir, weights);
+  BOOST_REQUIRE_EQUAL(groups.size(), 1);
+  BOOST_CHECK(groups.front() ==
+              std::set<TensorId>(weights.begin(), weights.end()));
+
+  auto report = ir.getMergeVarUpdateReport();
+  auto &group = report->groups.begin()->second;
+  BOOST_CHECK_EQUAL(group.bytes, nLayers * 8 * 8 * 4);
+  BOOST_CHECK(group.benefit > 0.0);
+  BOOST_CHECK_EQUAL(report->totalBenefit, group.benefit);
+
+  // Merging everything reports the same benefit
+  Ir allIr;
+  prepare(allIr, MergeVarUpdateType::All, getWidths(8, nLayers));
+  BOOST_CHECK_EQUAL(getNumVarUpdates(allIr), 1);
+  BOOST_CHECK_EQUAL(allIr.getMergeVarUpdateReport()->totalBenefit,
+                    report->totalBenefit);
+
+  // No report is made without merging
+  Ir noneIr;
+  prepare(noneIr, MergeVarUpdateType::None, getWidths(8, nLayers));
+  BOOST_CHECK_EQUAL(getNumVarUpdates(noneIr), nLayers);
+  BOOST_CHECK(noneIr.getMergeVarUpdateReport() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Transformation_MergeCostModel_LargeWeights) {
+  // Copying large weights into, and out of, a concatenation costs more than
+  // the VarUpdate programs it saves, so they are not merged.
+  constexpr int nLayers = 2;
+  Ir ir;
+  auto weights =
+      prepare(ir, MergeVarUpdateType::AutoCost, getWidths(1024, nLayers));
+  auto groups = getGroups(ir, weights);
+  BOOST_CHECK_EQUAL(groups.size(), nLayers);
+  for (auto &x : ir.getMergeVarUpdateReport()->groups) {
+    BOOST_CHECK_EQUAL(x.second.tensors.size(), 1);
+    BOOST_CHECK_EQUAL(x.second.bytes, 1024 * 1024 * 4);
+    BOOST_CHECK_EQUAL(x.second.benefit, 0.0);
+  }
+
+  // Whereas merging them all is estimated to be slower
+  Ir allIr;
+  prepare(allIr, MergeVarUpdateType::All, getWidths(1024, nLayers));
+  BOOST_CHECK_EQUAL(getNumVarUpdates(allIr), 1);
+  BOOST_CHECK(allIr.getMergeVarUpdateReport()->totalBenefit < 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(Transformation_MergeCostModel_MixedWeights) {
+  // A 2048 x 2048 weight is never worth merging, whichever VarUpdates are
+  // scheduled next to it, whereas the small weights on either side of it in
+  // the schedule are merged
+  Ir ir;
+  auto weights = prepare(
+      ir, MergeVarUpdateType::AutoCost, {8, 8, 8, 2048, 2048, 8, 8});
+  const TensorId large = weights.at(3);
+  auto groups          = getGroups(ir, weights);
+  BOOST_CHECK(groups.size() <= 3);
+  for (auto &group : groups) {
+    if (group.count(large)) {
+      BOOST_CHECK_EQUAL(group.size(), 1);
+    }
+  }
+  for (auto &x : ir.getMergeVarUpdateReport()->groups) {
+    BOOST_CHECK(x.second.benefit >= 0.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Transformation_MergeCostModel_CostModelSettings) {
+  // With faster copies, merging the large weights pays off
+  constexpr int nLayers = 2;
+  CostModelSettings costs;
+  costs.onChipCopyBytesPerCycle = 1e9;
+  Ir ir;
+  auto weights = prepare(
+      ir, MergeVarUpdateType::AutoCost, getWidths(1024, nLayers), costs);
+  auto groups = getGroups(ir, weights);
+  BOOST_REQUIRE_EQUAL(groups.size(), 1);
+  BOOST_CHECK_EQUAL(groups.front().size(), nLayers);
+  BOOST_CHECK(ir.getMergeVarUpdateReport()->totalBenefit > 0.0);
+
+  // Without a fixed cost per VarUpdate, merging never pays off
+  costs.programCycles = 0.0;
+  Ir freeIr;
+  weights = prepare(
+      freeIr, MergeVarUpdateType::AutoCost, getWidths(8, nLayers), costs);
+  BOOST_CHECK_EQUAL(getGroups(freeIr, weights).size(), nLayers);
+
+  costs.onChipCopyBytesPerCycle = 0.0;
+  Ir invalidIr;
+  BOOST_CHECK_THROW(prepare(invalidIr,
+                            MergeVarUpdateType::AutoCost,
+                            getWidths(8, nLayers),
+                            costs),
+                    error);
+}
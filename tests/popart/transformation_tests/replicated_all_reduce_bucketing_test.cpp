@@ -0,0 +1,236 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#define BOOST_TEST_MODULE ReplicatedAllReduceBucketingTest
+
+#include <boost/test/unit_test.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/op.hpp>
+#include <popart/op/collectives/replicatedallreduce.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensornames.hpp>
+#include <popart/tensors.hpp>
+#include <popart/testdevice.hpp>
+#include <popart/topocons.hpp>
+#include <popart/transforms/replicatedallreducebucketing.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace {
+
+constexpr int64_t size    = 16;
+constexpr int numLayers   = 4;
+constexpr int64_t wBytes  = size * size * 4;
+constexpr int numReplicas = 2;
+
+// Prepare a chain of MatMuls trained on two replicas, and return its weights.
+// With momentum and gradient accumulation, the accumulators are reduced
+// instead of the gradients.
+std::vector<TensorId>
+prepare(Ir &ir, int64_t bucketSize, bool accumulate = false) {
+  test_graphs::MatMulChain chain(1, size);
+  chain.addLayers(numLayers);
+  chain.addL1Loss();
+
+  SessionOptions opts;
+  opts.enableOutlining               = false;
+  opts.enableReplicatedGraphs        = true;
+  opts.replicatedGraphCount          = numReplicas;
+  opts.replicatedAllReduceBucketSize = bucketSize;
+
+  std::unique_ptr<Optimizer> optimizer;
+  if (accumulate) {
+    opts.enableGradientAccumulation = true;
+    opts.accumulationFactor         = 2;
+    optimizer                       = std::make_unique<SGD>(
+        SGD({{"defaultLearningRate", {0.01f, true}},
+             {"defaultMomentum", {0.9f, true}}}));
+  } else {
+    optimizer = std::make_unique<ConstSGD>(0.01);
+  }
+
+  chain.prepare(
+      ir, createTestDevice(TEST_TARGET, numReplicas), opts, *optimizer);
+
+  return chain.weights;
+}
+
+// The all-reduces of the type opid
+std::vector<Op *> getAllReduces(const Ir &ir, const OperatorIdentifier &opid) {
+  std::vector<Op *> allReduces;
+  for (auto op : ir.getMainGraph().getOpSchedule({})) {
+    if (op->opid == opid) {
+      allReduces.push_back(op);
+    }
+  }
+  return allReduces;
+}
+
+// Check that every tensor reduced is prefix + one of the weights, that each
+// weight is reduced by one bucket, and that each bucket of several tensors is
+// reduced by the opid all-reduce of their concatenation, in report order.
+// Return the number of tensors of each bucket.
+std::vector<int> checkBuckets(const Ir &ir,
+                              const std::vector<TensorId> &weights,
+                              const std::string &prefix,
+                              const OperatorIdentifier &opid) {
+  auto report = ir.getReplicatedAllReduceBucketReport();
+  BOOST_REQUIRE(report != nullptr);
+  BOOST_CHECK_EQUAL(report->numAllReducesBefore, numLayers);
+  BOOST_CHECK_EQUAL(report->numAllReducesAfter, report->buckets.size());
+
+  std::multiset<TensorId> reduced;
+  std::vector<int> bucketSizes;
+  double totalBenefit = 0.0;
+  for (int i = 0; i < report->buckets.size(); ++i) {
+    auto &bucket = report->buckets.at(i);
+    bucketSizes.push_back(static_cast<int>(bucket.tensors.size()));
+    reduced.insert(bucket.tensors.begin(), bucket.tensors.end());
+    BOOST_CHECK_EQUAL(bucket.bytes, bucket.tensors.size() * wBytes);
+    totalBenefit += bucket.benefit;
+    if (bucket.tensors.size() == 1) {
+      BOOST_CHECK_EQUAL(bucket.benefit, 0.0);
+      continue;
+    }
+    BOOST_CHECK(bucket.benefit > 0.0);
+
+    // bucket<i>___concatGrads <- ConcatInplace <- ReshapeInplace <- tensors
+    auto concatId = "bucket" + std::to_string(i) + "___concatGrads";
+    auto &tensors = ir.getMainGraph().getTensors();
+    BOOST_REQUIRE(tensors.contains(concatId));
+    Tensor *concat = tensors.get(concatId);
+    BOOST_REQUIRE_EQUAL(concat->consumers.getOps().size(), 1);
+    BOOST_CHECK(concat->consumers.getOps().front()->opid == opid);
+    Op *concatOp = concat->getProducer();
+    BOOST_REQUIRE_EQUAL(concatOp->input->n(), bucket.tensors.size());
+    for (int j = 0; j < bucket.tensors.size(); ++j) {
+      BOOST_CHECK_EQUAL(concatOp->inTensor(j)->getProducer()->inId(0),
+                        bucket.tensors.at(j));
+    }
+  }
+  BOOST_CHECK_CLOSE(report->totalBenefit, totalBenefit, 1e-6);
+
+  for (auto &w : weights) {
+    BOOST_CHECK_EQUAL(reduced.count(prefix + w), 1);
+  }
+  BOOST_CHECK_EQUAL(reduced.size(), weights.size());
+  BOOST_CHECK_EQUAL(getAllReduces(ir, opid).size(), bucketSizes.size());
+  return bucketSizes;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_Disabled) {
+  Ir ir;
+  prepare(ir, 0);
+  BOOST_CHECK_EQUAL(
+      getAllReduces(ir, Onnx::CustomOperators::ReplicatedAllReduce).size(),
+      numLayers);
+  BOOST_CHECK(ir.getReplicatedAllReduceBucketReport() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_TwoPerBucket) {
+  Ir ir;
+  auto weights = prepare(ir, 2 * wBytes);
+  BOOST_CHECK((checkBuckets(ir,
+                            weights,
+                            reservedGradientPrefix(),
+                            Onnx::CustomOperators::ReplicatedAllReduce) ==
+               std::vector<int>{2, 2}));
+  BOOST_CHECK(ir.getReplicatedAllReduceBucketReport()->totalBenefit > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_OneBucket) {
+  Ir ir;
+  auto weights = prepare(ir, numLayers * wBytes);
+  BOOST_CHECK((checkBuckets(ir,
+                            weights,
+                            reservedGradientPrefix(),
+                            Onnx::CustomOperators::ReplicatedAllReduce) ==
+               std::vector<int>{numLayers}));
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_TooSmall) {
+  // Every gradient is larger than the buckets, so none are merged
+  Ir ir;
+  auto weights = prepare(ir, 1);
+  BOOST_CHECK((checkBuckets(ir,
+                            weights,
+                            reservedGradientPrefix(),
+                            Onnx::CustomOperators::ReplicatedAllReduce) ==
+               std::vector<int>(numLayers, 1)));
+  BOOST_CHECK_EQUAL(ir.getReplicatedAllReduceBucketReport()->totalBenefit,
+                    0.0);
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_Accumulators) {
+  // The accumulators are reduced inplace, by an inplace all-reduce of their
+  // inplace concatenation, and no gradients are reduced
+  Ir ir;
+  auto weights = prepare(ir, numLayers * wBytes, true);
+  BOOST_CHECK(
+      (checkBuckets(ir,
+                    weights,
+                    reservedAcclToReducePrefix(),
+                    Onnx::CustomOperators::ReplicatedAllReduceInplace) ==
+       std::vector<int>{numLayers}));
+  BOOST_CHECK(
+      getAllReduces(ir, Onnx::CustomOperators::ReplicatedAllReduce).empty());
+  for (Op *op :
+       getAllReduces(ir, Onnx::CustomOperators::ReplicatedAllReduceInplace)) {
+    BOOST_CHECK(op->settings.executionContext ==
+                ExecutionContext::AccumulateOuterFragment);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ReplicatedAllReduceBucketing_Constrained) {
+  // The first all-reduce is constrained after the weight update which uses
+  // the second, so that they can not share a bucket without a cycle. One of
+  // them is left for a bucket of its own.
+  Ir ir;
+  auto weights = prepare(ir, 0);
+  auto allReduces =
+      getAllReduces(ir, Onnx::CustomOperators::ReplicatedAllReduce);
+  BOOST_REQUIRE_EQUAL(allReduces.size(), numLayers);
+  auto first      = allReduces.at(0);
+  auto second     = allReduces.at(1);
+  auto firstGrad  = first->inId(ReplicatedAllReduceOp::getInIndex());
+  auto secondGrad = second->inId(ReplicatedAllReduceOp::getInIndex());
+  auto &consumers =
+      second->outTensor(ReplicatedAllReduceOp::getOutIndex())->consumers;
+  BOOST_REQUIRE(!consumers.getOps().empty());
+  ir.getMainGraph().topoCons->insert(consumers.getOps().front(), first);
+
+  auto opts                          = ir.getSessionOptions();
+  opts.replicatedAllReduceBucketSize = numLayers * wBytes;
+  ir.setUserOptions(opts);
+  ir.applyTransform(ReplicatedAllReduceBucketing::id(), ir.getMainGraph());
+
+  auto bucketSizes = checkBuckets(ir,
+                                  weights,
+                                  reservedGradientPrefix(),
+                                  Onnx::CustomOperators::ReplicatedAllReduce);
+  std::sort(bucketSizes.begin(), bucketSizes.end());
+  BOOST_CHECK((bucketSizes == std::vector<int>{1, numLayers - 1}));
+
+  for (auto &bucket : ir.getReplicatedAllReduceBucketReport()->buckets) {
+    BOOST_CHECK(std::count(bucket.tensors.begin(),
+                           bucket.tensors.end(),
+                           firstGrad) +
+                    std::count(bucket.tensors.begin(),
+                               bucket.tensors.end(),
+                               secondGrad) <
+                2);
+  }
+
+  // The constraints of the buckets do not form a cycle
+  BOOST_CHECK_NO_THROW(ir.getMainGraph().getOpSchedule({}));
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_TESTUTIL_TEST_GRAPHS_MATMUL_CHAIN_HPP
+#define GUARD_TESTUTIL_TEST_GRAPHS_MATMUL_CHAIN_HPP
+
+#include <popart/builder.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/ir.hpp>
+#include <popart/names.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/patterns/patterns.hpp>
+#include <popart/sessionoptions.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace test_graphs {
+
+/**
+ * A chain of MatMuls, built layer by layer:
+ *
+ * input -> MatMul(w0) [-> Relu] -> MatMul(w1) [-> Relu] -> ... [-> L1 loss]
+ *
+ * The input is batchSize x width, and each weight is a Variable of
+ * width x outWidth, with every element 0.1. The builder is exposed, so that
+ * the layers can be annotated (execution phase, virtual graph, ...) or
+ * other Ops inserted between them.
+ */
+class MatMulChain {
+public:
+  MatMulChain(int64_t batchSize, int64_t width);
+
+  /// Add a MatMul of the output by a new weight of width x outWidth, followed
+  /// by a Relu if relu is true, and return the new output.
+  popart::TensorId addLayer(int64_t outWidth, bool relu = false);
+
+  /// Add numLayers layers of width x width weights.
+  void addLayers(int numLayers, bool relu = false);
+
+  /// Add an L1 loss of the output, and return it.
+  popart::TensorId addL1Loss(float lambda = 0.1f);
+
+  /// Prepare ir to train the chain with its loss, which is anchored.
+  void prepare(popart::Ir &ir,
+               std::shared_ptr<popart::DeviceInfo> device,
+               const popart::SessionOptions &opts,
+               const popart::Optimizer &optimizer,
+               const popart::Patterns &patterns = popart::Patterns(
+                   popart::PatternsLevel::Default)) const;
+
+  std::unique_ptr<popart::Builder> builder;
+  popart::TensorId input;
+  // The output of the last layer
+  popart::TensorId output;
+  // The current width of the output
+  int64_t width;
+  // The weights, one per layer
+  std::vector<popart::TensorId> weights;
+  popart::TensorId loss;
+};
+
+} // namespace test_graphs
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popart/dataflow.hpp>
+#include <popart/error.hpp>
+#include <popart/filereader.hpp>
+#include <popart/inputshapeinfo.hpp>
+#include <popart/tensorinfo.hpp>
+
+#include <testutil/test_graphs/matmul_chain.hpp>
+
+using namespace popart;
+
+namespace test_graphs {
+
+MatMulChain::MatMulChain(int64_t batchSize, int64_t width_)
+    : builder(Builder::create()), width(width_) {
+  TensorInfo inInfo{"FLOAT", std::vector<int64_t>{batchSize, width}};
+  input  = builder->addInputTensor(inInfo);
+  output = input;
+}
+
+TensorId MatMulChain::addLayer(int64_t outWidth, bool relu) {
+  auto aiOnnx = builder->aiOnnxOpset9();
+
+  TensorInfo wInfo{"FLOAT", std::vector<int64_t>{width, outWidth}};
+  std::vector<float> wVals(wInfo.nelms(), 0.1f);
+  ConstVoidData wData = {wVals.data(), wInfo};
+  weights.push_back(builder->addInitializedInputTensor(wData));
+
+  output = aiOnnx.matmul({output, weights.back()});
+  if (relu) {
+    output = aiOnnx.relu({output});
+  }
+  width = outWidth;
+  return output;
+}
+
+void MatMulChain::addLayers(int numLayers, bool relu) {
+  for (int i = 0; i < numLayers; ++i) {
+    addLayer(width, relu);
+  }
+}
+
+TensorId MatMulChain::addL1Loss(float lambda) {
+  loss = builder->aiGraphcoreOpset1().l1loss({output}, lambda);
+  return loss;
+}
+
+void MatMulChain::prepare(Ir &ir,
+                          std::shared_ptr<DeviceInfo> device,
+                          const SessionOptions &opts,
+                          const Optimizer &optimizer,
+                          const Patterns &patterns) const {
+  if (loss.empty()) {
+    throw error("MatMulChain::prepare requires a loss, see addL1Loss");
+  }
+
+  auto modelProto = io::getModelFromString(builder->getModelProto());
+  auto dataFlow   = DataFlow(1, {{loss, AnchorReturnType("All")}});
+
+  ir.prepare({modelProto,
+              InputShapeInfo(),
+              dataFlow,
+              loss,
+              &optimizer,
+              *device,
+              opts,
+              patterns});
+}
+
+} // namespace test_graphs
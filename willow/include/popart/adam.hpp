@@ -253,6 +253,9 @@ public:
   // this object can compute from the atomic scalars
   float getStoredValue(const TensorId &optId) const;
 
+  OptimizerScheduleDependence
+  getScheduleDependence(const TensorId &optId) const final;
+
   void insertSpecific(const TensorId &,
                       OptimizerValue lr,
                       OptimizerValue wd,
@@ -271,7 +274,7 @@ public:
   void insertSpecific(const TensorId &,
                       const std::map<std::string, std::pair<float, bool>> &);
 
-  const OptimizerValueMap &learningRates() const { return lrs; }
+  const OptimizerValueMap &learningRates() const final { return lrs; }
   const OptimizerValueMap &weightDecays() const { return wds; }
   const OptimizerValueMap &beta1s() const { return b1s; }
   const OptimizerValueMap &beta2s() const { return b2s; }
@@ -744,7 +744,8 @@ public:
   }
 
   /**
-   * Set the available memory for the given node. Used on the convolution op.
+   * Set the available memory for the given node. Used on the convolution,
+   * matmul and gather ops.
    *
    * \param nodeOutputName Name of the output tensor of the ONNX node
    * \param availableMemoryProportion The available memory proportion 0 < x
@@ -113,6 +113,16 @@ public:
   std::vector<std::set<Op *>>
   getLiveSets(const std::vector<Op *> &topoOps) const;
 
+  // As above, but only the live sets at the given positions in topoOps are
+  // returned. The memory used is linear in the size of topoOps.
+  std::map<int, std::set<Op *>>
+  getLiveSets(const std::vector<Op *> &topoOps,
+              const std::set<int> &positions) const;
+
+  // The total memOfOutputs() of the Ops in each live set of topoOps,
+  // computed incrementally without materialising the live sets.
+  std::vector<int64_t> getLiveMemory(const std::vector<Op *> &topoOps) const;
+
   const std::vector<TensorId> &getInputIds() const { return graph_inputs; }
   void addInput(const TensorId &, const TensorInfo &);
   // Mark an existing tensor as a graph input.
@@ -18,6 +18,13 @@
 
 namespace popart {
 
+struct AutoVirtualGraphPlan;
+struct ExecutionPhasePlan;
+struct MergeVarUpdateReport;
+struct PipelineStashReport;
+struct ReplicatedAllReduceBucketReport;
+struct ReplicatedTensorShardingPlan;
+
 // helper class used during backwards pass construction.
 // This class helps to decouple the non-grad op from a
 // grad op (previously grad ops kept a pointer to a non-grad
@@ -184,7 +191,9 @@ public:
       const ONNX_NAMESPACE::ModelProto &modelProto,
       const bool ignoreWeightsInModelWithoutCorrespondingIrWeight = false);
 
-  void updateOptimizer(const Optimizer &);
+  // Replace the optimizer, and reset the host data of the optimizer tensors.
+  // Returns the optimizer tensors whose values changed.
+  std::vector<TensorId> updateOptimizer(const Optimizer &);
   // take training steps
   ONNX_NAMESPACE::ModelProto step(int n);
   // if the tensor is returned to user (passes call to DataFlow).
@@ -385,6 +394,53 @@ public:
   // to number of IPUs.
   unsigned getMaxVirtualGraphId() const;
 
+  // The virtual graphs chosen by the AutoVirtualGraph transform, and their
+  // estimated costs, or nullptr if the transform has not been applied
+  const AutoVirtualGraphPlan *getAutoVirtualGraphPlan() const {
+    return autoVirtualGraphPlan.get();
+  }
+  void setAutoVirtualGraphPlan(const AutoVirtualGraphPlan &);
+
+  // The stash memory of each pipeline stage, as chosen by the Pipeline
+  // transform, or nullptr if the transform has not been applied
+  const PipelineStashReport *getPipelineStashReport() const {
+    return pipelineStashReport.get();
+  }
+  void setPipelineStashReport(const PipelineStashReport &);
+
+  // The VarUpdate groups chosen by a MergeVarUpdates transform, and their
+  // estimated benefits, or nullptr if no such transform has been applied
+  const MergeVarUpdateReport *getMergeVarUpdateReport() const {
+    return mergeVarUpdateReport.get();
+  }
+  void setMergeVarUpdateReport(const MergeVarUpdateReport &);
+
+  // The execution phases chosen for ExecutionPhaseSettings::autoMemoryBudget
+  // by the StreamingMemory transform, or nullptr if none were planned
+  const ExecutionPhasePlan *getExecutionPhasePlan() const {
+    return executionPhasePlan.get();
+  }
+  void setExecutionPhasePlan(const ExecutionPhasePlan &);
+
+  // The weights and optimizer state chosen for replicated tensor sharding by
+  // the StreamingMemory transform, for
+  // SessionOptions::replicatedTensorShardingMemoryBudget, or nullptr if no
+  // sharding was planned
+  const ReplicatedTensorShardingPlan *getReplicatedTensorShardingPlan() const {
+    return replicatedTensorShardingPlan.get();
+  }
+  void setReplicatedTensorShardingPlan(const ReplicatedTensorShardingPlan &);
+
+  // The buckets of gradients reduced together by the
+  // ReplicatedAllReduceBucketing transform, or nullptr if the transform has
+  // not been applied
+  const ReplicatedAllReduceBucketReport *
+  getReplicatedAllReduceBucketReport() const {
+    return replicatedAllReduceBucketReport.get();
+  }
+  void
+  setReplicatedAllReduceBucketReport(const ReplicatedAllReduceBucketReport &);
+
   // Return the opset version in use for a domain
   int getOpSetVersionFromModel(const std::string &domain) const;
 
@@ -491,6 +547,14 @@ private:
   SessionOptions userOptions;
   InputShapeInfo inputShapeInfo;
 
+  std::unique_ptr<AutoVirtualGraphPlan> autoVirtualGraphPlan;
+  std::unique_ptr<PipelineStashReport> pipelineStashReport;
+  std::unique_ptr<MergeVarUpdateReport> mergeVarUpdateReport;
+  std::unique_ptr<ExecutionPhasePlan> executionPhasePlan;
+  std::unique_ptr<ReplicatedTensorShardingPlan> replicatedTensorShardingPlan;
+  std::unique_ptr<ReplicatedAllReduceBucketReport>
+      replicatedAllReduceBucketReport;
+
   // The set of patterns to apply after constructing
   // forwards and backwards passes
   Patterns patterns;
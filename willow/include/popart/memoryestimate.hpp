@@ -0,0 +1,81 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_MEMORYESTIMATE_HPP
+#define GUARD_NEURALNET_MEMORYESTIMATE_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <popart/names.hpp>
+
+namespace popart {
+
+class Ir;
+class IrBundle;
+
+// The estimated memory (in bytes) of one virtual graph
+struct VirtualGraphMemoryEstimate {
+  // Variables initialised from the model, and constants
+  int64_t weightBytes = 0;
+  // Optimizer accumulators, counters and hyper parameters
+  int64_t optimizerStateBytes = 0;
+  // Pipeline stashes
+  int64_t stashBytes = 0;
+  // Peak of the activations which are live at the same time
+  int64_t peakActivationBytes = 0;
+  // Peak of the tensors which are loaded from, or stored to, remote buffers
+  int64_t remoteBufferStagingBytes = 0;
+  // Peak of the activations and remote buffer staging tensors which are live
+  // at the same time. Less than or equal to the sum of both peaks.
+  int64_t peakLiveBytes = 0;
+
+  int64_t totalBytes() const {
+    return weightBytes + optimizerStateBytes + stashBytes + peakLiveBytes;
+  }
+};
+
+struct MemoryEstimate {
+  // Keyed by virtual graph, or unusedVGraphId if virtual graphs are not used
+  std::map<VGraphId, VirtualGraphMemoryEstimate> virtualGraphs;
+
+  // The largest total of any virtual graph
+  int64_t getMaxBytes() const;
+};
+
+// Estimate the memory required by each virtual graph of a prepared Ir,
+// without lowering it to Poplar.
+//
+// The final schedule of every graph is walked with the LivenessAnalyzer, at
+// every call site of subgraphs. Tensors which alias each other after
+// inplacing are counted once, as the largest of them. Tile padding, Poplar
+// temporaries and code are not accounted for.
+MemoryEstimate estimateMemory(const Ir &ir);
+
+struct BatchSerializationFactorCandidate {
+  int factor;
+  // MemoryEstimate::getMaxBytes, or -1 if the Ir could not be prepared
+  int64_t maxBytes;
+  // Why the factor was rejected, or empty if it was chosen
+  std::string rejection;
+};
+
+struct BatchSerializationFactorChoice {
+  int factor = 0;
+  // In the order they were tried, ending with the chosen factor
+  std::vector<BatchSerializationFactorCandidate> candidates;
+};
+
+// Choose the batch serialisation factor for
+// BatchSerializationSettings::autoMemoryBudget. The candidates are the
+// divisors of the batch size, in increasing order. The Ir is prepared for each
+// of them, so the estimates include the slices, concats and subgraph copies
+// introduced by both BatchSerialize passes and both outlining passes. The
+// first candidate which fits is chosen; an error is thrown if none fits. The
+// Ir prepared for the chosen candidate is returned in chosenIr.
+BatchSerializationFactorChoice
+chooseBatchSerializationFactor(const IrBundle &bundle,
+                               std::unique_ptr<Ir> &chosenIr);
+
+} // namespace popart
+
+#endif
@@ -7,6 +7,11 @@
 
 namespace popart {
 
+// Map regions of an input of an elementwise operation with numpy broadcasting
+// to regions of its output, and back
+view::RegMap broadcastFwdRegMap(const Shape &inShape, const Shape &outShape);
+view::RegMap broadcastBwdRegMap(const Shape &inShape, const Shape &outShape);
+
 // Base class for elementwise unary operations
 class ElementWiseUnaryOp : public Op {
 public:
@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_FUSEDELEMENTWISE_HPP
+#define GUARD_NEURALNET_FUSEDELEMENTWISE_HPP
+
+#include <iosfwd>
+#include <popart/op.hpp>
+#include <popart/vendored/optional.hpp>
+
+namespace popart {
+
+// One elementwise operation of a FusedElementwiseOp
+struct FusedElementwiseStep {
+  enum class Type {
+    Add = 0,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Exp,
+    Log,
+    Sqrt,
+    Abs,
+    Sigmoid,
+    Tanh,
+    Sin,
+    Cos,
+    Reciprocal,
+    Relu,
+    Square,
+    Scale,
+    Gelu,
+    // Gradients, with the gradient as operand 0 and the forward output as
+    // operand 1
+    SigmoidGrad,
+    TanhGrad,
+    ReluGrad
+  };
+
+  Type type;
+  // Non-negative operands are inputs of the FusedElementwiseOp, and the
+  // negative operand -(i + 1) is the result of step i
+  std::vector<int> operands;
+  // The scale factor of a Scale step
+  float scaleFactor = 1.0f;
+
+  static int stepOperand(int step) { return -(step + 1); }
+};
+
+std::ostream &operator<<(std::ostream &, FusedElementwiseStep::Type);
+
+// A chain of elementwise operations, with numpy broadcasting of the inputs,
+// computed in a single expression. The steps are in topological order, and
+// the result of the last step is the output.
+class FusedElementwiseOp : public Op {
+public:
+  FusedElementwiseOp(const OperatorIdentifier &_opid,
+                     const std::vector<FusedElementwiseStep> &steps_,
+                     const Op::Settings &settings_);
+
+  std::unique_ptr<Op> clone() const override;
+  void setup() final;
+
+  const std::vector<FusedElementwiseStep> &getSteps() const { return steps; }
+
+  // The step an Op would be fused as, or none if it can not be fused
+  static nonstd::optional<FusedElementwiseStep> getStep(const Op *);
+
+  static OutIndex getOutIndex() { return 0; }
+
+  // Input 0 may be updated inplace, if it is not broadcast
+  std::vector<std::tuple<OperatorIdentifier, float>>
+  inplacePriorityDefault() const override;
+  std::unique_ptr<Op>
+  getInplaceVariant(const OperatorIdentifier &) const override;
+
+  view::RegMap fwdRegMap(InIndex, OutIndex) const final;
+  view::RegMap bwdRegMap(InIndex, OutIndex) const final;
+
+  void appendOutlineAttributes(OpSerialiserBase &) const override;
+
+  float getSubgraphValue() const final { return getLowSubgraphValue(); }
+
+private:
+  std::vector<FusedElementwiseStep> steps;
+};
+
+class FusedElementwiseInplaceOp : public FusedElementwiseOp {
+public:
+  FusedElementwiseInplaceOp(const FusedElementwiseOp &);
+
+  std::unique_ptr<Op> clone() const final;
+
+  std::vector<std::tuple<OperatorIdentifier, float>>
+  inplacePriorityDefault() const final {
+    return {};
+  }
+
+  view::Regions modifies(InIndex) const final;
+  view::Regions aliases(InIndex, OutIndex) const final;
+};
+
+} // namespace popart
+
+#endif
@@ -3,6 +3,7 @@
 #define GUARD_NEURALNET_GATHER_HPP
 
 #include <popart/op.hpp>
+#include <popart/vendored/optional.hpp>
 
 namespace popart {
 
@@ -10,7 +11,9 @@ class GatherOp : public Op {
 public:
   GatherOp(const OperatorIdentifier &_opid,
            int64_t axis_,
-           const Op::Settings &settings_);
+           const Op::Settings &settings_,
+           const nonstd::optional<float> &availableMemoryProportion_ =
+               nonstd::nullopt);
 
   std::unique_ptr<Op> clone() const override;
   std::vector<std::unique_ptr<Op>> getGradOps() override;
@@ -19,6 +22,14 @@ public:
   // Which axis to gather on.
   int64_t getAxis() const;
 
+  // The proportion of tile memory the planned slices may use
+  nonstd::optional<float> getAvailableMemoryProportion() const {
+    return availableMemoryProportion;
+  }
+  void setAvailableMemoryProportion(const nonstd::optional<float> v) {
+    availableMemoryProportion = v;
+  }
+
   static InIndex dataInIndex() { return 0; }
   static InIndex indicesInIndex() { return 1; }
   static InIndex outIndex() { return 0; }
@@ -33,6 +44,7 @@ public:
 
 private:
   int64_t axis = 0;
+  nonstd::optional<float> availableMemoryProportion;
 };
 
 class GatherGradOp : public Op {
@@ -47,6 +59,11 @@ public:
   // Which axis to gather on.
   int64_t getAxis() const;
 
+  // The forward GatherOp's, so both plan the same slices
+  nonstd::optional<float> getAvailableMemoryProportion() const {
+    return availableMemoryProportion;
+  }
+
   static InIndex gradInIndex() { return 0; }
   static InIndex indicesInIndex() { return 1; }
   static InIndex gradOutIndex() { return 0; }
@@ -58,6 +75,7 @@ public:
 private:
   int64_t axis;
   TensorInfo fwdDataInfo;
+  nonstd::optional<float> availableMemoryProportion;
 };
 
 } // namespace popart
@@ -0,0 +1,44 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_GRADIENTOVERFLOWCHECK_HPP
+#define GUARD_NEURALNET_GRADIENTOVERFLOWCHECK_HPP
+
+#include <popart/op.hpp>
+#include <popart/tensornames.hpp>
+
+namespace popart {
+
+// Check whether any of the gradients of a weight update is not finite. The
+// inputs are any number of FLOAT and FLOAT16 gradients, and of BOOL results of
+// other checks (of the gradients on other virtual graphs). The output is a
+// BOOL scalar, which is true if a gradient element is not finite or an input
+// check is true. It is inserted by the DynamicLossScaling transform.
+class GradientOverflowCheckOp : public Op {
+public:
+  GradientOverflowCheckOp(const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  void setup() final;
+
+  static OutIndex getOutIndex() { return 0; }
+
+  // The result of the check of all the gradients of the weight update
+  static TensorId getOverflowTensorId() {
+    return reservedGradientOverflowPrefix() + std::string("flag");
+  }
+
+  // The result of the check of the gradients on a virtual graph
+  static TensorId getPartialOverflowTensorId(VGraphId vgid) {
+    return reservedGradientOverflowPrefix() + std::string("vgraph") +
+           std::to_string(vgid);
+  }
+
+  // The result is never batched
+  int getOutBatchAxis(OutIndex) const override { return -1; }
+
+  float getSubgraphValue() const final { return getLowSubgraphValue(); }
+  bool isOutlineable() const final { return false; }
+};
+
+} // namespace popart
+
+#endif
@@ -0,0 +1,169 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_MULTITENSORUPDATE_HPP
+#define GUARD_NEURALNET_MULTITENSORUPDATE_HPP
+
+#include <popart/adam.hpp>
+#include <popart/op/varupdate.hpp>
+#include <popart/optimizervalue.hpp>
+
+namespace popart {
+
+// The multi-tensor Ops apply the optimizer update of a single tensor Op to
+// many tensors at once, in the same compute sets. They are created by the
+// FuseOptimizerUpdates transform.
+//
+// The inputs of tensor i are at the input indices of the single tensor Op,
+// plus i times the number of them. The hyper parameter inputs, which are
+// shared by all the tensors, are only connected for tensor 0. Output i is the
+// output of tensor i.
+
+// The base of the multi-tensor SGD0VarUpdateOp, SGD1VarUpdateOp and
+// AdamVarUpdateOp. It updates the Variables at the
+// VarUpdateOp::getVarToUpdateInIndex() of every tensor inplace. The static
+// VarUpdateOp indices are those of tensor 0; use getInIndex and getOutIndex
+// for the others. getVarId throws, as there is no single Variable.
+class MultiVarUpdateOp : public VarUpdateOp {
+public:
+  MultiVarUpdateOp(const OperatorIdentifier &,
+                   const std::vector<TensorId> &varIds,
+                   int numSingleInputs,
+                   const Op::Settings &);
+
+  std::unique_ptr<Op> cloneWithNewName(const TensorId &) const final;
+  void setup() final;
+  void appendOutlineAttributes(OpSerialiserBase &) const override;
+
+  view::Regions aliases(InIndex in, OutIndex out) const final;
+  view::Regions modifies(InIndex) const final;
+
+  ReplicatedTensorShardingIndices
+  getReplicatedTensorShardingIndices() const final;
+
+  float getSubgraphValue() const final { return getLowSubgraphValue(); }
+
+  const TensorId &getVarId() const final;
+  std::vector<TensorId> getVarIds() const final { return varIds; }
+
+  int getNumTensors() const { return static_cast<int>(varIds.size()); }
+
+  InIndex getInIndex(int tensor, InIndex singleIndex) const {
+    return tensor * numSingleInputs + singleIndex;
+  }
+  static OutIndex getOutIndex(int tensor) { return tensor; }
+
+private:
+  std::vector<TensorId> varIds;
+  int numSingleInputs;
+};
+
+// The gradients are reduced by then (see SGD0Decompose), so the reduction
+// type of the SGD0VarUpdateOps is not kept
+class MultiSGD0VarUpdateOp : public MultiVarUpdateOp {
+public:
+  MultiSGD0VarUpdateOp(const std::vector<TensorId> &varIds,
+                       OptimizerValue initSlr0,
+                       OptimizerValue initWdsf0,
+                       const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  std::map<InIndex, TensorId> optimizerInputs() const final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+
+  const OptimizerValue initSlr0;
+  const OptimizerValue initWdsf0;
+};
+
+class MultiSGD1VarUpdateOp : public MultiVarUpdateOp {
+public:
+  MultiSGD1VarUpdateOp(const std::vector<TensorId> &varIds,
+                       OptimizerValue initSlr1,
+                       const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  std::map<InIndex, TensorId> optimizerInputs() const final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+
+  const OptimizerValue initSlr1;
+};
+
+class MultiAdamVarUpdateOp : public MultiVarUpdateOp {
+public:
+  MultiAdamVarUpdateOp(const std::vector<TensorId> &varIds,
+                       OptimizerValue initLr,
+                       OptimizerValue initMwn,
+                       const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  std::map<InIndex, TensorId> optimizerInputs() const final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+
+  // Whether the learning rates are scaled by the Lamb norms, which are then
+  // connected for every tensor
+  bool hasLambInputs() const;
+
+  const OptimizerValue initLr;
+  const OptimizerValue initMwn;
+};
+
+class MultiAdamUpdaterOp : public Op {
+public:
+  MultiAdamUpdaterOp(int numTensors,
+                     AdamMode mode_,
+                     OptimizerValue wd,
+                     OptimizerValue b1,
+                     OptimizerValue b2,
+                     OptimizerValue eps,
+                     const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  void setup() final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+
+  // The step of every tensor is incremented inplace
+  view::Regions modifies(InIndex) const final;
+
+  ReplicatedTensorShardingIndices
+  getReplicatedTensorShardingIndices() const final;
+
+  float getSubgraphValue() const final { return getHighSubgraphValue(); }
+  bool isOptimizerOp() const final { return true; }
+
+  int getNumTensors() const { return numTensors; }
+
+  InIndex getInIndex(int tensor, InIndex singleIndex) const;
+  static OutIndex getOutIndex(int tensor) { return tensor; }
+
+  AdamMode mode;
+
+  const OptimizerValue initWd;
+  const OptimizerValue initB1;
+  const OptimizerValue initB2;
+  const OptimizerValue initEps;
+
+private:
+  int numTensors;
+};
+
+class MultiLambSquareOp : public Op {
+public:
+  MultiLambSquareOp(int numTensors, const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  void setup() final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+
+  float getSubgraphValue() const final { return getLowSubgraphValue(); }
+  bool isOptimizerOp() const final { return true; }
+
+  int getNumTensors() const { return numTensors; }
+
+  static InIndex getInIndex(int tensor) { return tensor; }
+  static OutIndex getOutIndex(int tensor) { return tensor; }
+
+private:
+  int numTensors;
+};
+
+} // namespace popart
+
+#endif
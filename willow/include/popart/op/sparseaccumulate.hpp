@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_SPARSEACCUMULATEOP_HPP
+#define GUARD_NEURALNET_SPARSEACCUMULATEOP_HPP
+
+#include <popart/op/accumulate.hpp>
+#include <popart/op/varupdate.hpp>
+#include <popart/optimizervalue.hpp>
+#include <popart/vendored/optional.hpp>
+
+namespace popart {
+
+class GatherGradOp;
+
+// Accumulate the gradient of a Gather along axis into the rows of an
+// accumulator it was gathered from, without forming the dense gradient:
+//
+//   accum[indices[i]] += factor * rows[i]
+//
+// Only the Add and DampenedAdd AccumulationTypes can be applied sparsely.
+class SparseAccumulateOp : public VarUpdateOp {
+
+public:
+  SparseAccumulateOp(const TensorId &varToUpdate,
+                     AccumulationType type_,
+                     OptimizerValue factor_,
+                     int64_t axis_,
+                     nonstd::optional<float> availableMemoryProportion_,
+                     const Op::Settings &);
+
+  std::unique_ptr<Op> clone() const final;
+  std::unique_ptr<Op> cloneWithNewName(const TensorId &newName) const final;
+  std::map<InIndex, TensorId> optimizerInputs() const final;
+  void appendOutlineAttributes(OpSerialiserBase &) const final;
+  void setup() final;
+
+  // The gradient of the gathered rows, with the shape of the Gather's output
+  static InIndex getUpdaterInIndex() { return 1; }
+  static InIndex getFactorInIndex() { return 2; }
+  static InIndex getIndicesInIndex() { return 3; }
+
+  float getSubgraphValue() const final { return getLowSubgraphValue(); }
+
+  const AccumulationType &getAccumulationType() const { return type; }
+  const OptimizerValue &getFactor() const { return factor; }
+  int64_t getAxis() const { return axis; }
+  nonstd::optional<float> getAvailableMemoryProportion() const {
+    return availableMemoryProportion;
+  }
+
+  // The GatherGradOp which produces the gradient of weight, if the gradient
+  // should be accumulated sparsely, as set by
+  // SessionOptions::sparseWeightUpdateTensors and
+  // SessionOptions::sparseWeightUpdateMinElements. Otherwise nullptr.
+  static GatherGradOp *getSparseGradient(const Tensor *weight,
+                                         const Tensor *weightGrad);
+
+private:
+  AccumulationType type;
+  const OptimizerValue factor;
+  int64_t axis;
+  nonstd::optional<float> availableMemoryProportion;
+};
+
+} // namespace popart
+
+#endif
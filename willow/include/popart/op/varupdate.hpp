@@ -24,7 +24,12 @@ public:
   view::Regions aliases(InIndex in, OutIndex) const override;
   view::Regions modifies(InIndex) const override;
 
-  const TensorId &getVarId() const { return varId; }
+  // The Var updated by this Op. The multi-tensor VarUpdateOps update many
+  // Vars, and throw (see getVarIds)
+  virtual const TensorId &getVarId() const { return varId; }
+
+  // All the Vars updated by this Op
+  virtual std::vector<TensorId> getVarIds() const { return {varId}; }
 
   // Return a map of all optimizer specific input Tensors (learning rate, etc)
   virtual std::map<InIndex, TensorId> optimizerInputs() const = 0;
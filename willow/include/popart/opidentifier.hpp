@@ -332,6 +332,9 @@ const static AiGraphcoreOpIdV1 ShrinkInplace("ShrinkInplace");
 const static AiGraphcoreOpIdV1 Stash("Stash");
 const static AiGraphcoreOpIdV1 ExpInplace("ExpInplace");
 const static AiGraphcoreOpIdV1 EluInplace("EluInplace");
+const static AiGraphcoreOpIdV1 FusedElementwise("FusedElementwise");
+const static AiGraphcoreOpIdV1
+    FusedElementwiseInplace("FusedElementwiseInplace");
 
 const static AiGraphcoreOpIdV1 L1("L1", 1, 1);
 const static AiGraphcoreOpIdV1 Nll("Nll", 2, 1);
@@ -356,6 +359,7 @@ const static AiGraphcoreOpIdV1 DynamicAddInplace("DynamicAddInplace", 3, 1);
 
 const static AiGraphcoreOpIdV1 Accumulate("Accumulate");
 const static AiGraphcoreOpIdV1 AccumulatorUpdate("AccumulatorUpdate");
+const static AiGraphcoreOpIdV1 SparseAccumulate("SparseAccumulate");
 
 const static AiGraphcoreOpIdV1 SGD0VarUpdate("SGD0VarUpdate");
 const static AiGraphcoreOpIdV1 SGD1Combo("SGD1Combo");
@@ -368,6 +372,14 @@ const static AiGraphcoreOpIdV1 AdamVarUpdate("AdamVarUpdate");
 const static AiGraphcoreOpIdV1 LambSquare("LambSquare");
 const static AiGraphcoreOpIdV1 LambR2Square("LambR2Square");
 
+const static AiGraphcoreOpIdV1 MultiSGD0VarUpdate("MultiSGD0VarUpdate");
+const static AiGraphcoreOpIdV1 MultiSGD1VarUpdate("MultiSGD1VarUpdate");
+const static AiGraphcoreOpIdV1 MultiAdamUpdater("MultiAdamUpdater");
+const static AiGraphcoreOpIdV1 MultiAdamVarUpdate("MultiAdamVarUpdate");
+const static AiGraphcoreOpIdV1 MultiLambSquare("MultiLambSquare");
+
+const static AiGraphcoreOpIdV1 GradientOverflowCheck("GradientOverflowCheck");
+
 const static AiGraphcoreOpIdV1 GradCopyToHost("GradCopyToHost");
 const static AiGraphcoreOpIdV1 GradCopyFromHost("GradCopyFromHost");
 const static AiGraphcoreOpIdV1 HostSGD0VarUpdate("HostSGD0VarUpdate");
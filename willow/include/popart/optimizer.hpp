@@ -33,6 +33,18 @@ enum class OptimizerReductionType {
 std::map<std::string, OptimizerValue>
 getOptMap(const std::map<std::string, std::pair<float, bool>> &m);
 
+// How the value v of an optimizer Tensor depends on the learning rates and the
+// loss scaling. If they are multiplied by the factors lr and ls, the value is
+//
+//   offset + (v - offset) * lr^lrPower * ls^lsPower
+//
+// See OptimizerSchedule
+struct OptimizerScheduleDependence {
+  float offset = 0.0f;
+  int lrPower  = 0;
+  int lsPower  = 0;
+};
+
 // The base Optimizer class
 class Optimizer {
 public:
@@ -55,6 +67,14 @@ public:
   virtual void resetTensorData(Tensor &) const = 0;
   virtual void setTensorData(Tensor &) const   = 0;
 
+  // How the value of the optimizer Tensor optId depends on the learning rates
+  // and the loss scaling
+  virtual OptimizerScheduleDependence
+  getScheduleDependence(const TensorId &optId) const = 0;
+
+  // The learning rates of all weights, which OptimizerSchedules scale
+  virtual const OptimizerValueMap &learningRates() const = 0;
+
   // Create a VarUpdate Op for a specific weight Tensor using this Optimizer,
   // and get the names of inputs to the VarUpdate Op fo a specific Tensor
   virtual std::unique_ptr<Op> createOp(const Tensor &weight, Graph &) const = 0;
@@ -331,6 +351,9 @@ public:
   // this object can compute from the atomic scalars
   float getStoredValue(const TensorId &optId) const;
 
+  OptimizerScheduleDependence
+  getScheduleDependence(const TensorId &optId) const final;
+
   void insertSpecific(const TensorId &,
                       OptimizerValue lr,
                       OptimizerValue wd,
@@ -349,7 +372,7 @@ public:
   // accumulation or because of momentum : return true, otherwise return false.
   bool requiresAccl(const Tensor &weight) const;
 
-  const OptimizerValueMap &learningRates() const { return lrs; }
+  const OptimizerValueMap &learningRates() const final { return lrs; }
   const OptimizerValueMap &weightDecays() const { return wds; }
   const OptimizerValueMap &momentums() const { return mms; }
   const OptimizerValueMap &dampenings() const { return dps; }
@@ -0,0 +1,51 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_OPTIMIZERSCHEDULE_HPP
+#define GUARD_NEURALNET_OPTIMIZERSCHEDULE_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace popart {
+
+// A schedule of a factor by which an optimizer hyper parameter (the learning
+// rates or the loss scaling) is multiplied at weight update t = 0, 1, 2 ...
+// It is evaluated on the device, so that it changes within a call to run.
+//
+// The factor is the product of a linear warmup and a decay:
+//
+//   warmup(t) = warmupStartFactor + (1 - warmupStartFactor) * t / warmupSteps
+//               for t < warmupSteps, and 1 after that
+//
+// The decay starts after the warmup, at s = max(t - warmupSteps, 0):
+//
+//   None:        1
+//   Step:        decayFactor ^ floor(s / decaySteps)
+//   Exponential: decayFactor ^ (s / decaySteps)
+//   Cosine:      minFactor + (1 - minFactor) *
+//                (1 + cos(pi * min(s, decaySteps) / decaySteps)) / 2
+class OptimizerSchedule {
+public:
+  enum class Decay { None = 0, Step, Exponential, Cosine };
+
+  int64_t warmupSteps     = 0;
+  float warmupStartFactor = 0.0f;
+
+  Decay decay        = Decay::None;
+  int64_t decaySteps = 1;
+  float decayFactor  = 1.0f;
+  float minFactor    = 0.0f;
+
+  // Does the schedule change the factor from 1
+  bool enabled() const;
+
+  // The factor at weight update t, as computed on the device
+  float evaluate(int64_t t) const;
+
+  // Throw an error if the schedule is not valid. The name is that of the
+  // scheduled hyper parameter, for the error message
+  void validate(const std::string &name) const;
+};
+
+} // namespace popart
+
+#endif
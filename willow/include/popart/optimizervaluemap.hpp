@@ -27,6 +27,9 @@ public:
 
   OptimizerValue getDefault() const { return defaultOptVal; }
 
+  // Is the default, or any of the specific OptimizerValues, const?
+  bool anyConst() const;
+
   // Check for compatibility of OptimizerValueMaps - can one replace another
   // after Graph construction without requiring changes to the compuatation
   // Graph?
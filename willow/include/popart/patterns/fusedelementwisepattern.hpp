@@ -0,0 +1,36 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_FUSED_ELEMENTWISE_PATTERN_HPP
+#define GUARD_NEURALNET_FUSED_ELEMENTWISE_PATTERN_HPP
+
+#include <popart/patterns/patterns.hpp>
+
+namespace popart {
+
+// Fuse a maximal subgraph of elementwise Ops, in which every intermediate
+// tensor has a single consumer, into one FusedElementwiseOp:
+//
+// (a) -> [Scale] -> (s) -> [Add] -> (t) -> [Gelu] -> (out)
+//                   (b) ----^
+//                  ==================>
+// {(a), (b)} -> [FusedElementwise] -> (out)
+//
+// The pattern is rooted on the last Op of the subgraph. When training, it only
+// applies once the backwards pass has been constructed. Forward tensors which
+// the gradients need then have several consumers, and are kept, and chains of
+// gradient Ops are fused too.
+class FusedElementwisePattern : public PreAliasPattern {
+public:
+  bool matches(Op *) const final;
+  // The intermediate tensors, which are removed
+  std::vector<const Tensor *> touches(Op *) const final;
+  bool apply(Op *) const final;
+
+private:
+  // The Ops fused by applying the pattern at root, in topological order,
+  // ending with root
+  std::vector<Op *> getFusedOps(Op *root) const;
+};
+
+} // namespace popart
+
+#endif
@@ -55,7 +55,8 @@ enum class PreAliasPatternType {
   RandomNormalLikeOpPattern,
   RandomUniformLikeOpPattern,
   ZerosLikeOpPattern,
-  ConvTranspose
+  ConvTranspose,
+  FusedElementwise
 };
 
 // Definition: A tensor is "touched" by a Pattern if
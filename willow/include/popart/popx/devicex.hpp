@@ -18,6 +18,7 @@
 #include <popart/popx/creatorx.hpp>
 #include <popart/popx/enigma.hpp>
 #include <popart/popx/linearmapper.hpp>
+#include <popart/popx/planningcache.hpp>
 #include <popart/popx/poplaroptionsx.hpp>
 #include <popart/popx/popprograms.hpp>
 #include <popart/popx/poptensors.hpp>
@@ -172,9 +173,36 @@ public:
   // poplar::Program. For Variable Tensors, this is the Copy from Stream program
   TaskId taskWhichPopulates(TensorId) const;
 
-  // PlanningCache for matmul and conv
-  poplin::PlanningCache convCache;
-  poplin::matmul::PlanningCache matmulCache;
+  // PlanningCache for matmul and conv, shared with other sessions if
+  // SessionOptions::enablePlanningCacheSharing
+  std::shared_ptr<PlanningCaches> planningCaches;
+  poplin::PlanningCache &convCache;
+  poplin::matmul::PlanningCache &matmulCache;
+
+  // Record the plans requested by the Opxs, see PlanningCacheStatistics
+  void recordConvPlan(const poplin::ConvParams &params,
+                      const poplar::OptionFlags &options);
+  void recordMatMulPlan(const poplar::Type &inputType,
+                        const poplar::Type &outputType,
+                        const std::vector<std::size_t> &aShape,
+                        const std::vector<std::size_t> &bShape,
+                        const poplar::OptionFlags &options);
+  const PlanningCacheStatistics &getPlanningCacheStatistics() const {
+    return planningCacheStatistics;
+  }
+
+  // The optimizer tensors of one IPU and data type, which are streamed from
+  // the host in one contiguous buffer if SessionOptions::packOptimizerStreams
+  struct PackedOptimizerStream {
+    TensorId id;
+    DataType dataType;
+    std::vector<Tensor *> tensors;
+    // The host end of the stream: the data of the tensors, in order
+    std::vector<char> buffer;
+  };
+  const std::vector<PackedOptimizerStream> &getPackedOptimizerStreams() const {
+    return packedOptimizerStreams;
+  }
 
   poplar::OptionFlags engineOptions, reportOptions;
   poplar::OptionFlags pooling_options;
@@ -351,6 +379,19 @@ private:
 
   TaskId fromHostTaskId(TensorId) const;
 
+  // Task to create the packed optimizer streams, and to append a Copy from
+  // each to the optimizer tensors it packs
+  PriTask fromHostPackedOptimizerTask(poplar::program::Sequence &streamSq);
+  TaskId fromHostPackedOptimizerTaskId() const;
+  bool packOptimizerStreams() const;
+  // Copy the host data of the optimizer tensors into the packed buffers
+  void packOptimizerStreamBuffers();
+
+  // Task to evaluate the optimizer schedules on the device, after the
+  // optimizer and the weights are written from the host, and after every
+  // weight update. See SessionOptions::learningRateSchedule
+  PriTask optimizerScheduleTask();
+
   // Task to create a poplar::Stream to write from poplar::Tensor to host
   PriTask streamToHostTask(Tensor *, bool isAnchorStream);
   TaskId streamToHostTaskId(TensorId, bool isAnchorStream) const;
@@ -391,6 +432,13 @@ private:
   void pipelinedOpTaskFunc(TaskId taskId, Op *, SequenceMap &seqs);
   void growOpx(Opx *, poplar::program::Sequence &);
 
+  // Is the Op grown in a program which is skipped when the gradients of the
+  // weight update overflow (see DynamicLossScaling)
+  bool isSkippedOnOverflow(const Op *) const;
+
+  // The tasks of the Ops for which isSkippedOnOverflow is true
+  std::set<TaskId> skippedOnOverflowTasks;
+
   TaskId opTaskId(Op *) const;
 
   void addOpTasks(PriTasks &);
@@ -613,6 +661,10 @@ private:
   bool prepareHasBeenCalled_;
   bool prepareGraphHasBeenCalled_;
 
+  PlanningCacheStatistics planningCacheStatistics;
+
+  std::vector<PackedOptimizerStream> packedOptimizerStreams;
+
   nonstd::optional<poplar::Executable> cachedExecutable;
   bool usingCachedExecutable = false;
 
@@ -2,6 +2,7 @@
 #ifndef GUARD_NEURALNET_EXPORTER_HPP
 #define GUARD_NEURALNET_EXPORTER_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,6 +18,19 @@ class Builder;
 namespace popx {
 class Devicex;
 
+struct StepIOExportOptions {
+  // Number of elements of a feed read from the IStepIO (and converted to the
+  // device type) before they are handed over to the file writer thread.
+  int64_t batchSize = 1024;
+  // If greater than 0, the output is split into files containing at most this
+  // many elements per feed, named <outputFilename>.<chunk index>.
+  int64_t elementsPerChunk = 0;
+  // If true and the output is split into chunks, chunk files that already
+  // exist are not written again. Their elements are still read from the
+  // IStepIO so that later chunks contain the right data.
+  bool resume = false;
+};
+
 // Return true if suport for exporters is compiled in.
 bool exporterIsAvailable();
 
@@ -33,13 +47,15 @@ void exportExecutable(poplar::Executable &executable,
 void exportStepIO(IStepIO &step,
                   const Devicex &device,
                   int64_t numElements,
-                  const std::string &outputFilename);
+                  const std::string &outputFilename,
+                  const StepIOExportOptions &options = {});
 void exportStepIO(Builder &builder,
                   IStepIO &step,
                   int64_t numElements,
                   const std::vector<std::string> &feeds,
                   const std::string &outputFilename,
-                  const std::string &metadataFilename);
+                  const std::string &metadataFilename,
+                  const StepIOExportOptions &options = {});
 
 } // namespace popx
 } // namespace popart
@@ -2,11 +2,29 @@
 #ifndef GUARD_NEURALNET_ADAMUPDATERX_HPP
 #define GUARD_NEURALNET_ADAMUPDATERX_HPP
 
+#include <popart/adam.hpp>
+#include <popart/optimizervalue.hpp>
 #include <popart/popx/opx.hpp>
 
 namespace popart {
 namespace popx {
 
+// Grow the updater term of Adam, Lamb or AdaMax (see optimizer.hpp) for var,
+// with its accumulators and its (already incremented) step. The non-const
+// hyper parameters are the inputs of opx at the AdamUpdaterOp indices. Used by
+// the AdamUpdaterOpx and the MultiAdamUpdaterOpx
+poplar::Tensor growAdamUpdater(const Opx &opx,
+                               AdamMode mode,
+                               const OptimizerValue &initWd,
+                               const OptimizerValue &initB1,
+                               const OptimizerValue &initB2,
+                               const OptimizerValue &initEps,
+                               const poplar::Tensor &var,
+                               const poplar::Tensor &accl1,
+                               const poplar::Tensor &accl2,
+                               const poplar::Tensor &step,
+                               poplar::program::Sequence &prog);
+
 class AdamUpdaterOpx : public Opx {
 public:
   AdamUpdaterOpx(Op *, Devicex *);
@@ -4,9 +4,19 @@
 
 #include <popart/popx/op/varupdatex.hpp>
 
+#include <popops/Expr.hpp>
+
 namespace popart {
 namespace popx {
 
+// The learning rate lr scaled by the Lamb trust ratio of the squared norms of
+// the weight (r1sq) and of its updater (r2sq):
+//   lr * min(sqrt(r1sq), mwn) / sqrt(r2sq), or lr if either norm is 0
+popops::expr::Any getLambLearningRate(const popops::expr::Any &lr,
+                                      const popops::expr::Any &r1sq,
+                                      const popops::expr::Any &r2sq,
+                                      const popops::expr::Any &mwn);
+
 class AdamVarUpdateOpx : public VarUpdateOpx {
 public:
   AdamVarUpdateOpx(Op *, Devicex *);
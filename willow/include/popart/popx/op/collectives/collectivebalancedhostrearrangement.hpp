@@ -0,0 +1,90 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_COLLECTIVEBALANCEDHOSTREARRANGEMENT_HPP
+#define GUARD_NEURALNET_COLLECTIVEBALANCEDHOSTREARRANGEMENT_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace popart {
+namespace popx {
+
+// A contiguous run of elements which is at offset in the original host tensor
+// and at rearrangedOffset in its collective balanced rearrangement
+struct HostRearrangementSegment {
+  HostRearrangementSegment(int64_t offset_,
+                           int64_t rearrangedOffset_,
+                           int64_t size_)
+      : offset(offset_), rearrangedOffset(rearrangedOffset_), size(size_) {}
+  int64_t offset;
+  int64_t rearrangedOffset;
+  int64_t size;
+};
+
+// The host side copy plan of a CollectiveBalancedReorder. It is computed once
+// per tensor, and does not depend on poplar, so that the (potentially multi-GB)
+// weight rearrangements of Devicex::remoteBufferWeightsFromHost and
+// remoteBufferWeightsToHost only have to execute it:
+//  - Segments which are contiguous in both tensors are merged
+//  - The copy is split into chunks of equal byte size, which are run on
+//    separate threads if the tensor is large enough
+class CollectiveBalancedHostRearrangement {
+public:
+  CollectiveBalancedHostRearrangement() = default;
+
+  // The segments must not overlap in either tensor. maxThreads = 0 uses as
+  // many threads as the host supports.
+  CollectiveBalancedHostRearrangement(
+      const std::vector<HostRearrangementSegment> &segments,
+      unsigned maxThreads = 0);
+
+  // Copy the segments of the original tensor in to the rearranged tensor out
+  void
+  rearrangeForCollective(const char *in, char *out, int64_t elemByteSize) const;
+
+  // Copy the segments of the rearranged tensor in to the original tensor out
+  void undoRearrangeForCollective(const char *in,
+                                  char *out,
+                                  int64_t elemByteSize) const;
+
+  const std::vector<HostRearrangementSegment> &getSegments() const {
+    return segments;
+  }
+
+  // Number of elements copied by a rearrangement (excludes padding)
+  int64_t getNumElems() const {
+    return cumulativeSizes.empty() ? 0 : cumulativeSizes.back();
+  }
+
+  // The number of threads a rearrangement of elemByteSize elements runs on
+  unsigned getNumThreads(int64_t elemByteSize) const;
+
+  // Below this many bytes per thread, starting the thread costs more than
+  // the copy it saves
+  static constexpr int64_t minBytesPerThread = 1 << 20;
+
+private:
+  void rearrange(const char *in,
+                 char *out,
+                 int64_t elemByteSize,
+                 bool forCollective) const;
+
+  // Copy the elements [begin, end) of the plan, counted in segment order
+  void copyRange(const char *in,
+                 char *out,
+                 int64_t elemByteSize,
+                 bool forCollective,
+                 int64_t begin,
+                 int64_t end) const;
+
+  std::vector<HostRearrangementSegment> segments;
+
+  // cumulativeSizes[i] is the number of elements in segments [0, i]
+  std::vector<int64_t> cumulativeSizes;
+
+  unsigned maxThreads = 0;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
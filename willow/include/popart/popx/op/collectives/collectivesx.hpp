@@ -3,6 +3,7 @@
 #define GUARD_NEURALNET_COLLECTIVESX_HPP
 
 #include <popart/names.hpp>
+#include <popart/popx/op/collectives/collectivebalancedhostrearrangement.hpp>
 #include <popart/popx/opx.hpp>
 
 namespace popart {
@@ -66,12 +67,6 @@ public:
   }
 
 private:
-  // Host tensor rearrangement routine
-  void rearrange(const char *in,
-                 char *out,
-                 int64_t elemByteSize,
-                 bool forCollective) const;
-
   // Graph or subgraph on which the tensor and reordered tensor are allocated
   poplar::Graph &graph;
 
@@ -88,6 +83,9 @@ private:
 
   // Proxy to reverse simplfy tensors to rearrange for collectives
   poplar::Tensor simplifyReverseProxy;
+
+  // Copy plan of the host-side rearrangements
+  CollectiveBalancedHostRearrangement hostRearrangement;
 };
 
 // If the input/output to a collective op is padded,
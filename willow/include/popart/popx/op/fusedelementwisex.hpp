@@ -0,0 +1,44 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_FUSEDELEMENTWISEX_HPP
+#define GUARD_NEURALNET_FUSEDELEMENTWISEX_HPP
+
+#include <memory>
+#include <popart/names.hpp>
+#include <popart/popx/opx.hpp>
+
+#include <popops/Expr.hpp>
+
+namespace popart {
+namespace popx {
+
+// Computes all the steps of a FusedElementwiseOp with one popops::map
+class FusedElementwiseOpx : public Opx {
+public:
+  FusedElementwiseOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const override;
+
+  // Inputs which are not broadcast have the layout of the output
+  InputCreatorType getInputCreatorType(InIndex) const override;
+  poplar::Tensor
+      unwindTensorLayout(poplar::Tensor, InIndex, OutIndex) const override;
+  view::RegMap unwindRegion(InIndex, OutIndex) const override;
+
+protected:
+  // The expression of all the steps, with placeholder i + 1 for input i
+  std::unique_ptr<popops::expr::Expr> getExpression() const;
+  // The inputs, broadcast to the shape of the output
+  std::vector<poplar::Tensor> getBroadcastInputs() const;
+};
+
+// Computes all the steps of a FusedElementwiseInplaceOp with one
+// popops::mapInPlace, into input 0
+class FusedElementwiseInplaceOpx : public FusedElementwiseOpx {
+public:
+  FusedElementwiseInplaceOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
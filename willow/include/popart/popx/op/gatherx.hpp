@@ -4,10 +4,41 @@
 
 #include <popart/names.hpp>
 #include <popart/popx/opx.hpp>
+#include <popart/vendored/optional.hpp>
+
+#include <popops/DynamicSlice.hpp>
 
 namespace popart {
 namespace popx {
 
+// The permutation that swaps the gather axis for the front.
+std::vector<unsigned> axisToFrontPermutation(std::size_t rank, int64_t axis);
+
+poplar::OptionFlags
+createSliceOptions(nonstd::optional<float> availableMemoryProportion);
+
+// Plan the slices of a dictionary of the given shape along axis, with
+// numLookups indices. The GatherOpx and its GatherGradOpx plan with the same
+// arguments, so the gather and the accumulation of its gradient share a plan,
+// and the layout of the dictionary.
+popops::SlicePlan createSlicePlan(const poplar::Graph &graph,
+                                  const poplar::Type &type,
+                                  const std::vector<std::size_t> &shape,
+                                  int64_t axis,
+                                  std::size_t numLookups,
+                                  bool usedForUpdate,
+                                  const poplar::OptionFlags &options);
+
+// Create a tensor of the given shape, laid out by the plan to be sliced along
+// axis.
+poplar::Tensor createSliceableTensor(poplar::Graph &graph,
+                                     const poplar::Type &type,
+                                     const std::vector<std::size_t> &shape,
+                                     int64_t axis,
+                                     const popops::SlicePlan &plan,
+                                     const poplar::OptionFlags &options,
+                                     const std::string &name);
+
 class GatherOpx : public Opx {
 public:
   GatherOpx(Op *, Devicex *);
@@ -29,6 +60,10 @@ public:
   std::vector<TensorId> mustExistBeforeCreate(int index0) const override;
 
 private:
+  // The plan of the slices, shared with the GatherGradOpx
+  popops::SlicePlan getSlicePlan() const;
+  poplar::OptionFlags getSliceOptions() const;
+
   int64_t axis;
 };
 
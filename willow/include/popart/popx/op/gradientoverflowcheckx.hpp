@@ -0,0 +1,24 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_GRADIENTOVERFLOWCHECKX_HPP
+#define GUARD_NEURALNET_GRADIENTOVERFLOWCHECKX_HPP
+
+#include <popart/names.hpp>
+#include <popart/popx/opx.hpp>
+
+namespace popart {
+namespace popx {
+
+// Each element of the gradients is tested by a single map per data type,
+// and the flags, with the checks given as inputs, are reduced by a single
+// LOGICAL_OR. Testing the elements rather than their sum means large but
+// finite gradients are never taken as an overflow.
+class GradientOverflowCheckOpx : public Opx {
+public:
+  GradientOverflowCheckOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
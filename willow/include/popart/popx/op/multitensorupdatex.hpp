@@ -0,0 +1,59 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_MULTITENSORUPDATEX_HPP
+#define GUARD_NEURALNET_MULTITENSORUPDATEX_HPP
+
+#include <popart/names.hpp>
+#include <popart/popx/op/varupdatex.hpp>
+
+namespace popart {
+namespace popx {
+
+// The multi-tensor Opxs grow the update of all their tensors on flattened and
+// concatenated views of them, so that each step of the update is a single
+// compute set over the tensors, with no copies into a merged layout.
+class MultiVarUpdateOpx : public VarUpdateOpx {
+public:
+  MultiVarUpdateOpx(Op *, Devicex *);
+
+protected:
+  // The input at singleIndex of every tensor
+  std::vector<poplar::Tensor> getInTensors(InIndex singleIndex) const;
+
+  // Set the outputs to the updated Variables
+  void setUpdatedVarOutTensors() const;
+};
+
+class MultiSGD0VarUpdateOpx : public MultiVarUpdateOpx {
+public:
+  MultiSGD0VarUpdateOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+class MultiSGD1VarUpdateOpx : public MultiVarUpdateOpx {
+public:
+  MultiSGD1VarUpdateOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+class MultiAdamVarUpdateOpx : public MultiVarUpdateOpx {
+public:
+  MultiAdamVarUpdateOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+class MultiAdamUpdaterOpx : public Opx {
+public:
+  MultiAdamUpdaterOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+class MultiLambSquareOpx : public Opx {
+public:
+  MultiLambSquareOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
@@ -0,0 +1,32 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_SPARSEACCUMULATEX_HPP
+#define GUARD_NEURALNET_SPARSEACCUMULATEX_HPP
+
+#include <popart/names.hpp>
+#include <popart/popx/op/varupdatex.hpp>
+
+#include <popops/DynamicSlice.hpp>
+
+namespace popart {
+namespace popx {
+
+class SparseAccumulateOpx : public VarUpdateOpx {
+public:
+  SparseAccumulateOpx(Op *, Devicex *);
+  void grow(poplar::program::Sequence &) const final;
+
+  // can create the accumulator input Tensor (@Var index), laid out for the
+  // planned updates, as the GatherOpx lays out the dictionary
+  poplar::Tensor createInput(InIndex, const std::string &name) const final;
+  InputCreatorType getInputCreatorType(InIndex) const final;
+  std::vector<TensorId> mustExistBeforeCreate(InIndex) const final;
+
+private:
+  popops::SlicePlan getSlicePlan() const;
+  poplar::OptionFlags getSliceOptions() const;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
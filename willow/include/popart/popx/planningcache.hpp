@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_PLANNINGCACHE_HPP
+#define GUARD_NEURALNET_PLANNINGCACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <poplar/OptionFlags.hpp>
+#include <poplar/Target.hpp>
+#include <poplar/Type.hpp>
+#include <poplin/Convolution.hpp>
+#include <poplin/MatMul.hpp>
+
+namespace popart {
+
+class DeviceInfo;
+
+// The plans of the convolutions and matmuls grown while lowering a session.
+// A plan is repeated if the same parameters and options were grown before, by
+// this session or, with SessionOptions::enablePlanningCacheSharing, by an
+// earlier session of the process, so that poplin finds it in its cache. These
+// are counted by popart, not by poplin: the plans requested to create the
+// inputs of convolutions and matmuls, or by the GRU and LSTM Opxs, are not
+// counted.
+struct PlanningCacheStatistics {
+  int64_t repeatedConvPlans   = 0;
+  int64_t newConvPlans        = 0;
+  int64_t repeatedMatMulPlans = 0;
+  int64_t newMatMulPlans      = 0;
+};
+
+namespace popx {
+
+// The poplin planning caches of a session. With sharing, the sessions of a
+// process which target the same device with the same Poplar version use the
+// same caches, so that a shape planned by one session is not planned again by
+// the next one.
+//
+// The poplin caches are not thread safe: they must only be used while holding
+// the lock returned by lock(), so that sessions sharing them are lowered one
+// at a time.
+class PlanningCaches {
+public:
+  // The caches shared by every session for the target of the device, or new
+  // caches if not shared
+  static std::shared_ptr<PlanningCaches> get(const DeviceInfo &deviceInfo,
+                                             bool shared);
+
+  // Release the shared caches, which are otherwise kept for the lifetime of
+  // the process. The sessions using them keep them until they are destroyed,
+  // and the next sessions share new caches.
+  static void releaseShared();
+
+  // Lock the caches for the lowering of a session
+  std::unique_lock<std::mutex> lock();
+
+  // Record a request for a plan, and return true if it was requested before
+  bool recordConv(const poplin::ConvParams &params,
+                  const poplar::OptionFlags &options);
+  bool recordMatMul(const poplar::Type &inputType,
+                    const poplar::Type &outputType,
+                    const std::vector<std::size_t> &aShape,
+                    const std::vector<std::size_t> &bShape,
+                    const poplar::OptionFlags &options);
+
+  poplin::PlanningCache conv;
+  poplin::matmul::PlanningCache matmul;
+
+private:
+  bool record(std::set<std::string> &keys, const std::string &key);
+
+  std::mutex useMutex;
+  std::mutex keysMutex;
+  std::set<std::string> convKeys;
+  std::set<std::string> matMulKeys;
+};
+
+} // namespace popx
+} // namespace popart
+
+#endif
@@ -45,6 +45,7 @@ public:
     Forward,
     Backward,
     VarUpdateFromAccumulator,
+    OptimizerSchedule,
     WeightstoHost,
     ToHostFinalCopy,
     CycleCountTensortoHost,
@@ -73,6 +74,9 @@ public:
   poplar::program::Sequence &backwardFragment();
   const poplar::program::Sequence &accumulateOuterFragment() const;
   poplar::program::Sequence &accumulateOuterFragment();
+  // Runs after every weight update
+  const poplar::program::Sequence &optimizerScheduleFragment() const;
+  poplar::program::Sequence &optimizerScheduleFragment();
   const poplar::program::Sequence &weightsToHostFragment() const;
   poplar::program::Sequence &weightsToHostFragment();
   // If ScheduledPreLoss::Yes, then return forwardFragment(), else return
@@ -0,0 +1,139 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_PREFETCHINGSTEPIO_HPP
+#define GUARD_NEURALNET_PREFETCHINGSTEPIO_HPP
+
+#include <popart/istepio.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace popart {
+
+struct PrefetchingStepIOOptions {
+  // The number of batches to fetch ahead of the device, per input tensor.
+  unsigned prefetchDepth = 2;
+  // The number of worker threads calling the upstream IStepIO. Each input
+  // tensor is served by exactly one worker so upstream calls for one tensor
+  // stay in order. If more than one worker is used, the upstream IStepIO must
+  // support concurrent calls for different tensors.
+  unsigned numWorkers = 1;
+  // The number of batches fetched per input tensor over the lifetime of the
+  // adapter. The workers never read past it, so it must not exceed the data
+  // the upstream IStepIO can supply. It is required when the input tensors
+  // are given explicitly, and is ignored when they are taken from an Ir (see
+  // PrefetchingStepIO::getFetchesPerRun).
+  int64_t maxFetchesPerTensor = 0;
+};
+
+struct PrefetchingStepIOStats {
+  // Number of 'prefetch' requests that were served from a ready buffer.
+  int64_t prefetchHits = 0;
+  // Number of 'prefetch' requests that found no ready buffer.
+  int64_t prefetchMisses = 0;
+  // Number of blocking requests that had to wait for a worker.
+  int64_t blockingWaits = 0;
+  // Total time, in seconds, blocking requests spent waiting for a worker.
+  double deviceWaitSeconds = 0.0;
+
+  // Fraction of 'prefetch' requests that were hits.
+  double prefetchHitRate() const;
+};
+
+// An IStepIO adapter that reads input data from an upstream IStepIO on
+// background worker threads, up to `prefetchDepth` batches ahead, so that
+// Poplar's prefetch requests (see SessionOptions::enablePrefetchDatastreams)
+// can be served without waiting for the upstream data source. Batches are
+// copied into buffers that are allocated once and reused. Output data is
+// passed through to the upstream IStepIO unchanged.
+class PrefetchingStepIO : public IStepIO {
+public:
+  // `inputs` maps every input tensor to the tensor info of a single batch of
+  // a single replica, as requested by the device.
+  PrefetchingStepIO(IStepIO &upstream,
+                    const std::map<TensorId, TensorInfo> &inputs,
+                    const PrefetchingStepIOOptions &options);
+  // Prefetch every input data stream of the prepared `ir`, for `numRuns`
+  // calls of Session::run. Exactly the batches the session reads are fetched.
+  PrefetchingStepIO(IStepIO &upstream,
+                    const Ir &ir,
+                    int64_t numRuns,
+                    const PrefetchingStepIOOptions &options = {});
+  // Don't allow copying.
+  PrefetchingStepIO(const PrefetchingStepIO &) = delete;
+  // Don't allow assigning.
+  PrefetchingStepIO &operator=(const PrefetchingStepIO &) = delete;
+  // Stops and joins the worker threads.
+  virtual ~PrefetchingStepIO();
+
+  virtual ConstVoidData in(TensorId id, int64_t numElements, bool prefetch);
+  virtual void inComplete(TensorId id, int64_t numElements);
+  virtual MutableVoidData out(TensorId id, int64_t numElements);
+  virtual void outComplete(TensorId id);
+  virtual void assertNumElements(const Ir &ir) const;
+
+  // The number of batches of every input tensor that one call of Session::run
+  // reads: one per batch, per gradient accumulation step, per replica.
+  static int64_t getFetchesPerRun(const Ir &ir);
+
+  // Get the counters accumulated since construction or the last reset.
+  PrefetchingStepIOStats getStats() const;
+  // Reset the counters, e.g. at the start of every step.
+  void resetStats();
+
+private:
+  // A reusable buffer holding one batch.
+  struct Slot {
+    std::vector<char> buffer;
+    TensorInfo info;
+  };
+
+  // A bounded queue of batches for one input tensor. The owning worker fills
+  // the slot after the last ready one, the consumer reads and releases the
+  // front slot.
+  struct TensorQueue {
+    TensorId id;
+    TensorInfo info;
+    std::vector<Slot> slots;
+    size_t head        = 0;
+    size_t count       = 0;
+    int64_t numFetched = 0;
+    std::exception_ptr fetchError;
+    std::mutex mutex;
+    std::condition_variable ready;
+  };
+
+  // Create the queues and start the workers.
+  void init(const std::map<TensorId, TensorInfo> &inputs);
+  // Main loop of a worker thread.
+  void workerLoop(unsigned workerIndex);
+  // Fetch one batch for a queue, if it has a free slot. Returns true if a
+  // batch was fetched.
+  bool fetchOne(TensorQueue &queue);
+  // Get the queue for a tensor, throwing an error if there is none.
+  TensorQueue &getQueue(const TensorId &id);
+
+  IStepIO &upstream;
+  PrefetchingStepIOOptions options;
+
+  std::map<TensorId, std::unique_ptr<TensorQueue>> queues;
+  std::vector<std::vector<TensorQueue *>> workerQueues;
+  std::vector<std::thread> workers;
+
+  // Used to wake up workers when a slot is released or on shutdown.
+  std::mutex workerMutex;
+  std::condition_variable workerWake;
+  uint64_t releaseGeneration = 0;
+  bool stopping              = false;
+
+  mutable std::mutex statsMutex;
+  PrefetchingStepIOStats stats;
+};
+
+} // namespace popart
+
+#endif
@@ -2,6 +2,10 @@
 #ifndef GUARD_NEURALNET_RECOMPUTE_HPP
 #define GUARD_NEURALNET_RECOMPUTE_HPP
 
+#include <set>
+#include <vector>
+#include <popart/names.hpp>
+
 namespace popart {
 
 enum class RecomputationType;
@@ -10,6 +14,42 @@ class Graph;
 namespace recompute {
 void autoAnnotate(Graph &graph, RecomputationType rctype);
 
+// The checkpoints chosen by RecomputationType::Budgeted for the forward Ops
+// of one virtual graph, with estimates of their memory and compute.
+struct BudgetedPlan {
+  // The virtual graph of the Ops, or unusedVGraphId if there are none
+  VGraphId virtualGraphId = unusedVGraphId;
+  // Forward Ops whose outputs are stored for the backwards pass. All other
+  // forward Ops on the virtual graph are recomputed
+  std::set<Op *> checkpoints;
+  // Bytes of checkpointed activations
+  int64_t checkpointMemory = 0;
+  // Estimated peak bytes of live activations, see planBudgeted
+  int64_t estimatedPeakMemory = 0;
+  // Estimated cost (~ multiply-accumulates) of recomputing the non-checkpoint
+  // Ops, and of running all the forward Ops once
+  double recomputeCost = 0.0;
+  double forwardCost   = 0.0;
+  bool withinBudget    = true;
+};
+
+// Choose checkpoints for each virtual graph of `graph` which minimise the
+// estimated cost of recomputation while keeping the estimated peak activation
+// memory within `memoryBudget` bytes. If memoryBudget is 0, or if it can't be
+// met, the checkpoints with the lowest estimated peak memory are chosen.
+//
+// The estimated peak memory is the larger of the peak liveness of the forward
+// pass, and the checkpointed activations plus the activations of the largest
+// recomputed segment (the Ops between two checkpoints), which are all live
+// while that segment's gradients are computed.
+//
+// The Graph is not modified.
+std::vector<BudgetedPlan> planBudgeted(const Graph &graph,
+                                       int64_t memoryBudget);
+
+// The estimated cost of running `op` once, used by planBudgeted
+double estimateRecomputeCost(const Op &op);
+
 } // namespace recompute
 } // namespace popart
 
@@ -2,12 +2,15 @@
 #ifndef GUARD_NEURALNET_NET_HPP
 #define GUARD_NEURALNET_NET_HPP
 
+#include <future>
 #include <memory>
 #include <vector>
 
 #include <poplar/DataStream.hpp>
 #include <popart/ir.hpp>
+#include <popart/memoryestimate.hpp>
 #include <popart/names.hpp>
+#include <popart/popx/exporter.hpp>
 #include <popart/stepio.hpp>
 
 namespace popart {
@@ -15,11 +18,41 @@ namespace popart {
 struct SessionOptions;
 class Patterns;
 class DeviceInfo;
+struct AutoVirtualGraphPlan;
+struct ExecutionPhasePlan;
+struct MergeVarUpdateReport;
+struct PipelineStashReport;
+struct PlanningCacheStatistics;
+struct ReplicatedAllReduceBucketReport;
+struct ReplicatedTensorShardingPlan;
 
 namespace popx {
 class Devicex;
 }
 
+/**
+ * A handle to a step started with Session::runAsync.
+ */
+class SessionRunHandle {
+public:
+  SessionRunHandle() = default;
+  explicit SessionRunHandle(std::shared_future<void> future);
+
+  /**
+   * Block until the step has finished. Any error raised while running the
+   * step (or a step started before it) is rethrown here.
+   */
+  void wait() const;
+
+  /**
+   * Return true if the step has finished, without blocking.
+   */
+  bool isComplete() const;
+
+private:
+  std::shared_future<void> future;
+};
+
 /**
  * Session is a runtime instance the provides an interface for executing ONNX
  * graphs on IPU hardware.
@@ -82,12 +115,37 @@ public:
    */
   void run(IStepIO &stepIO, std::string debugName = "");
 
+  /**
+   * Start one step on a background thread and return immediately.
+   *
+   * Steps started with runAsync run one at a time, in the order in which they
+   * were started, and any other call on this session that touches the device
+   * (including run) first waits for all of them to finish. The stepIO must
+   * stay alive, and its buffers must not be modified, until the step has
+   * finished.
+   *
+   * This allows double-buffered StepIO: with two StepIO objects A and B, start
+   * step N with A, fill B with the inputs of step N+1 and start it, then wait
+   * on the handle of step N and post-process the anchors of A while step N+1
+   * runs on the device. A may then be refilled for step N+2.
+   *
+   * runAsync itself is not thread safe and must be called from one thread.
+   *
+   * input data  : from address in stepIO.in
+   * debug name  : debug string to identify this run in logs
+   * output data : to addresses in stepIO.out
+   */
+  SessionRunHandle runAsync(IStepIO &stepIO, std::string debugName = "");
+
   /**
    * Export numElements from stepIO.in
+   *
+   * options : batching and chunking of the output, see StepIOExportOptions
    */
   void exportInputs(IStepIO &stepIO,
                     int64_t numElements,
-                    const std::string &outputFilename);
+                    const std::string &outputFilename,
+                    const popx::StepIOExportOptions &options = {});
 
   /**
    * Write current model to ONNX file
@@ -159,6 +217,92 @@ public:
    */
   TensorTileMap getTensorTileMap() const;
 
+  /**
+   * Retrieve the virtual graph of every Op, and the estimated memory,
+   * compute and copies of each virtual graph, as chosen by
+   * VirtualGraphMode::Auto or VirtualGraphMode::Balanced
+   *
+   * This is available as soon as the session has been created, so different
+   * options can be compared without calling `prepareDevice()`.
+   *
+   * \return the AutoVirtualGraphPlan of the session
+   */
+  const AutoVirtualGraphPlan &getAutoVirtualGraphPlan() const;
+
+  /**
+   * Retrieve the stash memory of each pipeline stage, before and after
+   * choosing between stashing and recomputing activations
+   *
+   * \return the PipelineStashReport of the session
+   */
+  const PipelineStashReport &getPipelineStashReport() const;
+
+  /**
+   * Retrieve the groups of VarUpdates merged by the 'mergeVarUpdate' session
+   * option, with their sizes and estimated benefits
+   *
+   * \return the MergeVarUpdateReport of the session
+   */
+  const MergeVarUpdateReport &getMergeVarUpdateReport() const;
+
+  /**
+   * Retrieve the execution phase of every Op, and the estimated memory,
+   * compute and traffic of each phase, as chosen for
+   * ExecutionPhaseSettings::autoMemoryBudget
+   *
+   * \return the ExecutionPhasePlan of the session
+   */
+  const ExecutionPhasePlan &getExecutionPhasePlan() const;
+
+  /**
+   * Retrieve which weights and optimizer state are sharded across replicas,
+   * with the memory saved and the collectives added, as chosen for
+   * SessionOptions::replicatedTensorShardingMemoryBudget
+   *
+   * \return the ReplicatedTensorShardingPlan of the session
+   */
+  const ReplicatedTensorShardingPlan &getReplicatedTensorShardingPlan() const;
+
+  /**
+   * Retrieve the buckets of gradients reduced across replicas by a single
+   * all-reduce, with their sizes and the estimated cycles saved, as chosen
+   * for SessionOptions::replicatedAllReduceBucketSize
+   *
+   * \return the ReplicatedAllReduceBucketReport of the session
+   */
+  const ReplicatedAllReduceBucketReport &
+  getReplicatedAllReduceBucketReport() const;
+
+  /**
+   * Estimate the memory required by each virtual graph, without compiling
+   * the model
+   *
+   * This is available as soon as the session has been created, so that
+   * configurations which will not fit can be rejected before
+   * `prepareDevice()`. See popart::estimateMemory.
+   *
+   * \return the MemoryEstimate of the session
+   */
+  MemoryEstimate getMemoryEstimate() const;
+
+  /**
+   * Retrieve how many of the convolution and matmul plans grown while
+   * preparing the device had been grown before
+   *
+   * \return the PlanningCacheStatistics of the session
+   */
+  PlanningCacheStatistics getPlanningCacheStatistics() const;
+
+  /**
+   * Retrieve the batch serialisation factor chosen for
+   * BatchSerializationSettings::autoMemoryBudget, and the candidates which
+   * were rejected
+   *
+   * \return the BatchSerializationFactorChoice of the session
+   */
+  const BatchSerializationFactorChoice &
+  getBatchSerializationFactorChoice() const;
+
   /**
    * Reset the weights with the weights in a ONNX model that differs to the
    * current model only in weights. This only updates the weights on the host;
@@ -196,10 +340,21 @@ public:
    */
   std::string serializeIr(IrSerializationFormat format);
 
-  const Ir &getIr() const { return ir; }
+  const Ir &getIr() const { return *ir; }
   const popx::Devicex &getDevice() const { return *device_; }
 
 protected:
+  /**
+   * Throw an error if the session is not in a state where run can be called.
+   */
+  void assertCanRun() const;
+
+  /**
+   * Block until all steps started with runAsync have finished. Errors are
+   * not rethrown here, they are reported through the handles.
+   */
+  void waitForPendingRuns() const;
+
   /**
    * Select a device type.
    *
@@ -207,12 +362,24 @@ protected:
    */
   void setDevice(std::shared_ptr<DeviceInfo> deviceInfo);
 
+  /**
+   * Prepare the Ir, first choosing the batch serialisation factor if
+   * BatchSerializationSettings::autoMemoryBudget is set.
+   */
+  void prepareIr(const IrBundle &bundle);
+
+  /**
+   * The batch serialisation factor chosen by prepareIr, if any
+   */
+  BatchSerializationFactorChoice batchSerializationFactorChoice;
+
   /**
    * abstraction of the computation, the Ir is where
    * all the compute graph optimisations, backwards pass construction,
-   * re-computation growing etc. happens.
+   * re-computation growing etc. happens. It is replaced by the Ir of the
+   * chosen candidate when the batch serialisation factor is chosen.
    */
-  Ir ir;
+  std::unique_ptr<Ir> ir;
 
   /**
    * Implementation of the computation, for IPU back-end this is
@@ -229,6 +396,11 @@ protected:
    * Flag to indicate if run has been called
    */
   bool runCalled = false;
+
+  /**
+   * The last step started with runAsync, if any
+   */
+  std::shared_future<void> pendingRun;
 };
 
 class InferenceSession : public Session {
@@ -308,9 +480,13 @@ public:
    * momentum. Reason: The Ir would need to change to incorporate momentum, but
    * the Ir is frozen once constructed.
    *
+   * The optimizer tensors are only written to the device if one of their
+   * values changed.
+   *
    * \param optimizer A pointer to a popart::Optimizer
+   * \return The ids of the optimizer tensors whose values changed
    */
-  void updateOptimizerFromHost(const Optimizer *optimizer);
+  std::vector<TensorId> updateOptimizerFromHost(const Optimizer *optimizer);
 
   /**
    * Access the stream IDs for variables that are involved in host side
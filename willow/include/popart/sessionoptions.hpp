@@ -9,6 +9,7 @@
 
 #include <popart/op.hpp>
 #include <popart/op/loss.hpp>
+#include <popart/optimizerschedule.hpp>
 #include <popart/tensorlocation.hpp>
 
 namespace popart {
@@ -33,6 +34,9 @@ enum class RecomputationType {
   Standard, // Algorithm to pick checkpoint to try an minimize max liveness
   NormOnly, // Only Norm ops (+ non-linearities, if following) are recomputed
   Pipeline, // Recompute all forward pipeline stages
+  Budgeted, // Minimise the cost of recomputation, subject to keeping the
+            // estimated activation memory on each IPU within
+            // SessionOptions::autoRecomputationMemoryBudget
   N         // the number of RecomputationTypes, must appear as the final enum
 };
 
@@ -45,6 +49,9 @@ enum class MergeVarUpdateType {
              // processed by different VarUpdateOps
   AutoTight, // Merge into groups, so that VarUpdateOps process Tensors of
              // exactly mergeVarUpdateMemThreshold in size
+  AutoCost,  // Merge into groups which minimise the estimated cycles of the
+             // VarUpdates and of the concats and slices merging adds, without
+             // increasing max-liveness by more than looseThresholdAtPeak
   N          // The number of MergeVarUpdateTypes, must appear as the final enum
 };
 
@@ -53,6 +60,7 @@ enum class VirtualGraphMode {
   Manual,  // user must set the virtualGraph attribute on all ops and losses
   Auto,    // autoVirtualGraph transform is used
   ExecutionPhases, // virtual graphs are tied to execution phases
+  Balanced, // autoVirtualGraph transform balancing memory, compute and copies
   N // The number of VirtualGraphModes, must appear as the final enum
 };
 
@@ -146,6 +154,12 @@ struct BatchSerializationSettings {
   // This setting is experimental and may change.
   BatchSerializationBatchSchedule batchSchedule =
       BatchSerializationBatchSchedule::Isomorphic;
+  // If greater than 0, the factor is chosen automatically, overriding
+  // 'factor': the smallest divisor of the batch size, up to maxAutoFactor,
+  // for which the estimated memory of every IPU is at most autoMemoryBudget
+  // bytes. See popart::chooseBatchSerializationFactor.
+  int64_t autoMemoryBudget = 0;
+  int maxAutoFactor        = 64;
 };
 
 enum class ExecutionPhaseIOSchedule {
@@ -216,6 +230,30 @@ struct ExecutionPhaseSettings {
       ExecutionPhaseIOSchedule::Preload;
 
   ExecutionPhaseSchedule schedule = ExecutionPhaseSchedule::Interleaving;
+
+  // Load ExecutionPhaseIOSchedule::OnDemand tensors up to this many phases
+  // before the phase which consumes them, so that loading overlaps with
+  // compute. With IO tiles (SessionOptions::numIOTiles) the tensors land on
+  // the IO tiles, and are copied to the compute tiles in the consuming phase.
+  // 0 disables prefetching.
+  int onDemandPrefetchPhases = 0;
+
+  // The most bytes of prefetched tensors held on any virtual graph, in any
+  // phase, waiting for the phase which consumes them. Tensors which do not
+  // fit are prefetched fewer phases ahead, or loaded on demand. 0 means no
+  // limit.
+  int64_t onDemandPrefetchMemoryBudget = 0;
+
+  // If greater than 0, the forward Ops without an execution phase are split
+  // into contiguous phases of the schedule, each holding at most this many
+  // bytes of weights and activations, instead of being split by weight bytes
+  // alone. See StreamingMemory::planExecutionPhases.
+  int64_t autoMemoryBudget = 0;
+  // Of those splits, the one with the least traffic between phases is chosen
+  // whose slowest phase is at most this many times slower than the slowest
+  // phase of the fastest split. The phase times are estimated with
+  // SessionOptions::costModelSettings.
+  double autoTimeSlack = 1.05;
 };
 
 // Setting that determines how the operations in the accumulate outer fragment
@@ -230,7 +268,14 @@ enum class AccumulateOuterFragmentSchedule {
   OverlapCycleOptimized,
   // Try and parallelize ops with different virtual graph IDs but avoid certain
   // steps that are costly in terms of memory usage.
-  OverlapMemoryOptimized
+  OverlapMemoryOptimized,
+  // Parallelize like OverlapCycleOptimized, and stream the remote tensors
+  // (e.g. optimizer state in remote buffers, see
+  // SessionOptions::optimizerStateTensorLocationSettings) of each virtual
+  // graph through the updates: the tensors of the next update are loaded
+  // before the current update, so that the two can overlap, and at most two
+  // updates have their tensors loaded at once.
+  OverlapStreamedUpdates
 };
 
 /**
@@ -255,6 +300,73 @@ struct AccumulateOuterFragmentSettings {
   std::vector<int> excludedVirtualGraphs = {};
 };
 
+/**
+ * A structure containing the settings of dynamic loss scaling. The loss
+ * scaling set by the host is multiplied by a factor, which is adjusted on the
+ * device after every weight update:
+ *
+ * - If a gradient of the update is not finite, the update is skipped and the
+ *   factor is multiplied by backoffFactor.
+ * - After growthInterval updates in a row without an overflow, the factor is
+ *   multiplied by growthFactor.
+ *
+ * The factor is kept within [minFactor, maxFactor], and starts at 1 when the
+ * weights are written to the device. Whether the gradients of a step
+ * overflowed is held in the BOOL tensor reservedGradientOverflowPrefix() +
+ * "flag" (see GradientOverflowCheckOp), which can be anchored.
+ */
+struct DynamicLossScalingSettings {
+  DynamicLossScalingSettings() = default;
+
+  DynamicLossScalingSettings &
+  operator=(const DynamicLossScalingSettings &rhs) = default;
+
+  bool enabled = false;
+
+  int64_t growthInterval = 2000;
+  float growthFactor     = 2.0f;
+  float backoffFactor    = 0.5f;
+
+  float minFactor = 1.0f / 65536.0f;
+  float maxFactor = 65536.0f;
+
+  // Throw an error if the settings are not valid
+  void validate() const;
+};
+
+/**
+ * Rough IPU figures used by the cost models of the automatic planners (see
+ * MergeVarUpdateType::AutoCost, ExecutionPhaseSettings::autoMemoryBudget,
+ * SessionOptions::replicatedTensorShardingMemoryBudget and
+ * SessionOptions::replicatedAllReduceBucketSize). They are order-of-magnitude
+ * estimates, to be tuned against profiles of the target system rather than
+ * exact timings.
+ */
+struct CostModelSettings {
+  CostModelSettings() = default;
+
+  CostModelSettings &operator=(const CostModelSettings &rhs) = default;
+
+  // The fixed cycles of a program with its own compute set and exchange,
+  // whatever its size
+  double programCycles = 2000.0;
+  // The bytes copied per cycle between tensors on the same IPU, e.g. into or
+  // out of a concatenated layout
+  double onChipCopyBytesPerCycle = 4096.0;
+  // The multiply-accumulates per cycle of an IPU, to compare the compute of
+  // an execution phase with its traffic
+  double macsPerCycle = 4096.0;
+  // The bytes loaded from, or stored to, remote buffers per cycle
+  double remoteBytesPerCycle = 16.0;
+  // The bytes copied per cycle between IPUs
+  double interIpuCopyBytesPerCycle = 64.0;
+  // The fixed cycles of a collective across replicas, for the sync and the
+  // exchange setup
+  double collectiveLatencyCycles = 10000.0;
+  // The bytes sent per cycle by each replica in a collective
+  double collectiveBytesPerCycle = 8.0;
+};
+
 /**
  * A structure containing user configuration options for the Session class
  */
@@ -313,6 +425,13 @@ struct SessionOptions {
   /// reduce model size at the cost of computation cycles
   RecomputationType autoRecomputation = RecomputationType::None;
 
+  /// The estimated activation memory (in bytes) per IPU which
+  /// RecomputationType::Budgeted must stay within. If 0, or if the budget
+  /// can't be met, the checkpoints with the lowest estimated peak memory are
+  /// used. When pipelining, the budget is for the stashes of each IPU:
+  /// recomputable activations are stashed while they fit in it.
+  int64_t autoRecomputationMemoryBudget = 0;
+
   /// Enable merging of VarUpdates into groups of VarUpdates, by flattening
   /// and concatenating Variable Tensors and Updating Tensors
   MergeVarUpdateType mergeVarUpdate = MergeVarUpdateType::None;
@@ -328,9 +447,63 @@ struct SessionOptions {
   /// where liveAtPeak is an estimate of the maximum live memory of the
   /// computation, and liveCurrently is an estimate of the live memory where the
   /// threshold is being used to determine whether to schedule or postpone a
-  /// VarUpdate.
+  /// VarUpdate. The AutoCost algorithm uses
+  /// liveAtPeak - liveCurrently + looseThresholdAtPeak as its memory cap.
   int64_t looseThresholdAtPeak = 8000;
 
+  /// The IPU figures used by the cost models of the automatic planners
+  CostModelSettings costModelSettings;
+
+  /// If greater than 0, the gradients reduced across replicas are merged into
+  /// buckets of at most this many bytes, each reduced by a single
+  /// all-reduce of their concatenation. Buckets are filled in the order the
+  /// gradients are produced, so that the first buckets are reduced while the
+  /// backwards pass continues. The accumulators reduced inplace by SGD with
+  /// momentum and by Adam are merged into buckets of their own. See
+  /// popart::ReplicatedAllReduceBucketReport.
+  int64_t replicatedAllReduceBucketSize = 0;
+
+  /// The weights whose gradients are accumulated sparsely by SGD with
+  /// momentum, and by Adam and Lamb with gradient accumulation. Each must be
+  /// used by a single Gather: the gradient of the gathered rows is added to
+  /// the rows of the optimizer's accumulator with a multi-update, instead of
+  /// forming the dense gradient of the whole table. The result is the same as
+  /// the dense accumulation. Gradients which are reduced across replicas
+  /// before they are accumulated are left dense.
+  std::set<TensorId> sparseWeightUpdateTensors;
+
+  /// If greater than 0, the gradients of the weights of at least this many
+  /// elements, which are used by a single Gather of fewer indices than the
+  /// weight has rows, are also accumulated sparsely. See
+  /// sparseWeightUpdateTensors.
+  int64_t sparseWeightUpdateMinElements = 0;
+
+  /// Stream the optimizer tensors (learning rates, weight decays, loss
+  /// scaling, momentums ...) of each IPU in one contiguous buffer per data
+  /// type, instead of one stream copy per tensor.
+  bool packOptimizerStreams = false;
+
+  /// Fuse the optimizer updates of many weights into one Op each: the
+  /// SGD1VarUpdates, AdamUpdaters, AdamVarUpdates and LambSquares with the
+  /// same placement and hyper parameters are applied to all their tensors in
+  /// the same compute sets, without copying the tensors into a merged layout
+  /// (see mergeVarUpdate).
+  bool fuseOptimizerUpdates = false;
+
+  /// Schedules of factors of the learning rates and of the loss scaling,
+  /// evaluated on the device at every weight update. They scale the values
+  /// of the non-const optimizer hyper parameters set by the host. The
+  /// schedules restart when the weights are written to the device. See
+  /// popart::OptimizerSchedule.
+  OptimizerSchedule learningRateSchedule;
+  OptimizerSchedule lossScalingSchedule;
+
+  /// Adjust the loss scaling on the device, so that it is as large as it can
+  /// be without the gradients overflowing. The weight updates whose gradients
+  /// overflow are skipped. It requires a non-const loss scaling. See
+  /// popart::DynamicLossScalingSettings.
+  DynamicLossScalingSettings dynamicLossScalingSettings;
+
   /// Before anchor tensors are streamed from device to host, they are not
   /// necessarily arranged in memory as required when they are to be copied
   /// from host stream to host. This can be done on the device or on the host.
@@ -414,6 +587,14 @@ struct SessionOptions {
   /// Path to save the poplar::Executable to.
   std::string cachePath = "session_cache";
 
+  /// Share the convolution and matmul planning caches with the other
+  /// sessions of the process which target the same device, so that shapes
+  /// planned by one session are not planned again by the next. The sessions
+  /// sharing the caches prepare their devices one at a time. The shared
+  /// caches are kept until popx::PlanningCaches::releaseShared is called.
+  /// See Session::getPlanningCacheStatistics.
+  bool enablePlanningCacheSharing = false;
+
   // Enable exceptions when floating point errors occur.
   bool enableFloatingPointChecks = false;
 
@@ -590,6 +771,18 @@ struct SessionOptions {
 
   // Overriding tensor location for specific tensors.
   std::map<TensorId, TensorLocation> tensorLocationSettingsOverride;
+
+  // If greater than 0, which weight and optimizer state tensors to shard
+  // across replicas is planned, instead of following the
+  // replicatedTensorSharding of their TensorLocationSettings. The tensors
+  // which save the most memory per estimated collective cycle are sharded
+  // until the weights, optimizer state and accumulators of every IPU fit in
+  // this many bytes. The accumulators, the tensors in
+  // tensorLocationSettingsOverride and those with fewer elements than the
+  // minElementsForReplicatedTensorSharding of their TensorLocationSettings
+  // are left as they are, but count towards the budget. The collectives are
+  // estimated with costModelSettings. See popart::ReplicatedTensorShardingPlan.
+  int64_t replicatedTensorShardingMemoryBudget = 0;
 };
 
 } // namespace popart
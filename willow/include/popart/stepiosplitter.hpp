@@ -2,14 +2,89 @@
 #ifndef GUARD_NEURALNET_STEPIOSPLITTER_HPP
 #define GUARD_NEURALNET_STEPIOSPLITTER_HPP
 
+#include <popart/error.hpp>
 #include <popart/istepio.hpp>
 
-#include <list>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <tuple>
+#include <vector>
 
 namespace popart {
 
+// A fixed-capacity, single-producer single-consumer ring buffer. The producer
+// (the StepIOSplitter, which serialises all upstream calls) and the consumer
+// (the Poplar callback thread of one replica) may run concurrently without
+// taking a lock. Slots are allocated once on construction so that no
+// allocation happens per batch.
+template <typename T> class StepIORingBuffer {
+public:
+  // Constructor. One extra slot is used to distinguish 'full' from 'empty'.
+  explicit StepIORingBuffer(size_t capacity_)
+      : slots(capacity_ + 1), head(0), tail(0) {}
+
+  // Don't allow copying.
+  StepIORingBuffer(const StepIORingBuffer &) = delete;
+  // Don't allow assigning.
+  StepIORingBuffer &operator=(const StepIORingBuffer &) = delete;
+
+  // The maximum number of elements the buffer can hold.
+  size_t capacity() const { return slots.size() - 1; }
+
+  // Number of elements currently in the buffer. Only exact when called from
+  // the producer or the consumer while the other side is idle.
+  size_t size() const {
+    const auto h = head.load(std::memory_order_acquire);
+    const auto t = tail.load(std::memory_order_acquire);
+    return (t + slots.size() - h) % slots.size();
+  }
+
+  // Check if the buffer is empty (consumer side).
+  bool empty() const {
+    return head.load(std::memory_order_relaxed) ==
+           tail.load(std::memory_order_acquire);
+  }
+
+  // Add an element to the back of the buffer (producer side).
+  void push_back(const T &value) {
+    const auto t    = tail.load(std::memory_order_relaxed);
+    const auto next = (t + 1) % slots.size();
+    if (next == head.load(std::memory_order_acquire)) {
+      throw error("[StepIOSplitter] Ring buffer capacity of {} element(s) "
+                  "exceeded",
+                  capacity());
+    }
+    slots[t] = value;
+    tail.store(next, std::memory_order_release);
+  }
+
+  // Access the element at the front of the buffer (consumer side).
+  const T &front() const {
+    return slots[head.load(std::memory_order_relaxed)];
+  }
+
+  // Discard the element at the front of the buffer (consumer side).
+  void pop_front() {
+    const auto h = head.load(std::memory_order_relaxed);
+    head.store((h + 1) % slots.size(), std::memory_order_release);
+  }
+
+  // Discard all elements. Must not be called concurrently with push/pop.
+  void clear() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  // Preallocated element storage.
+  std::vector<T> slots;
+  // Index of the front element, only written by the consumer.
+  std::atomic<size_t> head;
+  // Index one past the back element, only written by the producer.
+  std::atomic<size_t> tail;
+};
+
 // Forward declaration.
 class StepIOSplitter;
 
@@ -21,7 +96,8 @@ public:
   StepIOSplitterAdapter(StepIOSplitter *splitter,
                         unsigned replicationIndex,
                         TensorId id,
-                        const TensorInfo &info);
+                        const TensorInfo &info,
+                        size_t bufferCapacity);
   // Destructor.
   virtual ~StepIOSplitterAdapter() = default;
   // Get next data element for reading from adapter.
@@ -39,9 +115,9 @@ public:
   void reset();
 
   // Get reference to in data buffer.
-  std::list<ConstVoidData> &getInData() { return inData; }
+  StepIORingBuffer<ConstVoidData> &getInData() { return inData; }
   // Get reference to out data buffer.
-  std::list<MutableVoidData> &getOutData() { return outData; }
+  StepIORingBuffer<MutableVoidData> &getOutData() { return outData; }
 
 private:
   // Reference back to StepIOSplitter object.
@@ -51,9 +127,9 @@ private:
   // The id this adapter was created for.
   TensorId adapterId;
   // Buffer of elements to read from.
-  std::list<ConstVoidData> inData;
+  StepIORingBuffer<ConstVoidData> inData;
   // Buffer of elements to write into.
-  std::list<MutableVoidData> outData;
+  StepIORingBuffer<MutableVoidData> outData;
   // Void data to return if input with prefetch fails.
   ConstVoidData emptyVoidData;
 };
@@ -109,6 +185,12 @@ public:
   // IStepIO out of order).
   void getOutData(TensorId id, int64_t numElements, unsigned replicationIndex);
 
+  // The above two functions, as well as inCompleteCallback, may be called
+  // concurrently from the Poplar callbacks of different replicas and tensors.
+  // Implementations of IStepIO such as PyStepIO are not thread-safe, so all
+  // calls to the upstream IStepIO are serialised by one lock, and data is
+  // passed to each replica via a lock-free ring buffer.
+
   // Check number of elements in upstream IStepIO.
   virtual void assertNumElements(const Ir &) const;
 
@@ -124,6 +206,10 @@ public:
                                   unsigned replicationIndex);
 
 private:
+  // Capacity of the per-replica buffers; the most elements a single replica
+  // can hold in one step.
+  size_t bufferCapacity() const;
+
   // The number of replications.
   unsigned replicationFactor;
 
@@ -135,6 +221,8 @@ private:
 
   // The upstream datastream.
   IStepIO *upstreamIo;
+  // Serialises the calls to upstreamIo, for all tensors and replicas.
+  std::mutex upstreamMutex;
   // Map tuples TensorId to a map from replication indices to IStepIO adapters.
   std::map<TensorId, SplitIOTensorInfo> downstreamIoMap;
 };
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_SYNTHETICSTEPIO_HPP
+#define GUARD_NEURALNET_SYNTHETICSTEPIO_HPP
+
+#include <popart/istepio.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace popart {
+
+// Describes how the host generates synthetic data for one input tensor.
+class SyntheticInput {
+public:
+  enum class Kind {
+    UniformInt, // Integers uniformly distributed in [low, high)
+    Normal,     // Values distributed ~N(mean, stddev^2)
+    Replay      // The same recorded batch, repeated
+  };
+
+  // Integers uniformly distributed in [low, high), e.g. token ids within a
+  // vocabulary. The range must be representable in dataType.
+  static SyntheticInput
+  uniformInt(int64_t low, int64_t high, DataType dataType = DataType::INT32);
+
+  // Values with a normal distribution.
+  static SyntheticInput normal(float mean,
+                               float stddev,
+                               DataType dataType = DataType::FLOAT);
+
+  // Replay one recorded batch. The data is copied.
+  static SyntheticInput replay(const ConstVoidData &batch);
+
+  Kind kind() const { return kind_; }
+  DataType dataType() const { return dataType_; }
+
+  // Generate `numBatches` batches of `numElements` elements each.
+  std::vector<char> generate(int64_t numElements,
+                             unsigned numBatches,
+                             uint64_t seed) const;
+
+private:
+  SyntheticInput(Kind kind, DataType dataType);
+
+  Kind kind_;
+  DataType dataType_;
+  int64_t low  = 0;
+  int64_t high = 0;
+  float mean   = 0.0f;
+  float stddev = 1.0f;
+  std::vector<char> replayData;
+};
+
+// An IStepIO that feeds synthetic data, generated on the host, through the
+// real host-to-device streams. Unlike SessionOptions::syntheticDataMode,
+// this exercises the full input path (stream callbacks, StepIOSplitter, type
+// conversion and host-to-device bandwidth) without a data pipeline.
+//
+// To keep up with the device, a pool of `poolSize` batches is generated per
+// input the first time it is requested and then cycled through. Outputs are
+// written to scratch buffers and discarded. The data types of the outputs are
+// taken from the Ir in assertNumElements, so runtime asserts must be enabled.
+class SyntheticStepIO : public IStepIO {
+public:
+  SyntheticStepIO(const std::map<TensorId, SyntheticInput> &inputs,
+                  unsigned poolSize = 16,
+                  uint64_t seed     = 0);
+
+  virtual ConstVoidData in(TensorId id, int64_t numElements, bool prefetch);
+  virtual void inComplete(TensorId id, int64_t numElements);
+  virtual MutableVoidData out(TensorId id, int64_t numElements);
+  // Record the tensor info of every anchor
+  virtual void assertNumElements(const Ir &) const;
+
+private:
+  struct InputState {
+    InputState(const SyntheticInput &generator_) : generator(generator_) {}
+
+    SyntheticInput generator;
+    std::vector<char> pool;
+    int64_t numElements = 0;
+    unsigned next       = 0;
+    std::mutex mutex;
+  };
+
+  // Get the state of an input, generating its pool on first use.
+  InputState &getInput(const TensorId &id, int64_t numElements);
+
+  unsigned poolSize;
+  uint64_t seed;
+  std::map<TensorId, std::unique_ptr<InputState>> inputs;
+
+  mutable std::mutex outputMutex;
+  mutable std::map<TensorId, TensorInfo> outputInfos;
+  std::map<TensorId, std::vector<char>> outputScratch;
+};
+
+} // namespace popart
+
+#endif
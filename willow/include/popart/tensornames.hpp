@@ -55,6 +55,10 @@ constexpr const char *reservedLossScalingPrefix() { return "lossScaling_"; }
 
 constexpr const char *reservedRandomSeedPrefix() { return "randomSeed___"; }
 
+constexpr const char *reservedGradientOverflowPrefix() {
+  return "GradientOverflow___";
+}
+
 constexpr const char *reservedIndexPrefix() { return "Index___"; }
 
 std::vector<std::string> reservedOptimizerPrefixes();
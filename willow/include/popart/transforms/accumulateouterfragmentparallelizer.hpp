@@ -109,6 +109,10 @@ protected:
   void tryToParallelizeOpClusters(Graph &graph, OpClusters &opClusters) const;
   // Helper function to add constraints for group of ops.
   void addOpConstraints(Graph &graph, const Ops &ops) const;
+  // Add constraints to stream the remote tensors of the clusters of one
+  // virtual graph, in order, through their updates.
+  void addStreamingConstraints(Graph &graph,
+                               const OpClusters &opClusters) const;
 };
 
 } // namespace popart
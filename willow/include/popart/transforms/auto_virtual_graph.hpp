@@ -27,6 +27,30 @@ public:
   std::pair<bool, OpId> best_split(float split_cost);
 };
 
+// The estimated cost of one virtual graph of an AutoVirtualGraphPlan
+struct AutoVirtualGraphStage {
+  int64_t numOps = 0;
+  // Bytes of Variable and Const inputs, doubled with gradient accumulation
+  int64_t weightBytes = 0;
+  // Bytes of activations kept for the backwards pass, multiplied by the
+  // stash depth of the pipeline stage when pipelining
+  int64_t activationBytes = 0;
+  // The largest number of bytes of forward activations live at once
+  int64_t peakLiveBytes = 0;
+  // Estimated compute, see recompute::estimateRecomputeCost
+  double computeCost = 0.0;
+  // Bytes copied in from other virtual graphs
+  int64_t copyInBytes = 0;
+};
+
+// The virtual graph of every Op, and estimated costs of each virtual graph,
+// as chosen by the AutoVirtualGraph transform
+struct AutoVirtualGraphPlan {
+  std::map<OpId, VGraphId> placement;
+  std::vector<AutoVirtualGraphStage> stages;
+  int64_t totalCopyBytes = 0;
+};
+
 class AutoVirtualGraph : public Transform {
 public:
   static std::size_t id();
@@ -42,6 +66,19 @@ public:
 
   float
   costFn(Op *op, bool training, float w_weights, float w_activations) const;
+
+  // Partition the Ops of `graph` over `numIpus` virtual graphs, without
+  // modifying it. The schedule is split into contiguous stages minimising
+  // the largest stage cost (memory and compute, each relative to the whole
+  // graph), and then the bytes copied between stages. The stage memory is its
+  // weights, its backwards pass activations (multiplied by the stash depth
+  // when pipelining) and its peak live forward activations.
+  AutoVirtualGraphPlan planBalanced(const Graph &graph, int64_t numIpus) const;
+
+  // The estimated costs of an existing assignment of Ops to virtual graphs
+  AutoVirtualGraphPlan estimate(const Graph &graph,
+                                const std::map<OpId, VGraphId> &placement,
+                                int64_t numIpus) const;
 };
 
 } // namespace popart
@@ -0,0 +1,38 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_DYNAMICLOSSSCALING_HPP
+#define GUARD_NEURALNET_DYNAMICLOSSSCALING_HPP
+
+#include <popart/transforms/transform.hpp>
+
+namespace popart {
+
+// Insert the check of the gradients of dynamic loss scaling (see
+// DynamicLossScalingSettings). The Ops of the weight update, which are
+// skipped by the device when the gradients overflow, are scheduled after a
+// GradientOverflowCheckOp of their gradients: the inputs of the weight update
+// which are produced outside of it. The gradients are checked by one Op per
+// virtual graph, whose results are combined by another, into the tensor
+// GradientOverflowCheckOp::getOverflowTensorId().
+class DynamicLossScaling : public Transform {
+public:
+  static std::size_t id();
+
+  DynamicLossScaling() : Transform() {}
+  virtual ~DynamicLossScaling() override {}
+
+  virtual bool apply(Graph &graph) const final;
+
+  virtual std::size_t getId() const final { return id(); }
+
+  virtual std::string getName() const final { return "DynamicLossScaling"; }
+
+  // Is the Op part of the weight update, which is skipped when the gradients
+  // overflow: the optimizer Ops which run once per step, except for the resets
+  // of the gradient accumulators. A CallOp is skipped if all the Ops of its
+  // subgraph are.
+  static bool isSkippedOnOverflow(const Op *op);
+};
+
+} // namespace popart
+
+#endif
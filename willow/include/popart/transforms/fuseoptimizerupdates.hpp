@@ -0,0 +1,44 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_FUSEOPTIMIZERUPDATES_HPP
+#define GUARD_NEURALNET_FUSEOPTIMIZERUPDATES_HPP
+
+#include <popart/transforms/transform.hpp>
+
+namespace popart {
+
+// Replace the per-tensor optimizer Ops of the decomposed optimizers by
+// multi-tensor Ops (see op/multitensorupdate.hpp), which update all their
+// tensors in the same compute sets:
+//
+//   SGD0VarUpdateOp -> MultiSGD0VarUpdateOp
+//   SGD1VarUpdateOp -> MultiSGD1VarUpdateOp
+//   AdamUpdaterOp   -> MultiAdamUpdaterOp
+//   AdamVarUpdateOp -> MultiAdamVarUpdateOp
+//   LambSquareOp    -> MultiLambSquareOp
+//
+// Unlike MergeVarUpdates, the tensors are not copied into a concatenated
+// layout: the multi-tensor Opxs work on concatenated views of them. Only Ops
+// with the same placement, execution context, data type and hyper parameters
+// are fused, and an Op is left alone if fusing it would create a cycle.
+//
+// With the overlapping AccumulateOuterFragmentSchedules, the updates of
+// weights whose state is streamed from remote memory in the accumulate outer
+// fragment are not fused, so that the AccumulateOuterFragmentParallelizer can
+// still schedule the load, update and store of each weight as a chunk.
+class FuseOptimizerUpdates : public Transform {
+public:
+  static std::size_t id();
+
+  FuseOptimizerUpdates() : Transform() {}
+  virtual ~FuseOptimizerUpdates() override {}
+
+  virtual bool apply(Graph &graph) const final;
+
+  virtual std::size_t getId() const final { return id(); }
+
+  virtual std::string getName() const final { return "FuseOptimizerUpdates"; }
+};
+
+} // namespace popart
+
+#endif
@@ -28,6 +28,25 @@ public:
   }
 };
 
+// A group of VarUpdateOps merged into one
+struct MergeVarUpdateGroup {
+  // The Variables updated by the group, in the order they are concatenated
+  std::vector<TensorId> tensors;
+  // The bytes of the Variables, or of the slices of them, updated
+  int64_t bytes = 0;
+  // The estimated cycles saved by merging: the VarUpdate programs removed,
+  // less the concats and slices added. Zero for a single VarUpdate.
+  double benefit = 0.0;
+};
+
+// The groups chosen by a MergeVarUpdates transform
+struct MergeVarUpdateReport {
+  // Keyed by the name of the group's partition
+  std::map<std::string, MergeVarUpdateGroup> groups;
+  // The sum of the benefits of the groups
+  double totalBenefit = 0.0;
+};
+
 class MergeVarUpdates : public Transform {
 public:
   // A unique identifier identifiying a group of VarUpdates which can be merged.
@@ -67,6 +86,16 @@ private:
 class MergeAuto : public MergeVarUpdates {
 public:
   int64_t getThresholdMemory(const Graph &) const;
+  int64_t getMemToPlayWithAtPeak(const Graph &) const;
+
+protected:
+  // For every position in opSched, an estimate of the memory which can be
+  // used to delay VarUpdates without increasing max-liveness by more than
+  // getMemToPlayWithAtPeak
+  std::vector<int64_t>
+  getMemToPlayWith(const Graph &,
+                   const std::vector<Op *> &opSched,
+                   const std::map<Op *, int> &schedIndex) const;
 };
 
 // Reshape (really just a flatten to {1, nelms}), Slice, Concat, so that there
@@ -94,7 +123,25 @@ public:
   virtual ~MergeLooseThreshold() override {}
   virtual std::size_t getId() const final { return id(); }
   virtual std::string getName() const final { return "MergeLooseThreshold"; }
-  int64_t getMemToPlayWithAtPeak(const Graph &) const;
+
+private:
+  PartitionMap getFinal(const Graph &) const final;
+};
+
+// Merge the VarUpdates of each partition into the groups, of consecutive
+// VarUpdates in the schedule, which minimise the estimated cycles of the
+// VarUpdate programs plus those of the concats and slices added by merging.
+// Delaying a VarUpdate keeps its updater live until the last VarUpdate of its
+// group, where the concatenated copies of the group are live too. Both must fit
+// in the memory of MergeAuto::getMemToPlayWith, less that already used by the
+// groups of previously planned partitions.
+class MergeCostModel : public MergeAuto {
+public:
+  static std::size_t id();
+  MergeCostModel() : MergeAuto() {}
+  virtual ~MergeCostModel() override {}
+  virtual std::size_t getId() const final { return id(); }
+  virtual std::string getName() const final { return "MergeCostModel"; }
 
 private:
   PartitionMap getFinal(const Graph &) const final;
@@ -7,6 +7,23 @@
 
 namespace popart {
 
+// The stash memory of one pipeline stage. The candidates are the activations
+// which would all be stashed without recomputation.
+struct PipelineStashStage {
+  int64_t numCandidates  = 0;
+  int64_t candidateBytes = 0;
+  int64_t numStashes     = 0;
+  int64_t stashBytes     = 0;
+};
+
+struct PipelineStashReport {
+  // Keyed by the pipeline stage of the StashOps
+  std::map<PipelineStage, PipelineStashStage> stages;
+  // The estimated cost of the Ops recomputed instead of being stashed, see
+  // recompute::estimateRecomputeCost
+  double recomputeCost = 0.0;
+};
+
 class Pipeline : public Transform {
 public:
   static std::size_t id();
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#ifndef GUARD_NEURALNET_REPLICATEDALLREDUCEBUCKETING_HPP
+#define GUARD_NEURALNET_REPLICATEDALLREDUCEBUCKETING_HPP
+
+#include <vector>
+#include <popart/names.hpp>
+#include <popart/transforms/transform.hpp>
+
+namespace popart {
+
+// Gradients reduced across replicas by a single ReplicatedAllReduceOp
+struct ReplicatedAllReduceBucket {
+  // The reduced gradients, in the order they are concatenated
+  std::vector<TensorId> tensors;
+  int64_t bytes = 0;
+  // The estimated cycles saved by the bucket, with
+  // SessionOptions::costModelSettings: the latencies of the all-reduces
+  // removed, less the copy into the flat buffer. Zero for a bucket of one
+  // gradient.
+  double benefit = 0.0;
+};
+
+// The buckets chosen by the ReplicatedAllReduceBucketing transform
+struct ReplicatedAllReduceBucketReport {
+  // In the order the gradients are produced by the backwards pass
+  std::vector<ReplicatedAllReduceBucket> buckets;
+  int64_t numAllReducesBefore = 0;
+  int64_t numAllReducesAfter  = 0;
+  // The sum of the benefits of the buckets
+  double totalBenefit = 0.0;
+};
+
+// Merge the ReplicatedAllReduceOps of the gradients, inserted when the
+// optimizers are decomposed, into buckets of at most
+// SessionOptions::replicatedAllReduceBucketSize bytes. The gradients of a
+// bucket are flattened and concatenated into one buffer, which is reduced by
+// a single ReplicatedAllReduceOp, and sliced back into the reduced gradients.
+//
+// Gradients are bucketed in the order they are produced, and each bucket is
+// reduced as soon as its last gradient is ready, so that the reduction of the
+// first buckets is interleaved with the rest of the backwards pass. Only
+// all-reduces with the same placement, execution context and data type share
+// a bucket, and an all-reduce which depends on another, through tensors or
+// topological constraints, is not bucketed with it. The
+// ReplicatedAllReduceInplaceOps of the accumulators of SGD1 and
+// Adam are bucketed too, separately, by an inplace all-reduce of the inplace
+// concatenation of the accumulators.
+class ReplicatedAllReduceBucketing : public Transform {
+public:
+  static std::size_t id();
+
+  ReplicatedAllReduceBucketing() : Transform() {}
+  virtual ~ReplicatedAllReduceBucketing() override {}
+
+  virtual bool apply(Graph &graph) const final;
+
+  virtual std::size_t getId() const final { return id(); }
+
+  virtual std::string getName() const final {
+    return "ReplicatedAllReduceBucketing";
+  }
+};
+
+} // namespace popart
+
+#endif
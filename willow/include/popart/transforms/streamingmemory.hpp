@@ -7,6 +7,68 @@
 
 namespace popart {
 
+// The estimated cost of one execution phase of an ExecutionPhasePlan
+struct ExecutionPhaseCost {
+  int64_t numOps = 0;
+  // Bytes of the Variable and Const inputs of the phase
+  int64_t weightBytes = 0;
+  // Bytes of the activations produced in the phase, and of those consumed in
+  // it but produced elsewhere
+  int64_t activationBytes = 0;
+  // Estimated compute, see recompute::estimateRecomputeCost
+  double computeCost = 0.0;
+  // Bytes of the inputs of the phase which are in remote buffers, as decided
+  // by the TensorLocationSettings
+  int64_t remoteBytes = 0;
+  // Bytes of the on-chip activations produced in an earlier phase
+  int64_t copyBytes = 0;
+};
+
+// The execution phase of every planned Op, and the estimated costs of each
+// phase, as chosen for ExecutionPhaseSettings::autoMemoryBudget
+struct ExecutionPhasePlan {
+  std::map<OpId, ExecutionPhase> phases;
+  // Indexed by execution phase
+  std::vector<ExecutionPhaseCost> costs;
+  // Estimated compute of each group of IPUs, that is of the phases with the
+  // same value of (phase % ExecutionPhaseSettings::stages)
+  std::vector<double> stageComputeCosts;
+  int64_t totalRemoteBytes = 0;
+  int64_t totalCopyBytes   = 0;
+};
+
+// Whether a weight or optimizer state tensor is sharded across replicas, as
+// chosen for SessionOptions::replicatedTensorShardingMemoryBudget
+struct ReplicatedTensorShardingDecision {
+  VGraphId vgid = unusedVGraphId;
+  bool sharded  = false;
+  // The size of the tensor, before sharding
+  int64_t bytes = 0;
+  // The memory saved on each replica, if sharded
+  int64_t savedBytes = 0;
+  // The bytes added to the collectives of each replica per step, if sharded
+  int64_t collectiveBytes = 0;
+  // The estimated cycles of these collectives
+  double collectiveCycles = 0.0;
+};
+
+struct ReplicatedTensorShardingPlan {
+  std::map<TensorId, ReplicatedTensorShardingDecision> tensors;
+  // The location of every planned tensor, in the form of
+  // SessionOptions::tensorLocationSettingsOverride
+  std::map<TensorId, TensorLocation> locations;
+  // The bytes of the weights, optimizer state and accumulators on each
+  // replica of each virtual graph, after sharding
+  std::map<VGraphId, int64_t> bytes;
+  // The part of bytes which the plan can not change: the accumulators, the
+  // tensors in SessionOptions::tensorLocationSettingsOverride and the tensors
+  // with fewer elements than replicas
+  std::map<VGraphId, int64_t> fixedBytes;
+  int64_t savedBytes      = 0;
+  int64_t collectiveBytes = 0;
+  double collectiveCycles = 0.0;
+};
+
 class StreamingMemory : public Transform {
 public:
   static std::size_t id(int);
@@ -22,6 +84,17 @@ public:
     return "StreamingMemory " + std::to_string(pass);
   }
 
+  // Assign execution phases to the Ops of `graph` without one, without
+  // modifying it. The Ops are split into contiguous phases of the schedule,
+  // each holding at most ExecutionPhaseSettings::autoMemoryBudget bytes of
+  // weights and activations. The phases minimise the estimated time of the
+  // slowest phase, the larger of its compute and of its remote buffer and
+  // inter-phase copies, and then, within ExecutionPhaseSettings::autoTimeSlack
+  // of that time, the total bytes loaded from remote buffers and copied
+  // between phases. The times are estimated with
+  // SessionOptions::costModelSettings.
+  ExecutionPhasePlan planExecutionPhases(Graph &graph) const;
+
 private:
   TensorId generateRemoteArgTensorId(TensorId tid, VGraphId vgid) const;
 
@@ -6,6 +6,7 @@
 #include <map>
 
 #include <popart/op.hpp>
+#include <popart/transforms/streamingmemory.hpp>
 #include <popart/vendored/optional.hpp>
 
 namespace popart {
@@ -50,6 +51,10 @@ public:
 
   // Determine where to place a tensor (used by StreamingMemory).
   TensorLocation determineTensorLocation(Tensor *tensor) const;
+  // Plan which weights and optimizer state to shard across replicas, for
+  // SessionOptions::replicatedTensorShardingMemoryBudget. The plan overrides
+  // the sharding chosen by determineTensorLocation (used by StreamingMemory).
+  const ReplicatedTensorShardingPlan &planReplicatedTensorSharding();
   // Sanity checking helper function (used by StreamingMemory).
   void sanitizePlacementAnnotation(Op *op, ExecutionPhase phase) const;
 
@@ -259,6 +264,16 @@ private:
                                     const TensorConfig &tensorConfig,
                                     const TensorStreamingContext &context);
 
+  // The phase in which to load an ExecutionPhaseIOSchedule::OnDemand tensor
+  // for a consuming context: up to onDemandPrefetchPhases before the
+  // consuming phase, while the prefetched bytes held on its virtual graph fit
+  // in onDemandPrefetchMemoryBudget, otherwise the consuming phase itself
+  ExecutionPhase getOnDemandLoadPhase(const TensorConfig &tensorConfig,
+                                      const TensorStreamingContext &context);
+
+  // Log how many of the bytes loaded on demand for each phase are prefetched
+  void logPrefetchOverlap() const;
+
   // Helper functions to insert a RemoteLoadOp.
   RemoteLoadOp *insertRemoteLoadOp(const TensorConfig &tensorConfig,
                                    const TensorStreamingContext context,
@@ -345,6 +360,20 @@ private:
 
   // A map of gathered tensor ID counters
   GatheredTensorMap gatheredTensorCounter;
+
+  // The replicated tensor sharding plan, empty if not planned
+  ReplicatedTensorShardingPlan rtsPlan;
+
+  // The load phase of each OnDemand tensor, by consuming phase
+  std::map<std::pair<Tensor *, ExecutionPhase>, ExecutionPhase>
+      onDemandLoadPhases;
+
+  // The prefetched bytes held on each virtual graph in each phase
+  std::map<std::pair<VGraphId, ExecutionPhase>, int64_t> prefetchedBytes;
+
+  // The bytes loaded on demand for each consuming phase, in the phase itself
+  // and prefetched in earlier phases
+  std::map<ExecutionPhase, std::pair<int64_t, int64_t>> onDemandLoadBytes;
 };
 
 } // namespace popart
@@ -430,6 +430,31 @@ float Adam::getStoredValue(const TensorId &optId) const {
               optId);
 }
 
+OptimizerScheduleDependence
+Adam::getScheduleDependence(const TensorId &optId) const {
+  OptimizerScheduleDependence dependence;
+
+  if (optId.find(reservedLossScalingPrefix()) != std::string::npos ||
+      lshelper.idMatch(optId)) {
+    // ls
+    dependence.lsPower = 1;
+  } else if (lrhelper.idMatch(optId)) {
+    // lr
+    dependence.lrPower = 1;
+  } else if (gshelper.idMatch(optId)) {
+    // 1 / (ls * af)
+    dependence.lsPower = -1;
+  } else if (!b1helper.idMatch(optId) && !b2helper.idMatch(optId) &&
+             !wdhelper.idMatch(optId) && !epshelper.idMatch(optId) &&
+             !mwnhelper.idMatch(optId)) {
+    throw error("In getScheduleDependence for {}, it doesn't match any "
+                "existing optimizer prefix",
+                optId);
+  }
+
+  return dependence;
+}
+
 bool Adam::validReplacement(const Optimizer &other) const {
   if (other.type() != type()) {
     return false;
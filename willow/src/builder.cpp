@@ -1009,7 +1009,8 @@ void Builder::setAvailableMemoryProportion(
     const TensorId &nodeOutputName,
     const float availableMemoryProportion) {
   auto nodeProto = impl_->findNodeProtoByOutputNames({nodeOutputName});
-  if (!(nodeProto.op_type() == "Conv" || nodeProto.op_type() == "MatMul")) {
+  if (!(nodeProto.op_type() == "Conv" || nodeProto.op_type() == "MatMul" ||
+        nodeProto.op_type() == "Gather")) {
     return;
   } else if (availableMemoryProportion > 1.0f ||
              availableMemoryProportion <= 0.0f) {
@@ -1,5 +1,6 @@
 // Copyright (c) 2019 Graphcore Ltd. All rights reserved.
 #include <algorithm>
+#include <functional>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/range/algorithm.hpp>
@@ -472,8 +473,17 @@ bool Graph::hasUserRecomputeOps() const {
   return false;
 }
 
-std::vector<std::set<Op *>>
-Graph::getLiveSets(const std::vector<Op *> &topoOps) const {
+namespace {
+
+// Walk topoOps in order, tracking which Ops have outputs that are still
+// needed by later Ops in topoOps (see Graph::getLiveSets). Only the number of
+// outstanding consumers is stored per Op, so the cost is linear in the size
+// of topoOps. onLive(op) and onDead(op) are called as Ops enter and leave the
+// live set, and afterOp(i) is called once topoOps[i] has run.
+void visitLiveness(const std::vector<Op *> &topoOps,
+                   const std::function<void(Op *)> &onLive,
+                   const std::function<void(Op *)> &onDead,
+                   const std::function<void(int)> &afterOp) {
 
   // the key op waits for the ops in val
   // so the key op is later in the sort.
@@ -504,9 +514,11 @@ Graph::getLiveSets(const std::vector<Op *> &topoOps) const {
     }
   }
 
-  std::set<Op *> live = {};
-  std::vector<std::set<Op *>> liveSets;
-  for (Op *newOp : topoOps) {
+  // Ops which have run and are still waited on. nWaiting of an op which has
+  // not run yet may already be decremented, so this is tracked separately.
+  std::set<Op *, POpCmp> live;
+  for (int i = 0; i < topoOps.size(); ++i) {
+    Op *newOp = topoOps[i];
     for (Op *isEarlier : waiting[newOp]) {
       if (live.count(isEarlier) == 0) {
         throw internal_error(
@@ -516,14 +528,59 @@ Graph::getLiveSets(const std::vector<Op *> &topoOps) const {
       --nWaiting[isEarlier];
       if (nWaiting[isEarlier] == 0) {
         live.erase(isEarlier);
+        onDead(isEarlier);
       }
     }
     live.insert(newOp);
-    liveSets.push_back(live);
+    onLive(newOp);
+    afterOp(i);
   }
+}
+
+} // namespace
+
+std::vector<std::set<Op *>>
+Graph::getLiveSets(const std::vector<Op *> &topoOps) const {
+  std::set<Op *> live;
+  std::vector<std::set<Op *>> liveSets;
+  visitLiveness(
+      topoOps,
+      [&live](Op *op) { live.insert(op); },
+      [&live](Op *op) { live.erase(op); },
+      [&live, &liveSets](int) { liveSets.push_back(live); });
   return liveSets;
 }
 
+std::map<int, std::set<Op *>>
+Graph::getLiveSets(const std::vector<Op *> &topoOps,
+                   const std::set<int> &positions) const {
+  std::set<Op *> live;
+  std::map<int, std::set<Op *>> liveSets;
+  visitLiveness(
+      topoOps,
+      [&live](Op *op) { live.insert(op); },
+      [&live](Op *op) { live.erase(op); },
+      [&](int i) {
+        if (positions.count(i) != 0) {
+          liveSets.emplace(i, live);
+        }
+      });
+  return liveSets;
+}
+
+std::vector<int64_t>
+Graph::getLiveMemory(const std::vector<Op *> &topoOps) const {
+  int64_t mem = 0;
+  std::vector<int64_t> liveMemory;
+  liveMemory.reserve(topoOps.size());
+  visitLiveness(
+      topoOps,
+      [&mem](Op *op) { mem += op->memOfOutputs(); },
+      [&mem](Op *op) { mem -= op->memOfOutputs(); },
+      [&mem, &liveMemory](int) { liveMemory.push_back(mem); });
+  return liveMemory;
+}
+
 int64_t Graph::getVirtualGraphId(const Op &op) {
   if (op.hasVirtualGraphId()) {
     return op.getVirtualGraphId();
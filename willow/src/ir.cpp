@@ -45,8 +45,10 @@
 #include <popart/transforms/auto_virtual_graph.hpp>
 #include <popart/transforms/batchserialize.hpp>
 #include <popart/transforms/decomposegradsum.hpp>
+#include <popart/transforms/dynamiclossscaling.hpp>
 #include <popart/transforms/dynamicoptransform.hpp>
 #include <popart/transforms/explicitrecompute.hpp>
+#include <popart/transforms/fuseoptimizerupdates.hpp>
 #include <popart/transforms/groupmatmuls.hpp>
 #include <popart/transforms/hostreduce.hpp>
 #include <popart/transforms/inferpipelinestages.hpp>
@@ -59,6 +61,7 @@
 #include <popart/transforms/pipeline.hpp>
 #include <popart/transforms/prune.hpp>
 #include <popart/transforms/remotesetup.hpp>
+#include <popart/transforms/replicatedallreducebucketing.hpp>
 #include <popart/transforms/serializematmuls.hpp>
 #include <popart/transforms/streamingmemory.hpp>
 #include <popart/transforms/subgraphoutline.hpp>
@@ -127,7 +130,7 @@ std::vector<Tensor *> Ir::optimizerTensors() const {
   return optimizerTensors;
 }
 
-void Ir::updateOptimizer(const Optimizer &newOptimizer) {
+std::vector<TensorId> Ir::updateOptimizer(const Optimizer &newOptimizer) {
   // TODO this will be cleaner when T12589 is done
   auto newOptimizerClone = newOptimizer.clone();
   newOptimizerClone->setFactorsFromOptions(getSessionOptions());
@@ -137,9 +140,22 @@ void Ir::updateOptimizer(const Optimizer &newOptimizer) {
                 optimizer->type_s());
   }
   optimizer = std::move(newOptimizerClone);
+
+  std::vector<TensorId> changed;
+  std::vector<char> oldData;
   for (auto opt : optimizerTensors()) {
+    auto nbytes = static_cast<size_t>(opt->info.nbytes());
+    auto data   = static_cast<const char *>(opt->tensorData()->data());
+    oldData.assign(data, data + nbytes);
     optimizer->resetTensorData(*opt);
+    if (!std::equal(oldData.begin(), oldData.end(), data)) {
+      changed.push_back(opt->id);
+    }
   }
+  logging::ir::debug("Updated optimizer: {} of {} optimizer tensors changed",
+                     changed.size(),
+                     optimizerTensors().size());
+  return changed;
 }
 
 void Ir::dotCheckpoint(DotCheck check) const {
@@ -839,7 +855,9 @@ void Ir::prepareImpl(const IrBundle &gb) {
   }
 
   enableTransform(AutoVirtualGraph::id(),
-                  userOptions.virtualGraphMode == VirtualGraphMode::Auto);
+                  userOptions.virtualGraphMode == VirtualGraphMode::Auto ||
+                      userOptions.virtualGraphMode ==
+                          VirtualGraphMode::Balanced);
   applyTransform(AutoVirtualGraph::id(), getMainGraph());
 
   // Required transform order for StreamingMemory is:
@@ -959,6 +977,12 @@ void Ir::prepareImpl(const IrBundle &gb) {
     updateVertices();
     break;
   }
+  case (MergeVarUpdateType::AutoCost): {
+    enableTransform(MergeCostModel::id(), true);
+    applyTransform(MergeCostModel::id(), getMainGraph());
+    updateVertices();
+    break;
+  }
 
   case (MergeVarUpdateType::None): {
     // do nothing
@@ -1007,6 +1031,13 @@ void Ir::prepareImpl(const IrBundle &gb) {
   applyPreAliasPattern(&adamDecomposer, getMainGraph());
   decomposedOptimizers = true;
 
+  // Merge the gradient all-reduces into buckets
+  if (canTrain() && getSessionOptions().enableReplicatedGraphs &&
+      getSessionOptions().replicatedAllReduceBucketSize > 0 &&
+      !getSessionOptions().hostAllReduce) {
+    applyTransform(ReplicatedAllReduceBucketing::id(), getMainGraph());
+  }
+
   if (getSessionOptions().hostWeightUpdate &&
       !getSessionOptions().hostAllReduce) {
     throw error(
@@ -1032,6 +1063,12 @@ void Ir::prepareImpl(const IrBundle &gb) {
     }
   }
 
+  // Check the gradients for overflows before the weight updates, which are
+  // skipped when they overflow
+  if (canTrain() && getSessionOptions().dynamicLossScalingSettings.enabled) {
+    applyTransform(DynamicLossScaling::id(), getMainGraph());
+  }
+
   // Add internal ops to copy tensors between ipu's as needed
   applyTransform(InterIpuCopy::id(), getMainGraph());
 
@@ -1049,6 +1086,13 @@ void Ir::prepareImpl(const IrBundle &gb) {
   // Remove extra RemoteLoad, RemoteStore and Replicated ops that are not used
   applyTransform(Prune::id(), getMainGraph());
 
+  // Fuse the optimizer updates of the weights into multi-tensor Ops, now that
+  // the weights are placed and the optimizers decomposed
+  if (canTrain() && getSessionOptions().fuseOptimizerUpdates) {
+    applyTransform(FuseOptimizerUpdates::id(), getMainGraph());
+    updateVertices();
+  }
+
   if (userOptions.virtualGraphMode == VirtualGraphMode::ExecutionPhases &&
       userOptions.executionPhaseSettings.phases > 1) {
     verifyVirtualGraphIds(true);
@@ -1063,7 +1107,9 @@ void Ir::prepareImpl(const IrBundle &gb) {
   if (userOptions.accumulateOuterFragmentSettings.schedule ==
           AccumulateOuterFragmentSchedule::OverlapCycleOptimized ||
       userOptions.accumulateOuterFragmentSettings.schedule ==
-          AccumulateOuterFragmentSchedule::OverlapMemoryOptimized) {
+          AccumulateOuterFragmentSchedule::OverlapMemoryOptimized ||
+      userOptions.accumulateOuterFragmentSettings.schedule ==
+          AccumulateOuterFragmentSchedule::OverlapStreamedUpdates) {
     applyTransform(AccumulateOuterFragmentParallelizer::id(), getMainGraph());
   }
 
@@ -2818,6 +2864,34 @@ unsigned Ir::getMaxVirtualGraphId() const {
   return maxVirtualGraphId;
 }
 
+void Ir::setAutoVirtualGraphPlan(const AutoVirtualGraphPlan &plan) {
+  autoVirtualGraphPlan = std::make_unique<AutoVirtualGraphPlan>(plan);
+}
+
+void Ir::setPipelineStashReport(const PipelineStashReport &report) {
+  pipelineStashReport = std::make_unique<PipelineStashReport>(report);
+}
+
+void Ir::setMergeVarUpdateReport(const MergeVarUpdateReport &report) {
+  mergeVarUpdateReport = std::make_unique<MergeVarUpdateReport>(report);
+}
+
+void Ir::setExecutionPhasePlan(const ExecutionPhasePlan &plan) {
+  executionPhasePlan = std::make_unique<ExecutionPhasePlan>(plan);
+}
+
+void Ir::setReplicatedTensorShardingPlan(
+    const ReplicatedTensorShardingPlan &plan) {
+  replicatedTensorShardingPlan =
+      std::make_unique<ReplicatedTensorShardingPlan>(plan);
+}
+
+void Ir::setReplicatedAllReduceBucketReport(
+    const ReplicatedAllReduceBucketReport &report) {
+  replicatedAllReduceBucketReport =
+      std::make_unique<ReplicatedAllReduceBucketReport>(report);
+}
+
 Op *Ir::growLossGradients() {
 
   float lossScale            = 1.0f;
@@ -0,0 +1,430 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <onnx/onnx_pb.h>
+#include <popart/error.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/liveness.hpp>
+#include <popart/logging.hpp>
+#include <popart/memoryestimate.hpp>
+#include <popart/op/remote.hpp>
+#include <popart/op/stash.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensors.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace popart {
+
+namespace {
+
+// Ordered by priority: an alias group containing tensors of different
+// categories takes the highest.
+enum class MemoryCategory {
+  Activation = 0,
+  RemoteStaging,
+  Stash,
+  OptimizerState,
+  Weight
+};
+
+bool isRemoteOp(const Op *op) {
+  return op->isConvertibleTo<RemoteLoadOp>() ||
+         op->isConvertibleTo<RemoteStoreOp>() ||
+         op->isConvertibleTo<RemoteExchangeOp>();
+}
+
+MemoryCategory getCategory(const Tensor *t,
+                           const std::set<TensorId> &initialisers) {
+  if (t->tensorType() == TensorType::Const) {
+    return MemoryCategory::Weight;
+  }
+  if (t->tensorType() == TensorType::Variable) {
+    return initialisers.find(t->id) != initialisers.end()
+               ? MemoryCategory::Weight
+               : MemoryCategory::OptimizerState;
+  }
+  if (t->isOptimizerTensor()) {
+    return MemoryCategory::OptimizerState;
+  }
+  if (t->hasProducer() && t->getProducer()->isConvertibleTo<StashOp>()) {
+    return MemoryCategory::Stash;
+  }
+  if (t->hasProducer() && isRemoteOp(t->getProducer())) {
+    return MemoryCategory::RemoteStaging;
+  }
+  for (auto consumer : t->consumers.getOps()) {
+    if (isRemoteOp(consumer)) {
+      return MemoryCategory::RemoteStaging;
+    }
+  }
+  return MemoryCategory::Activation;
+}
+
+// Tensors which alias each other, and share the same memory
+struct AliasGroup {
+  MemoryCategory category = MemoryCategory::Activation;
+  VGraphId vGraphId       = unusedVGraphId;
+  int64_t bytes           = 0;
+  // Right-closed intervals of the global schedule
+  std::vector<std::pair<int64_t, int64_t>> intervals;
+};
+
+class AliasGroups {
+public:
+  int64_t find(Tensor *t) {
+    auto it = index.find(t);
+    if (it == index.end()) {
+      index[t] = parents.size();
+      parents.push_back(parents.size());
+      return parents.size() - 1;
+    }
+    auto i = it->second;
+    while (parents[i] != i) {
+      parents[i] = parents[parents[i]];
+      i          = parents[i];
+    }
+    return i;
+  }
+
+  void merge(Tensor *a, Tensor *b) {
+    auto ra = find(a);
+    auto rb = find(b);
+    if (ra != rb) {
+      parents[std::max(ra, rb)] = std::min(ra, rb);
+    }
+  }
+
+private:
+  std::unordered_map<Tensor *, int64_t> index;
+  std::vector<int64_t> parents;
+};
+
+// The greatest common divisor of the batch axes of the streamed inputs
+int64_t getBatchSize(const Ir &ir) {
+  int64_t batchSize = 0;
+  for (auto tensor : ir.getMainGraph().getTensors().getOfType(
+           TensorType::Stream)) {
+    auto axis = tensor->getBatchAxis();
+    if (axis < 0 || axis >= tensor->info.rank()) {
+      continue;
+    }
+    int64_t a = tensor->info.dim(axis);
+    int64_t b = batchSize;
+    while (b != 0) {
+      auto r = a % b;
+      a      = b;
+      b      = r;
+    }
+    batchSize = a;
+  }
+  return batchSize;
+}
+
+int64_t getPeak(const std::vector<int64_t> &deltas) {
+  int64_t live = 0;
+  int64_t peak = 0;
+  for (auto delta : deltas) {
+    live += delta;
+    peak = std::max(peak, live);
+  }
+  return peak;
+}
+
+} // namespace
+
+int64_t MemoryEstimate::getMaxBytes() const {
+  int64_t maxBytes = 0;
+  for (auto &vgid_estimate : virtualGraphs) {
+    maxBytes = std::max(maxBytes, vgid_estimate.second.totalBytes());
+  }
+  return maxBytes;
+}
+
+MemoryEstimate estimateMemory(const Ir &ir) {
+  liveness::LivenessAnalyzer analyzer(&ir);
+  analyzer.apply();
+
+  std::set<TensorId> initialisers;
+  for (auto &initialiser : ir.getModel().graph().initializer()) {
+    initialisers.insert(initialiser.name());
+  }
+
+  // Group the tensors of all graphs by their aliases after inplacing
+  std::vector<Tensor *> tensors;
+  AliasGroups aliasGroups;
+  for (auto graph : ir.getAllGraphs()) {
+    auto &graphTensors = graph->getTensors();
+    for (auto &tid : graphTensors.getAllTensorIds()) {
+      auto tensor = graphTensors.get(tid);
+      if (!tensor->info.isSet()) {
+        continue;
+      }
+      tensors.push_back(tensor);
+      for (auto &alias : graphTensors.getAliases().aliasChainsFrom(tensor)) {
+        if (alias.first != tensor) {
+          aliasGroups.merge(tensor, alias.first);
+        }
+      }
+    }
+  }
+
+  std::map<int64_t, AliasGroup> groups;
+  for (auto tensor : tensors) {
+    auto &group    = groups[aliasGroups.find(tensor)];
+    group.category =
+        std::max(group.category, getCategory(tensor, initialisers));
+    group.bytes = std::max(group.bytes, tensor->info.nbytes());
+    if (group.vGraphId == unusedVGraphId) {
+      group.vGraphId = tensor->getVirtualGraphIdUnsafe();
+    }
+  }
+
+  // Live intervals of every tensor, over all call sites of its graph. A tensor
+  // becomes live when it is produced (or first consumed, if it has no
+  // producer), and stays live until its last consumer.
+  std::unordered_map<Tensor *, std::vector<std::pair<int64_t, int64_t>>>
+      tensorIntervals;
+  auto produce = [&tensorIntervals](Tensor *t, int64_t position) {
+    tensorIntervals[t].push_back({position, position});
+  };
+  auto consume = [&tensorIntervals](Tensor *t, int64_t position) {
+    auto &intervals = tensorIntervals[t];
+    if (intervals.empty()) {
+      intervals.push_back({position, position});
+    } else {
+      intervals.back().second = position;
+    }
+  };
+
+  const int64_t scheduleSize = analyzer.getOpScheduleSize();
+  for (int64_t i = 0; i < scheduleSize; ++i) {
+    auto &node = analyzer.getOpScheduleAt(i);
+    auto op    = node.getOp();
+    switch (node.getStatus()) {
+    case liveness::OpStatus::Normal:
+    case liveness::OpStatus::Enter: {
+      for (auto t : op->input->tensors()) {
+        consume(t, i);
+      }
+      if (node.getStatus() == liveness::OpStatus::Normal) {
+        for (auto t : op->output->tensors()) {
+          produce(t, i);
+        }
+      }
+      break;
+    }
+    case liveness::OpStatus::CopyInput:
+    case liveness::OpStatus::CopyOutput:
+    case liveness::OpStatus::CopyModified: {
+      auto ids      = node.getTensorIds();
+      auto subgraph = op->getCalledGraphs().front();
+      auto outer    = op->getGraph().getTensors().get(ids.first);
+      auto inner    = subgraph->getTensors().get(ids.second);
+      auto status   = node.getStatus();
+      if (status == liveness::OpStatus::CopyInput) {
+        consume(outer, i);
+        produce(inner, i);
+      } else if (status == liveness::OpStatus::CopyOutput) {
+        consume(inner, i);
+        produce(outer, i);
+      } else {
+        // The modified tensor stays live through the call
+        consume(inner, i);
+        consume(outer, i);
+      }
+      break;
+    }
+    case liveness::OpStatus::Exit:
+    default:
+      break;
+    }
+  }
+
+  for (auto &tensor_intervals : tensorIntervals) {
+    auto tensor = tensor_intervals.first;
+    if (!tensor->info.isSet()) {
+      continue;
+    }
+    auto &group = groups.at(aliasGroups.find(tensor));
+    group.intervals.insert(group.intervals.end(),
+                           tensor_intervals.second.begin(),
+                           tensor_intervals.second.end());
+  }
+
+  // Sum the persistent tensors, and the live bytes of the others at every
+  // position of the global schedule
+  MemoryEstimate estimate;
+  std::map<VGraphId, std::vector<int64_t>> activationDeltas;
+  std::map<VGraphId, std::vector<int64_t>> stagingDeltas;
+  std::map<VGraphId, std::vector<int64_t>> liveDeltas;
+
+  for (auto &index_group : groups) {
+    auto &group = index_group.second;
+    auto &vg    = estimate.virtualGraphs[group.vGraphId];
+    switch (group.category) {
+    case MemoryCategory::Weight:
+      vg.weightBytes += group.bytes;
+      continue;
+    case MemoryCategory::OptimizerState:
+      vg.optimizerStateBytes += group.bytes;
+      continue;
+    case MemoryCategory::Stash:
+      vg.stashBytes += group.bytes;
+      continue;
+    case MemoryCategory::Activation:
+    case MemoryCategory::RemoteStaging:
+      break;
+    }
+
+    auto &deltas = group.category == MemoryCategory::Activation
+                       ? activationDeltas[group.vGraphId]
+                       : stagingDeltas[group.vGraphId];
+    auto &live   = liveDeltas[group.vGraphId];
+    deltas.resize(scheduleSize + 1, 0);
+    live.resize(scheduleSize + 1, 0);
+
+    // Merge overlapping intervals of the aliased tensors
+    auto &intervals = group.intervals;
+    std::sort(intervals.begin(), intervals.end());
+    int64_t start = -1;
+    int64_t end   = -1;
+    auto addInterval = [&]() {
+      if (start >= 0) {
+        deltas[start] += group.bytes;
+        deltas[end + 1] -= group.bytes;
+        live[start] += group.bytes;
+        live[end + 1] -= group.bytes;
+      }
+    };
+    for (auto &interval : intervals) {
+      if (start >= 0 && interval.first <= end + 1) {
+        end = std::max(end, interval.second);
+      } else {
+        addInterval();
+        start = interval.first;
+        end   = interval.second;
+      }
+    }
+    addInterval();
+  }
+
+  for (auto &vgid_deltas : activationDeltas) {
+    estimate.virtualGraphs[vgid_deltas.first].peakActivationBytes =
+        getPeak(vgid_deltas.second);
+  }
+  for (auto &vgid_deltas : stagingDeltas) {
+    estimate.virtualGraphs[vgid_deltas.first].remoteBufferStagingBytes =
+        getPeak(vgid_deltas.second);
+  }
+  for (auto &vgid_deltas : liveDeltas) {
+    estimate.virtualGraphs[vgid_deltas.first].peakLiveBytes =
+        getPeak(vgid_deltas.second);
+  }
+
+  for (auto &vgid_estimate : estimate.virtualGraphs) {
+    auto &vg = vgid_estimate.second;
+    logging::ir::debug("Estimated memory of virtual graph {}: {} bytes "
+                       "(weights {}, optimizer state {}, stashes {}, peak "
+                       "activations {}, remote buffer staging {})",
+                       vgid_estimate.first,
+                       vg.totalBytes(),
+                       vg.weightBytes,
+                       vg.optimizerStateBytes,
+                       vg.stashBytes,
+                       vg.peakActivationBytes,
+                       vg.remoteBufferStagingBytes);
+  }
+
+  return estimate;
+}
+
+BatchSerializationFactorChoice
+chooseBatchSerializationFactor(const IrBundle &bundle,
+                               std::unique_ptr<Ir> &chosenIr) {
+  auto &settings = bundle.userOptions.batchSerializationSettings;
+  auto budget    = settings.autoMemoryBudget;
+
+  auto prepare = [&bundle](int factor, Ir &ir) {
+    SessionOptions options                    = bundle.userOptions;
+    options.batchSerializationSettings.factor = factor;
+    ir.prepare({bundle.modelProto,
+                bundle.inputShapeInfo,
+                bundle.dataFlow,
+                bundle.loss,
+                bundle.optimizer,
+                bundle.deviceInfo,
+                options,
+                bundle.patterns});
+  };
+
+  // Without batch serialisation. Errors are not specific to the factor, so
+  // are not caught.
+  auto unserializedIr = std::make_unique<Ir>();
+  prepare(1, *unserializedIr);
+  int64_t batchSize    = getBatchSize(*unserializedIr);
+  int64_t unserialized = estimateMemory(*unserializedIr).getMaxBytes();
+
+  BatchSerializationFactorChoice choice;
+  for (int factor = 1; factor <= std::max(1, settings.maxAutoFactor);
+       ++factor) {
+    if (factor > 1 && (batchSize == 0 || batchSize % factor != 0)) {
+      continue;
+    }
+
+    BatchSerializationFactorCandidate candidate{factor, -1, ""};
+    std::unique_ptr<Ir> ir;
+    if (factor == 1) {
+      ir                 = std::move(unserializedIr);
+      candidate.maxBytes = unserialized;
+    } else {
+      try {
+        ir = std::make_unique<Ir>();
+        prepare(factor, *ir);
+        candidate.maxBytes = estimateMemory(*ir).getMaxBytes();
+      } catch (const error &e) {
+        candidate.rejection = e.what();
+      }
+    }
+
+    if (candidate.maxBytes >= 0 && candidate.maxBytes > budget) {
+      candidate.rejection = logging::format("estimated {} bytes on an IPU, "
+                                            "over the budget of {} bytes",
+                                            candidate.maxBytes,
+                                            budget);
+    }
+
+    if (candidate.rejection.empty()) {
+      logging::ir::info("Batch serialisation factor {} chosen, estimated {} "
+                        "bytes on an IPU",
+                        factor,
+                        candidate.maxBytes);
+      choice.factor = factor;
+      choice.candidates.push_back(candidate);
+      chosenIr = std::move(ir);
+      return choice;
+    }
+
+    logging::ir::info("Batch serialisation factor {} rejected: {}",
+                      factor,
+                      candidate.rejection);
+    choice.candidates.push_back(candidate);
+  }
+
+  std::stringstream ss;
+  for (auto &candidate : choice.candidates) {
+    ss << logging::format(
+        "\n  factor {}: {}", candidate.factor, candidate.rejection);
+  }
+  throw error("No batch serialisation factor up to {} fits the memory budget "
+              "of {} bytes per IPU. The batch size is {}. Candidates:{}",
+              settings.maxAutoFactor,
+              budget,
+              batchSize,
+              ss.str());
+}
+
+} // namespace popart
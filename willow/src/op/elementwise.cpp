@@ -8,9 +8,22 @@ using namespace popart;
 
 view::RegMap binaryFwdRegMapImpl(const ElementWiseBinaryBaseOp &op,
                                  InIndex argIndex) {
-  auto out_shape = op.outShape(op.getOutIndex());
-  auto in_shape  = op.inShape(argIndex);
+  return broadcastFwdRegMap(op.inShape(argIndex),
+                            op.outShape(op.getOutIndex()));
+}
+
+view::RegMap binaryBwdRegMapImpl(const ElementWiseBinaryBaseOp &op,
+                                 InIndex argIndex) {
+  return broadcastBwdRegMap(op.inShape(argIndex),
+                            op.outShape(op.getOutIndex()));
+}
+
+} // namespace
 
+namespace popart {
+
+view::RegMap broadcastFwdRegMap(const Shape &in_shape,
+                                const Shape &out_shape) {
   return [out_shape, in_shape](const view::Region &r) {
     auto out_size  = out_shape.size();
     auto arg_shape = padShape(in_shape, out_size, int64_t{1});
@@ -28,11 +41,10 @@ view::RegMap binaryFwdRegMapImpl(const ElementWiseBinaryBaseOp &op,
   };
 }
 
-view::RegMap binaryBwdRegMapImpl(const ElementWiseBinaryBaseOp &op,
-                                 InIndex argIndex) {
-  auto arg_shape = op.inShape(argIndex);
+view::RegMap broadcastBwdRegMap(const Shape &arg_shape,
+                                const Shape &full_out_shape) {
   auto arg_size  = arg_shape.size();
-  auto out_shape = unpadShape(op.outShape(op.getOutIndex()), arg_size);
+  auto out_shape = unpadShape(full_out_shape, arg_size);
 
   return [arg_size, out_shape, arg_shape](const view::Region &r) {
     auto lower = unpadShape(r.getLower(), arg_size);
@@ -50,10 +62,6 @@ view::RegMap binaryBwdRegMapImpl(const ElementWiseBinaryBaseOp &op,
   };
 }
 
-} // namespace
-
-namespace popart {
-
 ElementWiseUnaryOp::ElementWiseUnaryOp(const OperatorIdentifier &_opid,
                                        const Op::Settings &settings_)
     : Op(_opid, settings_) {}
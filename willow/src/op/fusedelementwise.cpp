@@ -0,0 +1,216 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <popart/error.hpp>
+#include <popart/op/elementwise.hpp>
+#include <popart/op/fusedelementwise.hpp>
+#include <popart/op/scale.hpp>
+#include <popart/opserialiser.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+#include <popart/tensorinfo.hpp>
+
+namespace popart {
+
+std::ostream &operator<<(std::ostream &os, FusedElementwiseStep::Type type) {
+  using Type = FusedElementwiseStep::Type;
+  switch (type) {
+  case Type::Add:
+    return os << "Add";
+  case Type::Sub:
+    return os << "Sub";
+  case Type::Mul:
+    return os << "Mul";
+  case Type::Div:
+    return os << "Div";
+  case Type::Neg:
+    return os << "Neg";
+  case Type::Exp:
+    return os << "Exp";
+  case Type::Log:
+    return os << "Log";
+  case Type::Sqrt:
+    return os << "Sqrt";
+  case Type::Abs:
+    return os << "Abs";
+  case Type::Sigmoid:
+    return os << "Sigmoid";
+  case Type::Tanh:
+    return os << "Tanh";
+  case Type::Sin:
+    return os << "Sin";
+  case Type::Cos:
+    return os << "Cos";
+  case Type::Reciprocal:
+    return os << "Reciprocal";
+  case Type::Relu:
+    return os << "Relu";
+  case Type::Square:
+    return os << "Square";
+  case Type::Scale:
+    return os << "Scale";
+  case Type::Gelu:
+    return os << "Gelu";
+  case Type::SigmoidGrad:
+    return os << "SigmoidGrad";
+  case Type::TanhGrad:
+    return os << "TanhGrad";
+  case Type::ReluGrad:
+    return os << "ReluGrad";
+  }
+  throw error("Unknown FusedElementwiseStep::Type {}", static_cast<int>(type));
+}
+
+FusedElementwiseOp::FusedElementwiseOp(
+    const OperatorIdentifier &_opid,
+    const std::vector<FusedElementwiseStep> &steps_,
+    const Op::Settings &settings_)
+    : Op(_opid, settings_), steps(steps_) {}
+
+std::unique_ptr<Op> FusedElementwiseOp::clone() const {
+  return std::make_unique<FusedElementwiseOp>(*this);
+}
+
+void FusedElementwiseOp::setup() {
+  if (steps.empty()) {
+    throw error("FusedElementwiseOp {} has no steps", debugName());
+  }
+
+  auto info = inInfo(0);
+  for (int i = 1; i < input->n(); ++i) {
+    info = npOut(info, inInfo(i));
+  }
+  outInfo(getOutIndex()) = info;
+}
+
+nonstd::optional<FusedElementwiseStep>
+FusedElementwiseOp::getStep(const Op *op) {
+  using Type = FusedElementwiseStep::Type;
+
+  // The Ops which can be fused, and their number of inputs
+  static const std::map<std::pair<std::string, std::string>,
+                        std::pair<Type, int>>
+      fusable = {
+          {{Domain::ai_onnx, "Add"}, {Type::Add, 2}},
+          {{Domain::ai_onnx, "Sub"}, {Type::Sub, 2}},
+          {{Domain::ai_onnx, "Mul"}, {Type::Mul, 2}},
+          {{Domain::ai_onnx, "Div"}, {Type::Div, 2}},
+          {{Domain::ai_onnx, "Neg"}, {Type::Neg, 1}},
+          {{Domain::ai_onnx, "Exp"}, {Type::Exp, 1}},
+          {{Domain::ai_onnx, "Log"}, {Type::Log, 1}},
+          {{Domain::ai_onnx, "Sqrt"}, {Type::Sqrt, 1}},
+          {{Domain::ai_onnx, "Abs"}, {Type::Abs, 1}},
+          {{Domain::ai_onnx, "Sigmoid"}, {Type::Sigmoid, 1}},
+          {{Domain::ai_onnx, "Tanh"}, {Type::Tanh, 1}},
+          {{Domain::ai_onnx, "Sin"}, {Type::Sin, 1}},
+          {{Domain::ai_onnx, "Cos"}, {Type::Cos, 1}},
+          {{Domain::ai_onnx, "Reciprocal"}, {Type::Reciprocal, 1}},
+          {{Domain::ai_onnx, "Relu"}, {Type::Relu, 1}},
+          {{Domain::ai_graphcore, "Square"}, {Type::Square, 1}},
+          {{Domain::ai_graphcore, "Scale"}, {Type::Scale, 1}},
+          {{Domain::ai_graphcore, "ScaleGrad"}, {Type::Scale, 1}},
+          {{Domain::ai_graphcore, "Gelu"}, {Type::Gelu, 1}},
+          {{Domain::ai_graphcore, "SigmoidGrad"}, {Type::SigmoidGrad, 2}},
+          {{Domain::ai_graphcore, "TanhGrad"}, {Type::TanhGrad, 2}},
+          {{Domain::ai_graphcore, "ReluGrad"}, {Type::ReluGrad, 2}}};
+
+  auto found = fusable.find({op->opid.domain, op->opid.type});
+  if (found == fusable.end()) {
+    return nonstd::nullopt;
+  }
+
+  const int numInputs = found->second.second;
+  if (op->input->n() != numInputs || op->output->n() != 1 ||
+      !op->output->hasIndex(0)) {
+    return nonstd::nullopt;
+  }
+  for (int i = 0; i < numInputs; ++i) {
+    if (!op->input->hasIndex(i)) {
+      return nonstd::nullopt;
+    }
+  }
+
+  FusedElementwiseStep step;
+  step.type = found->second.first;
+  if (step.type == Type::Scale) {
+    auto scaleOp = dynamic_cast<const ScaleOp *>(op);
+    if (!scaleOp) {
+      return nonstd::nullopt;
+    }
+    step.scaleFactor = scaleOp->getScaleFactor();
+  }
+  return step;
+}
+
+std::vector<std::tuple<OperatorIdentifier, float>>
+FusedElementwiseOp::inplacePriorityDefault() const {
+  if (inShape(0) == outShape(getOutIndex())) {
+    return {{Onnx::CustomOperators::FusedElementwiseInplace, 10.0f}};
+  }
+  return {};
+}
+
+std::unique_ptr<Op> FusedElementwiseOp::getInplaceVariant(
+    const OperatorIdentifier &operator_id) const {
+  if (operator_id == Onnx::CustomOperators::FusedElementwiseInplace) {
+    return std::make_unique<FusedElementwiseInplaceOp>(*this);
+  }
+  // catch remaining cases and throw an error
+  return Op::getInplaceVariant(operator_id);
+}
+
+view::RegMap FusedElementwiseOp::fwdRegMap(InIndex inIndex,
+                                           OutIndex outIndex) const {
+  return broadcastFwdRegMap(inShape(inIndex), outShape(outIndex));
+}
+
+view::RegMap FusedElementwiseOp::bwdRegMap(InIndex inIndex,
+                                           OutIndex outIndex) const {
+  return broadcastBwdRegMap(inShape(inIndex), outShape(outIndex));
+}
+
+void FusedElementwiseOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+  Op::appendOutlineAttributes(os);
+
+  // For example "Scale(0)[0.5];Add(-1,1)"
+  std::ostringstream ss;
+  for (int i = 0; i < steps.size(); ++i) {
+    auto &step = steps.at(i);
+    ss << (i > 0 ? ";" : "") << step.type << "(";
+    for (int j = 0; j < step.operands.size(); ++j) {
+      ss << (j > 0 ? "," : "") << step.operands.at(j);
+    }
+    ss << ")";
+    if (step.type == FusedElementwiseStep::Type::Scale) {
+      ss << "[" << step.scaleFactor << "]";
+    }
+  }
+  os.appendAttribute("steps", ss.str());
+}
+
+FusedElementwiseInplaceOp::FusedElementwiseInplaceOp(
+    const FusedElementwiseOp &op)
+    : FusedElementwiseOp(Onnx::CustomOperators::FusedElementwiseInplace,
+                         op.getSteps(),
+                         op.getSettings()) {}
+
+std::unique_ptr<Op> FusedElementwiseInplaceOp::clone() const {
+  return std::make_unique<FusedElementwiseInplaceOp>(*this);
+}
+
+view::Regions FusedElementwiseInplaceOp::modifies(InIndex index) const {
+  if (index == 0) {
+    return {view::Region::getFull(inShape(index))};
+  } else {
+    return {view::Region::getEmpty(inRank(index))};
+  }
+}
+
+view::Regions FusedElementwiseInplaceOp::aliases(InIndex index,
+                                                 OutIndex) const {
+  return modifies(index);
+}
+
+} // namespace popart
@@ -13,8 +13,10 @@ namespace popart {
 
 GatherOp::GatherOp(const OperatorIdentifier &_opid,
                    int64_t axis_,
-                   const Op::Settings &settings_)
-    : Op(_opid, settings_), axis(axis_) {}
+                   const Op::Settings &settings_,
+                   const nonstd::optional<float> &availableMemoryProportion_)
+    : Op(_opid, settings_), axis(axis_),
+      availableMemoryProportion(availableMemoryProportion_) {}
 
 std::unique_ptr<Op> GatherOp::clone() const {
   return std::make_unique<GatherOp>(*this);
@@ -60,6 +62,7 @@ void GatherOp::setup() {
 void GatherOp::appendOutlineAttributes(OpSerialiserBase &os) const {
   Op::appendOutlineAttributes(os);
   os.appendAttribute("axis", axis);
+  os.appendAttribute("available_memory_proportion", availableMemoryProportion);
 }
 
 // A gather on a degenerate dimension with a rank 1 index tensor with a single
@@ -72,7 +75,8 @@ bool GatherOp::canBeReplacedByIdentity() {
 
 GatherGradOp::GatherGradOp(const GatherOp &op, int64_t axis_)
     : Op(Onnx::GradOperators::GatherGrad, op.getSettings()), axis(axis_),
-      fwdDataInfo(op.inInfo(GatherOp::dataInIndex())) {}
+      fwdDataInfo(op.inInfo(GatherOp::dataInIndex())),
+      availableMemoryProportion(op.getAvailableMemoryProportion()) {}
 
 std::unique_ptr<Op> GatherGradOp::clone() const {
   return std::make_unique<GatherGradOp>(*this);
@@ -100,6 +104,7 @@ int64_t GatherGradOp::getAxis() const { return axis; }
 void GatherGradOp::appendOutlineAttributes(OpSerialiserBase &os) const {
   Op::appendOutlineAttributes(os);
   os.appendAttribute("axis", axis);
+  os.appendAttribute("available_memory_proportion", availableMemoryProportion);
 }
 
 namespace {
@@ -127,8 +132,15 @@ static OpCreator<GatherOp> gatherOpCreator(
                    {Onnx::Operators::Gather_11, gatherOpDef}}),
     [](const OpCreatorInfo &info) {
       int64_t axis = info.attributes.getAttribute<Attributes::Int>("axis", 0);
+      nonstd::optional<float> availableMemoryProportion;
 
-      return std::unique_ptr<Op>(new GatherOp(info.opid, axis, info.settings));
+      if (info.attributes.hasAttribute(sAvailMemAttribute)) {
+        availableMemoryProportion =
+            info.attributes.getAttribute<Attributes::Float>(sAvailMemAttribute);
+      }
+
+      return std::unique_ptr<Op>(new GatherOp(
+          info.opid, axis, info.settings, availableMemoryProportion));
     },
     true);
 } // namespace
@@ -0,0 +1,36 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popart/error.hpp>
+#include <popart/op/gradientoverflowcheck.hpp>
+#include <popart/opidentifier.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+
+namespace popart {
+
+GradientOverflowCheckOp::GradientOverflowCheckOp(
+    const Op::Settings &settings_)
+    : Op(Onnx::CustomOperators::GradientOverflowCheck, settings_) {}
+
+std::unique_ptr<Op> GradientOverflowCheckOp::clone() const {
+  return std::make_unique<GradientOverflowCheckOp>(*this);
+}
+
+void GradientOverflowCheckOp::setup() {
+  if (input->n() == 0) {
+    throw error("{} has no inputs to check", debugName());
+  }
+  for (auto &index_tensor : input->tensorMap()) {
+    auto dataType = index_tensor.second->info.dataType();
+    if (dataType != DataType::FLOAT && dataType != DataType::FLOAT16 &&
+        dataType != DataType::BOOL) {
+      throw error("{} can not check input {} of type {}, only FLOAT, FLOAT16 "
+                  "and BOOL inputs are supported",
+                  debugName(),
+                  index_tensor.second->id,
+                  dataType);
+    }
+  }
+  outInfo(getOutIndex()) = {DataType::BOOL, {}};
+}
+
+} // namespace popart
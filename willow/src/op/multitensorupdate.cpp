@@ -0,0 +1,280 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <memory>
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/adamupdater.hpp>
+#include <popart/op/adamvarupdate.hpp>
+#include <popart/op/multitensorupdate.hpp>
+#include <popart/op/sgd0varupdate.hpp>
+#include <popart/op/sgd1varupdate.hpp>
+#include <popart/opserialiser.hpp>
+#include <popart/region.hpp>
+
+namespace popart {
+
+MultiVarUpdateOp::MultiVarUpdateOp(const OperatorIdentifier &opid_,
+                                   const std::vector<TensorId> &varIds_,
+                                   int numSingleInputs_,
+                                   const Op::Settings &settings_)
+    : VarUpdateOp(opid_, varIds_.front(), settings_), varIds(varIds_),
+      numSingleInputs(numSingleInputs_) {}
+
+std::unique_ptr<Op> MultiVarUpdateOp::cloneWithNewName(const TensorId &) const {
+  throw error("{} updates {} Variables, it can not be cloned with a new name",
+              debugName(),
+              getNumTensors());
+}
+
+const TensorId &MultiVarUpdateOp::getVarId() const {
+  throw error("{} updates {} Variables, use getVarIds to get them",
+              debugName(),
+              getNumTensors());
+}
+
+void MultiVarUpdateOp::setup() {
+  for (int i = 0; i < getNumTensors(); ++i) {
+    outInfo(getOutIndex(i)) = inInfo(getInIndex(i, getVarToUpdateInIndex()));
+  }
+}
+
+void MultiVarUpdateOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+  Op::appendOutlineAttributes(os);
+  os.appendAttribute("num tensors", getNumTensors());
+}
+
+view::Regions MultiVarUpdateOp::aliases(InIndex in, OutIndex out) const {
+  if (in == getInIndex(out, getVarToUpdateInIndex())) {
+    return {view::Region::getFull(inShape(in))};
+  } else {
+    return {view::Region::getEmpty(inRank(in))};
+  }
+}
+
+view::Regions MultiVarUpdateOp::modifies(InIndex in) const {
+  if (in % numSingleInputs == getVarToUpdateInIndex()) {
+    return {view::Region::getFull(inShape(in))};
+  } else {
+    return {view::Region::getEmpty(inRank(in))};
+  }
+}
+
+ReplicatedTensorShardingIndices
+MultiVarUpdateOp::getReplicatedTensorShardingIndices() const {
+  ReplicatedTensorShardingIndices indices;
+  for (int i = 0; i < getNumTensors(); ++i) {
+    indices.insert(
+        {{getInIndex(i, getVarToUpdateInIndex()),
+          getInIndex(i, VarUpdateWithUpdaterOp::getUpdaterInIndex())},
+         {getOutIndex(i)}});
+  }
+  return indices;
+}
+
+MultiSGD0VarUpdateOp::MultiSGD0VarUpdateOp(const std::vector<TensorId> &varIds_,
+                                           OptimizerValue slr0,
+                                           OptimizerValue wdsf0,
+                                           const Op::Settings &opSettings)
+    : MultiVarUpdateOp(Onnx::CustomOperators::MultiSGD0VarUpdate,
+                       varIds_,
+                       SGD0VarUpdateOp::getWdsf0InIndex() + 1,
+                       opSettings),
+      initSlr0(slr0), initWdsf0(wdsf0) {}
+
+std::unique_ptr<Op> MultiSGD0VarUpdateOp::clone() const {
+  return std::make_unique<MultiSGD0VarUpdateOp>(*this);
+}
+
+std::map<InIndex, TensorId> MultiSGD0VarUpdateOp::optimizerInputs() const {
+  std::map<InIndex, TensorId> m;
+  if (!initSlr0.isConst()) {
+    auto index = SGD0VarUpdateOp::getSlr0InIndex();
+    m.insert({index, inId(index)});
+  }
+  if (!initWdsf0.isConst()) {
+    auto index = SGD0VarUpdateOp::getWdsf0InIndex();
+    m.insert({index, inId(index)});
+  }
+  return m;
+}
+
+void MultiSGD0VarUpdateOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+
+  MultiVarUpdateOp::appendOutlineAttributes(os);
+
+  if (initSlr0.isConst()) {
+    os.appendAttribute("const scaled learning rate", initSlr0.val());
+  }
+
+  if (initWdsf0.isConst()) {
+    os.appendAttribute("const weight decay scale factor", initWdsf0.val());
+  }
+}
+
+MultiSGD1VarUpdateOp::MultiSGD1VarUpdateOp(const std::vector<TensorId> &varIds_,
+                                           OptimizerValue slr1,
+                                           const Op::Settings &opSettings)
+    : MultiVarUpdateOp(Onnx::CustomOperators::MultiSGD1VarUpdate,
+                       varIds_,
+                       SGD1VarUpdateOp::getSlr1InIndex() + 1,
+                       opSettings),
+      initSlr1(slr1) {}
+
+std::unique_ptr<Op> MultiSGD1VarUpdateOp::clone() const {
+  return std::make_unique<MultiSGD1VarUpdateOp>(*this);
+}
+
+std::map<InIndex, TensorId> MultiSGD1VarUpdateOp::optimizerInputs() const {
+  std::map<InIndex, TensorId> m;
+  if (!initSlr1.isConst()) {
+    auto index = SGD1VarUpdateOp::getSlr1InIndex();
+    m.insert({index, inId(index)});
+  }
+  return m;
+}
+
+void MultiSGD1VarUpdateOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+
+  MultiVarUpdateOp::appendOutlineAttributes(os);
+
+  if (initSlr1.isConst()) {
+    os.appendAttribute("const scaled learning rate", initSlr1.val());
+  }
+}
+
+MultiAdamVarUpdateOp::MultiAdamVarUpdateOp(const std::vector<TensorId> &varIds_,
+                                           OptimizerValue lr,
+                                           OptimizerValue mwn,
+                                           const Op::Settings &opSettings)
+    : MultiVarUpdateOp(Onnx::CustomOperators::MultiAdamVarUpdate,
+                       varIds_,
+                       AdamVarUpdateOp::getMwnInIndex() + 1,
+                       opSettings),
+      initLr(lr), initMwn(mwn) {}
+
+std::unique_ptr<Op> MultiAdamVarUpdateOp::clone() const {
+  return std::make_unique<MultiAdamVarUpdateOp>(*this);
+}
+
+std::map<InIndex, TensorId> MultiAdamVarUpdateOp::optimizerInputs() const {
+  std::map<InIndex, TensorId> m;
+  if (!initLr.isConst()) {
+    auto index = AdamVarUpdateOp::getLrInIndex();
+    m.insert({index, inId(index)});
+  }
+  if (!initMwn.isConst() && hasLambInputs()) {
+    auto index = AdamVarUpdateOp::getMwnInIndex();
+    m.insert({index, inId(index)});
+  }
+  return m;
+}
+
+void MultiAdamVarUpdateOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+
+  MultiVarUpdateOp::appendOutlineAttributes(os);
+
+  if (initLr.isConst()) {
+    os.appendAttribute("const learning rate", initLr.val());
+  }
+
+  if (initMwn.isConst()) {
+    os.appendAttribute("const max weight norm", initMwn.val());
+  }
+}
+
+bool MultiAdamVarUpdateOp::hasLambInputs() const {
+  return hasInput(AdamVarUpdateOp::getLambR1SqInIndex()) &&
+         hasInput(AdamVarUpdateOp::getLambR2SqInIndex());
+}
+
+MultiAdamUpdaterOp::MultiAdamUpdaterOp(int numTensors_,
+                                       AdamMode mode_,
+                                       OptimizerValue wd,
+                                       OptimizerValue b1,
+                                       OptimizerValue b2,
+                                       OptimizerValue eps,
+                                       const Op::Settings &opSettings)
+    : Op(Onnx::CustomOperators::MultiAdamUpdater, opSettings), mode(mode_),
+      initWd(wd), initB1(b1), initB2(b2), initEps(eps),
+      numTensors(numTensors_) {}
+
+std::unique_ptr<Op> MultiAdamUpdaterOp::clone() const {
+  return std::make_unique<MultiAdamUpdaterOp>(*this);
+}
+
+InIndex MultiAdamUpdaterOp::getInIndex(int tensor, InIndex singleIndex) const {
+  return tensor * (AdamUpdaterOp::getEpsInIndex() + 1) + singleIndex;
+}
+
+void MultiAdamUpdaterOp::setup() {
+  for (int i = 0; i < numTensors; ++i) {
+    outInfo(getOutIndex(i)) =
+        inInfo(getInIndex(i, AdamUpdaterOp::getVarInIndex()));
+  }
+}
+
+void MultiAdamUpdaterOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+
+  Op::appendOutlineAttributes(os);
+
+  if (initWd.isConst()) {
+    os.appendAttribute("const weight decay", initWd.val());
+  }
+
+  if (initB1.isConst()) {
+    os.appendAttribute("const beta1", initB1.val());
+  }
+
+  if (initB2.isConst()) {
+    os.appendAttribute("const beta2", initB2.val());
+  }
+
+  if (initEps.isConst()) {
+    os.appendAttribute("const eps", initEps.val());
+  }
+
+  os.appendAttribute("mode", static_cast<int>(mode));
+  os.appendAttribute("num tensors", numTensors);
+}
+
+view::Regions MultiAdamUpdaterOp::modifies(InIndex index) const {
+  if (index % (AdamUpdaterOp::getEpsInIndex() + 1) ==
+      AdamUpdaterOp::getStepInIndex()) {
+    return {view::Region::getFull(inShape(index), view::AccessType::ReadWrite)};
+  } else {
+    return {view::Region::getEmpty(inRank(index))};
+  }
+}
+
+ReplicatedTensorShardingIndices
+MultiAdamUpdaterOp::getReplicatedTensorShardingIndices() const {
+  ReplicatedTensorShardingIndices indices;
+  for (int i = 0; i < numTensors; ++i) {
+    indices.insert({{getInIndex(i, AdamUpdaterOp::getVarInIndex()),
+                     getInIndex(i, AdamUpdaterOp::getAccl1InIndex()),
+                     getInIndex(i, AdamUpdaterOp::getAccl2InIndex())},
+                    {getOutIndex(i)}});
+  }
+  return indices;
+}
+
+MultiLambSquareOp::MultiLambSquareOp(int numTensors_,
+                                     const Op::Settings &settings_)
+    : Op(Onnx::CustomOperators::MultiLambSquare, settings_),
+      numTensors(numTensors_) {}
+
+std::unique_ptr<Op> MultiLambSquareOp::clone() const {
+  return std::make_unique<MultiLambSquareOp>(*this);
+}
+
+void MultiLambSquareOp::setup() {
+  for (int i = 0; i < numTensors; ++i) {
+    outInfo(getOutIndex(i)) = {DataType::FLOAT, {}};
+  }
+}
+
+void MultiLambSquareOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+  Op::appendOutlineAttributes(os);
+  os.appendAttribute("num tensors", numTensors);
+}
+
+} // namespace popart
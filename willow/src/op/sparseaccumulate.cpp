@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <memory>
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/gather.hpp>
+#include <popart/op/sparseaccumulate.hpp>
+#include <popart/opserialiser.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+
+namespace popart {
+
+SparseAccumulateOp::SparseAccumulateOp(
+    const TensorId &varToUpdate,
+    AccumulationType type_,
+    OptimizerValue factor_,
+    int64_t axis_,
+    nonstd::optional<float> availableMemoryProportion_,
+    const Op::Settings &opSettings)
+    : VarUpdateOp(Onnx::CustomOperators::SparseAccumulate,
+                  varToUpdate,
+                  opSettings),
+      type(type_), factor(factor_), axis(axis_),
+      availableMemoryProportion(availableMemoryProportion_) {
+  if (type != AccumulationType::Add &&
+      type != AccumulationType::DampenedAdd) {
+    throw error("SparseAccumulateOp only supports the Add and DampenedAdd "
+                "accumulation types, not {}",
+                static_cast<int>(type));
+  }
+}
+
+std::unique_ptr<Op>
+SparseAccumulateOp::cloneWithNewName(const TensorId &x) const {
+  return std::make_unique<SparseAccumulateOp>(
+      x, type, factor, axis, availableMemoryProportion, settings);
+}
+
+std::unique_ptr<Op> SparseAccumulateOp::clone() const {
+  return std::make_unique<SparseAccumulateOp>(*this);
+}
+
+std::map<InIndex, TensorId> SparseAccumulateOp::optimizerInputs() const {
+  std::map<InIndex, TensorId> m;
+  if (!factor.isConst()) {
+    auto index = getFactorInIndex();
+    m.insert({index, inId(index)});
+  }
+  return m;
+}
+
+void SparseAccumulateOp::setup() {
+  auto accumInfo   = inInfo(getVarToUpdateInIndex());
+  auto rowsInfo    = inInfo(getUpdaterInIndex());
+  auto indicesInfo = inInfo(getIndicesInIndex());
+
+  if (axis < 0 || axis >= accumInfo.rank()) {
+    throw error("SparseAccumulateOp {}: axis {} is out of range for an "
+                "accumulator of rank {}",
+                debugName(),
+                axis,
+                accumInfo.rank());
+  }
+
+  // The rows have the shape of the gathered data: the accumulator's, with
+  // the axis replaced by the indices
+  Shape rowsShape;
+  auto accumShape = accumInfo.shape();
+  rowsShape.insert(
+      rowsShape.end(), accumShape.begin(), accumShape.begin() + axis);
+  rowsShape.insert(
+      rowsShape.end(), indicesInfo.shape().begin(), indicesInfo.shape().end());
+  rowsShape.insert(
+      rowsShape.end(), accumShape.begin() + axis + 1, accumShape.end());
+  if (rowsInfo.shape() != rowsShape ||
+      rowsInfo.dataType() != accumInfo.dataType()) {
+    std::ostringstream oss;
+    oss << "SparseAccumulateOp " << debugName() << ": the rows have TensorInfo "
+        << rowsInfo << ", but the accumulator has TensorInfo " << accumInfo
+        << " and the indices have TensorInfo " << indicesInfo;
+    throw error(oss.str());
+  }
+
+  outInfo(getUpdatedVarOutIndex()) = accumInfo;
+}
+
+void SparseAccumulateOp::appendOutlineAttributes(OpSerialiserBase &os) const {
+
+  Op::appendOutlineAttributes(os);
+
+  os.appendAttribute("type", static_cast<int>(getAccumulationType()));
+  os.appendAttribute("axis", axis);
+  os.appendAttribute("available_memory_proportion", availableMemoryProportion);
+
+  if (factor.isConst()) {
+    os.appendAttribute("const factor", getFactor().val());
+  }
+}
+
+GatherGradOp *SparseAccumulateOp::getSparseGradient(const Tensor *weight,
+                                                    const Tensor *weightGrad) {
+  auto &ir   = weight->getIr();
+  auto &opts = ir.getSessionOptions();
+
+  if ((opts.sparseWeightUpdateTensors.empty() &&
+       opts.sparseWeightUpdateMinElements <= 0) ||
+      opts.hostAllReduce) {
+    return nullptr;
+  }
+
+  if (!weightGrad->hasProducer()) {
+    return nullptr;
+  }
+  auto gatherGrad = dynamic_cast<GatherGradOp *>(weightGrad->getProducer());
+  if (!gatherGrad) {
+    return nullptr;
+  }
+
+  // The dense gradient must not be needed by anything but the optimizer
+  if (weightGrad->consumers.getTotal() != 1 || ir.isAnchored(weightGrad->id)) {
+    return nullptr;
+  }
+
+  auto &rowsInfo = gatherGrad->inInfo(GatherGradOp::gradInIndex());
+  if (rowsInfo.dataType() != weight->info.dataType()) {
+    return nullptr;
+  }
+
+  if (opts.sparseWeightUpdateTensors.count(weight->id) > 0) {
+    return gatherGrad;
+  }
+
+  // Automatically, for large tables of which fewer rows are gathered than
+  // there are
+  auto numRows    = weight->info.dim(static_cast<int>(gatherGrad->getAxis()));
+  auto numLookups = gatherGrad->inInfo(GatherGradOp::indicesInIndex()).nelms();
+  if (opts.sparseWeightUpdateMinElements > 0 &&
+      weight->info.nelms() >= opts.sparseWeightUpdateMinElements &&
+      numLookups < numRows) {
+    return gatherGrad;
+  }
+
+  return nullptr;
+}
+
+} // namespace popart
@@ -470,6 +470,36 @@ float SGD::getStoredValue(const TensorId &optId) const {
               optId);
 }
 
+OptimizerScheduleDependence
+SGD::getScheduleDependence(const TensorId &optId) const {
+  OptimizerScheduleDependence dependence;
+
+  if (optId.find(reservedLossScalingPrefix()) != std::string::npos) {
+    // ls
+    dependence.lsPower = 1;
+  } else if (slr0helper.idMatch(optId)) {
+    // lr * (1 - dp) / ls
+    dependence.lrPower = 1;
+    dependence.lsPower = -1;
+  } else if (wdsf0helper.idMatch(optId)) {
+    // 1 - lr * (1 - dp) * wd
+    dependence.offset  = 1.0f;
+    dependence.lrPower = 1;
+  } else if (slr1helper.idMatch(optId)) {
+    // lr / (vs * rf)
+    dependence.lrPower = 1;
+  } else if (dpsf1helper.idMatch(optId)) {
+    // (1 - dm) * vs * rf / (ls * af)
+    dependence.lsPower = -1;
+  } else if (!swd1helper.idMatch(optId) && !smm1helper.idMatch(optId)) {
+    throw error("In getScheduleDependence for {}, it doesn't match any "
+                "existing optimizer prefix",
+                optId);
+  }
+
+  return dependence;
+}
+
 bool SGD::validReplacement(const Optimizer &other) const {
   if (other.type() != type()) {
     return false;
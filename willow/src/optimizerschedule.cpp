@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <cmath>
+#include <popart/error.hpp>
+#include <popart/optimizerschedule.hpp>
+
+namespace popart {
+
+bool OptimizerSchedule::enabled() const {
+  return warmupSteps > 0 || decay != Decay::None;
+}
+
+float OptimizerSchedule::evaluate(int64_t t) const {
+  float factor = 1.0f;
+  if (t < warmupSteps) {
+    factor = warmupStartFactor + (1.0f - warmupStartFactor) *
+                                     static_cast<float>(t) /
+                                     static_cast<float>(warmupSteps);
+  }
+
+  auto s     = static_cast<float>(std::max<int64_t>(t - warmupSteps, 0));
+  auto steps = static_cast<float>(decaySteps);
+  switch (decay) {
+  case Decay::None:
+    break;
+  case Decay::Step:
+    factor *= std::pow(decayFactor, std::floor(s / steps));
+    break;
+  case Decay::Exponential:
+    factor *= std::pow(decayFactor, s / steps);
+    break;
+  case Decay::Cosine: {
+    const float pi = 3.14159265358979f;
+    auto cosine    = std::cos(pi * std::min(s, steps) / steps);
+    factor *= minFactor + (1.0f - minFactor) * 0.5f * (1.0f + cosine);
+    break;
+  }
+  }
+  return factor;
+}
+
+void OptimizerSchedule::validate(const std::string &name) const {
+  if (warmupSteps < 0) {
+    throw error("The {} schedule has {} warmup steps, it must not be negative",
+                name,
+                warmupSteps);
+  }
+  if (decay != Decay::None && decaySteps <= 0) {
+    throw error("The {} schedule has {} decay steps, it must be positive",
+                name,
+                decaySteps);
+  }
+  if ((decay == Decay::Step || decay == Decay::Exponential) &&
+      decayFactor <= 0.0f) {
+    throw error("The {} schedule has a decay factor of {}, it must be "
+                "positive",
+                name,
+                decayFactor);
+  }
+}
+
+} // namespace popart
@@ -23,6 +23,18 @@ OptimizerValue OptimizerValueMap::get(const TensorId &id) const {
   return defaultOptVal;
 }
 
+bool OptimizerValueMap::anyConst() const {
+  if (defaultOptVal.isConst()) {
+    return true;
+  }
+  for (const auto &id_ov : specifics) {
+    if (id_ov.second.isConst()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool OptimizerValueMap::validReplacement(const OptimizerValueMap &ovm) const {
 
   if (!defaultOptVal.validReplacement(ovm.defaultOptVal)) {
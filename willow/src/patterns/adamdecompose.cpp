@@ -16,8 +16,10 @@
 #include <popart/op/concat.hpp>
 #include <popart/op/div.hpp>
 #include <popart/op/flatten.hpp>
+#include <popart/op/gather.hpp>
 #include <popart/op/lamb.hpp>
 #include <popart/op/slice.hpp>
+#include <popart/op/sparseaccumulate.hpp>
 #include <popart/patterns/adamdecompose.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensorinfo.hpp>
@@ -177,12 +179,32 @@ bool AdamDecompose::apply(Op *op) const {
   }
 
   // Gradient accumulation
+  // The gradient of a Gather may be accumulated sparsely, unless it has to be
+  // reduced across replicas first
+  GatherGradOp *gatherGrad = nullptr;
+  if (combo->withGradAccum &&
+      combo->reductionType != OptimizerReductionType::GradReduce &&
+      combo->accumType == weightGrad->info.dataType()) {
+    gatherGrad = SparseAccumulateOp::getSparseGradient(weight, weightGrad);
+  }
+
   if (combo->withGradAccum) {
-    auto accumOpUp = std::make_unique<AccumulateOp>(
-        accumId,
-        AccumulationType::Add,
-        OptimizerValue(1.0f),
-        Op::Settings(graph, combo->name() + "_accumulate"));
+    std::unique_ptr<VarUpdateOp> accumOpUp;
+    if (gatherGrad) {
+      accumOpUp = std::make_unique<SparseAccumulateOp>(
+          accumId,
+          AccumulationType::Add,
+          OptimizerValue(1.0f),
+          gatherGrad->getAxis(),
+          gatherGrad->getAvailableMemoryProportion(),
+          Op::Settings(graph, combo->name() + "_sparse_accumulate"));
+    } else {
+      accumOpUp = std::make_unique<AccumulateOp>(
+          accumId,
+          AccumulationType::Add,
+          OptimizerValue(1.0f),
+          Op::Settings(graph, combo->name() + "_accumulate"));
+    }
     auto accumOp = accumOpUp.get();
     transferBaseProperties(combo, accumOp);
     graph.moveIntoGraph(std::move(accumOpUp));
@@ -193,12 +215,20 @@ bool AdamDecompose::apply(Op *op) const {
                             VarUpdateOp::getVarToUpdateInIndex());
     accumOp->connectInTensor(VarUpdateOp::getVarToUpdateInIndex(), accumId);
 
-    logging::pattern::trace("Connecting input {} to {} at {}",
-                            gradIntoAccumId,
-                            accumOp->str(),
-                            VarUpdateWithUpdaterOp::getUpdaterInIndex());
-    accumOp->connectInTensor(VarUpdateWithUpdaterOp::getUpdaterInIndex(),
-                             gradIntoAccumId);
+    if (gatherGrad) {
+      accumOp->connectInTensor(SparseAccumulateOp::getUpdaterInIndex(),
+                               gatherGrad->inId(GatherGradOp::gradInIndex()));
+      accumOp->connectInTensor(
+          SparseAccumulateOp::getIndicesInIndex(),
+          gatherGrad->inId(GatherGradOp::indicesInIndex()));
+    } else {
+      logging::pattern::trace("Connecting input {} to {} at {}",
+                              gradIntoAccumId,
+                              accumOp->str(),
+                              VarUpdateWithUpdaterOp::getUpdaterInIndex());
+      accumOp->connectInTensor(VarUpdateWithUpdaterOp::getUpdaterInIndex(),
+                               gradIntoAccumId);
+    }
 
     // The updated accumulator
     TensorId updatedAccumId = ir.createIntermediateTensorId(accumId);
@@ -599,6 +629,14 @@ bool AdamDecompose::apply(Op *op) const {
   combo->disconnectAllOutputs();
   graph.eraseOp(combo->id);
 
+  // The dense gradient of the sparsely accumulated Gather is not needed
+  if (gatherGrad) {
+    gatherGrad->disconnectAllInputs();
+    gatherGrad->disconnectAllOutputs();
+    graph.getTensors().remove(weightGradId);
+    graph.eraseOp(gatherGrad->id);
+  }
+
   adamVarUpdOp->connectOutTensor(AdamVarUpdateOp::getUpdatedVarOutIndex(),
                                  updatedWeightId);
   adamVarUpdOp->setup();
@@ -0,0 +1,220 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/op/fusedelementwise.hpp>
+#include <popart/patterns/fusedelementwisepattern.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+#include <popart/tensors.hpp>
+#include <popart/topocons.hpp>
+
+namespace popart {
+
+namespace {
+
+bool isFloatingPoint(const Tensor *t) {
+  return t->info.dataType() == DataType::FLOAT ||
+         t->info.dataType() == DataType::FLOAT16;
+}
+
+bool canFuse(Op *op) {
+  if (!FusedElementwiseOp::getStep(op)) {
+    return false;
+  }
+  for (auto &index_tensor : op->input->tensorMap()) {
+    if (!isFloatingPoint(index_tensor.second)) {
+      return false;
+    }
+  }
+  if (!isFloatingPoint(op->output->tensor(0))) {
+    return false;
+  }
+  return !op->getGraph().topoCons->hasConstraint(op);
+}
+
+// Can the producer of t be fused into consumer, removing t?
+bool canFuseProducer(Tensor *t, Op *consumer) {
+  if (!t->hasProducer() || !canFuse(t->getProducer())) {
+    return false;
+  }
+
+  // Consumed once, by consumer only
+  if (t->consumers.getTotal() != 1) {
+    return false;
+  }
+
+  auto &graphOutputs = t->getGraph().getOutputIds();
+  if (t->getIr().isAnchored(t->id) ||
+      std::find(graphOutputs.begin(), graphOutputs.end(), t->id) !=
+          graphOutputs.end()) {
+    return false;
+  }
+
+  // The fused Ops must be placed, and recomputed, alike
+  Op *producer = t->getProducer();
+  return producer->getOptionalVGraphId() == consumer->getOptionalVGraphId() &&
+         producer->getOptionalPipelineStage() ==
+             consumer->getOptionalPipelineStage() &&
+         producer->getOptionalExecutionPhase() ==
+             consumer->getOptionalExecutionPhase() &&
+         producer->getOptionalBatchSerializedPhase() ==
+             consumer->getOptionalBatchSerializedPhase() &&
+         producer->settings.recomputeType == consumer->settings.recomputeType &&
+         producer->settings.tileSet == consumer->settings.tileSet &&
+         producer->settings.scope == consumer->settings.scope;
+}
+
+} // namespace
+
+bool FusedElementwisePattern::matches(Op *op) const {
+  auto &ir = op->getIr();
+  if (ir.canTrain() && !ir.hasConstructedBackwards()) {
+    return false;
+  }
+
+  if (!canFuse(op)) {
+    return false;
+  }
+
+  // The root is the last Op of the subgraph
+  Tensor *out = op->output->tensor(0);
+  if (out->consumers.getTotal() == 1 &&
+      canFuse(out->consumers.getOps().front()) &&
+      canFuseProducer(out, out->consumers.getOps().front())) {
+    return false;
+  }
+
+  for (auto &index_tensor : op->input->tensorMap()) {
+    if (canFuseProducer(index_tensor.second, op)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<Op *> FusedElementwisePattern::getFusedOps(Op *root) const {
+  std::vector<Op *> ops;
+
+  // Every intermediate tensor has a single consumer, so the subgraph is a
+  // tree, and a post-order traversal is a topological order
+  std::function<void(Op *)> visit = [&ops, &visit](Op *op) {
+    for (auto &index_tensor : op->input->tensorMap()) {
+      if (canFuseProducer(index_tensor.second, op)) {
+        visit(index_tensor.second->getProducer());
+      }
+    }
+    ops.push_back(op);
+  };
+  visit(root);
+
+  return ops;
+}
+
+std::vector<const Tensor *> FusedElementwisePattern::touches(Op *root) const {
+  std::vector<const Tensor *> intermediates;
+  for (Op *op : getFusedOps(root)) {
+    if (op != root) {
+      intermediates.push_back(op->output->tensor(0));
+    }
+  }
+  return intermediates;
+}
+
+bool FusedElementwisePattern::apply(Op *root) const {
+  auto &graph = root->getGraph();
+  auto ops    = getFusedOps(root);
+
+  std::vector<FusedElementwiseStep> steps;
+  std::vector<TensorId> inputs;
+  std::map<Op *, int> stepIndices;
+
+  for (Op *op : ops) {
+    auto step = *FusedElementwiseOp::getStep(op);
+    for (auto &index_tensor : op->input->tensorMap()) {
+      Tensor *t  = index_tensor.second;
+      auto found = t->hasProducer() ? stepIndices.find(t->getProducer())
+                                    : stepIndices.end();
+      if (found != stepIndices.end()) {
+        step.operands.push_back(
+            FusedElementwiseStep::stepOperand(found->second));
+      } else {
+        auto input = std::find(inputs.begin(), inputs.end(), t->id);
+        step.operands.push_back(std::distance(inputs.begin(), input));
+        if (input == inputs.end()) {
+          inputs.push_back(t->id);
+        }
+      }
+    }
+    stepIndices[op] = steps.size();
+    steps.push_back(step);
+  }
+
+  // Only input 0 may be updated inplace, so make it one which is not broadcast
+  const auto &outShape = root->output->tensor(0)->info.shape();
+  auto full            = std::find_if(
+      inputs.begin(), inputs.end(), [&graph, &outShape](const TensorId &id) {
+        return graph.getTensors().get(id)->info.shape() == outShape;
+      });
+  if (full != inputs.end() && full != inputs.begin()) {
+    const int fullIndex = std::distance(inputs.begin(), full);
+    std::swap(inputs.front(), *full);
+    for (auto &step : steps) {
+      for (auto &operand : step.operands) {
+        if (operand == 0) {
+          operand = fullIndex;
+        } else if (operand == fullIndex) {
+          operand = 0;
+        }
+      }
+    }
+  }
+
+  auto fusedOpUp = std::make_unique<FusedElementwiseOp>(
+      Onnx::CustomOperators::FusedElementwise,
+      steps,
+      Op::Settings(graph, getReplacementOpName(root, "")));
+  auto fusedOp = fusedOpUp.get();
+  transferBaseProperties(root, fusedOp);
+  graph.moveIntoGraph(std::move(fusedOpUp));
+
+  logging::pattern::trace(
+      "Fusing {} elementwise Ops into {}", ops.size(), fusedOp->debugName());
+
+  TensorId outId = root->output->tensor(0)->id;
+  std::vector<TensorId> intermediates;
+  for (Op *op : ops) {
+    if (op != root) {
+      intermediates.push_back(op->output->tensor(0)->id);
+    }
+    op->disconnectAllInputs();
+    op->disconnectAllOutputs();
+  }
+  for (auto &id : intermediates) {
+    graph.getTensors().remove(id);
+  }
+  for (Op *op : ops) {
+    graph.eraseOp(op->id);
+  }
+
+  for (InIndex i = 0; i < inputs.size(); ++i) {
+    fusedOp->connectInTensor(i, inputs.at(i));
+  }
+  fusedOp->connectOutTensor(FusedElementwiseOp::getOutIndex(), outId);
+  fusedOp->setup();
+
+  return true;
+}
+
+namespace {
+static PatternCreator<FusedElementwisePattern>
+    fusedElementwisePattern(PreAliasPatternType::FusedElementwise,
+                            "FusedElementwise",
+                            /* enabled = */ false);
+}
+
+} // namespace popart
@@ -21,6 +21,7 @@
 #include <popart/patterns/divarg1gradoppattern.hpp>
 #include <popart/patterns/elementwisegradoppattern.hpp>
 #include <popart/patterns/expgradoppattern.hpp>
+#include <popart/patterns/fusedelementwisepattern.hpp>
 #include <popart/patterns/gemmdecompositionpattern.hpp>
 #include <popart/patterns/initaccumulatepattern.hpp>
 #include <popart/patterns/inplace.hpp>
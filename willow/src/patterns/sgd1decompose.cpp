@@ -10,10 +10,12 @@
 #include <popart/op/collectives/replicatedallreduce.hpp>
 #include <popart/op/concat.hpp>
 #include <popart/op/flatten.hpp>
+#include <popart/op/gather.hpp>
 #include <popart/op/sgd1acclupdate.hpp>
 #include <popart/op/sgd1combo.hpp>
 #include <popart/op/sgd1varupdate.hpp>
 #include <popart/op/slice.hpp>
+#include <popart/op/sparseaccumulate.hpp>
 #include <popart/patterns/sgd1decompose.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensorinfo.hpp>
@@ -157,20 +159,39 @@ bool SGD1Decompose::apply(Op *op) const {
     graph.topoCons->insert(reduceOp, combo, true);
   }
 
-  // Accumulate Op
+  // The gradient of a Gather may be accumulated sparsely, unless it has to be
+  // reduced across replicas first
+  GatherGradOp *gatherGrad = nullptr;
+  if (combo->reductionType != OptimizerReductionType::GradReduce) {
+    gatherGrad = SparseAccumulateOp::getSparseGradient(weight, weightGrad);
+  }
+
+  // Accumulate Op (or SparseAccumulate Op)
   //
   // Inputs:
   // (1) acclIn (a.k.a. the Velocity Tensor / Gradient Accumulation Tensor)
-  // (2) dW (a.k.a. the Mini-Batch Weight Gradient Tensor)
+  // (2) dW (a.k.a. the Mini-Batch Weight Gradient Tensor), or the gradient
+  //     of the gathered rows and their indices
   // (3) dampeningScaleFactor (an input only if not Const)
   //
   // Outputs:
   // (4) an alias of acclIn
-  auto acclOpUp = std::make_unique<AccumulateOp>(
-      acclIntoAccumulatorId,
-      AccumulationType::DampenedAdd,
-      combo->initDpsf1,
-      Op::Settings(graph, combo->name() + "_accumulate"));
+  std::unique_ptr<VarUpdateOp> acclOpUp;
+  if (gatherGrad) {
+    acclOpUp = std::make_unique<SparseAccumulateOp>(
+        acclIntoAccumulatorId,
+        AccumulationType::DampenedAdd,
+        combo->initDpsf1,
+        gatherGrad->getAxis(),
+        gatherGrad->getAvailableMemoryProportion(),
+        Op::Settings(graph, combo->name() + "_sparse_accumulate"));
+  } else {
+    acclOpUp = std::make_unique<AccumulateOp>(
+        acclIntoAccumulatorId,
+        AccumulationType::DampenedAdd,
+        combo->initDpsf1,
+        Op::Settings(graph, combo->name() + "_accumulate"));
+  }
   auto acclOp = acclOpUp.get();
   transferBaseProperties(combo, acclOp);
   graph.moveIntoGraph(std::move(acclOpUp));
@@ -183,15 +204,22 @@ bool SGD1Decompose::apply(Op *op) const {
   acclOp->connectInTensor(VarUpdateOp::getVarToUpdateInIndex(),
                           acclIntoAccumulatorId);
   // (2)
-  logging::pattern::trace("Connecting input {} to {} at {}",
-                          weightGradId,
-                          acclOp->str(),
-                          VarUpdateWithUpdaterOp::getUpdaterInIndex());
-  acclOp->connectInTensor(VarUpdateWithUpdaterOp::getUpdaterInIndex(),
-                          combo->reductionType ==
-                                  OptimizerReductionType::GradReduce
-                              ? reducedWeightGradId
-                              : weightGradId);
+  if (gatherGrad) {
+    acclOp->connectInTensor(SparseAccumulateOp::getUpdaterInIndex(),
+                            gatherGrad->inId(GatherGradOp::gradInIndex()));
+    acclOp->connectInTensor(SparseAccumulateOp::getIndicesInIndex(),
+                            gatherGrad->inId(GatherGradOp::indicesInIndex()));
+  } else {
+    logging::pattern::trace("Connecting input {} to {} at {}",
+                            weightGradId,
+                            acclOp->str(),
+                            VarUpdateWithUpdaterOp::getUpdaterInIndex());
+    acclOp->connectInTensor(VarUpdateWithUpdaterOp::getUpdaterInIndex(),
+                            combo->reductionType ==
+                                    OptimizerReductionType::GradReduce
+                                ? reducedWeightGradId
+                                : weightGradId);
+  }
 
   // (3)
   if (!combo->initDpsf1.isConst()) {
@@ -347,6 +375,14 @@ bool SGD1Decompose::apply(Op *op) const {
   combo->disconnectAllOutputs();
   graph.eraseOp(combo->id);
 
+  // The dense gradient of the sparsely accumulated Gather is not needed
+  if (gatherGrad) {
+    gatherGrad->disconnectAllInputs();
+    gatherGrad->disconnectAllOutputs();
+    graph.getTensors().remove(weightGradId);
+    graph.eraseOp(gatherGrad->id);
+  }
+
   // (4)
   sgd1VarUpdateOp->connectOutTensor(VarUpdateOp::getUpdatedVarOutIndex(),
                                     updatedWeightId);
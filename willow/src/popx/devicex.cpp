@@ -1,6 +1,7 @@
 // Copyright (c) 2018 Graphcore Ltd. All rights reserved.
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
@@ -40,12 +41,14 @@
 #include <popart/op.hpp>
 #include <popart/op/call.hpp>
 #include <popart/op/getrandomseed.hpp>
+#include <popart/op/gradientoverflowcheck.hpp>
 #include <popart/op/if.hpp>
 #include <popart/op/ipucopy.hpp>
 #include <popart/op/remote.hpp>
 #include <popart/op/restore.hpp>
 #include <popart/op/subgraphop.hpp>
 #include <popart/op/varupdate.hpp>
+#include <popart/optimizer.hpp>
 #include <popart/patterns/pattern.hpp>
 #include <popart/popx/devicex.hpp>
 #include <popart/popx/devicexmanager.hpp>
@@ -63,6 +66,7 @@
 #include <popart/tensors.hpp>
 #include <popart/tojson.hpp>
 #include <popart/topocons.hpp>
+#include <popart/transforms/dynamiclossscaling.hpp>
 
 #include <popart/op/hostreducevarupdate.hpp>
 #include <popart/op/varupdate.hpp>
@@ -74,6 +78,8 @@
 namespace popart {
 namespace popx {
 
+namespace pe = popops::expr;
+
 namespace {
 
 void progressLogger(int progress, int total) {
@@ -111,6 +117,56 @@ private:
   SavedInfo() : irHash(0) {}
 };
 
+// The factor of an OptimizerSchedule at the weight update t, as
+// OptimizerSchedule::evaluate
+pe::Any getOptimizerScheduleExpr(const OptimizerSchedule &schedule,
+                                 const pe::Expr &t) {
+  pe::Any factor(pe::Const(1.0f));
+
+  if (schedule.warmupSteps > 0) {
+    auto start = schedule.warmupStartFactor;
+    auto steps = pe::Const(static_cast<float>(schedule.warmupSteps));
+    factor     = pe::Select(
+        pe::Add(pe::Const(start),
+                pe::Divide(pe::Mul(pe::Const(1.0f - start), t), steps)),
+        pe::Const(1.0f),
+        pe::Lt(t, steps));
+  }
+
+  // The decay starts after the warmup
+  pe::Any s(pe::Max(
+      pe::Sub(t, pe::Const(static_cast<float>(schedule.warmupSteps))),
+      pe::Const(0.0f)));
+  auto steps = pe::Const(static_cast<float>(schedule.decaySteps));
+
+  switch (schedule.decay) {
+  case OptimizerSchedule::Decay::None:
+    break;
+  case OptimizerSchedule::Decay::Step:
+    factor = pe::Mul(factor,
+                     pe::Pow(pe::Const(schedule.decayFactor),
+                             pe::Floor(pe::Divide(s, steps))));
+    break;
+  case OptimizerSchedule::Decay::Exponential:
+    factor = pe::Mul(
+        factor,
+        pe::Pow(pe::Const(schedule.decayFactor), pe::Divide(s, steps)));
+    break;
+  case OptimizerSchedule::Decay::Cosine: {
+    const float pi = 3.14159265358979f;
+    auto cosine    = pe::Cos(
+        pe::Mul(pe::Const(pi), pe::Divide(pe::Min(s, steps), steps)));
+    factor = pe::Mul(
+        factor,
+        pe::Add(pe::Const(schedule.minFactor),
+                pe::Mul(pe::Const((1.0f - schedule.minFactor) * 0.5f),
+                        pe::Add(pe::Const(1.0f), cosine))));
+    break;
+  }
+  }
+  return factor;
+}
+
 // Walk the producers of an ops inputs, applying function f to every producer.
 // The producers are walked in a top down fashion. If f returns false of an op,
 // then further producers below it are not traversed.
@@ -891,8 +947,13 @@ poplar::Graph &Devicex::getVirtualGraph(VGraphId virtualGraphIndex,
 Devicex::~Devicex() = default;
 
 Devicex::Devicex(const Ir &ir, std::shared_ptr<DeviceInfo> deviceInfo_)
-    : _ir(ir), progs(PopPrograms(this)), tensors(ir), deviceInfo(deviceInfo_),
-      prepareHasBeenCalled_(false), prepareGraphHasBeenCalled_(false) {
+    : _ir(ir), progs(PopPrograms(this)),
+      planningCaches(PlanningCaches::get(
+          *deviceInfo_,
+          ir.getSessionOptions().enablePlanningCacheSharing)),
+      convCache(planningCaches->conv), matmulCache(planningCaches->matmul),
+      tensors(ir), deviceInfo(deviceInfo_), prepareHasBeenCalled_(false),
+      prepareGraphHasBeenCalled_(false) {
   POPART_TRACEPOINT();
   logging::devicex::info("Setting selected device: {}", *deviceInfo);
 
@@ -1052,6 +1113,9 @@ void Devicex::optimizerFromHost() {
   POPART_TRACEPOINT();
   if (ir().useSyntheticData() == false) {
     logging::devicex::debug("Writing optimizer from host, ");
+    if (packOptimizerStreams()) {
+      packOptimizerStreamBuffers();
+    }
     pEngine->disableExecutionProfiling();
     run(PopPrograms::ProgramIndex::OptimizerFromHost, "OptimizerFromHost");
     logging::devicex::debug("done.");
@@ -1219,6 +1283,10 @@ TaskId Devicex::taskWhichPopulates(TensorId id) const {
   // if a Tensor is of type Stream, the Copy from host to device populates it
   else if (!ir().useSyntheticData() &&
            tensor->tensorType() == TensorType::Stream) {
+    // Packed optimizer tensors are all copied by a single task
+    if (packOptimizerStreams() && tensor->isOptimizerTensor()) {
+      return fromHostPackedOptimizerTaskId();
+    }
     return fromHostTaskId(tensor->id);
   }
 
@@ -2177,6 +2245,16 @@ PriTask Devicex::opTask(Op *op, double priority, TaskId prevOpTaskId) {
     }
   }
 
+  // The Ops skipped when the gradients overflow need the result of the check
+  if (isSkippedOnOverflow(op)) {
+    skippedOnOverflowTasks.insert(opTaskId(op));
+    auto checkTask =
+        taskWhichCreates(GradientOverflowCheckOp::getOverflowTensorId());
+    if (std::find(deps.begin(), deps.end(), checkTask) == deps.end()) {
+      deps.push_back(checkTask);
+    }
+  }
+
   // Add initTensorTask dependencies for externally created output tensors
   Opx *opx = getOpx(op->id);
   for (auto t_inds : op->output->indicesMap()) {
@@ -2245,6 +2323,12 @@ PriTask Devicex::opTask(Op *op, double priority, TaskId prevOpTaskId) {
   return {priority, opTaskId(op), deps, f};
 }
 
+bool Devicex::isSkippedOnOverflow(const Op *op) const {
+  // The Ops of the subgraphs are skipped by their CallOps
+  return &op->getGraph() == &ir().getMainGraph() &&
+         DynamicLossScaling::isSkippedOnOverflow(op);
+}
+
 void Devicex::growOpx(Opx *opx, poplar::program::Sequence &seq) {
   logging::devicex::trace("Calling growOpx for Op {} with debugName {}",
                           opx->op_p->str(),
@@ -2282,7 +2366,8 @@ void Devicex::growOpx(Opx *opx, poplar::program::Sequence &seq) {
     }
   }
 
-  // Grow code for the Op
+  // Grow code for the Op. The Ops skipped on overflow are made conditional
+  // when their sequences are emplaced (see emplaceTaskSeqs)
   opx->grow(seq);
 
   if (ir().getSessionOptions().opxModifyChecking) {
@@ -2658,9 +2743,17 @@ void Devicex::loadEngineAndConnectStreams() {
 
     logging::devicex::debug("Connecting optimizer streams");
 
-    for (auto tensor : ir().optimizerTensors()) {
-      logging::devicex::debug("   {}", tensor->str());
-      pEngine->connectStream(h2dId(tensor->id), tensor->tensorData()->data());
+    if (packOptimizerStreams()) {
+      for (auto &packed : packedOptimizerStreams) {
+        logging::devicex::debug("   {}", packed.id);
+        pEngine->connectStream(h2dId(packed.id), packed.buffer.data());
+      }
+    } else {
+      for (auto tensor : ir().optimizerTensors()) {
+        logging::devicex::debug("   {}", tensor->str());
+        pEngine->connectStream(h2dId(tensor->id),
+                               tensor->tensorData()->data());
+      }
     }
 
     stepIoSplitter = std::make_unique<StepIOSplitter>(
@@ -2866,6 +2959,9 @@ void Devicex::prepareGraph() {
     return;
   }
 
+  // The planning caches are used by the Opxs while the graph is prepared
+  auto planningCachesLock = planningCaches->lock();
+
   logging::devicex::info("Poplar version: {}", poplar::versionString());
   logging::devicex::info("Poplar release githash: {}", poplar::packageHash());
 
@@ -3082,7 +3178,8 @@ void Devicex::prepareGraph() {
     // 2
     if (ir().useSyntheticData()) {
       tasks.add(setInitTensorValTask(tensor));
-    } else {
+    } else if (!(packOptimizerStreams() && tensor->isOptimizerTensor())) {
+      // Packed optimizer tensors share their streams
       tasks.add(streamFromHostTask(tensor));
     }
   }
@@ -3153,9 +3250,43 @@ void Devicex::prepareGraph() {
       }
     }
 
+    // evaluate the optimizer schedules, and the dynamic loss scaling, on the
+    // device
+    auto &opts = ir().getSessionOptions();
+    if (ir().canTrain() && (opts.learningRateSchedule.enabled() ||
+                            opts.lossScalingSchedule.enabled() ||
+                            opts.dynamicLossScalingSettings.enabled)) {
+      opts.learningRateSchedule.validate("learning rate");
+      opts.lossScalingSchedule.validate("loss scaling");
+      // Const values are folded into the VarUpdates, so the device can not
+      // rescale them
+      auto &optimizer = ir().getOptimizer();
+      if (opts.learningRateSchedule.enabled() &&
+          optimizer.learningRates().anyConst()) {
+        throw error("Only non-const learning rates can be scheduled, but the "
+                    "optimizer has a const learning rate");
+      }
+      if (opts.lossScalingSchedule.enabled() &&
+          optimizer.lossScaling().isConst()) {
+        throw error("Only a non-const loss scaling can be scheduled, but the "
+                    "optimizer has a const loss scaling");
+      }
+      if (opts.enablePipelining && !opts.enableGradientAccumulation) {
+        throw error("Optimizer schedules with pipelining require gradient "
+                    "accumulation");
+      }
+      tasks.add(optimizerScheduleTask());
+    }
+
     // create Program to write optimizer tensors to device
-    for (auto tensor : ir().optimizerTensors()) {
-      tasks.add(fromHostTask(tensor, progs.streamOptimizerFromHostFragment()));
+    if (packOptimizerStreams()) {
+      tasks.add(
+          fromHostPackedOptimizerTask(progs.streamOptimizerFromHostFragment()));
+    } else {
+      for (auto tensor : ir().optimizerTensors()) {
+        tasks.add(
+            fromHostTask(tensor, progs.streamOptimizerFromHostFragment()));
+      }
     }
 
     for (Tensor *tensor : ir().dataStreamTensors()) {
@@ -3287,6 +3418,21 @@ void Devicex::prepareGraph() {
                                               DependencyType::SubGraph,
                                               DependencyType::Scheduler});
 
+  // Sequences of consecutive Ops which are skipped when the gradients
+  // overflow, per final sequence. Each is emplaced under a single If, rather
+  // than one If per Op.
+  SequenceMap skippedSeqs;
+  auto emplaceSkippedSeq = [&](poplar::program::Sequence *finalSeq) {
+    auto found = skippedSeqs.find(finalSeq);
+    if (found != skippedSeqs.end()) {
+      finalSeq->add(poplar::program::If(
+          tensors.get(GradientOverflowCheckOp::getOverflowTensorId()),
+          poplar::program::Sequence(),
+          found->second));
+      skippedSeqs.erase(found);
+    }
+  };
+
   auto emplaceTaskSeqs = [&](std::set<TaskId> filter) {
     // 2.) Add intermediate sequences in final sequence
     // Linearised, ignoring TENSOR creation dependencies (weight init deps)
@@ -3298,9 +3444,17 @@ void Devicex::prepareGraph() {
           seqs.find(emplaceTask.name) != seqs.end()) {
         logging::devicex::trace("Adding sequences for task {}",
                                 emplaceTask.name);
+        bool skipped = skippedOnOverflowTasks.find(emplaceTask.name) !=
+                       skippedOnOverflowTasks.end();
         for (auto seq : seqs[emplaceTask.name]) {
-          // Emplace intermediate sequence in final sequence
-          seq.first->add(seq.second);
+          if (skipped) {
+            // Defer until the next Op which is not skipped
+            skippedSeqs[seq.first].add(seq.second);
+          } else {
+            // Emplace intermediate sequence in final sequence
+            emplaceSkippedSeq(seq.first);
+            seq.first->add(seq.second);
+          }
         }
         // Erase sequences for task, so that each tasks's sequences
         // are only added once.
@@ -3308,6 +3462,9 @@ void Devicex::prepareGraph() {
         taskOrder.push_back(emplaceTask.name);
       }
     }
+    while (!skippedSeqs.empty()) {
+      emplaceSkippedSeq(skippedSeqs.begin()->first);
+    }
   };
 
   // 1.) Create sequences and tensors
@@ -3554,6 +3711,28 @@ poplar::Executable Devicex::getExecutable() {
   }
 }
 
+void Devicex::recordConvPlan(const poplin::ConvParams &params,
+                             const poplar::OptionFlags &options) {
+  if (planningCaches->recordConv(params, options)) {
+    ++planningCacheStatistics.repeatedConvPlans;
+  } else {
+    ++planningCacheStatistics.newConvPlans;
+  }
+}
+
+void Devicex::recordMatMulPlan(const poplar::Type &inputType,
+                               const poplar::Type &outputType,
+                               const std::vector<std::size_t> &aShape,
+                               const std::vector<std::size_t> &bShape,
+                               const poplar::OptionFlags &options) {
+  if (planningCaches->recordMatMul(
+          inputType, outputType, aShape, bShape, options)) {
+    ++planningCacheStatistics.repeatedMatMulPlans;
+  } else {
+    ++planningCacheStatistics.newMatMulPlans;
+  }
+}
+
 std::string Devicex::getPoplarCachePath() {
   return ir().getSessionOptions().cachePath + ".poplar";
 }
@@ -3727,6 +3906,310 @@ PriTask Devicex::fromHostTask(Tensor *tensor,
           f};
 }
 
+PriTask
+Devicex::fromHostPackedOptimizerTask(poplar::program::Sequence &sq) {
+  // All optimizer tensors must exist, to know which IPUs they are on
+  std::vector<std::pair<TaskId, DependencyType>> deps;
+  for (auto tensor : ir().optimizerTensors()) {
+    deps.push_back({initTensorTaskId(tensor->id), DependencyType::Tensor});
+  }
+
+  auto f = [&sq, this]() {
+    SequenceMap seqs;
+
+    // Group the optimizer tensors by the IPU of their first tile, their data
+    // type and their replicated stream mode
+    using GroupKey =
+        std::tuple<unsigned, DataType, Tensor::ReplicatedStreamMode>;
+    std::map<GroupKey, std::vector<Tensor *>> groups;
+    auto tilesPerIPU = graph().getTarget().getTilesPerIPU();
+    for (auto tensor : ir().optimizerTensors()) {
+      auto mapping  = graph().getTileMapping(tensors.get(tensor->id));
+      unsigned tile = 0;
+      while (tile < mapping.size() && mapping.at(tile).empty()) {
+        ++tile;
+      }
+      groups[GroupKey{tile / tilesPerIPU,
+                      tensor->info.dataType(),
+                      tensor->getReplicatedStreamMode()}]
+          .push_back(tensor);
+    }
+
+    packedOptimizerStreams.clear();
+    for (auto &group : groups) {
+      auto ipu        = std::get<0>(group.first);
+      auto dataType   = std::get<1>(group.first);
+      auto streamMode = std::get<2>(group.first);
+
+      auto typeName   = TensorInfo(dataType, Shape{}).data_type_lcase();
+
+      PackedOptimizerStream packed;
+      packed.id = "packedOptimizer_ipu" + std::to_string(ipu) + "_" + typeName;
+      packed.dataType = dataType;
+      packed.tensors  = group.second;
+
+      std::vector<poplar::Tensor> dsts;
+      int64_t nelms  = 0;
+      int64_t nbytes = 0;
+      for (auto tensor : packed.tensors) {
+        dsts.push_back(tensors.get(tensor->id).flatten());
+        nelms += tensor->info.nelms();
+        nbytes += tensor->info.nbytes();
+      }
+      packed.buffer.resize(nbytes);
+
+      auto mode = streamMode == Tensor::ReplicatedStreamMode::Replicate
+                      ? poplar::ReplicatedStreamMode::REPLICATE
+                      : poplar::ReplicatedStreamMode::BROADCAST;
+      auto stream = graph().addHostToDeviceFIFO(
+          h2dId(packed.id), popType(dataType), nelms, mode);
+
+      logging::devicex::debug("Adding poplar::program::Copy from host {} to "
+                              "{} optimizer tensors",
+                              packed.id,
+                              packed.tensors.size());
+      seqs[&sq].add(
+          poplar::program::Copy(stream, poplar::concat(dsts), false));
+
+      packedOptimizerStreams.push_back(std::move(packed));
+    }
+    return seqs;
+  };
+
+  double priority = ir().getSessionOptions().groupHostSync
+                        ? std::numeric_limits<double>::max()
+                        : -1e6;
+  return {priority, fromHostPackedOptimizerTaskId(), deps, f};
+}
+
+TaskId Devicex::fromHostPackedOptimizerTaskId() const {
+  return "fromHostPackedOptimizerTask";
+}
+
+bool Devicex::packOptimizerStreams() const {
+  return ir().getSessionOptions().packOptimizerStreams &&
+         !ir().useSyntheticData();
+}
+
+PriTask Devicex::optimizerScheduleTask() {
+  // The optimizer tensors must have been written from the host
+  std::vector<std::pair<TaskId, DependencyType>> deps;
+  if (packOptimizerStreams()) {
+    deps.push_back(
+        {fromHostPackedOptimizerTaskId(), DependencyType::Scheduler});
+  }
+  for (auto tensor : ir().optimizerTensors()) {
+    deps.push_back({initTensorTaskId(tensor->id), DependencyType::Tensor});
+    if (!packOptimizerStreams()) {
+      deps.push_back({fromHostTaskId(tensor->id), DependencyType::Scheduler});
+    }
+  }
+  // The dynamic loss scaling is adjusted from the check of the gradients
+  if (ir().getSessionOptions().dynamicLossScalingSettings.enabled) {
+    deps.push_back(
+        taskWhichCreates(GradientOverflowCheckOp::getOverflowTensorId()));
+  }
+
+  auto f = [this]() {
+    SequenceMap seqs;
+    auto &opts      = ir().getSessionOptions();
+    auto &optimizer = ir().getOptimizer();
+    auto &dls       = opts.dynamicLossScalingSettings;
+
+    // Group the scheduled optimizer tensors by their data type and by how
+    // they depend on the schedules
+    using GroupKey = std::tuple<DataType, float, int, int>;
+    std::map<GroupKey, std::vector<poplar::Tensor>> groups;
+    for (auto tensor : ir().optimizerTensors()) {
+      auto dependence = optimizer.getScheduleDependence(tensor->id);
+      if (!opts.learningRateSchedule.enabled()) {
+        dependence.lrPower = 0;
+      }
+      if (!opts.lossScalingSchedule.enabled() && !dls.enabled) {
+        dependence.lsPower = 0;
+      }
+      if (dependence.lrPower != 0 || dependence.lsPower != 0) {
+        groups[GroupKey{tensor->info.dataType(),
+                        dependence.offset,
+                        dependence.lrPower,
+                        dependence.lsPower}]
+            .push_back(tensors.get(tensor->id).flatten());
+      }
+    }
+    if (groups.empty()) {
+      throw error("The optimizer schedules do not change any optimizer "
+                  "tensor. Only non-const learning rates and loss scaling "
+                  "can be scheduled.");
+    }
+
+    // The number of weight updates, and the factors of the schedules
+    auto step =
+        getScalarVariable(graph(), poplar::INT, "optimizerSchedule/step");
+    auto lrFactor =
+        getScalarVariable(graph(), poplar::FLOAT, "optimizerSchedule/lr");
+    auto lsFactor =
+        getScalarVariable(graph(), poplar::FLOAT, "optimizerSchedule/ls");
+    poputil::mapTensorLinearly(graph(), step);
+    poputil::mapTensorLinearly(graph(), lrFactor);
+    poputil::mapTensorLinearly(graph(), lsFactor);
+
+    poplar::program::Sequence evaluate;
+    auto t = pe::Cast(pe::_2, poplar::FLOAT);
+    popops::mapInPlace(graph(),
+                       getOptimizerScheduleExpr(opts.learningRateSchedule, t),
+                       {lrFactor, step},
+                       evaluate,
+                       "optimizerSchedule/evaluateLr");
+    popops::mapInPlace(graph(),
+                       getOptimizerScheduleExpr(opts.lossScalingSchedule, t),
+                       {lsFactor, step},
+                       evaluate,
+                       "optimizerSchedule/evaluateLs");
+
+    // The factor of the dynamic loss scaling, and the number of weight
+    // updates in a row without an overflow
+    poplar::Tensor dlsFactor;
+    poplar::Tensor dlsGoodSteps;
+    if (dls.enabled) {
+      dlsFactor =
+          getScalarVariable(graph(), poplar::FLOAT, "dynamicLossScaling/ls");
+      dlsGoodSteps =
+          getScalarVariable(graph(), poplar::INT, "dynamicLossScaling/steps");
+      poputil::mapTensorLinearly(graph(), dlsFactor);
+      poputil::mapTensorLinearly(graph(), dlsGoodSteps);
+      popops::mapInPlace(graph(),
+                         pe::Mul(pe::_1, pe::_2),
+                         {lsFactor, dlsFactor},
+                         evaluate,
+                         "dynamicLossScaling/evaluateLs");
+    }
+
+    // The values written from the host are kept as the values for factors
+    // of 1, from which the scheduled values are computed
+    poplar::program::Sequence rebase;
+    for (auto &group : groups) {
+      auto dataType = std::get<0>(group.first);
+      auto offset   = std::get<1>(group.first);
+      auto lrPower  = std::get<2>(group.first);
+      auto lsPower  = std::get<3>(group.first);
+
+      auto values = poplar::concat(group.second);
+      auto base =
+          graph().clone(poplar::FLOAT, values, "optimizerSchedule/base");
+      if (dataType == DataType::FLOAT) {
+        rebase.add(poplar::program::Copy(values, base));
+      } else {
+        rebase.add(poplar::program::Copy(
+            popops::cast(graph(), values, poplar::FLOAT, rebase), base));
+      }
+
+      // offset + (base - offset) * lr^lrPower * ls^lsPower
+      std::vector<poplar::Tensor> ins{values, base};
+      pe::Any value(pe::Sub(pe::_2, pe::Const(offset)));
+      auto applyPower = [&ins, &value](const poplar::Tensor &factor,
+                                       int power) {
+        if (power == 0) {
+          return;
+        }
+        ins.push_back(factor);
+        pe::PlaceHolder placeHolder(static_cast<unsigned>(ins.size()));
+        for (int i = 0; i < std::abs(power); ++i) {
+          if (power > 0) {
+            value = pe::Mul(value, placeHolder);
+          } else {
+            value = pe::Divide(value, placeHolder);
+          }
+        }
+      };
+      applyPower(lrFactor, lrPower);
+      applyPower(lsFactor, lsPower);
+      value = pe::Add(value, pe::Const(offset));
+      if (dataType != DataType::FLOAT) {
+        value = pe::Cast(value, popType(dataType));
+      }
+      popops::mapInPlace(
+          graph(), value, ins, evaluate, "optimizerSchedule/evaluate");
+
+      logging::devicex::debug("Scheduling {} optimizer tensors of type {}, "
+                              "lr^{} ls^{}",
+                              group.second.size(),
+                              dataType,
+                              lrPower,
+                              lsPower);
+    }
+
+    // Rebase when the optimizer is written from the host
+    auto &optimizerSeq = seqs[&progs.streamOptimizerFromHostFragment()];
+    optimizerSeq.add(rebase);
+    optimizerSeq.add(evaluate);
+
+    // Restart when the weights are written from the host
+    auto &weightsSeq = seqs[&progs.streamWeightsFromHostFragment()];
+    popops::zero(graph(), step, weightsSeq, "optimizerSchedule/restart");
+    if (dls.enabled) {
+      auto one = getConst(graph(), poplar::FLOAT, {}, 1.0, "one");
+      weightsSeq.add(poplar::program::Copy(one, dlsFactor));
+      popops::zero(
+          graph(), dlsGoodSteps, weightsSeq, "dynamicLossScaling/restart");
+    }
+    weightsSeq.add(evaluate);
+
+    // Step after every weight update
+    auto &stepSeq = seqs[&progs.optimizerScheduleFragment()];
+    if (dls.enabled) {
+      // Back off if the gradients overflowed, and grow after growthInterval
+      // weight updates in a row without an overflow
+      auto overflow =
+          tensors.get(GradientOverflowCheckOp::getOverflowTensorId());
+      auto interval = pe::Const(static_cast<int>(dls.growthInterval));
+      pe::Any grow(pe::Gte(pe::Add(pe::_2, pe::Const(1)), interval));
+      popops::mapInPlace(
+          graph(),
+          pe::Select(pe::Max(pe::Mul(pe::_1, pe::Const(dls.backoffFactor)),
+                             pe::Const(dls.minFactor)),
+                     pe::Select(pe::Min(pe::Mul(pe::_1,
+                                                pe::Const(dls.growthFactor)),
+                                        pe::Const(dls.maxFactor)),
+                                pe::_1,
+                                grow),
+                     pe::_3),
+          {dlsFactor, dlsGoodSteps, overflow},
+          stepSeq,
+          "dynamicLossScaling/update");
+      popops::mapInPlace(
+          graph(),
+          pe::Select(pe::Const(0),
+                     pe::Add(pe::_1, pe::Const(1)),
+                     pe::Or(pe::_2,
+                            pe::Gte(pe::Add(pe::_1, pe::Const(1)), interval))),
+          {dlsGoodSteps, overflow},
+          stepSeq,
+          "dynamicLossScaling/goodSteps");
+    }
+    popops::mapInPlace(graph(),
+                       pe::Add(pe::_1, pe::Const(1)),
+                       {step},
+                       stepSeq,
+                       "optimizerSchedule/step");
+    stepSeq.add(evaluate);
+
+    return seqs;
+  };
+
+  return {0, "optimizerScheduleTask", deps, f};
+}
+
+void Devicex::packOptimizerStreamBuffers() {
+  for (auto &packed : packedOptimizerStreams) {
+    auto dst = packed.buffer.data();
+    for (auto tensor : packed.tensors) {
+      auto nbytes = static_cast<size_t>(tensor->info.nbytes());
+      std::memcpy(dst, tensor->tensorData()->data(), nbytes);
+      dst += nbytes;
+    }
+  }
+}
+
 PriTask Devicex::toHostTask(Tensor *tensor,
                             poplar::program::Sequence &sq,
                             ToHostStreamType stype) const {
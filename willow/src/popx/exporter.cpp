@@ -14,6 +14,14 @@
 #include <ipu/poplar_executable_data.h>
 #endif
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+
 namespace popart {
 namespace popx {
 namespace {
@@ -68,30 +76,35 @@ void validateInfeedInfo(ipu::Metadata &meta,
   throw error("Couldn't find a feed named " + feedName + " in the metadata");
 }
 
-void exportFeedContent(ipu::FeedWriter &writer,
-                       const TensorInfo &feedInfo,
-                       int64_t numElements,
-                       IStepIO &step,
-                       const std::string &feedName) {
-  std::vector<int32_t> conversionBuffer;
-  for (int64_t n = 0; n < numElements; n++) {
-    if (n % 1000 == 0) {
-      logging::debug("Exporting {}/{} from {}", n, numElements, feedName);
-    }
-    ConstVoidData data = step.in(feedName, feedInfo.nelms(), false);
+// Read `count` elements of a feed from the IStepIO into the contiguous
+// buffer `dst`, converting them to the type of the feed if needed.
+void readFeedBatch(IStepIO &step,
+                   const TensorInfo &feedInfo,
+                   const std::string &feedName,
+                   int64_t first,
+                   int64_t count,
+                   char *dst) {
+  const int64_t nelms  = feedInfo.nelms();
+  const int64_t nbytes = feedInfo.nbytes();
+
+  for (int64_t n = 0; n < count; n++) {
+    ConstVoidData data = step.in(feedName, nelms, false);
 
     // check the shape
     if (data.info.shape() != feedInfo.shape()) {
       std::stringstream ss;
       ss << "The shape provided " << data.info.shape()
          << " didn't match the one expected " << feedInfo.shape()
-         << " for the input " << feedName << " (element " << n << ")";
+         << " for the input " << feedName << " (element " << first + n
+         << ")";
       throw error(ss.str());
     }
 
+    char *elementDst = dst + n * nbytes;
+
     // check the type
     if (data.info.dataType() == feedInfo.dataType()) {
-      writer.AppendTensor(data.data);
+      std::memcpy(elementDst, data.data, nbytes);
     } else if (data.info.dataType() == DataType::INT64 &&
                feedInfo.dataType() == DataType::INT32) {
 
@@ -102,15 +115,13 @@ void exportFeedContent(ipu::FeedWriter &writer,
                                feedName);
         loggingWarning = true;
       }
-      if (conversionBuffer.empty()) {
-        conversionBuffer.resize(feedInfo.nelms());
-      }
-      int32_t *dest      = conversionBuffer.data();
+      // A plain element-wise loop over contiguous buffers, which the
+      // compiler vectorises.
       const int64_t *src = static_cast<const int64_t *>(data.data);
-      for (int i = 0; i < feedInfo.nelms(); ++i) {
-        dest[i] = static_cast<int32_t>(src[i]);
-      }
-      writer.AppendTensor(conversionBuffer.data());
+      std::transform(src,
+                     src + nelms,
+                     reinterpret_cast<int32_t *>(elementDst),
+                     [](int64_t x) { return static_cast<int32_t>(x); });
     } else {
       std::stringstream ss;
       ss << "Type discrepency for tensor " << feedName
@@ -119,14 +130,119 @@ void exportFeedContent(ipu::FeedWriter &writer,
          << ". Consider a custom copy here (as memcpy cannot be used)";
       throw error(ss.str());
     }
-    step.inComplete(feedName, feedInfo.nelms());
+    step.inComplete(feedName, nelms);
   }
+}
+
+void exportFeedContent(ipu::FeedWriter &writer,
+                       const TensorInfo &feedInfo,
+                       int64_t numElements,
+                       IStepIO &step,
+                       const std::string &feedName,
+                       const StepIOExportOptions &options) {
+  const int64_t nbytes    = feedInfo.nbytes();
+  const int64_t batchSize = std::max<int64_t>(1, options.batchSize);
+
+  // Elements are read into one batch buffer while the other one is written
+  // to file on a background thread. The IStepIO is only ever called from this
+  // thread, as it may not be thread safe.
+  std::array<std::vector<char>, 2> batches;
+  std::future<void> pendingWrite;
+  size_t current = 0;
+
+  for (int64_t first = 0; first < numElements; first += batchSize) {
+    const int64_t count = std::min(batchSize, numElements - first);
+    auto &batch         = batches[current];
+    batch.resize(count * nbytes);
+
+    readFeedBatch(step, feedInfo, feedName, first, count, batch.data());
+
+    if (pendingWrite.valid()) {
+      pendingWrite.get();
+    }
+    pendingWrite =
+        std::async(std::launch::async, [&writer, &batch, count, nbytes]() {
+          for (int64_t n = 0; n < count; n++) {
+            writer.AppendTensor(batch.data() + n * nbytes);
+          }
+        });
+    current = (current + 1) % batches.size();
+
+    logging::debug(
+        "Exporting {}/{} from {}", first + count, numElements, feedName);
+  }
+
+  if (pendingWrite.valid()) {
+    pendingWrite.get();
+  }
+
   logging::info("Successfully exported {}/{} from {}",
                 numElements,
                 numElements,
                 feedName);
 }
 
+// Read and discard elements of a feed, used to skip over chunks that have
+// already been exported.
+void skipFeedContent(IStepIO &step,
+                     const TensorInfo &feedInfo,
+                     int64_t numElements,
+                     const std::string &feedName) {
+  for (int64_t n = 0; n < numElements; n++) {
+    step.in(feedName, feedInfo.nelms(), false);
+    step.inComplete(feedName, feedInfo.nelms());
+  }
+  logging::info("Skipped {} already exported element(s) from {}",
+                numElements,
+                feedName);
+}
+
+// Export `numElements` elements of every feed, to one file or to several
+// chunk files depending on `options`. `writeFeeds` writes the given number of
+// elements of all feeds to a file, `skipFeeds` consumes them from the
+// IStepIO without writing them.
+void exportChunks(
+    int64_t numElements,
+    const std::string &outputFilename,
+    const StepIOExportOptions &options,
+    const std::function<void(ipu::BinaryWriter &, int64_t)> &writeFeeds,
+    const std::function<void(int64_t)> &skipFeeds) {
+
+  if (options.elementsPerChunk <= 0) {
+    ipu::BinaryWriter file(outputFilename);
+    writeFeeds(file, numElements);
+    file.Close();
+    return;
+  }
+
+  int64_t chunk = 0;
+  for (int64_t first = 0; first < numElements;
+       first += options.elementsPerChunk, chunk++) {
+    const int64_t count =
+        std::min(options.elementsPerChunk, numElements - first);
+    const std::string filename = outputFilename + "." + std::to_string(chunk);
+
+    if (options.resume && std::ifstream(filename).good()) {
+      logging::info("Chunk {} already exists, skipping", filename);
+      skipFeeds(count);
+      continue;
+    }
+
+    // Write to a temporary file first so that an interrupted export never
+    // leaves a chunk behind that would be skipped when resuming.
+    const std::string tmpFilename = filename + ".tmp";
+    {
+      ipu::BinaryWriter file(tmpFilename);
+      writeFeeds(file, count);
+      file.Close();
+    }
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+      throw error("Failed to rename {} to {}", tmpFilename, filename);
+    }
+    logging::info("Exported chunk {} ({} element(s))", filename, count);
+  }
+}
+
 ipu::MetadataBuilder
 createBuilderAndExportWeights(const Devicex &device,
                               const std::string *weightsPath = nullptr) {
@@ -165,8 +281,33 @@ createBuilderAndExportWeights(const Devicex &device,
     }
   }
 
-  // Adding optimizers as inputs
-  for (auto tensor : device.ir().optimizerTensors()) {
+  // Adding packed optimizer streams as inputs
+  for (auto &packed : device.getPackedOptimizerStreams()) {
+    int64_t nelms = 0;
+    std::vector<char> data;
+    for (auto tensor : packed.tensors) {
+      auto begin = static_cast<const char *>(tensor->tensorData()->data());
+      data.insert(data.end(), begin, begin + tensor->info.nbytes());
+      nelms += tensor->info.nelms();
+    }
+    ipu::TensorInfo info;
+    info.SetHandle(device.h2dId(packed.id));
+    info.SetName(packed.id);
+    setIpuShape(info, TensorInfo(packed.dataType, Shape{nelms}));
+    builder.AddInput(info);
+    if (weights_writer) {
+      info.SetType(ipu::TensorType::InputData);
+      ipu::Tensor out{info, data.data()};
+      weights_writer->WriteTensor(out);
+    }
+  }
+
+  // Adding the optimizers which are not packed as inputs
+  std::vector<Tensor *> optimizerTensors;
+  if (device.getPackedOptimizerStreams().empty()) {
+    optimizerTensors = device.ir().optimizerTensors();
+  }
+  for (auto tensor : optimizerTensors) {
     ipu::TensorInfo info;
     info.SetHandle(device.h2dId(tensor->id));
     info.SetName(tensor->id);
@@ -282,11 +423,11 @@ void exportStepIO(Builder &builder,
                   int64_t numElements,
                   const std::vector<std::string> &feeds,
                   const std::string &outputFilename,
-                  const std::string &metadataFilename) {
+                  const std::string &metadataFilename,
+                  const StepIOExportOptions &options) {
 #ifndef POPLAR_RUNNER
   throw error(errorMsg, "export an IStepIO");
 #else  // POPLAR_RUNNER
-  ipu::BinaryWriter file(outputFilename);
   std::unique_ptr<ipu::Metadata> meta;
   if (!metadataFilename.empty()) {
     if (ipu::IsJsonFile(metadataFilename)) {
@@ -298,6 +439,9 @@ void exportStepIO(Builder &builder,
       meta = loader.ReadMetadata();
     }
   }
+
+  std::map<std::string, TensorInfo> feedInfos;
+  std::map<std::string, ipu::TensorInfo> ipuInfos;
   for (const std::string &feed : feeds) {
     TensorInfo feedInfo{builder.getTensorDataType(feed),
                         builder.getTensorShape(feed)};
@@ -306,34 +450,52 @@ void exportStepIO(Builder &builder,
     ipuInfo.SetType(ipu::TensorType::Infeed);
     setIpuShape(ipuInfo, feedInfo);
 
-    ipu::FeedWriter writer = file.CreateFeed(feed, ipuInfo, numElements);
     if (meta) {
       validateInfeedInfo(*meta, feed, ipuInfo);
     }
-    exportFeedContent(writer, feedInfo, numElements, step, feed);
+    feedInfos.emplace(feed, feedInfo);
+    ipuInfos.emplace(feed, ipuInfo);
   }
-  file.Close();
+
+  auto writeFeeds = [&](ipu::BinaryWriter &file, int64_t count) {
+    for (const std::string &feed : feeds) {
+      ipu::FeedWriter writer = file.CreateFeed(feed, ipuInfos.at(feed), count);
+      exportFeedContent(writer, feedInfos.at(feed), count, step, feed, options);
+    }
+  };
+  auto skipFeeds = [&](int64_t count) {
+    for (const std::string &feed : feeds) {
+      skipFeedContent(step, feedInfos.at(feed), count, feed);
+    }
+  };
+  exportChunks(numElements, outputFilename, options, writeFeeds, skipFeeds);
 #endif // POPLAR_RUNNER
 }
 
 void exportStepIO(IStepIO &step,
                   const Devicex &device,
                   int64_t numElements,
-                  const std::string &outputFilename) {
+                  const std::string &outputFilename,
+                  const StepIOExportOptions &options) {
 #ifndef POPLAR_RUNNER
   throw error(errorMsg, "export an IStepIO");
 #else  // POPLAR_RUNNER
-  ipu::BinaryWriter file(outputFilename);
-  for (Tensor *tensor : device.ir().dataStreamTensors()) {
-    ipu::TensorInfo info;
-    info.SetName(tensor->id);
-    info.SetType(ipu::TensorType::Infeed);
-    setIpuShape(info, tensor->info);
-    std::vector<int32_t> conversionBuffer;
-    ipu::FeedWriter writer = file.CreateFeed(info.Name(), info, numElements);
-    exportFeedContent(writer, tensor->info, numElements, step, tensor->id);
-  }
-  file.Close();
+  auto writeFeeds = [&](ipu::BinaryWriter &file, int64_t count) {
+    for (Tensor *tensor : device.ir().dataStreamTensors()) {
+      ipu::TensorInfo info;
+      info.SetName(tensor->id);
+      info.SetType(ipu::TensorType::Infeed);
+      setIpuShape(info, tensor->info);
+      ipu::FeedWriter writer = file.CreateFeed(info.Name(), info, count);
+      exportFeedContent(writer, tensor->info, count, step, tensor->id, options);
+    }
+  };
+  auto skipFeeds = [&](int64_t count) {
+    for (Tensor *tensor : device.ir().dataStreamTensors()) {
+      skipFeedContent(step, tensor->info, count, tensor->id);
+    }
+  };
+  exportChunks(numElements, outputFilename, options, writeFeeds, skipFeeds);
 #endif // POPLAR_RUNNER
 }
 
@@ -18,21 +18,17 @@ namespace pe = popops::expr;
 namespace popart {
 namespace popx {
 
-AdamUpdaterOpx::AdamUpdaterOpx(Op *op, Devicex *devicex) : Opx(op, devicex) {
-  verifyOp<AdamUpdaterOp>(op, Onnx::CustomOperators::AdamUpdater);
-}
-
-void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
-  auto adamUpdaterOp = getOp<AdamUpdaterOp>();
-
-  poplar::Tensor var   = getInTensor(AdamUpdaterOp::getVarInIndex());
-  poplar::Tensor accl1 = getInTensor(AdamUpdaterOp::getAccl1InIndex());
-  poplar::Tensor accl2 = getInTensor(AdamUpdaterOp::getAccl2InIndex());
-  poplar::Tensor step  = getInTensor(AdamUpdaterOp::getStepInIndex());
-
-  // Update step
-  popops::mapInPlace(graph(), pe::Add(pe::_1, pe::Const(1)), {step}, prog);
-
+poplar::Tensor growAdamUpdater(const Opx &opx,
+                               AdamMode mode,
+                               const OptimizerValue &initWd,
+                               const OptimizerValue &initB1,
+                               const OptimizerValue &initB2,
+                               const OptimizerValue &initEps,
+                               const poplar::Tensor &var,
+                               const poplar::Tensor &accl1,
+                               const poplar::Tensor &accl2,
+                               const poplar::Tensor &step,
+                               poplar::program::Sequence &prog) {
   // Calculate updater term for both const & tensor optimizer parameters
   std::vector<poplar::Tensor> tensors{var, accl1, accl2, step};
 
@@ -43,16 +39,15 @@ void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
   pe::Any vhat(pe::Const(0.0f));
 
   // With bias correction
-  if (adamUpdaterOp.mode == AdamMode::Adam ||
-      adamUpdaterOp.mode == AdamMode::Lamb) {
+  if (mode == AdamMode::Adam || mode == AdamMode::Lamb) {
     // b1correction: (1 - b_1^t)
-    if (adamUpdaterOp.initB1.isConst()) {
+    if (initB1.isConst()) {
       b1correction =
           pe::Sub(pe::Const(1.0f),
-                  pe::Pow(pe::Const(adamUpdaterOp.initB1.val()),
+                  pe::Pow(pe::Const(initB1.val()),
                           pe::Cast(pe::PlaceHolder(4), poplar::FLOAT)));
     } else {
-      tensors.push_back(getInTensor(AdamUpdaterOp::getBeta1InIndex()));
+      tensors.push_back(opx.getInTensor(AdamUpdaterOp::getBeta1InIndex()));
       b1correction =
           pe::Sub(pe::Const(1.0f),
                   pe::Pow(pe::PlaceHolder(tensors.size()),
@@ -60,13 +55,13 @@ void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
     }
 
     // b2correction: (1 - b_2^t)
-    if (adamUpdaterOp.initB2.isConst()) {
+    if (initB2.isConst()) {
       b2correction =
           pe::Sub(pe::Const(1.0f),
-                  pe::Pow(pe::Const(adamUpdaterOp.initB2.val()),
+                  pe::Pow(pe::Const(initB2.val()),
                           pe::Cast(pe::PlaceHolder(4), poplar::FLOAT)));
     } else {
-      tensors.push_back(getInTensor(AdamUpdaterOp::getBeta2InIndex()));
+      tensors.push_back(opx.getInTensor(AdamUpdaterOp::getBeta2InIndex()));
       b2correction =
           pe::Sub(pe::Const(1.0f),
                   pe::Pow(pe::PlaceHolder(tensors.size()),
@@ -86,12 +81,11 @@ void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
   vhat = pe::Divide(pe::PlaceHolder(3), b2correction);
 
   // Update term (without weight decay) -> mhat/(sqrt(vhat) + eps)
-  if (adamUpdaterOp.initEps.isConst()) {
-    expr = pe::Divide(
-        pe::Cast(mhat, accl2.elementType()),
-        pe::Add(pe::Sqrt(vhat), pe::Const(adamUpdaterOp.initEps.val())));
+  if (initEps.isConst()) {
+    expr = pe::Divide(pe::Cast(mhat, accl2.elementType()),
+                      pe::Add(pe::Sqrt(vhat), pe::Const(initEps.val())));
   } else {
-    tensors.push_back(getInTensor(AdamUpdaterOp::getEpsInIndex()));
+    tensors.push_back(opx.getInTensor(AdamUpdaterOp::getEpsInIndex()));
     expr = pe::Divide(pe::Cast(mhat, accl2.elementType()),
                       pe::Add(pe::Sqrt(vhat),
                               pe::Cast(pe::PlaceHolder(tensors.size()),
@@ -99,26 +93,53 @@ void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
   }
 
   // AdamW (weight decay)
-  if (adamUpdaterOp.initWd.isConst()) {
-    if (adamUpdaterOp.initWd.val() == 0.0f) {
+  if (initWd.isConst()) {
+    if (initWd.val() == 0.0f) {
       // No weight decay, expr stays unchanged
     } else {
       // Constant weight decay
-      expr = pe::Add(
-          pe::Cast(expr, var.elementType()),
-          pe::Mul(pe::Const(adamUpdaterOp.initWd.val()), pe::PlaceHolder(1)));
+      expr = pe::Add(pe::Cast(expr, var.elementType()),
+                     pe::Mul(pe::Const(initWd.val()), pe::PlaceHolder(1)));
     }
   } else {
     // Non-const weight decay
-    tensors.push_back(getInTensor(AdamUpdaterOp::getWdInIndex()));
+    tensors.push_back(opx.getInTensor(AdamUpdaterOp::getWdInIndex()));
     expr = pe::Add(
         pe::Cast(expr, var.elementType()),
         pe::Mul(pe::Cast(pe::PlaceHolder(tensors.size()), var.elementType()),
                 pe::PlaceHolder(1)));
   }
 
-  poplar::Tensor updater =
-      popops::map(graph(), pe::Cast(expr, var.elementType()), tensors, prog);
+  return popops::map(
+      opx.graph(), pe::Cast(expr, var.elementType()), tensors, prog);
+}
+
+AdamUpdaterOpx::AdamUpdaterOpx(Op *op, Devicex *devicex) : Opx(op, devicex) {
+  verifyOp<AdamUpdaterOp>(op, Onnx::CustomOperators::AdamUpdater);
+}
+
+void AdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
+  auto adamUpdaterOp = getOp<AdamUpdaterOp>();
+
+  poplar::Tensor var   = getInTensor(AdamUpdaterOp::getVarInIndex());
+  poplar::Tensor accl1 = getInTensor(AdamUpdaterOp::getAccl1InIndex());
+  poplar::Tensor accl2 = getInTensor(AdamUpdaterOp::getAccl2InIndex());
+  poplar::Tensor step  = getInTensor(AdamUpdaterOp::getStepInIndex());
+
+  // Update step
+  popops::mapInPlace(graph(), pe::Add(pe::_1, pe::Const(1)), {step}, prog);
+
+  poplar::Tensor updater = growAdamUpdater(*this,
+                                           adamUpdaterOp.mode,
+                                           adamUpdaterOp.initWd,
+                                           adamUpdaterOp.initB1,
+                                           adamUpdaterOp.initB2,
+                                           adamUpdaterOp.initEps,
+                                           var,
+                                           accl1,
+                                           accl2,
+                                           step,
+                                           prog);
 
   if (hasInViewChangers(AdamUpdaterOp::getVarInIndex())) {
     setOutViewChangers(AdamUpdaterOp::getUpdaterOutIndex(),
@@ -15,6 +15,20 @@ namespace pe = popops::expr;
 namespace popart {
 namespace popx {
 
+pe::Any getLambLearningRate(const pe::Any &lr,
+                            const pe::Any &r1sq,
+                            const pe::Any &r2sq,
+                            const pe::Any &mwn) {
+  return pe::Mul(
+      lr,
+      pe::Select(pe::Const(1.0f),
+                 pe::Select(pe::Const(1.0f),
+                            pe::Divide(pe::Min(pe::Sqrt(r1sq), mwn),
+                                       pe::Sqrt(r2sq)),
+                            pe::Equal(r2sq, pe::Const(0.0f))),
+                 pe::Equal(r1sq, pe::Const(0.0f))));
+}
+
 AdamVarUpdateOpx::AdamVarUpdateOpx(Op *op, Devicex *devicex)
     : VarUpdateOpx(op, devicex) {
   verifyOp<AdamVarUpdateOp>(op, Onnx::CustomOperators::AdamVarUpdate);
@@ -58,16 +72,8 @@ void AdamVarUpdateOpx::grow(poplar::program::Sequence &prog) const {
       mwn = pe::PlaceHolder(tensors.size());
     }
 
-    lr = pe::Mul(
-        lr,
-        pe::Select(
-            pe::Const(1.0f),
-            pe::Select(
-                pe::Const(1.0f),
-                pe::Divide(pe::Min(pe::Sqrt(pe::PlaceHolder(r1sqindex)), mwn),
-                           pe::Sqrt(pe::PlaceHolder(r2sqindex))),
-                pe::Equal(pe::PlaceHolder(r2sqindex), pe::Const(0.0f))),
-            pe::Equal(pe::PlaceHolder(r1sqindex), pe::Const(0.0f))));
+    lr = getLambLearningRate(
+        lr, pe::PlaceHolder(r1sqindex), pe::PlaceHolder(r2sqindex), mwn);
   }
 
   if (tensors.size() == 0) {
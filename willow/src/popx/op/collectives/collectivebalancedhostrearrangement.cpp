@@ -0,0 +1,129 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <popart/error.hpp>
+#include <popart/popx/op/collectives/collectivebalancedhostrearrangement.hpp>
+
+namespace popart {
+namespace popx {
+
+constexpr int64_t CollectiveBalancedHostRearrangement::minBytesPerThread;
+
+CollectiveBalancedHostRearrangement::CollectiveBalancedHostRearrangement(
+    const std::vector<HostRearrangementSegment> &segments_,
+    unsigned maxThreads_)
+    : maxThreads(maxThreads_) {
+  for (auto &s : segments_) {
+    if (s.offset < 0 || s.rearrangedOffset < 0 || s.size < 0) {
+      throw error("Invalid host rearrangement segment (offset {}, rearranged "
+                  "offset {}, size {})",
+                  s.offset,
+                  s.rearrangedOffset,
+                  s.size);
+    }
+    if (s.size == 0) {
+      continue;
+    }
+    if (!segments.empty() &&
+        segments.back().offset + segments.back().size == s.offset &&
+        segments.back().rearrangedOffset + segments.back().size ==
+            s.rearrangedOffset) {
+      // Contiguous in both tensors: one larger memcpy
+      segments.back().size += s.size;
+      cumulativeSizes.back() += s.size;
+    } else {
+      segments.push_back(s);
+      cumulativeSizes.push_back(getNumElems() + s.size);
+    }
+  }
+}
+
+unsigned
+CollectiveBalancedHostRearrangement::getNumThreads(int64_t elemByteSize) const {
+  int64_t numThreads = maxThreads;
+  if (numThreads == 0) {
+    numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  int64_t numBytes = getNumElems() * elemByteSize;
+  numThreads       = std::min(numThreads, numBytes / minBytesPerThread);
+  return static_cast<unsigned>(std::max<int64_t>(numThreads, 1));
+}
+
+void CollectiveBalancedHostRearrangement::copyRange(const char *in,
+                                                    char *out,
+                                                    int64_t elemByteSize,
+                                                    bool forCollective,
+                                                    int64_t begin,
+                                                    int64_t end) const {
+  // The first segment which ends after begin
+  auto it =
+      std::upper_bound(cumulativeSizes.begin(), cumulativeSizes.end(), begin);
+  size_t index = std::distance(cumulativeSizes.begin(), it);
+
+  while (begin < end) {
+    auto &s              = segments[index];
+    int64_t segmentBegin = cumulativeSizes[index] - s.size;
+    int64_t skip         = begin - segmentBegin;
+    int64_t size         = std::min(cumulativeSizes[index], end) - begin;
+
+    int64_t inOff  = s.offset + skip;
+    int64_t outOff = s.rearrangedOffset + skip;
+    if (!forCollective) {
+      std::swap(inOff, outOff);
+    }
+
+    std::memcpy(out + outOff * elemByteSize,
+                in + inOff * elemByteSize,
+                size * elemByteSize);
+
+    begin += size;
+    ++index;
+  }
+}
+
+void CollectiveBalancedHostRearrangement::rearrange(const char *in,
+                                                    char *out,
+                                                    int64_t elemByteSize,
+                                                    bool forCollective) const {
+  int64_t numElems    = getNumElems();
+  unsigned numThreads = getNumThreads(elemByteSize);
+
+  if (numThreads == 1) {
+    copyRange(in, out, elemByteSize, forCollective, 0, numElems);
+    return;
+  }
+
+  // The segments do not overlap, so each thread copies an equally sized
+  // range of them, splitting segments at the range boundaries
+  std::vector<std::thread> workers;
+  workers.reserve(numThreads - 1);
+  for (unsigned i = 1; i < numThreads; ++i) {
+    int64_t begin = numElems * i / numThreads;
+    int64_t end   = numElems * (i + 1) / numThreads;
+    workers.emplace_back([=]() {
+      copyRange(in, out, elemByteSize, forCollective, begin, end);
+    });
+  }
+  copyRange(in, out, elemByteSize, forCollective, 0, numElems / numThreads);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void CollectiveBalancedHostRearrangement::rearrangeForCollective(
+    const char *in,
+    char *out,
+    int64_t elemByteSize) const {
+  rearrange(in, out, elemByteSize, true);
+}
+
+void CollectiveBalancedHostRearrangement::undoRearrangeForCollective(
+    const char *in,
+    char *out,
+    int64_t elemByteSize) const {
+  rearrange(in, out, elemByteSize, false);
+}
+
+} // namespace popx
+} // namespace popart
@@ -118,6 +118,51 @@ CollectiveBalancedReorder::CollectiveBalancedReorder(
   }
   numRearrangedTensorElems =
       reordering.back().rearranged_offset + reordering.back().size;
+
+  auto reorder = reordering;
+
+  // Sort by start offset in the simplified tensor
+  std::sort(reorder.begin(),
+            reorder.end(),
+            [](const ReorderMetadata &a, const ReorderMetadata &b) {
+              return a.offset < b.offset;
+            });
+
+  // Offsets in the original tensor, sorted by the simplified tensor order
+  auto intervals = graph.getSortedContiguousRegions(
+      simplifyProxy, graph.getTileMapping(simplifyProxy)[0])[0];
+
+  int64_t intervalIndex  = 0;
+  int64_t intervalOffset = 0;
+
+  std::vector<HostRearrangementSegment> segments;
+  for (auto &r : reorder) {
+    if (r.offset > -1) {
+      // Translate offset in the simplifed tensor (ostart) to offset in the
+      // original input tensor (osstart)
+      int64_t copiedOffset = 0;
+      while (copiedOffset < r.size) {
+        auto currentInterval = intervals[intervalIndex];
+        int64_t osstart      = currentInterval.begin();
+        int64_t intervalSize = currentInterval.size();
+        int64_t size =
+            std::min(intervalSize - intervalOffset, r.size - copiedOffset);
+
+        segments.emplace_back(osstart + intervalOffset,
+                              r.rearranged_offset + copiedOffset,
+                              size);
+
+        copiedOffset += size;
+        intervalOffset += size;
+        if (intervalOffset == currentInterval.size()) {
+          // Next proxy interval
+          ++intervalIndex;
+          intervalOffset = 0;
+        }
+      }
+    }
+  }
+  hostRearrangement = CollectiveBalancedHostRearrangement(segments);
 }
 
 poplar::Tensor
@@ -200,76 +245,18 @@ poplar::Tensor CollectiveBalancedReorder::undoRearrangeForCollective(
   return concatResult;
 }
 
-void CollectiveBalancedReorder::rearrange(const char *in,
-                                          char *out,
-                                          int64_t elemByteSize,
-                                          bool forCollective) const {
-  auto reorder = reordering;
-
-  // Sort by start offset in the original tensor
-  std::sort(reorder.begin(),
-            reorder.end(),
-            [](const ReorderMetadata &a, const ReorderMetadata &b) {
-              return a.offset < b.offset;
-            });
-
-  // Offsets in the original tensor, sorted by the simplified tensor order
-  auto intervals = graph.getSortedContiguousRegions(
-      simplifyProxy, graph.getTileMapping(simplifyProxy)[0])[0];
-
-  int64_t intervalIndex  = 0;
-  int64_t intervalOffset = 0;
-
-  for (auto &r : reorder) {
-    if (r.offset > -1) {
-      // Translate offset in the simplifed tensor (ostart) to offset in the
-      // original input tensor (osstart)
-      int64_t copiedOffset = 0;
-      while (copiedOffset < r.size) {
-        auto currentInterval = intervals[intervalIndex];
-        int64_t osstart      = currentInterval.begin();
-        int64_t intervalSize = currentInterval.size();
-        int64_t size =
-            std::min(intervalSize - intervalOffset, r.size - copiedOffset);
-
-        int64_t inOff;
-        int64_t outOff;
-        if (forCollective) {
-          inOff  = (osstart + intervalOffset) * elemByteSize;
-          outOff = (r.rearranged_offset + copiedOffset) * elemByteSize;
-        } else {
-          outOff = (osstart + intervalOffset) * elemByteSize;
-          inOff  = (r.rearranged_offset + copiedOffset) * elemByteSize;
-        }
-
-        auto byteSize = size * elemByteSize;
-
-        std::memcpy(out + outOff, in + inOff, byteSize);
-
-        copiedOffset += size;
-        intervalOffset += size;
-        if (intervalOffset == currentInterval.size()) {
-          // Next proxy interval
-          ++intervalIndex;
-          intervalOffset = 0;
-        }
-      }
-    }
-  }
-}
-
 void CollectiveBalancedReorder::rearrangeForCollective(
     const char *in,
     char *out,
     int64_t elemByteSize) const {
-  rearrange(in, out, elemByteSize, true);
+  hostRearrangement.rearrangeForCollective(in, out, elemByteSize);
 }
 
 void CollectiveBalancedReorder::undoRearrangeForCollective(
     const char *in,
     char *out,
     int64_t elemByteSize) const {
-  rearrange(in, out, elemByteSize, false);
+  hostRearrangement.undoRearrangeForCollective(in, out, elemByteSize);
 }
 
 poplar::Tensor
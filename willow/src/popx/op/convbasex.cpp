@@ -156,6 +156,8 @@ void MultiConvBaseOpx::grow(poplar::program::Sequence &prog) const {
                                                  params);
     allWeights.push_back(weights5D);
 
+    dv_p->recordConvPlan(getPoplarConvParams(params), getConvOptions(i));
+
     // Log the report plan
     std::stringstream ss;
     poplin::reportPlanInfo(ss,
@@ -0,0 +1,225 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popart/broadcastutil.hpp>
+#include <popart/error.hpp>
+#include <popart/op/fusedelementwise.hpp>
+#include <popart/popx/devicex.hpp>
+#include <popart/popx/op/fusedelementwisex.hpp>
+#include <popart/popx/opxmanager.hpp>
+#include <popart/util.hpp>
+
+#include <popops/ElementWise.hpp>
+
+namespace pe = popops::expr;
+
+namespace popart {
+namespace popx {
+
+namespace {
+
+std::unique_ptr<pe::Expr> unaryExpr(pe::UnaryOpType type, const pe::Expr &a) {
+  return std::make_unique<pe::UnaryOp>(type, a);
+}
+
+std::unique_ptr<pe::Expr>
+binaryExpr(pe::BinaryOpType type, const pe::Expr &a, const pe::Expr &b) {
+  return std::make_unique<pe::BinaryOp>(type, a, b);
+}
+
+// The expression of one step, on its operands a and b
+std::unique_ptr<pe::Expr> stepExpr(const FusedElementwiseStep &step,
+                                   const pe::Expr &a,
+                                   const pe::Expr *b) {
+  using Type = FusedElementwiseStep::Type;
+  switch (step.type) {
+  case Type::Add:
+    return binaryExpr(pe::BinaryOpType::ADD, a, *b);
+  case Type::Sub:
+    return binaryExpr(pe::BinaryOpType::SUBTRACT, a, *b);
+  case Type::Mul:
+    return binaryExpr(pe::BinaryOpType::MULTIPLY, a, *b);
+  case Type::Div:
+    return binaryExpr(pe::BinaryOpType::DIVIDE, a, *b);
+  case Type::Neg:
+    return unaryExpr(pe::UnaryOpType::NEGATE, a);
+  case Type::Exp:
+    return unaryExpr(pe::UnaryOpType::EXPONENT, a);
+  case Type::Log:
+    return unaryExpr(pe::UnaryOpType::LOGARITHM, a);
+  case Type::Sqrt:
+    return unaryExpr(pe::UnaryOpType::SQRT, a);
+  case Type::Abs:
+    return unaryExpr(pe::UnaryOpType::ABSOLUTE, a);
+  case Type::Sigmoid:
+    return unaryExpr(pe::UnaryOpType::SIGMOID, a);
+  case Type::Tanh:
+    return unaryExpr(pe::UnaryOpType::TANH, a);
+  case Type::Sin:
+    return unaryExpr(pe::UnaryOpType::SIN, a);
+  case Type::Cos:
+    return unaryExpr(pe::UnaryOpType::COS, a);
+  case Type::Reciprocal:
+    return unaryExpr(pe::UnaryOpType::INVERSE, a);
+  case Type::Square:
+    return unaryExpr(pe::UnaryOpType::SQUARE, a);
+  case Type::Relu:
+    return binaryExpr(pe::BinaryOpType::MAXIMUM, a, pe::Const(0.0f));
+  case Type::Scale:
+    return binaryExpr(
+        pe::BinaryOpType::MULTIPLY, a, pe::Const(step.scaleFactor));
+  case Type::Gelu: {
+    // The tanh approximation, as popnn::NonLinearityType::GELU:
+    // 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+    auto cube  = binaryExpr(pe::BinaryOpType::MULTIPLY,
+                           a,
+                           *unaryExpr(pe::UnaryOpType::SQUARE, a));
+    auto inner = binaryExpr(
+        pe::BinaryOpType::ADD,
+        a,
+        *binaryExpr(pe::BinaryOpType::MULTIPLY, pe::Const(0.044715f), *cube));
+    auto tanhExpr = unaryExpr(
+        pe::UnaryOpType::TANH,
+        *binaryExpr(
+            pe::BinaryOpType::MULTIPLY, pe::Const(0.7978845608f), *inner));
+    return binaryExpr(
+        pe::BinaryOpType::MULTIPLY,
+        *binaryExpr(pe::BinaryOpType::MULTIPLY, pe::Const(0.5f), a),
+        *binaryExpr(pe::BinaryOpType::ADD, pe::Const(1.0f), *tanhExpr));
+  }
+  case Type::SigmoidGrad:
+    // grad * y * (1 - y)
+    return binaryExpr(
+        pe::BinaryOpType::MULTIPLY,
+        *binaryExpr(pe::BinaryOpType::MULTIPLY, a, *b),
+        *binaryExpr(pe::BinaryOpType::SUBTRACT, pe::Const(1.0f), *b));
+  case Type::TanhGrad:
+    // grad * (1 - y^2)
+    return binaryExpr(
+        pe::BinaryOpType::MULTIPLY,
+        a,
+        *binaryExpr(pe::BinaryOpType::SUBTRACT,
+                    pe::Const(1.0f),
+                    *unaryExpr(pe::UnaryOpType::SQUARE, *b)));
+  case Type::ReluGrad:
+    // grad where y > 0, else 0
+    return std::make_unique<pe::TernaryOp>(
+        pe::TernaryOpType::SELECT,
+        a,
+        pe::Const(0.0f),
+        *binaryExpr(pe::BinaryOpType::GREATER_THAN, *b, pe::Const(0.0f)));
+  }
+  throw error("Unsupported FusedElementwiseStep::Type {}", step.type);
+}
+
+} // namespace
+
+FusedElementwiseOpx::FusedElementwiseOpx(Op *op, Devicex *devicex)
+    : Opx(op, devicex) {
+  verifyOp<FusedElementwiseOp>(
+      op,
+      {Onnx::CustomOperators::FusedElementwise,
+       Onnx::CustomOperators::FusedElementwiseInplace});
+}
+
+std::unique_ptr<pe::Expr> FusedElementwiseOpx::getExpression() const {
+  auto &steps = dynamic_cast<FusedElementwiseOp *>(op_p)->getSteps();
+
+  std::vector<pe::PlaceHolder> placeholders;
+  for (int i = 0; i < op_p->input->n(); ++i) {
+    placeholders.emplace_back(i + 1);
+  }
+
+  std::vector<std::unique_ptr<pe::Expr>> results;
+  auto getOperand = [&placeholders, &results](int operand) -> pe::Expr * {
+    if (operand >= 0) {
+      return &placeholders.at(operand);
+    } else {
+      return results.at(-(operand + 1)).get();
+    }
+  };
+
+  for (auto &step : steps) {
+    pe::Expr *a = getOperand(step.operands.at(0));
+    pe::Expr *b =
+        step.operands.size() > 1 ? getOperand(step.operands.at(1)) : nullptr;
+    results.push_back(stepExpr(step, *a, b));
+  }
+
+  return std::move(results.back());
+}
+
+std::vector<poplar::Tensor> FusedElementwiseOpx::getBroadcastInputs() const {
+  const auto shape = vXtoY<int64_t, std::size_t>(
+      outShape(FusedElementwiseOp::getOutIndex()));
+
+  std::vector<poplar::Tensor> inputs;
+  for (InIndex i = 0; i < op_p->input->n(); ++i) {
+    auto t = getInTensor(i);
+    t      = t.reshape(padShape(t.shape(), shape.size(), std::size_t{1}));
+    for (unsigned dim = 0; dim < shape.size(); ++dim) {
+      if (t.dim(dim) == 1 && shape[dim] != 1) {
+        t = t.broadcast(static_cast<unsigned>(shape[dim]), dim);
+      }
+    }
+    inputs.push_back(t);
+  }
+  return inputs;
+}
+
+void FusedElementwiseOpx::grow(poplar::program::Sequence &prog) const {
+  auto out = popops::map(
+      graph(), *getExpression(), getBroadcastInputs(), prog, debugPrefix());
+  setOutTensor(FusedElementwiseOp::getOutIndex(), out);
+}
+
+InputCreatorType FusedElementwiseOpx::getInputCreatorType(InIndex index) const {
+  if (inShape(index) == outShape(FusedElementwiseOp::getOutIndex())) {
+    return InputCreatorType::CanUnwind;
+  }
+  return Opx::getInputCreatorType(index);
+}
+
+poplar::Tensor FusedElementwiseOpx::unwindTensorLayout(poplar::Tensor tensor,
+                                                       InIndex,
+                                                       OutIndex) const {
+  return tensor;
+}
+
+view::RegMap FusedElementwiseOpx::unwindRegion(InIndex, OutIndex) const {
+  return [](const view::Region &r) { return view::Regions(1, r); };
+}
+
+FusedElementwiseInplaceOpx::FusedElementwiseInplaceOpx(Op *op,
+                                                       Devicex *devicex)
+    : FusedElementwiseOpx(op, devicex) {
+  verifyOp<FusedElementwiseInplaceOp>(
+      op, Onnx::CustomOperators::FusedElementwiseInplace);
+}
+
+void FusedElementwiseInplaceOpx::grow(poplar::program::Sequence &prog) const {
+  auto inputs = getBroadcastInputs();
+
+  // If input 0 is not parallel writeable, compute out of place, as the inplace
+  // elementwise Opxs do
+  if (!inputs.front().isParallelWriteable()) {
+    auto out = popops::map(graph(),
+                           *getExpression(),
+                           inputs,
+                           prog,
+                           debugPrefix("outplaceFallback"));
+    setOutTensor(FusedElementwiseOp::getOutIndex(), out);
+    return;
+  }
+
+  popops::mapInPlace(graph(), *getExpression(), inputs, prog, debugPrefix());
+  setOutTensor(FusedElementwiseOp::getOutIndex(), inputs.front());
+}
+
+namespace {
+OpxCreator<FusedElementwiseOpx>
+    fusedElementwiseOpxCreator(Onnx::CustomOperators::FusedElementwise);
+OpxCreator<FusedElementwiseInplaceOpx> fusedElementwiseInplaceOpxCreator(
+    Onnx::CustomOperators::FusedElementwiseInplace);
+} // namespace
+
+} // namespace popx
+} // namespace popart
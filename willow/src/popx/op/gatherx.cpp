@@ -1,5 +1,6 @@
 // Copyright (c) 2019 Graphcore Ltd. All rights reserved.
 #include <popart/error.hpp>
+#include <popart/ir.hpp>
 #include <popart/op/gather.hpp>
 #include <popart/popx/devicex.hpp>
 #include <popart/popx/op/gatherx.hpp>
@@ -10,6 +11,7 @@
 #include <popops/ElementWise.hpp>
 #include <popops/Gather.hpp>
 #include <popops/Zero.hpp>
+#include <popops/embedding.hpp>
 #include <poputil/TileMapping.hpp>
 
 #include <boost/range/algorithm.hpp>
@@ -19,6 +21,80 @@
 namespace popart {
 namespace popx {
 
+std::vector<unsigned> axisToFrontPermutation(std::size_t rank, int64_t axis) {
+  std::vector<unsigned> permutation(rank, 0);
+  boost::iota(permutation, 0);
+  std::swap(permutation.front(), permutation[axis]);
+  return permutation;
+}
+
+poplar::OptionFlags
+createSliceOptions(nonstd::optional<float> availableMemoryProportion) {
+  poplar::OptionFlags options;
+  if (availableMemoryProportion) {
+    options.set("availableMemoryProportion",
+                std::to_string(*availableMemoryProportion));
+  }
+  return options;
+}
+
+popops::SlicePlan createSlicePlan(const poplar::Graph &graph,
+                                  const poplar::Type &type,
+                                  const std::vector<std::size_t> &shape,
+                                  int64_t axis,
+                                  std::size_t numLookups,
+                                  bool usedForUpdate,
+                                  const poplar::OptionFlags &options) {
+  const std::size_t numElements = boost::accumulate(
+      shape, std::size_t{1}, std::multiplies<std::size_t>());
+  if (numElements == 0 || numLookups == 0) {
+    return popops::SlicePlan();
+  }
+
+  const auto numEntries = shape.at(axis);
+  auto planOptions      = options;
+  planOptions.set("usedForUpdate", usedForUpdate ? "true" : "false");
+  return popops::embedding::plan(graph,
+                                 type,
+                                 numEntries,
+                                 numElements / numEntries,
+                                 {numLookups},
+                                 planOptions);
+}
+
+poplar::Tensor createSliceableTensor(poplar::Graph &graph,
+                                     const poplar::Type &type,
+                                     const std::vector<std::size_t> &shape,
+                                     int64_t axis,
+                                     const popops::SlicePlan &plan,
+                                     const poplar::OptionFlags &options,
+                                     const std::string &name) {
+  auto permutation = axisToFrontPermutation(shape.size(), axis);
+
+  std::vector<std::size_t> permutedShape;
+  for (auto dim : permutation) {
+    permutedShape.push_back(shape[dim]);
+  }
+  const std::size_t embeddingSize =
+      boost::accumulate(std::next(permutedShape.begin()),
+                        permutedShape.end(),
+                        std::size_t{1},
+                        std::multiplies<std::size_t>());
+
+  auto result =
+      popops::createSliceableTensor(graph,
+                                    type,
+                                    {permutedShape.front(), embeddingSize},
+                                    {0},
+                                    {1},
+                                    plan,
+                                    options,
+                                    name);
+
+  // The permutation is its own inverse.
+  return result.reshape(permutedShape).dimShuffle(permutation);
+}
+
 GatherOpx::GatherOpx(Op *op, Devicex *devicex) : Opx(op, devicex) {
   verifyOp<GatherOp>(op,
                      {Onnx::Operators::Gather_1, Onnx::Operators::Gather_11});
@@ -29,6 +105,21 @@ GatherOpx::GatherOpx(Op *op, Devicex *devicex) : Opx(op, devicex) {
   inputCreatorPriority = std::numeric_limits<double>::max();
 }
 
+poplar::OptionFlags GatherOpx::getSliceOptions() const {
+  return createSliceOptions(
+      dynamic_cast<GatherOp *>(op_p)->getAvailableMemoryProportion());
+}
+
+popops::SlicePlan GatherOpx::getSlicePlan() const {
+  return createSlicePlan(graph(),
+                         popType(inInfo(GatherOp::dataInIndex())),
+                         inInfo(GatherOp::dataInIndex()).shape_szt(),
+                         axis,
+                         inInfo(GatherOp::indicesInIndex()).nelms(),
+                         op_p->getIr().canTrain(),
+                         getSliceOptions());
+}
+
 void GatherOpx::grow(poplar::program::Sequence &prog) const {
   const auto indicesShape = inShape(GatherOp::indicesInIndex());
   const auto outputShape =
@@ -54,9 +145,7 @@ void GatherOpx::grow(poplar::program::Sequence &prog) const {
     offsets = offsets.reinterpret(poplar::UNSIGNED_INT);
 
     // Create a permutation that swaps the gather axis for the front.
-    std::vector<unsigned> permutation(data.rank(), 0);
-    boost::iota(permutation, 0);
-    std::swap(permutation.front(), permutation[axis]);
+    auto permutation = axisToFrontPermutation(data.rank(), axis);
 
     // Place the gather axis at the front.
     data = data.dimShuffle(permutation);
@@ -71,8 +160,8 @@ void GatherOpx::grow(poplar::program::Sequence &prog) const {
                                      {0},
                                      {1},
                                      prog,
-                                     popops::SlicePlan(),
-                                     poplar::OptionFlags(),
+                                     getSlicePlan(),
+                                     getSliceOptions(),
                                      debugPrefix());
 
     // Reshape the result to "unflatten" the other dimensions.
@@ -97,12 +186,23 @@ poplar::Tensor GatherOpx::createInput(int index,
   auto info        = inInfo(GatherOp::dataInIndex());
   const auto shape = info.shape_szt();
 
-  return popops::createGatherInput(graph(),
-                                   popType(info),
-                                   shape,
-                                   static_cast<unsigned>(axis),
-                                   popops::GatherParams{},
-                                   name);
+  if (info.nelms() == 0 || inInfo(GatherOp::indicesInIndex()).nelms() == 0) {
+    return popops::createGatherInput(graph(),
+                                     popType(info),
+                                     shape,
+                                     static_cast<unsigned>(axis),
+                                     popops::GatherParams{},
+                                     name);
+  }
+
+  // Lay out the data for the planned slices
+  return createSliceableTensor(graph(),
+                               popType(info),
+                               shape,
+                               axis,
+                               getSlicePlan(),
+                               getSliceOptions(),
+                               name);
 }
 
 InputCreatorType GatherOpx::getInputCreatorType(int index0) const {
@@ -127,22 +227,45 @@ void GatherGradOpx::grow(poplar::program::Sequence &prog) const {
   auto update  = getInTensor(GatherGradOp::gradInIndex());
   auto indices = getInTensor(GatherGradOp::indicesInIndex());
 
-  auto result = popops::createGatherInput(graph(),
-                                          update.elementType(),
-                                          outputShape,
-                                          static_cast<unsigned>(axis),
-                                          popops::GatherParams{},
-                                          debugPrefix("result"));
+  if (outInfo(GatherGradOp::gradOutIndex()).nelms() == 0 ||
+      update.numElements() == 0 || indices.numElements() == 0) {
+    auto result = popops::createGatherInput(graph(),
+                                            update.elementType(),
+                                            outputShape,
+                                            static_cast<unsigned>(axis),
+                                            popops::GatherParams{},
+                                            debugPrefix("result"));
 
-  // Zero the result tensor
-  popops::zero(graph(), result, prog, debugPrefix("zero"));
+    // Zero the result tensor
+    popops::zero(graph(), result, prog, debugPrefix("zero"));
 
-  if (result.numElements() == 0 || update.numElements() == 0 ||
-      indices.numElements() == 0) {
     setOutTensor(GatherGradOp::gradOutIndex(), result);
     return;
   }
 
+  // Plan as the forward gather does, so the result has the layout of the
+  // gathered data
+  const auto options = createSliceOptions(
+      dynamic_cast<GatherGradOp *>(op_p)->getAvailableMemoryProportion());
+  const auto plan = createSlicePlan(graph(),
+                                    update.elementType(),
+                                    outputShape,
+                                    axis,
+                                    indices.numElements(),
+                                    true,
+                                    options);
+
+  auto result = createSliceableTensor(graph(),
+                                      update.elementType(),
+                                      outputShape,
+                                      axis,
+                                      plan,
+                                      options,
+                                      debugPrefix("result"));
+
+  // Zero the result tensor
+  popops::zero(graph(), result, prog, debugPrefix("zero"));
+
   auto scale = graph().addConstant(
       update.elementType(), {}, 1.0f, debugPrefix("const_1"));
   graph().setTileMapping(scale, 0);
@@ -150,16 +273,16 @@ void GatherGradOpx::grow(poplar::program::Sequence &prog) const {
   // Flatten the index shaped region of the update
   update = update.flatten(static_cast<unsigned>(axis),
                           static_cast<unsigned>(axis) + indices.rank());
-  // Put the slice dimension at the front
-  update = update.dimRoll(static_cast<unsigned>(axis));
+  // Swap the slice dimension for the front, as in the forward gather
+  update = update.dimShuffle(axisToFrontPermutation(update.rank(), axis));
   // Flatten the rest of the dimensions
   update = update.flatten(1, update.rank());
   // Add a degenerate dimension
   update = update.expand({1});
 
   auto target = result;
-  // Put the slice dimension at the front
-  target = target.dimRoll(static_cast<unsigned>(axis));
+  // Swap the slice dimension for the front, as in the forward gather
+  target = target.dimShuffle(axisToFrontPermutation(target.rank(), axis));
   // Flatten the rest of the dimensions
   target = target.flatten(1, target.rank());
 
@@ -180,8 +303,8 @@ void GatherGradOpx::grow(poplar::program::Sequence &prog) const {
                          {0},
                          {1},
                          prog,
-                         popops::SlicePlan(),
-                         poplar::OptionFlags(),
+                         plan,
+                         options,
                          debugPrefix());
 
   setOutTensor(GatherGradOp::gradOutIndex(), result);
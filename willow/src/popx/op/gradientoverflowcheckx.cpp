@@ -0,0 +1,61 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <map>
+#include <popart/op/gradientoverflowcheck.hpp>
+#include <popart/popx/devicex.hpp>
+#include <popart/popx/op/gradientoverflowcheckx.hpp>
+#include <popart/popx/opxmanager.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+
+#include <popops/ElementWise.hpp>
+#include <popops/Reduce.hpp>
+
+namespace pe = popops::expr;
+
+namespace popart {
+namespace popx {
+
+GradientOverflowCheckOpx::GradientOverflowCheckOpx(Op *op, Devicex *devicex)
+    : Opx(op, devicex) {
+  verifyOp<GradientOverflowCheckOp>(
+      op, Onnx::CustomOperators::GradientOverflowCheck);
+}
+
+void GradientOverflowCheckOpx::grow(poplar::program::Sequence &prog) const {
+  // The flattened inputs of each data type
+  std::map<DataType, std::vector<poplar::Tensor>> inputs;
+  for (auto &index_tensor : op_p->input->tensorMap()) {
+    inputs[index_tensor.second->info.dataType()].push_back(
+        getInTensor(index_tensor.first).flatten());
+  }
+
+  // The flags of the non-finite elements, and the checks given as inputs
+  std::vector<poplar::Tensor> flags;
+  for (auto &type_ins : inputs) {
+    if (type_ins.first == DataType::BOOL) {
+      flags.insert(flags.end(), type_ins.second.begin(), type_ins.second.end());
+    } else {
+      flags.push_back(popops::map(graph(),
+                                  pe::Not(pe::IsFinite(pe::_1)),
+                                  {poplar::concat(type_ins.second)},
+                                  prog,
+                                  debugPrefix("notFinite")));
+    }
+  }
+
+  auto overflow = popops::reduce(graph(),
+                                 poplar::concat(flags),
+                                 {0},
+                                 {popops::Operation::LOGICAL_OR},
+                                 prog,
+                                 debugPrefix("overflow"));
+  setOutTensor(GradientOverflowCheckOp::getOutIndex(), overflow);
+}
+
+namespace {
+OpxCreator<GradientOverflowCheckOpx> gradientOverflowCheckOpxCreator(
+    Onnx::CustomOperators::GradientOverflowCheck);
+} // namespace
+
+} // namespace popx
+} // namespace popart
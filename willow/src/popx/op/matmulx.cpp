@@ -428,6 +428,12 @@ void MatMulOpx::grow(poplar::program::Sequence &prog) const {
   if (auto _outputType = matmul.getOutputType())
     outputType = popType(*_outputType);
 
+  dv_p->recordMatMulPlan(combinedBroadcastTs.first.elementType(),
+                         outputType,
+                         combinedBroadcastTs.first.shape(),
+                         combinedBroadcastTs.second.shape(),
+                         opts);
+
   auto outTensor =
       poplin::matMulGrouped(graph(),                    // graph
                             combinedBroadcastTs.first,  // A
@@ -0,0 +1,382 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/adamupdater.hpp>
+#include <popart/op/adamvarupdate.hpp>
+#include <popart/op/multitensorupdate.hpp>
+#include <popart/op/sgd0varupdate.hpp>
+#include <popart/op/sgd1varupdate.hpp>
+#include <popart/popx/devicex.hpp>
+#include <popart/popx/op/adamupdaterx.hpp>
+#include <popart/popx/op/adamvarupdatex.hpp>
+#include <popart/popx/op/multitensorupdatex.hpp>
+#include <popart/popx/opxmanager.hpp>
+
+#include <popops/Cast.hpp>
+#include <popops/ElementWise.hpp>
+#include <popops/Reduce.hpp>
+#include <popops/ScaledAdd.hpp>
+
+namespace pe = popops::expr;
+
+namespace popart {
+namespace popx {
+
+namespace {
+
+// A view of the tensors, flattened and concatenated
+poplar::Tensor concatFlattened(const std::vector<poplar::Tensor> &tensors) {
+  std::vector<poplar::Tensor> flattened;
+  for (auto &t : tensors) {
+    flattened.push_back(t.flatten());
+  }
+  return poplar::concat(flattened);
+}
+
+// A view of the scalars, each repeated for every element of its tensor, which
+// lines up with concatFlattened(tensors)
+poplar::Tensor broadcastScalars(const std::vector<poplar::Tensor> &scalars,
+                                const std::vector<poplar::Tensor> &tensors) {
+  std::vector<poplar::Tensor> broadcast;
+  for (int i = 0; i < tensors.size(); ++i) {
+    broadcast.push_back(scalars.at(i).reshape({1}).broadcast(
+        static_cast<unsigned>(tensors.at(i).numElements()), 0));
+  }
+  return poplar::concat(broadcast);
+}
+
+} // namespace
+
+MultiVarUpdateOpx::MultiVarUpdateOpx(Op *op, Devicex *devicex)
+    : VarUpdateOpx(op, devicex) {}
+
+std::vector<poplar::Tensor>
+MultiVarUpdateOpx::getInTensors(InIndex singleIndex) const {
+  auto &op = getOp<MultiVarUpdateOp>();
+  std::vector<poplar::Tensor> tensors;
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    tensors.push_back(getInTensor(op.getInIndex(i, singleIndex)));
+  }
+  return tensors;
+}
+
+void MultiVarUpdateOpx::setUpdatedVarOutTensors() const {
+  auto &op = getOp<MultiVarUpdateOp>();
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    auto varIndex = op.getInIndex(i, VarUpdateOp::getVarToUpdateInIndex());
+    if (hasInViewChangers(varIndex)) {
+      setOutViewChangers(MultiVarUpdateOp::getOutIndex(i),
+                         getInViewChangers(varIndex));
+    }
+    // output is a reference to the updated input
+    setOutTensor(MultiVarUpdateOp::getOutIndex(i), getInTensor(varIndex));
+  }
+}
+
+MultiSGD0VarUpdateOpx::MultiSGD0VarUpdateOpx(Op *op, Devicex *devicex)
+    : MultiVarUpdateOpx(op, devicex) {
+  verifyOp<MultiSGD0VarUpdateOp>(op, Onnx::CustomOperators::MultiSGD0VarUpdate);
+}
+
+void MultiSGD0VarUpdateOpx::grow(poplar::program::Sequence &prog) const {
+
+  // see SGD0VarUpdateOpx for the equations implemented here
+
+  auto &op = getOp<MultiSGD0VarUpdateOp>();
+
+  poplar::Tensor weights =
+      concatFlattened(getInTensors(VarUpdateOp::getVarToUpdateInIndex()));
+
+  // (1) update weights with weight decay
+
+  // non-const weight decay scale factor
+  if (!op.initWdsf0.isConst()) {
+    popops::mapInPlace(
+        graph(),
+        pe::Mul(pe::_1, pe::_2),
+        {weights, getInTensor(SGD0VarUpdateOp::getWdsf0InIndex())},
+        prog,
+        debugPrefix("nonConstWeightDecay"));
+  }
+
+  // const weight decay scale factor
+  else {
+    float scaleFactor = op.initWdsf0.val();
+    if (scaleFactor != 1.0f) {
+      popops::mapInPlace(graph(),
+                         pe::Mul(pe::_1, pe::Const(scaleFactor)),
+                         {weights},
+                         prog,
+                         debugPrefix("constWeightDecay"));
+    }
+  }
+
+  // (2) subtract scaled gradients
+  poplar::Tensor weightDeltas = concatFlattened(
+      getInTensors(VarUpdateWithUpdaterOp::getUpdaterInIndex()));
+
+  // non-const scaled learning rate case
+  if (!op.initSlr0.isConst()) {
+    popops::scaledAddTo(
+        graph(),
+        weights,
+        weightDeltas,
+        popops::neg(graph(),
+                    getInTensor(SGD0VarUpdateOp::getSlr0InIndex()),
+                    prog,
+                    debugPrefix("neg")),
+        prog,
+        debugPrefix("nonConstScaledSubtract"));
+  }
+
+  // const scaled learning rate case
+  else {
+    popops::scaledAddTo(graph(),
+                        weights,
+                        weightDeltas,
+                        -op.initSlr0.val(),
+                        prog,
+                        debugPrefix("scaledSubtract"));
+  }
+
+  setUpdatedVarOutTensors();
+}
+
+MultiSGD1VarUpdateOpx::MultiSGD1VarUpdateOpx(Op *op, Devicex *devicex)
+    : MultiVarUpdateOpx(op, devicex) {
+  verifyOp<MultiSGD1VarUpdateOp>(op, Onnx::CustomOperators::MultiSGD1VarUpdate);
+}
+
+void MultiSGD1VarUpdateOpx::grow(poplar::program::Sequence &prog) const {
+
+  // see optimizer.hpp for the equations implemented here
+
+  auto &op = getOp<MultiSGD1VarUpdateOp>();
+
+  poplar::Tensor velocity = concatFlattened(
+      getInTensors(VarUpdateWithUpdaterOp::getUpdaterInIndex()));
+
+  poplar::Tensor weights =
+      concatFlattened(getInTensors(VarUpdateOp::getVarToUpdateInIndex()));
+
+  // non-const scaled learning rate case
+  if (!op.initSlr1.isConst()) {
+    popops::scaledAddTo(
+        graph(),
+        weights,
+        velocity,
+        popops::neg(graph(),
+                    getInTensor(SGD1VarUpdateOp::getSlr1InIndex()),
+                    prog,
+                    debugPrefix("neg")),
+        prog,
+        debugPrefix("nonConstScaledSubtractSGD1"));
+  }
+
+  // const scaled learning rate case
+  else {
+    popops::scaledAddTo(graph(),
+                        weights,
+                        velocity,
+                        -op.initSlr1.val(),
+                        prog,
+                        debugPrefix("constScaledSubtractSGD1"));
+  }
+
+  setUpdatedVarOutTensors();
+}
+
+MultiAdamVarUpdateOpx::MultiAdamVarUpdateOpx(Op *op, Devicex *devicex)
+    : MultiVarUpdateOpx(op, devicex) {
+  verifyOp<MultiAdamVarUpdateOp>(op, Onnx::CustomOperators::MultiAdamVarUpdate);
+}
+
+void MultiAdamVarUpdateOpx::grow(poplar::program::Sequence &prog) const {
+
+  // see optimizer.hpp for the equations implemented here
+
+  auto &op = getOp<MultiAdamVarUpdateOp>();
+
+  auto vars     = getInTensors(VarUpdateOp::getVarToUpdateInIndex());
+  auto updaters = getInTensors(VarUpdateWithUpdaterOp::getUpdaterInIndex());
+
+  poplar::Tensor var     = concatFlattened(vars);
+  poplar::Tensor updater = concatFlattened(updaters);
+
+  std::vector<poplar::Tensor> tensors;
+
+  pe::Any lr(pe::Const(0.0f));
+  pe::Any mwn(pe::Const(0.0f));
+
+  if (op.initLr.isConst()) {
+    lr = pe::Const(op.initLr.val());
+  } else {
+    tensors.push_back(getInTensor(AdamVarUpdateOp::getLrInIndex()));
+    lr = pe::PlaceHolder(tensors.size());
+  }
+
+  if (!op.hasLambInputs()) {
+    if (tensors.size() == 0) {
+      // Variable update: var -= lr * updater
+      popops::scaledAddTo(graph(), var, updater, -op.initLr.val(), prog);
+    } else {
+      // Calculate final non-const learning rate tensor from expression
+      poplar::Tensor lrt = popops::map(graph(), pe::Neg(lr), tensors, prog);
+
+      // Variable update: var -= lr * updater
+      popops::scaledAddTo(graph(), var, updater, lrt, prog);
+    }
+  } else {
+    // The Lamb scaled learning rates of all the tensors, from the vectors of
+    // their squared norms: lr = lr * sqrt(r1)/sqrt(r2)
+    tensors.push_back(
+        concatFlattened(getInTensors(AdamVarUpdateOp::getLambR1SqInIndex())));
+    auto r1sqindex = tensors.size();
+    tensors.push_back(
+        concatFlattened(getInTensors(AdamVarUpdateOp::getLambR2SqInIndex())));
+    auto r2sqindex = tensors.size();
+
+    if (op.initMwn.isConst()) {
+      mwn = pe::Const(op.initMwn.val());
+    } else {
+      tensors.push_back(getInTensor(AdamVarUpdateOp::getMwnInIndex()));
+      mwn = pe::PlaceHolder(tensors.size());
+    }
+
+    poplar::Tensor lrt = popops::map(
+        graph(),
+        pe::Neg(getLambLearningRate(
+            lr, pe::PlaceHolder(r1sqindex), pe::PlaceHolder(r2sqindex), mwn)),
+        tensors,
+        prog);
+
+    // Variable update: var -= lr * updater, with the learning rate of each
+    // tensor repeated over its elements
+    std::vector<poplar::Tensor> lrts;
+    for (int i = 0; i < vars.size(); ++i) {
+      lrts.push_back(lrt.slice(i, i + 1));
+    }
+    popops::mapInPlace(
+        graph(),
+        pe::Cast(pe::Add(pe::Cast(pe::_1, poplar::FLOAT),
+                         pe::Mul(pe::_3, pe::Cast(pe::_2, poplar::FLOAT))),
+                 var.elementType()),
+        {var, updater, broadcastScalars(lrts, vars)},
+        prog,
+        debugPrefix("lambScaledSubtract"));
+  }
+
+  setUpdatedVarOutTensors();
+}
+
+MultiAdamUpdaterOpx::MultiAdamUpdaterOpx(Op *op, Devicex *devicex)
+    : Opx(op, devicex) {
+  verifyOp<MultiAdamUpdaterOp>(op, Onnx::CustomOperators::MultiAdamUpdater);
+}
+
+void MultiAdamUpdaterOpx::grow(poplar::program::Sequence &prog) const {
+  auto &op = getOp<MultiAdamUpdaterOp>();
+
+  std::vector<poplar::Tensor> vars;
+  std::vector<poplar::Tensor> accl1s;
+  std::vector<poplar::Tensor> accl2s;
+  std::vector<poplar::Tensor> steps;
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    vars.push_back(
+        getInTensor(op.getInIndex(i, AdamUpdaterOp::getVarInIndex())));
+    accl1s.push_back(
+        getInTensor(op.getInIndex(i, AdamUpdaterOp::getAccl1InIndex())));
+    accl2s.push_back(
+        getInTensor(op.getInIndex(i, AdamUpdaterOp::getAccl2InIndex())));
+    steps.push_back(
+        getInTensor(op.getInIndex(i, AdamUpdaterOp::getStepInIndex())));
+  }
+
+  // Update the steps of all the tensors
+  popops::mapInPlace(graph(),
+                     pe::Add(pe::_1, pe::Const(1)),
+                     {concatFlattened(steps)},
+                     prog);
+
+  poplar::Tensor updater = growAdamUpdater(*this,
+                                           op.mode,
+                                           op.initWd,
+                                           op.initB1,
+                                           op.initB2,
+                                           op.initEps,
+                                           concatFlattened(vars),
+                                           concatFlattened(accl1s),
+                                           concatFlattened(accl2s),
+                                           broadcastScalars(steps, vars),
+                                           prog);
+
+  // Split the updater into those of the tensors
+  std::size_t start = 0;
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    auto &var = vars.at(i);
+    auto end  = start + var.numElements();
+
+    auto varIndex = op.getInIndex(i, AdamUpdaterOp::getVarInIndex());
+    if (hasInViewChangers(varIndex)) {
+      setOutViewChangers(MultiAdamUpdaterOp::getOutIndex(i),
+                         getInViewChangers(varIndex));
+    }
+    setOutTensor(MultiAdamUpdaterOp::getOutIndex(i),
+                 updater.slice(start, end).reshape(var.shape()));
+    start = end;
+  }
+}
+
+MultiLambSquareOpx::MultiLambSquareOpx(Op *op, Devicex *devicex)
+    : Opx(op, devicex) {
+  verifyOp<MultiLambSquareOp>(op, Onnx::CustomOperators::MultiLambSquare);
+}
+
+void MultiLambSquareOpx::grow(poplar::program::Sequence &prog) const {
+  auto &op = getOp<MultiLambSquareOp>();
+
+  std::vector<poplar::Tensor> ins;
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    ins.push_back(getInTensor(MultiLambSquareOp::getInIndex(i)));
+  }
+
+  poplar::Tensor cast = concatFlattened(ins);
+  if (cast.elementType() != poplar::FLOAT) {
+    cast = popops::cast(
+        graph(), cast, poplar::FLOAT, prog, debugPrefix("LambCastFP32"));
+  }
+
+  // The reductions of all the tensors share their compute sets
+  std::vector<poplar::ComputeSet> css;
+  std::size_t start = 0;
+  for (int i = 0; i < op.getNumTensors(); ++i) {
+    auto end = start + ins.at(i).numElements();
+    auto rsq = popops::reduce(graph(),
+                              cast.slice(start, end),
+                              poplar::FLOAT,
+                              {0},
+                              {popops::Operation::SQUARE_ADD},
+                              css,
+                              debugPrefix("LambSquaredReducedFP32"));
+    setOutTensor(MultiLambSquareOp::getOutIndex(i), rsq);
+    start = end;
+  }
+  for (auto &cs : css) {
+    prog.add(poplar::program::Execute(cs));
+  }
+}
+
+namespace {
+OpxCreator<MultiSGD0VarUpdateOpx>
+    multiSGD0VarUpdateOpxCreator(Onnx::CustomOperators::MultiSGD0VarUpdate);
+OpxCreator<MultiSGD1VarUpdateOpx>
+    multiSGD1VarUpdateOpxCreator(Onnx::CustomOperators::MultiSGD1VarUpdate);
+OpxCreator<MultiAdamVarUpdateOpx>
+    multiAdamVarUpdateOpxCreator(Onnx::CustomOperators::MultiAdamVarUpdate);
+OpxCreator<MultiAdamUpdaterOpx>
+    multiAdamUpdaterOpxCreator(Onnx::CustomOperators::MultiAdamUpdater);
+OpxCreator<MultiLambSquareOpx>
+    multiLambSquareOpxCreator(Onnx::CustomOperators::MultiLambSquare);
+} // namespace
+} // namespace popx
+} // namespace popart
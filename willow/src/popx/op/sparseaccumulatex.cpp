@@ -0,0 +1,150 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popops/Cast.hpp>
+#include <popops/DynamicSlice.hpp>
+#include <popops/Gather.hpp>
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/op/sparseaccumulate.hpp>
+#include <popart/popx/devicex.hpp>
+#include <popart/popx/op/gatherx.hpp>
+#include <popart/popx/op/sparseaccumulatex.hpp>
+#include <popart/popx/opxmanager.hpp>
+
+namespace popart {
+namespace popx {
+
+SparseAccumulateOpx::SparseAccumulateOpx(Op *op, Devicex *devicex)
+    : VarUpdateOpx(op, devicex) {
+  verifyOp<SparseAccumulateOp>(op, {Onnx::CustomOperators::SparseAccumulate});
+}
+
+poplar::OptionFlags SparseAccumulateOpx::getSliceOptions() const {
+  return createSliceOptions(
+      getOp<SparseAccumulateOp>().getAvailableMemoryProportion());
+}
+
+popops::SlicePlan SparseAccumulateOpx::getSlicePlan() const {
+  auto &accumulateOp = getOp<SparseAccumulateOp>();
+  auto accumInfo     = inInfo(VarUpdateOp::getVarToUpdateInIndex());
+  return createSlicePlan(
+      graph(),
+      popType(accumInfo),
+      accumInfo.shape_szt(),
+      accumulateOp.getAxis(),
+      inInfo(SparseAccumulateOp::getIndicesInIndex()).nelms(),
+      true,
+      getSliceOptions());
+}
+
+void SparseAccumulateOpx::grow(poplar::program::Sequence &prog) const {
+
+  auto &accumulateOp = getOp<SparseAccumulateOp>();
+  const auto axis    = accumulateOp.getAxis();
+
+  auto accum   = getInTensor(VarUpdateOp::getVarToUpdateInIndex());
+  auto rows    = getInTensor(SparseAccumulateOp::getUpdaterInIndex());
+  auto indices = getInTensor(SparseAccumulateOp::getIndicesInIndex());
+
+  if (accum.numElements() != 0 && indices.numElements() != 0) {
+    poplar::Tensor factor;
+    if (accumulateOp.getFactor().isConst()) {
+      factor = getConst(accum.elementType(),
+                        {},
+                        accumulateOp.getFactor().val(),
+                        debugPrefix("constFactor"));
+    } else {
+      factor = getInTensor(SparseAccumulateOp::getFactorInIndex());
+      if (factor.elementType() != accum.elementType()) {
+        factor = popops::cast(graph(),
+                              factor,
+                              accum.elementType(),
+                              prog,
+                              debugPrefix("castFactor"));
+      }
+    }
+
+    // Shape the rows and the accumulator as the GatherGradOpx shapes the
+    // gradient and its result
+    rows = rows.flatten(static_cast<unsigned>(axis),
+                        static_cast<unsigned>(axis) + indices.rank());
+    rows = rows.dimShuffle(axisToFrontPermutation(rows.rank(), axis));
+    rows = rows.flatten(1, rows.rank());
+    rows = rows.expand({1});
+
+    auto target = accum.dimShuffle(axisToFrontPermutation(accum.rank(), axis));
+    target = target.flatten(1, target.rank());
+
+    indices = indices.flatten();
+    indices = indices.expand({1});
+    // Reinterpret the indices as unsigned int, assuming negative indices don't
+    // exist.
+    indices = indices.reinterpret(poplar::UNSIGNED_INT);
+
+    // accum[indices] += factor * rows
+    popops::multiUpdateAdd(graph(),
+                           target,
+                           rows,
+                           indices,
+                           factor,
+                           {0},
+                           {1},
+                           prog,
+                           getSlicePlan(),
+                           getSliceOptions(),
+                           debugPrefix("sparseAccumulate"));
+  }
+
+  // reference accum returned
+  setOutTensor(VarUpdateOp::getUpdatedVarOutIndex(), accum);
+}
+
+poplar::Tensor SparseAccumulateOpx::createInput(InIndex inIndex,
+                                                const std::string &name) const {
+  if (inIndex != VarUpdateOp::getVarToUpdateInIndex()) {
+    throw error("SparseAccumulateOpx::createInput, cannot create input at {}, "
+                "it can only create the var to update input Tensor",
+                inIndex);
+  }
+
+  auto &accumulateOp = getOp<SparseAccumulateOp>();
+  auto accumInfo     = inInfo(inIndex);
+
+  if (accumInfo.nelms() == 0 ||
+      inInfo(SparseAccumulateOp::getIndicesInIndex()).nelms() == 0) {
+    return popops::createGatherInput(
+        graph(),
+        popType(accumInfo),
+        accumInfo.shape_szt(),
+        static_cast<unsigned>(accumulateOp.getAxis()),
+        popops::GatherParams{},
+        name);
+  }
+
+  return createSliceableTensor(graph(),
+                               popType(accumInfo),
+                               accumInfo.shape_szt(),
+                               accumulateOp.getAxis(),
+                               getSlicePlan(),
+                               getSliceOptions(),
+                               name);
+}
+
+InputCreatorType
+SparseAccumulateOpx::getInputCreatorType(InIndex inIndex) const {
+  return inIndex == VarUpdateOp::getVarToUpdateInIndex()
+             ? InputCreatorType::CanCreate
+             : Opx::getInputCreatorType(inIndex);
+}
+
+std::vector<TensorId>
+SparseAccumulateOpx::mustExistBeforeCreate(InIndex) const {
+  return {};
+}
+
+namespace {
+OpxCreator<SparseAccumulateOpx>
+    SparseAccumulateOpxCreator({Onnx::CustomOperators::SparseAccumulate});
+}
+
+} // namespace popx
+} // namespace popart
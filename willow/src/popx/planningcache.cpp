@@ -0,0 +1,99 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <map>
+#include <sstream>
+
+#include <poplar/Graph.hpp>
+#include <poplar/Target.hpp>
+#include <popart/devicemanager.hpp>
+#include <popart/logging.hpp>
+#include <popart/popx/planningcache.hpp>
+
+namespace popart {
+namespace popx {
+
+namespace {
+
+std::string getTargetKey(const poplar::Target &target) {
+  std::stringstream ss;
+  ss << poplar::versionString() << " " << target.getTargetArchString() << " "
+     << static_cast<int>(target.getTargetType()) << " " << target.getNumIPUs()
+     << " " << target.getTilesPerIPU();
+  return ss.str();
+}
+
+void appendOptions(std::stringstream &ss, const poplar::OptionFlags &options) {
+  // OptionFlags are ordered by key
+  for (auto &key_val : options) {
+    ss << " " << key_val.first << "=" << key_val.second;
+  }
+}
+
+std::mutex registryMutex;
+// Kept until released, so that sessions which are created one after the
+// other share the caches
+std::map<std::string, std::shared_ptr<PlanningCaches>> registry;
+
+} // namespace
+
+std::shared_ptr<PlanningCaches>
+PlanningCaches::get(const DeviceInfo &deviceInfo, bool shared) {
+  if (!shared) {
+    return std::make_shared<PlanningCaches>();
+  }
+
+  auto key = getTargetKey(deviceInfo.getTarget());
+  std::lock_guard<std::mutex> lock(registryMutex);
+  auto &caches = registry[key];
+  if (caches) {
+    logging::devicex::debug("Sharing the planning caches for target {}", key);
+  } else {
+    caches = std::make_shared<PlanningCaches>();
+  }
+  return caches;
+}
+
+void PlanningCaches::releaseShared() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  logging::devicex::debug("Releasing {} shared planning caches",
+                          registry.size());
+  registry.clear();
+}
+
+std::unique_lock<std::mutex> PlanningCaches::lock() {
+  return std::unique_lock<std::mutex>(useMutex);
+}
+
+bool PlanningCaches::recordConv(const poplin::ConvParams &params,
+                                const poplar::OptionFlags &options) {
+  std::stringstream ss;
+  ss << params;
+  appendOptions(ss, options);
+  return record(convKeys, ss.str());
+}
+
+bool PlanningCaches::recordMatMul(const poplar::Type &inputType,
+                                  const poplar::Type &outputType,
+                                  const std::vector<std::size_t> &aShape,
+                                  const std::vector<std::size_t> &bShape,
+                                  const poplar::OptionFlags &options) {
+  std::stringstream ss;
+  ss << inputType << " " << outputType;
+  for (auto dim : aShape) {
+    ss << " " << dim;
+  }
+  ss << " x";
+  for (auto dim : bShape) {
+    ss << " " << dim;
+  }
+  appendOptions(ss, options);
+  return record(matMulKeys, ss.str());
+}
+
+bool PlanningCaches::record(std::set<std::string> &keys,
+                            const std::string &key) {
+  std::lock_guard<std::mutex> lock(keysMutex);
+  return !keys.insert(key).second;
+}
+
+} // namespace popx
+} // namespace popart
@@ -95,6 +95,15 @@ poplar::program::Sequence &PopPrograms::accumulateOuterFragment() {
   return seqs[static_cast<int>(ProgramFragmentIndex::VarUpdateFromAccumulator)];
 }
 
+const poplar::program::Sequence &
+PopPrograms::optimizerScheduleFragment() const {
+  return seqs[static_cast<int>(ProgramFragmentIndex::OptimizerSchedule)];
+}
+
+poplar::program::Sequence &PopPrograms::optimizerScheduleFragment() {
+  return seqs[static_cast<int>(ProgramFragmentIndex::OptimizerSchedule)];
+}
+
 const poplar::program::Sequence &PopPrograms::weightsToHostFragment() const {
   return seqs[static_cast<int>(ProgramFragmentIndex::WeightstoHost)];
 }
@@ -318,6 +327,7 @@ PopPrograms::getMainProgramFromPipelineFragments() const {
   if (!dv_p->getOuterLoopFragEmpty()) {
 
     inner.add(accumulateOuterFragment());
+    inner.add(optimizerScheduleFragment());
     // If doing gradient accumulation, the inner loop is over mini batches,
     // and this outer loop loops over multiple batches per step.
     auto bps = dv_p->ir().getDataFlow().batchesPerStep();
@@ -356,6 +366,7 @@ poplar::program::Sequence PopPrograms::program() const {
       prog = poplar::program::Repeat(accumulationFactor, prog);
       prog.add(accumulateOuterFragment());
     }
+    prog.add(optimizerScheduleFragment());
 
     if (dv_p->ir().getSessionOptions().instrumentWithHardwareCycleCounter &&
         instrumentations.find(Instrumentation::Inner) !=
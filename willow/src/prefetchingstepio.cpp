@@ -0,0 +1,278 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/prefetchingstepio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace popart {
+
+double PrefetchingStepIOStats::prefetchHitRate() const {
+  auto total = prefetchHits + prefetchMisses;
+  if (total == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(prefetchHits) / static_cast<double>(total);
+}
+
+PrefetchingStepIO::PrefetchingStepIO(
+    IStepIO &upstream_,
+    const std::map<TensorId, TensorInfo> &inputs,
+    const PrefetchingStepIOOptions &options_)
+    : upstream(upstream_), options(options_) {
+  init(inputs);
+}
+
+PrefetchingStepIO::PrefetchingStepIO(IStepIO &upstream_,
+                                     const Ir &ir,
+                                     int64_t numRuns,
+                                     const PrefetchingStepIOOptions &options_)
+    : upstream(upstream_), options(options_) {
+  if (numRuns < 1) {
+    throw error("PrefetchingStepIO requires at least 1 run, not {}", numRuns);
+  }
+  options.maxFetchesPerTensor = getFetchesPerRun(ir) * numRuns;
+
+  std::map<TensorId, TensorInfo> inputs;
+  for (auto tensor : ir.dataStreamTensors()) {
+    inputs.emplace(tensor->id, tensor->info);
+  }
+  init(inputs);
+}
+
+int64_t PrefetchingStepIO::getFetchesPerRun(const Ir &ir) {
+  auto &opts = ir.getSessionOptions();
+  int64_t replicationFactor =
+      opts.enableReplicatedGraphs ? opts.replicatedGraphCount : 1;
+  int64_t accumulationFactor =
+      opts.enableGradientAccumulation ? opts.accumulationFactor : 1;
+  return ir.getDataFlow().batchesPerStep() * accumulationFactor *
+         replicationFactor;
+}
+
+void PrefetchingStepIO::init(const std::map<TensorId, TensorInfo> &inputs) {
+  if (options.maxFetchesPerTensor < 1) {
+    throw error("PrefetchingStepIO requires a maxFetchesPerTensor of at "
+                "least 1, so that it does not read past the end of the "
+                "upstream IStepIO");
+  }
+  if (options.prefetchDepth == 0) {
+    throw error("PrefetchingStepIO requires a prefetchDepth of at least 1");
+  }
+
+  auto numWorkers = std::max<size_t>(
+      1, std::min<size_t>(options.numWorkers, inputs.size()));
+  workerQueues.resize(numWorkers);
+
+  size_t index = 0;
+  for (auto &input : inputs) {
+    auto queue  = std::make_unique<TensorQueue>();
+    queue->id   = input.first;
+    queue->info = input.second;
+    queue->slots.resize(options.prefetchDepth);
+    workerQueues[index % numWorkers].push_back(queue.get());
+    queues.emplace(input.first, std::move(queue));
+    ++index;
+  }
+
+  logging::devicex::debug("[PrefetchingStepIO] Prefetching {} input(s) {} "
+                          "batch(es) ahead using {} worker(s)",
+                          queues.size(),
+                          options.prefetchDepth,
+                          numWorkers);
+
+  for (unsigned workerIndex = 0; workerIndex < numWorkers; ++workerIndex) {
+    workers.emplace_back(&PrefetchingStepIO::workerLoop, this, workerIndex);
+  }
+}
+
+PrefetchingStepIO::~PrefetchingStepIO() {
+  {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    stopping = true;
+  }
+  workerWake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void PrefetchingStepIO::workerLoop(unsigned workerIndex) {
+  auto &myQueues = workerQueues.at(workerIndex);
+
+  while (true) {
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(workerMutex);
+      if (stopping) {
+        return;
+      }
+      generation = releaseGeneration;
+    }
+
+    bool fetched = false;
+    for (auto queue : myQueues) {
+      fetched |= fetchOne(*queue);
+    }
+
+    if (!fetched) {
+      // Nothing to do until the consumer releases a slot.
+      std::unique_lock<std::mutex> lock(workerMutex);
+      workerWake.wait(lock, [&]() {
+        return stopping || releaseGeneration != generation;
+      });
+    }
+  }
+}
+
+bool PrefetchingStepIO::fetchOne(TensorQueue &queue) {
+  size_t slotIndex = 0;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.fetchError || queue.count == queue.slots.size() ||
+        queue.numFetched >= options.maxFetchesPerTensor) {
+      return false;
+    }
+    slotIndex = (queue.head + queue.count) % queue.slots.size();
+  }
+
+  // Only this worker writes to the free slot, and the consumer won't read it
+  // until it is marked as ready, so we can fill it without holding the lock.
+  std::exception_ptr fetchError;
+  try {
+    auto numElements = queue.info.nelms();
+    auto data        = upstream.in(queue.id, numElements, false);
+    if (data.data == nullptr) {
+      throw error("[PrefetchingStepIO] Upstream IStepIO unexpectedly did not "
+                  "provide input data for tensor {}",
+                  queue.id);
+    }
+
+    // The upstream data type may differ from the device type (e.g. INT64
+    // data for an INT32 tensor), in which case the conversion is left to the
+    // consumer as if it had called the upstream IStepIO directly.
+    auto &slot = queue.slots[slotIndex];
+    slot.info  = TensorInfo(data.info.dataType(), queue.info.shape());
+
+    auto nbytes = static_cast<size_t>(slot.info.nbytes());
+    if (slot.buffer.size() != nbytes) {
+      slot.buffer.resize(nbytes);
+    }
+    std::memcpy(slot.buffer.data(), data.data, nbytes);
+
+    upstream.inComplete(queue.id, numElements);
+  } catch (...) {
+    fetchError = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (fetchError) {
+      queue.fetchError = fetchError;
+    } else {
+      ++queue.count;
+      ++queue.numFetched;
+    }
+  }
+  queue.ready.notify_all();
+
+  return !fetchError;
+}
+
+PrefetchingStepIO::TensorQueue &
+PrefetchingStepIO::getQueue(const TensorId &id) {
+  auto it = queues.find(id);
+  if (it == queues.end()) {
+    throw error("[PrefetchingStepIO] No input tensor {} was registered with "
+                "the PrefetchingStepIO",
+                id);
+  }
+  return *it->second;
+}
+
+ConstVoidData
+PrefetchingStepIO::in(TensorId id, int64_t numElements, bool prefetch) {
+  auto &queue = getQueue(id);
+
+  if (numElements != queue.info.nelms()) {
+    throw error("[PrefetchingStepIO] Requested {} element(s) for tensor {} "
+                "but the PrefetchingStepIO was created for {} element(s)",
+                numElements,
+                id,
+                queue.info.nelms());
+  }
+
+  std::unique_lock<std::mutex> lock(queue.mutex);
+
+  if (prefetch) {
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    if (queue.count == 0) {
+      ++stats.prefetchMisses;
+      return ConstVoidData{nullptr, queue.info};
+    }
+    ++stats.prefetchHits;
+  } else if (queue.count == 0 && !queue.fetchError) {
+    auto start = std::chrono::steady_clock::now();
+    queue.ready.wait(lock,
+                     [&]() { return queue.count > 0 || queue.fetchError; });
+    std::chrono::duration<double> waited =
+        std::chrono::steady_clock::now() - start;
+
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    ++stats.blockingWaits;
+    stats.deviceWaitSeconds += waited.count();
+  }
+
+  if (queue.count == 0) {
+    std::rethrow_exception(queue.fetchError);
+  }
+
+  auto &slot = queue.slots[queue.head];
+  return ConstVoidData{slot.buffer.data(), slot.info};
+}
+
+void PrefetchingStepIO::inComplete(TensorId id, int64_t) {
+  auto &queue = getQueue(id);
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.count == 0) {
+      throw error("[PrefetchingStepIO] No input data available to mark as "
+                  "complete for tensor {}",
+                  id);
+    }
+    queue.head = (queue.head + 1) % queue.slots.size();
+    --queue.count;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    ++releaseGeneration;
+  }
+  workerWake.notify_all();
+}
+
+MutableVoidData PrefetchingStepIO::out(TensorId id, int64_t numElements) {
+  return upstream.out(id, numElements);
+}
+
+void PrefetchingStepIO::outComplete(TensorId id) { upstream.outComplete(id); }
+
+void PrefetchingStepIO::assertNumElements(const Ir &ir) const {
+  upstream.assertNumElements(ir);
+}
+
+PrefetchingStepIOStats PrefetchingStepIO::getStats() const {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return stats;
+}
+
+void PrefetchingStepIO::resetStats() {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats = PrefetchingStepIOStats();
+}
+
+} // namespace popart
@@ -8,12 +8,19 @@
 #include <popart/op/call.hpp>
 #include <popart/op/conv.hpp>
 #include <popart/op/groupnorm.hpp>
+#include <popart/op/matmul.hpp>
 #include <popart/pbwrap.hpp>
 #include <popart/recompute.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensornames.hpp>
 #include <popart/tensors.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <numeric>
+#include <tuple>
+
 namespace popart {
 
 namespace recompute {
@@ -46,27 +53,16 @@ void annotateStandard(const Graph &graph) {
 
   logging::ir::debug("Ops which are fwdToBwd determined (non-empty set)");
 
-  // liveSets[i] : set of ops whose outputs have not all
-  // been consumed by their (non-grad) consumers just after
-  // linearised[i] has run. By this defn,
-  // linearised[i] \in live[i]
-  std::vector<std::set<Op *>> liveSets = graph.getLiveSets(fwdOps);
-
-  // The memory (bytes) which will be needed to
-  // store all the output tensors in a liveness set.
-  std::vector<int64_t> memoryOfLives;
-  for (auto &liveSet : liveSets) {
-    int64_t mem = 0;
-    for (auto op : liveSet) {
-      mem += op->memOfOutputs();
-    }
-    memoryOfLives.push_back(mem);
-  }
+  // memoryOfLives[i] : the memory (bytes) which will be needed to store all
+  // the output tensors of the ops whose outputs have not all been consumed by
+  // their (non-grad) consumers just after linearised[i] has run. See
+  // Graph::getLiveSets.
+  std::vector<int64_t> memoryOfLives = graph.getLiveMemory(fwdOps);
 
   logging::ir::debug("Memory of outputs of live sets determined");
 
   int nFwdOps = static_cast<int>(fwdOps.size());
-  if (nFwdOps != liveSets.size() || memoryOfLives.size() != nFwdOps) {
+  if (memoryOfLives.size() != nFwdOps) {
     throw internal_error("sizes of vectors do not match");
   }
 
@@ -88,28 +84,34 @@ void annotateStandard(const Graph &graph) {
 
   logging::ir::debug("Decreasing intervals obtained");
 
-  //   defn, checkpoints: Ops whose
-  //   outputs we guarantee will be available
-  //   at any time
-  std::set<Op *> checkpoints;
-
   // we choose the lowest memory set from each interval,
   // and add its members to checkpoints.
+  std::set<int> bestPositions;
   for (auto interval : intervals) {
     int begin            = interval[0];
     int end              = interval[1];
     int64_t lowestMemory = std::numeric_limits<int64_t>::max();
-    std::set<Op *> bestSet{};
+    int bestPosition     = -1;
     for (int i = begin; i < end; ++i) {
       if (memoryOfLives[i] < lowestMemory) {
         lowestMemory = memoryOfLives[i];
-        bestSet      = liveSets[i];
+        bestPosition = i;
       }
     }
-    for (Op *op : bestSet) {
-      if (checkpoints.count(op) == 0) {
-        checkpoints.insert(op);
-      }
+    if (bestPosition >= 0) {
+      bestPositions.insert(bestPosition);
+    }
+  }
+
+  //   defn, checkpoints: Ops whose
+  //   outputs we guarantee will be available
+  //   at any time
+  std::set<Op *> checkpoints;
+
+  // Only the chosen live sets are materialised.
+  for (auto &position_liveSet : graph.getLiveSets(fwdOps, bestPositions)) {
+    for (Op *op : position_liveSet.second) {
+      checkpoints.insert(op);
     }
   }
 
@@ -120,8 +122,258 @@ void annotateStandard(const Graph &graph) {
   }
 }
 
+// Of the ways to checkpoint Ops such that the outputs of each run of
+// recomputed Ops (a segment) are at most maxSegmentMemory bytes, find one
+// which checkpoints the fewest bytes. Solved exactly by dynamic programming
+// over the schedule, with a sliding window minimum.
+std::vector<bool> minMemoryCheckpoints(const std::vector<int64_t> &mem,
+                                       int64_t maxSegmentMemory) {
+  const int nOps = static_cast<int>(mem.size());
+
+  // prefix[i] : bytes output by Ops 0 to i - 1
+  std::vector<int64_t> prefix(nOps + 1, 0);
+  for (int i = 0; i < nOps; ++i) {
+    prefix[i + 1] = prefix[i] + mem[i];
+  }
+
+  // Node 0 is before the first Op, node nOps + 1 is after the last Op and
+  // node p in between is a checkpoint on Op p - 1. Going from node q to node
+  // p recomputes Ops q to p - 2.
+  // lowest[p] : fewest checkpointed bytes up to and including node p
+  std::vector<int64_t> lowest(nOps + 2, 0);
+  std::vector<int> previous(nOps + 2, 0);
+
+  // Nodes q < p, in increasing order of both q and lowest[q]
+  std::deque<int> window;
+  for (int p = 1; p <= nOps + 1; ++p) {
+    while (!window.empty() && lowest[window.back()] >= lowest[p - 1]) {
+      window.pop_back();
+    }
+    window.push_back(p - 1);
+    // The segment from q only grows with p, so nodes which are too far away
+    // can be dropped for good. Node p - 1 is always close enough.
+    while (prefix[p - 1] - prefix[window.front()] > maxSegmentMemory) {
+      window.pop_front();
+    }
+    previous[p] = window.front();
+    lowest[p]   = lowest[window.front()] + (p <= nOps ? mem[p - 1] : 0);
+  }
+
+  std::vector<bool> isCheckpoint(nOps, false);
+  for (int p = previous[nOps + 1]; p > 0; p = previous[p]) {
+    isCheckpoint[p - 1] = true;
+  }
+  return isCheckpoint;
+}
+
+struct BudgetedCandidate {
+  std::vector<bool> isCheckpoint;
+  int64_t checkpointMemory = 0;
+  int64_t peakMemory       = 0;
+  double recomputeCost     = 0.0;
+};
+
+BudgetedCandidate evaluateCheckpoints(std::vector<bool> isCheckpoint,
+                                      const std::vector<int64_t> &mem,
+                                      const std::vector<double> &cost,
+                                      int64_t peakLiveMemory) {
+  BudgetedCandidate candidate;
+  int64_t segmentMemory    = 0;
+  int64_t maxSegmentMemory = 0;
+  for (int i = 0; i < mem.size(); ++i) {
+    if (isCheckpoint[i]) {
+      candidate.checkpointMemory += mem[i];
+      segmentMemory = 0;
+    } else {
+      candidate.recomputeCost += cost[i];
+      segmentMemory += mem[i];
+      maxSegmentMemory = std::max(maxSegmentMemory, segmentMemory);
+    }
+  }
+  candidate.peakMemory = std::max(
+      peakLiveMemory, candidate.checkpointMemory + maxSegmentMemory);
+  candidate.isCheckpoint = std::move(isCheckpoint);
+  return candidate;
+}
+
+BudgetedPlan
+planOps(const Graph &graph, const std::vector<Op *> &ops, int64_t budget) {
+  const int nOps = static_cast<int>(ops.size());
+
+  std::vector<int64_t> mem;
+  std::vector<double> cost;
+  int64_t totalMemory = 0;
+  double totalCost    = 0.0;
+  for (auto op : ops) {
+    mem.push_back(op->memOfOutputs());
+    cost.push_back(estimateRecomputeCost(*op));
+    totalMemory += mem.back();
+    totalCost += cost.back();
+  }
+
+  int64_t peakLiveMemory = 0;
+  for (auto liveMemory : graph.getLiveMemory(ops)) {
+    peakLiveMemory = std::max(peakLiveMemory, liveMemory);
+  }
+
+  // Recomputing in k segments of about totalMemory / k bytes each gives the
+  // classic sqrt(N) checkpointing when k ~ sqrt(N).
+  std::set<int64_t> maxSegmentMemories{0};
+  const int maxSegments = std::min(nOps, 64);
+  for (int k = 1; k <= maxSegments; ++k) {
+    maxSegmentMemories.insert((totalMemory + k - 1) / k);
+  }
+
+  // Ops which are the most expensive to recompute per byte first
+  std::vector<int> byCostPerByte(nOps);
+  std::iota(byCostPerByte.begin(), byCostPerByte.end(), 0);
+  std::stable_sort(byCostPerByte.begin(),
+                   byCostPerByte.end(),
+                   [&mem, &cost](int a, int b) {
+                     return cost[a] * std::max<int64_t>(mem[b], 1) >
+                            cost[b] * std::max<int64_t>(mem[a], 1);
+                   });
+
+  auto withinBudget = [budget](const BudgetedCandidate &c) {
+    return budget > 0 && c.peakMemory <= budget;
+  };
+  auto isBetter = [&withinBudget](const BudgetedCandidate &a,
+                                  const BudgetedCandidate &b) {
+    if (withinBudget(a) != withinBudget(b)) {
+      return withinBudget(a);
+    }
+    if (withinBudget(a)) {
+      return std::tie(a.recomputeCost, a.peakMemory) <
+             std::tie(b.recomputeCost, b.peakMemory);
+    }
+    return std::tie(a.peakMemory, a.recomputeCost) <
+           std::tie(b.peakMemory, b.recomputeCost);
+  };
+
+  BudgetedCandidate best;
+  bool haveBest = false;
+  for (auto maxSegmentMemory : maxSegmentMemories) {
+    auto candidate = evaluateCheckpoints(
+        minMemoryCheckpoints(mem, maxSegmentMemory), mem, cost, peakLiveMemory);
+
+    // Spend what is left of the budget on also checkpointing the Ops which
+    // save the most recomputation per byte. Checkpointing an Op can only
+    // shorten segments, so this can't take the plan over the budget.
+    int64_t spare = withinBudget(candidate) ? budget - candidate.peakMemory : 0;
+    auto isCheckpoint = candidate.isCheckpoint;
+    for (int i : byCostPerByte) {
+      if (!isCheckpoint[i] && mem[i] <= spare) {
+        isCheckpoint[i] = true;
+        spare -= mem[i];
+      }
+    }
+    candidate =
+        evaluateCheckpoints(std::move(isCheckpoint), mem, cost, peakLiveMemory);
+
+    if (!haveBest || isBetter(candidate, best)) {
+      best     = std::move(candidate);
+      haveBest = true;
+    }
+  }
+
+  BudgetedPlan plan;
+  for (int i = 0; i < nOps; ++i) {
+    if (best.isCheckpoint[i]) {
+      plan.checkpoints.insert(ops[i]);
+    }
+  }
+  plan.checkpointMemory    = best.checkpointMemory;
+  plan.estimatedPeakMemory = best.peakMemory;
+  plan.recomputeCost       = best.recomputeCost;
+  plan.forwardCost         = totalCost;
+  plan.withinBudget        = budget <= 0 || withinBudget(best);
+  return plan;
+}
+
+void annotateBudgeted(const Graph &graph) {
+  auto &opts  = graph.getIr().getSessionOptions();
+  auto budget = opts.autoRecomputationMemoryBudget;
+
+  std::set<Op *> checkpoints;
+  for (auto &plan : planBudgeted(graph, budget)) {
+    checkpoints.insert(plan.checkpoints.begin(), plan.checkpoints.end());
+
+    double extraCompute =
+        plan.forwardCost > 0.0 ? plan.recomputeCost / plan.forwardCost : 0.0;
+    logging::transform::info(
+        "[Budgeted recompute] Virtual graph {}: {} bytes of checkpoints, "
+        "estimated peak activation memory {} bytes (budget {}), recomputation "
+        "adds {}% to the forward pass compute",
+        plan.virtualGraphId,
+        plan.checkpointMemory,
+        plan.estimatedPeakMemory,
+        budget,
+        static_cast<int64_t>(std::round(100.0 * extraCompute)));
+    if (!plan.withinBudget) {
+      logging::transform::warn(
+          "[Budgeted recompute] Unable to keep the estimated peak activation "
+          "memory of virtual graph {} within {} bytes, using the lowest memory "
+          "checkpoints found ({} bytes)",
+          plan.virtualGraphId,
+          budget,
+          plan.estimatedPeakMemory);
+    }
+  }
+
+  for (auto op : graph.getOpSchedule({})) {
+    if (op->toLoss == PathToLoss::Yes && checkpoints.count(op) == 0) {
+      op->settings.recomputeType = RecomputeType::Recompute;
+    }
+  }
+}
+
 } // namespace
 
+double estimateRecomputeCost(const Op &op) {
+  double outElements = 0.0;
+  for (auto &t_inds : op.output->indicesMap()) {
+    outElements += static_cast<double>(t_inds.first->info.nelms());
+  }
+
+  // Every output element of a convolution or matmul needs one multiply-
+  // accumulate per element of the reduced dimension(s). Everything else is
+  // assumed to take a constant number of operations per output element.
+  if (op.isConvertibleTo<ConvOp>() &&
+      op.input->hasIndex(ConvOp::getWeightsInIndex())) {
+    auto &weights = op.input->tensor(ConvOp::getWeightsInIndex())->info;
+    if (weights.rank() > 0 && weights.dim(0) > 0) {
+      auto macsPerElement = weights.nelms() / weights.dim(0);
+      return outElements * static_cast<double>(macsPerElement);
+    }
+  } else if (op.isConvertibleTo<MatMulOp>()) {
+    auto &lhs = dynamic_cast<const MatMulOp &>(op).lhsIn()->info;
+    if (lhs.rank() > 0) {
+      return outElements * static_cast<double>(lhs.dim(lhs.rank() - 1));
+    }
+  }
+  return outElements;
+}
+
+std::vector<BudgetedPlan> planBudgeted(const Graph &graph,
+                                       int64_t memoryBudget) {
+  // The forward Ops of each virtual graph, in schedule order
+  std::map<VGraphId, std::vector<Op *>> fwdOps;
+  for (auto op : graph.getOpSchedule({})) {
+    if (op->toLoss == PathToLoss::Yes) {
+      auto vgid = op->hasVirtualGraphId() ? op->getVirtualGraphId()
+                                          : unusedVGraphId;
+      fwdOps[vgid].push_back(op);
+    }
+  }
+
+  std::vector<BudgetedPlan> plans;
+  for (auto &vgid_ops : fwdOps) {
+    plans.push_back(planOps(graph, vgid_ops.second, memoryBudget));
+    plans.back().virtualGraphId = vgid_ops.first;
+  }
+  return plans;
+}
+
 void autoAnnotate(Graph &graph, RecomputationType rctype) {
 
   switch (rctype) {
@@ -140,6 +392,11 @@ void autoAnnotate(Graph &graph, RecomputationType rctype) {
     annotateNormOnly(graph);
     break;
   }
+  case RecomputationType::Budgeted: {
+    logging::transform::info("Using 'Budgeted' auto-recompute method");
+    annotateBudgeted(graph);
+    break;
+  }
 
   case RecomputationType::N:
   case RecomputationType::Pipeline:
@@ -1,11 +1,12 @@
 // Copyright (c) 2018 Graphcore Ltd. All rights reserved.
+#include <chrono>
 #include <fstream>
 
 #include <popart/builder_impl.hpp>
 #include <popart/error.hpp>
 #include <popart/filereader.hpp>
 #include <popart/graph.hpp>
-#include <popart/ir.hpp>
+#include <popart/ir->hpp>
 #include <popart/logging.hpp>
 #include <popart/onnxutil.hpp>
 #include <popart/popx/devicex.hpp>
@@ -15,6 +16,11 @@
 #include <popart/tensor.hpp>
 #include <popart/tensordata.hpp>
 #include <popart/tensors.hpp>
+#include <popart/transforms/auto_virtual_graph.hpp>
+#include <popart/transforms/mergevarupdates.hpp>
+#include <popart/transforms/pipeline.hpp>
+#include <popart/transforms/replicatedallreducebucketing.hpp>
+#include <popart/transforms/streamingmemory.hpp>
 #include <popart/util.hpp>
 #include <popart/version.hpp>
 
@@ -22,7 +28,25 @@
 
 namespace popart {
 
-Session::Session() {
+SessionRunHandle::SessionRunHandle(std::shared_future<void> future_)
+    : future(future_) {}
+
+void SessionRunHandle::wait() const {
+  if (!future.valid()) {
+    throw error("SessionRunHandle is not associated with a step");
+  }
+  future.get();
+}
+
+bool SessionRunHandle::isComplete() const {
+  if (!future.valid()) {
+    throw error("SessionRunHandle is not associated with a step");
+  }
+  return future.wait_for(std::chrono::seconds(0)) ==
+         std::future_status::ready;
+}
+
+Session::Session() : ir(std::make_unique<Ir>()) {
   POPART_TRACEPOINT();
   logging::session::info("Popart version: {}", popart::core::versionString());
   logging::session::info("Popart release githash: {}",
@@ -32,19 +56,20 @@ Session::Session() {
 void Session::setDevice(std::shared_ptr<DeviceInfo> deviceInfo) {
   POPART_TRACEPOINT();
   logging::session::trace("Session::setDevice({})", *deviceInfo);
-  device_.reset(new popx::Devicex(ir, deviceInfo));
+  device_.reset(new popx::Devicex(*ir, deviceInfo));
 }
 
 void Session::setRandomSeed(uint64_t seedValue) {
   POPART_TRACEPOINT();
   logging::session::trace("Session::setRandomSeed({})", seedValue);
-  if (!ir.requiresRandomSeed()) {
+  if (!ir->requiresRandomSeed()) {
     logging::session::warn("Trying to set the random seed, but this session "
                            "has no random behaviour. Doing nothing.");
     return;
   }
-  // Set seed value on host
-  ir.setRandomSeedValue(seedValue);
+  // Set seed value on host, once the steps in flight are done with it
+  waitForPendingRuns();
+  ir->setRandomSeedValue(seedValue);
 
   // ... Then stream to device
   if (!device_->prepareHasBeenCalled()) {
@@ -60,6 +85,7 @@ uint64_t Session::getCycleCount(std::string id) {
   if (!runCalled) {
     throw error("Must call run before getCycleCount.");
   }
+  waitForPendingRuns();
   auto cycleCounts = device_->cycleCountTensorToHost();
   if (cycleCounts.find(id) != cycleCounts.end()) {
     // Always get cycle count from first replica
@@ -74,14 +100,14 @@ uint64_t Session::getCycleCount(std::string id) {
 // get the TensorInfo on a Tensor
 TensorInfo Session::getInfo(TensorId id) const {
   logging::session::trace("Session::getInfo({})", id);
-  TensorInfo info = ir.getMainGraph().getTensors().get(id)->info;
+  TensorInfo info = ir->getMainGraph().getTensors().get(id)->info;
   if (!info.isSet()) {
     throw error("TensorInfo for `" + id + "' not set");
   }
   return info;
 }
 
-Session::~Session() = default;
+Session::~Session() { waitForPendingRuns(); }
 
 void Session::compileAndExport(std::string executablePath,
                                std::string weightsPath) {
@@ -112,6 +138,7 @@ void Session::weightsFromHost() {
   POPART_TRACEPOINT();
   logging::session::trace("Sessions::weightsFromHost");
 
+  waitForPendingRuns();
   device_->weightsFromHost();
   weightsFromHostCalled = true;
 }
@@ -124,6 +151,7 @@ void Session::weightsToHost() {
     throw error("Must call setDevice before {}", __func__);
   }
 
+  waitForPendingRuns();
   device_->weightsToHost();
 }
 
@@ -135,6 +163,7 @@ void Session::readWeights(const IWeightsIO &weightsIo) {
     throw error("Must call setDevice before {}", __func__);
   }
 
+  waitForPendingRuns();
   device_->readWeights(weightsIo);
 }
 
@@ -146,55 +175,94 @@ void Session::writeWeights(const IWeightsIO &weightsIo) {
     throw error("Must call setDevice before {}", __func__);
   }
 
+  waitForPendingRuns();
   device_->writeWeights(weightsIo);
 }
 
 void Session::exportInputs(IStepIO &stepIO,
                            int64_t num_elements,
-                           const std::string &output_filename) {
+                           const std::string &output_filename,
+                           const popx::StepIOExportOptions &options) {
   POPART_TRACEPOINT();
   logging::session::trace("Session::exportInputs");
-  exportStepIO(stepIO, *device_, num_elements, output_filename);
+  exportStepIO(stepIO, *device_, num_elements, output_filename, options);
 }
 
-void Session::run(IStepIO &stepio, std::string debugName) {
-  POPART_TRACEPOINT();
-  logging::session::trace("Session::run {}", debugName);
-  if (!ir.canInfer()) {
+void Session::assertCanRun() const {
+  if (!ir->canInfer()) {
     throw error("Trying to infer when not in inference mode");
   }
 
-  if (ir.containsInitialisers() && ir.isTraining() &&
+  if (ir->containsInitialisers() && ir->isTraining() &&
       weightsFromHostCalled == false) {
     throw error(
         "Must call weightsFromHost before run as the model has initializers "
         "and the session has been created in training mode");
   }
+}
+
+void Session::waitForPendingRuns() const {
+  if (pendingRun.valid()) {
+    pendingRun.wait();
+  }
+}
+
+void Session::run(IStepIO &stepio, std::string debugName) {
+  POPART_TRACEPOINT();
+  logging::session::trace("Session::run {}", debugName);
+  assertCanRun();
+  waitForPendingRuns();
 
   device_->run(stepio, debugName);
 
   runCalled = true;
 }
 
+SessionRunHandle Session::runAsync(IStepIO &stepio, std::string debugName) {
+  POPART_TRACEPOINT();
+  logging::session::trace("Session::runAsync {}", debugName);
+  assertCanRun();
+
+  // Chain onto the previous step so that steps run in order and never
+  // overlap on the (non thread safe) device.
+  auto previousRun = pendingRun;
+
+  auto step = [this, &stepio, debugName, previousRun]() {
+    if (previousRun.valid()) {
+      // Rethrows if the previous step failed, in which case this step is not
+      // started.
+      previousRun.get();
+    }
+    device_->run(stepio, debugName);
+  };
+
+  pendingRun = std::async(std::launch::async, step).share();
+
+  runCalled = true;
+  return SessionRunHandle(pendingRun);
+}
+
 // write current model to ONNX file
 void Session::modelToHost(const std::string &fn) {
   POPART_TRACEPOINT();
   logging::session::trace("Session::modelToHost");
 
-  ONNX_NAMESPACE::ModelProto model      = ir.getModel();
+  waitForPendingRuns();
+
+  ONNX_NAMESPACE::ModelProto model      = ir->getModel();
   ONNX_NAMESPACE::GraphProto *onnxgraph = model.mutable_graph();
 
-  for (auto tId : ir.additionalModelProtoTensors) {
+  for (auto tId : ir->additionalModelProtoTensors) {
     // For additional tensors we want to save in the onnx modelproto, we copy
     // their info into across to the proto.
-    if (ir.tensorExistsInInitialisers(tId)) {
+    if (ir->tensorExistsInInitialisers(tId)) {
       throw error("Tensor id {} already in initializers, duplicate tensor "
                   "Ids not allowed in onnx specification.",
                   tId);
     } else {
       ONNX_NAMESPACE::TensorProto *init = onnxgraph->add_initializer();
       init->set_name(tId);
-      auto tensor = ir.getMainGraph().getTensors().get(tId);
+      auto tensor = ir->getMainGraph().getTensors().get(tId);
 
       ConstVoidData cvData;
       cvData.data = tensor->tensorData()->data();
@@ -260,10 +328,10 @@ void Session::modelToHost(const std::string &fn) {
 
   io::writeModel(model, fn);
 
-  if (!ir.getSessionOptions().constantWeights ||
-      ir.getExecutionMode() != Ir::ExecutionMode::Inference) {
+  if (!ir->getSessionOptions().constantWeights ||
+      ir->getExecutionMode() != Ir::ExecutionMode::Inference) {
     // Weights in ir, device, and disk now all match
-    ir.resetWeights(model);
+    ir->resetWeights(model);
   }
 }
 
@@ -271,6 +339,7 @@ std::string Session::getSummaryReport(bool resetProfile) const {
   POPART_TRACEPOINT();
   logging::session::trace("Session::getSummaryReport");
 
+  waitForPendingRuns();
   return device_->getSummaryReport(resetProfile);
 }
 
@@ -283,6 +352,7 @@ std::string Session::getGraphReport(bool useCbor) const {
 std::string Session::getExecutionReport(bool useCbor, bool resetProfile) const {
   POPART_TRACEPOINT();
   logging::session::trace("Session::getExecutionReport");
+  waitForPendingRuns();
   return device_->getExecutionReport(useCbor, resetProfile);
 }
 
@@ -298,17 +368,128 @@ TensorTileMap Session::getTensorTileMap() const {
   return device_->getTensorTileMap();
 }
 
+const AutoVirtualGraphPlan &Session::getAutoVirtualGraphPlan() const {
+  logging::session::trace("Session::getAutoVirtualGraphPlan");
+
+  auto plan = ir->getAutoVirtualGraphPlan();
+  if (plan == nullptr) {
+    throw error("No automatic virtual graph plan is available. Set the "
+                "'virtualGraphMode' session option to VirtualGraphMode::Auto "
+                "or VirtualGraphMode::Balanced, with more than one IPU");
+  }
+  return *plan;
+}
+
+const PipelineStashReport &Session::getPipelineStashReport() const {
+  logging::session::trace("Session::getPipelineStashReport");
+
+  auto report = ir->getPipelineStashReport();
+  if (report == nullptr) {
+    throw error("No pipeline stash report is available. Set the "
+                "'enablePipelining' session option to train a pipelined "
+                "model");
+  }
+  return *report;
+}
+
+const MergeVarUpdateReport &Session::getMergeVarUpdateReport() const {
+  logging::session::trace("Session::getMergeVarUpdateReport");
+
+  auto report = ir->getMergeVarUpdateReport();
+  if (report == nullptr) {
+    throw error("No VarUpdate merging report is available. Set the "
+                "'mergeVarUpdate' session option to train a model with "
+                "merged VarUpdates");
+  }
+  return *report;
+}
+
+const ExecutionPhasePlan &Session::getExecutionPhasePlan() const {
+  logging::session::trace("Session::getExecutionPhasePlan");
+
+  auto plan = ir->getExecutionPhasePlan();
+  if (plan == nullptr) {
+    throw error("No execution phase plan is available. Set the "
+                "'executionPhaseSettings.autoMemoryBudget' session option, "
+                "with VirtualGraphMode::ExecutionPhases and more than one "
+                "phase");
+  }
+  return *plan;
+}
+
+const ReplicatedTensorShardingPlan &
+Session::getReplicatedTensorShardingPlan() const {
+  logging::session::trace("Session::getReplicatedTensorShardingPlan");
+
+  auto plan = ir->getReplicatedTensorShardingPlan();
+  if (plan == nullptr) {
+    throw error("No replicated tensor sharding plan is available. Set the "
+                "'replicatedTensorShardingMemoryBudget' session option");
+  }
+  return *plan;
+}
+
+PlanningCacheStatistics Session::getPlanningCacheStatistics() const {
+  logging::session::trace("Session::getPlanningCacheStatistics");
+  if (!device_) {
+    throw error("Must call prepareDevice before getPlanningCacheStatistics");
+  }
+  return device_->getPlanningCacheStatistics();
+}
+
+const ReplicatedAllReduceBucketReport &
+Session::getReplicatedAllReduceBucketReport() const {
+  logging::session::trace("Session::getReplicatedAllReduceBucketReport");
+
+  auto report = ir->getReplicatedAllReduceBucketReport();
+  if (report == nullptr) {
+    throw error("No all-reduce bucket report is available. Set the "
+                "'replicatedAllReduceBucketSize' session option to train a "
+                "replicated model");
+  }
+  return *report;
+}
+
+MemoryEstimate Session::getMemoryEstimate() const {
+  logging::session::trace("Session::getMemoryEstimate");
+
+  return estimateMemory(*ir);
+}
+
+const BatchSerializationFactorChoice &
+Session::getBatchSerializationFactorChoice() const {
+  logging::session::trace("Session::getBatchSerializationFactorChoice");
+
+  if (batchSerializationFactorChoice.candidates.empty()) {
+    throw error("No batch serialisation factor was chosen. Set "
+                "BatchSerializationSettings::autoMemoryBudget to choose one "
+                "automatically");
+  }
+  return batchSerializationFactorChoice;
+}
+
+void Session::prepareIr(const IrBundle &bundle) {
+  if (bundle.userOptions.batchSerializationSettings.autoMemoryBudget <= 0) {
+    ir->prepare(bundle);
+    return;
+  }
+
+  // The Ir prepared for the chosen factor is kept, rather than prepared again
+  batchSerializationFactorChoice = chooseBatchSerializationFactor(bundle, ir);
+}
+
 void Session::resetHostWeights(
     const std::string &modelProtoOrFilename,
     const bool ignoreWeightsInModelWithoutCorrespondingHostWeight) {
   POPART_TRACEPOINT();
   logging::session::trace("Session::resetHostWeights");
-  if (ir.getSessionOptions().constantWeights &&
-      ir.getExecutionMode() == Ir::ExecutionMode::Inference) {
+  if (ir->getSessionOptions().constantWeights &&
+      ir->getExecutionMode() == Ir::ExecutionMode::Inference) {
     throw error("Cannot call resetHostWeights when constantWeights is set");
   }
   auto modelProto = onnxutil::getModelProto(modelProtoOrFilename);
-  ir.resetWeights(modelProto,
+  waitForPendingRuns();
+  ir->resetWeights(modelProto,
                   ignoreWeightsInModelWithoutCorrespondingHostWeight);
 
   // After the weights has been reset they must be rewritten to the target
@@ -318,7 +499,7 @@ void Session::resetHostWeights(
 std::string Session::serializeIr(IrSerializationFormat format) {
   (void)format;
   std::stringstream ss;
-  ir.serialise(Ir::SerialiseFormat::JSON, ss);
+  ir->serialise(Ir::SerialiseFormat::JSON, ss);
   return ss.str();
 }
 
@@ -339,7 +520,7 @@ void InferenceSession::configureFromOnnx(
 
   auto modelProto = onnxutil::getModelProto(modelProtoOrFilename);
 
-  ir.prepare(
+  prepareIr(
       {modelProto, perk, df, {}, nullptr, *deviceInfo, userOptions, patterns});
 }
 
@@ -384,14 +565,14 @@ void TrainingSession::configureFromOnnx(const std::string &modelProtoOrFilename,
 
   auto modelProto = onnxutil::getModelProto(modelProtoOrFilename);
 
-  ir.prepare({modelProto,
-              perk,
-              df,
-              lossIn,
-              &optimizerIn,
-              *deviceInfo,
-              userOptions,
-              patterns});
+  prepareIr({modelProto,
+             perk,
+             df,
+             lossIn,
+             &optimizerIn,
+             *deviceInfo,
+             userOptions,
+             patterns});
 }
 
 std::unique_ptr<TrainingSession>
@@ -426,10 +607,20 @@ TrainingSession::createFromOnnxModel(const std::string &model,
   return session;
 }
 
-void TrainingSession::updateOptimizerFromHost(const Optimizer *optimizer) {
+std::vector<TensorId>
+TrainingSession::updateOptimizerFromHost(const Optimizer *optimizer) {
   POPART_TRACEPOINT();
   logging::session::trace("TrainingSession::updateOptimizerFromHost");
-  ir.updateOptimizer(*optimizer);
+  waitForPendingRuns();
+
+  auto changed = ir->updateOptimizer(*optimizer);
+
+  // The device already holds the values of the optimizer tensors
+  if (changed.empty()) {
+    logging::session::debug("No optimizer tensors changed, not writing the "
+                            "optimizer to the device");
+    return changed;
+  }
 
   // There has been a change to the TensorData of the optimizer tensors
   // on the host, but there wont be an equivalent update to the device-side
@@ -438,6 +629,7 @@ void TrainingSession::updateOptimizerFromHost(const Optimizer *optimizer) {
   // write whatever optimizer tensors (learning rates,
   // momentum, initial momentum tensors) there are to device
   device_->optimizerFromHost();
+  return changed;
 }
 
 const std::vector<std::string> &
@@ -455,6 +647,7 @@ void TrainingSession::connectStreamToCallback(
     std::function<void(void *)> callback,
     unsigned index) {
   POPART_TRACEPOINT();
+  waitForPendingRuns();
   device_->connectStreamToCallback(streamHandle, callback, index);
 }
 
@@ -463,6 +656,7 @@ void TrainingSession::copyFromRemoteBuffer(const std::string &buffer,
                                            int repeat_index,
                                            unsigned replication_index) {
   POPART_TRACEPOINT();
+  waitForPendingRuns();
   device_->copyFromRemoteBuffer(buffer, w, repeat_index, replication_index);
 }
 
@@ -471,6 +665,7 @@ void TrainingSession::copyToRemoteBuffer(void *w,
                                          int repeat_index,
                                          unsigned replication_index) {
   POPART_TRACEPOINT();
+  waitForPendingRuns();
   device_->copyToRemoteBuffer(w, buffer, repeat_index, replication_index);
 }
 
@@ -62,6 +62,30 @@ BatchSerializationSettings::BatchSerializationSettings(
       concatOnPipelineStageChange{concatOnPipelineStageChange_},
       batchSchedule{batchSchedule_} {}
 
+void DynamicLossScalingSettings::validate() const {
+  if (growthInterval <= 0) {
+    throw error("The dynamic loss scaling growth interval is {}, it must be "
+                "positive",
+                growthInterval);
+  }
+  if (growthFactor < 1.0f) {
+    throw error("The dynamic loss scaling growth factor is {}, it must be at "
+                "least 1",
+                growthFactor);
+  }
+  if (backoffFactor <= 0.0f || backoffFactor > 1.0f) {
+    throw error("The dynamic loss scaling backoff factor is {}, it must be in "
+                "(0, 1]",
+                backoffFactor);
+  }
+  if (minFactor <= 0.0f || minFactor > 1.0f || maxFactor < 1.0f) {
+    throw error("The dynamic loss scaling factor is bounded by [{}, {}], "
+                "which must be positive and contain 1",
+                minFactor,
+                maxFactor);
+  }
+}
+
 std::string getDotCheckString(DotCheck d) {
   const static std::array<std::string, NDotChecks> V = getDotCheckIds();
   return V[static_cast<int>(d)];
@@ -93,6 +117,8 @@ std::string toString(VirtualGraphMode v) {
     return "VirtualGraphMode::Auto";
   case VirtualGraphMode::ExecutionPhases:
     return "VirtualGraphMode::ExecutionPhases";
+  case VirtualGraphMode::Balanced:
+    return "VirtualGraphMode::Balanced";
   case VirtualGraphMode::N:
     throw error("Bad VirtualGraphMode {}", static_cast<int>(v));
   default:
@@ -115,6 +141,8 @@ std::string toString(RecomputationType r) {
     return "RecomputationType::Pipeline";
   case RecomputationType::NormOnly:
     return "RecomputationType::NormOnly";
+  case RecomputationType::Budgeted:
+    return "RecomputationType::Budgeted";
   case RecomputationType::N:
     throw error("Bad RecomputationType {}", static_cast<int>(r));
   default:
@@ -1,14 +1,18 @@
 // Copyright (c) 2020 Graphcore Ltd. All rights reserved.
 #include <popart/stepiosplitter.hpp>
 
+#include <algorithm>
+
 namespace popart {
 
 StepIOSplitterAdapter::StepIOSplitterAdapter(StepIOSplitter *splitter_,
                                              unsigned replicationIndex_,
                                              TensorId id,
-                                             const TensorInfo &info)
+                                             const TensorInfo &info,
+                                             size_t bufferCapacity)
     : splitter(splitter_), replicationIndex(replicationIndex_), adapterId(id),
-      inData(), outData(), emptyVoidData{nullptr, info} {}
+      inData(bufferCapacity), outData(bufferCapacity),
+      emptyVoidData{nullptr, info} {}
 
 ConstVoidData
 StepIOSplitterAdapter::in(TensorId id, int64_t numElements, bool prefetch) {
@@ -177,6 +181,16 @@ void StepIOSplitter::getInData(TensorId id,
   unsigned lastInIndex    = 0;
   auto &splitIoTensorInfo = it->second;
 
+  std::lock_guard<std::mutex> lock(upstreamMutex);
+
+  // Another replica may have fetched data for this replica while we were
+  // waiting for the lock, in which case there is nothing left to do.
+  auto requestedIt = splitIoTensorInfo.adapterMap.find(replicationIndex);
+  if (requestedIt != splitIoTensorInfo.adapterMap.end() &&
+      !requestedIt->second->getInData().empty()) {
+    return;
+  }
+
   do {
     // Remember the index we're getting data for as it is used in the loop
     // condition and the value of inIndex may or may not change when we get
@@ -287,6 +301,16 @@ void StepIOSplitter::getOutData(TensorId id,
   unsigned lastOutIndex   = 0;
   auto &splitIoTensorInfo = it->second;
 
+  std::lock_guard<std::mutex> lock(upstreamMutex);
+
+  // Another replica may have fetched a buffer for this replica while we were
+  // waiting for the lock, in which case there is nothing left to do.
+  auto requestedIt = splitIoTensorInfo.adapterMap.find(replicationIndex);
+  if (requestedIt != splitIoTensorInfo.adapterMap.end() &&
+      !requestedIt->second->getOutData().empty()) {
+    return;
+  }
+
   do {
     // Remember the index we're getting data for as it is updated in the loop.
     lastOutIndex = splitIoTensorInfo.outIndex;
@@ -350,6 +374,12 @@ void StepIOSplitter::assertNumElements(const Ir &ir) const {
   }
 }
 
+size_t StepIOSplitter::bufferCapacity() const {
+  // Each replica receives at most one element per batch per accumulation.
+  return std::max<size_t>(
+      1, static_cast<size_t>(batchesPerStep) * accumulationFactor);
+}
+
 IStepIO *StepIOSplitter::getDownstreamStepIO(TensorId id,
                                              const TensorInfo &info,
                                              unsigned replicationIndex) {
@@ -364,7 +394,7 @@ IStepIO *StepIOSplitter::getDownstreamStepIO(TensorId id,
       // We have a StepIOTensorInfo but no adapter for this replication index.
       auto &adapter = splitIoTensorInfo.adapterMap[replicationIndex];
       adapter       = std::make_unique<StepIOSplitterAdapter>(
-          this, replicationIndex, id, info);
+          this, replicationIndex, id, info, bufferCapacity());
       return adapter.get();
     }
   } else {
@@ -372,7 +402,7 @@ IStepIO *StepIOSplitter::getDownstreamStepIO(TensorId id,
     auto &splitIoTensorInfo = downstreamIoMap[id];
     auto &adapter           = splitIoTensorInfo.adapterMap[replicationIndex];
     adapter                 = std::make_unique<StepIOSplitterAdapter>(
-        this, replicationIndex, id, info);
+        this, replicationIndex, id, info, bufferCapacity());
     return adapter.get();
   }
 }
@@ -385,6 +415,8 @@ void StepIOSplitter::inCompleteCallback(TensorId id,
   if (it1 != downstreamIoMap.end()) {
     auto &splitIoTensorInfo = it1->second;
 
+    std::lock_guard<std::mutex> lock(upstreamMutex);
+
     // Is this the last replica that we got data for?
     auto replicaMatch = ((replicationIndex + 1) % replicationFactor) ==
                         splitIoTensorInfo.inIndex;
@@ -0,0 +1,275 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <boost/random/normal_distribution.hpp>
+#include <popart/error.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/syntheticstepio.hpp>
+#include <popart/tensor.hpp>
+#include <popart/util.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+
+namespace popart {
+
+namespace {
+
+template <typename T>
+void fillIntegers(char *dst,
+                  int64_t n,
+                  int64_t low,
+                  int64_t high,
+                  std::mt19937_64 &generator) {
+  std::uniform_int_distribution<int64_t> distribution(low, high - 1);
+  T *typedDst = reinterpret_cast<T *>(dst);
+  for (int64_t i = 0; i < n; ++i) {
+    typedDst[i] = static_cast<T>(distribution(generator));
+  }
+}
+
+template <typename T> bool isRepresentable(int64_t value) {
+  if (value < 0) {
+    return std::numeric_limits<T>::is_signed &&
+           value >= static_cast<int64_t>(std::numeric_limits<T>::min());
+  }
+  return static_cast<uint64_t>(value) <=
+         static_cast<uint64_t>(std::numeric_limits<T>::max());
+}
+
+bool isRepresentable(int64_t value, DataType dataType) {
+  switch (dataType) {
+  case DataType::INT8:
+    return isRepresentable<int8_t>(value);
+  case DataType::UINT8:
+    return isRepresentable<uint8_t>(value);
+  case DataType::INT16:
+    return isRepresentable<int16_t>(value);
+  case DataType::UINT16:
+    return isRepresentable<uint16_t>(value);
+  case DataType::INT32:
+    return isRepresentable<int32_t>(value);
+  case DataType::UINT32:
+    return isRepresentable<uint32_t>(value);
+  case DataType::INT64:
+    return isRepresentable<int64_t>(value);
+  case DataType::UINT64:
+    return isRepresentable<uint64_t>(value);
+  default:
+    throw error("SyntheticInput::uniformInt does not support data type {}",
+                dataType);
+  }
+}
+
+int64_t dataTypeSize(DataType dataType) {
+  return getDataTypeInfoMap().at(dataType).nbytes();
+}
+
+} // namespace
+
+SyntheticInput::SyntheticInput(Kind kind, DataType dataType)
+    : kind_(kind), dataType_(dataType) {}
+
+SyntheticInput
+SyntheticInput::uniformInt(int64_t low, int64_t high, DataType dataType) {
+  if (high <= low) {
+    throw error("SyntheticInput::uniformInt requires low < high, got [{}, {})",
+                low,
+                high);
+  }
+  if (!isRepresentable(low, dataType) || !isRepresentable(high - 1, dataType)) {
+    throw error("SyntheticInput::uniformInt range [{}, {}) does not fit in "
+                "data type {}",
+                low,
+                high,
+                dataType);
+  }
+  SyntheticInput input(Kind::UniformInt, dataType);
+  input.low  = low;
+  input.high = high;
+  return input;
+}
+
+SyntheticInput
+SyntheticInput::normal(float mean, float stddev, DataType dataType) {
+  if (dataType != DataType::FLOAT && dataType != DataType::FLOAT16) {
+    throw error("SyntheticInput::normal only supports FLOAT and FLOAT16, "
+                "not {}",
+                dataType);
+  }
+  SyntheticInput input(Kind::Normal, dataType);
+  input.mean   = mean;
+  input.stddev = stddev;
+  return input;
+}
+
+SyntheticInput SyntheticInput::replay(const ConstVoidData &batch) {
+  SyntheticInput input(Kind::Replay, batch.info.dataType());
+  auto begin = static_cast<const char *>(batch.data);
+  input.replayData.assign(begin, begin + batch.info.nbytes());
+  return input;
+}
+
+std::vector<char> SyntheticInput::generate(int64_t numElements,
+                                           unsigned numBatches,
+                                           uint64_t seed) const {
+  const int64_t batchBytes = numElements * dataTypeSize(dataType_);
+  std::vector<char> data(batchBytes * numBatches);
+  std::mt19937_64 generator(seed);
+
+  switch (kind_) {
+  case Kind::UniformInt: {
+    const int64_t n = numElements * numBatches;
+    switch (dataType_) {
+    case DataType::INT8:
+      fillIntegers<int8_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::UINT8:
+      fillIntegers<uint8_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::INT16:
+      fillIntegers<int16_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::UINT16:
+      fillIntegers<uint16_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::INT32:
+      fillIntegers<int32_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::UINT32:
+      fillIntegers<uint32_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::INT64:
+      fillIntegers<int64_t>(data.data(), n, low, high, generator);
+      break;
+    case DataType::UINT64:
+      fillIntegers<uint64_t>(data.data(), n, low, high, generator);
+      break;
+    default:
+      throw error("SyntheticInput::uniformInt does not support data type {}",
+                  dataType_);
+    }
+    break;
+  }
+  case Kind::Normal: {
+    // Boost Random ensures numerical consistency across implementations
+    boost::random::normal_distribution<float> distribution(mean, stddev);
+    const int64_t elementBytes = dataTypeSize(dataType_);
+    for (int64_t i = 0; i < numElements * numBatches; ++i) {
+      auto converted =
+          convertFloatToDataType(dataType_, distribution(generator));
+      std::memcpy(&data[i * elementBytes], converted.data(), elementBytes);
+    }
+    break;
+  }
+  case Kind::Replay: {
+    if (replayData.size() != batchBytes) {
+      throw error("The recorded batch has {} byte(s) but {} element(s) of "
+                  "type {} were requested",
+                  replayData.size(),
+                  numElements,
+                  dataType_);
+    }
+    for (unsigned b = 0; b < numBatches; ++b) {
+      std::memcpy(&data[b * batchBytes], replayData.data(), batchBytes);
+    }
+    break;
+  }
+  }
+
+  return data;
+}
+
+SyntheticStepIO::SyntheticStepIO(
+    const std::map<TensorId, SyntheticInput> &inputs_,
+    unsigned poolSize_,
+    uint64_t seed_)
+    : poolSize(std::max(1u, poolSize_)), seed(seed_) {
+  for (auto &input : inputs_) {
+    inputs.emplace(input.first, std::make_unique<InputState>(input.second));
+  }
+}
+
+SyntheticStepIO::InputState &SyntheticStepIO::getInput(const TensorId &id,
+                                                       int64_t numElements) {
+  auto it = inputs.find(id);
+  if (it == inputs.end()) {
+    throw error("No synthetic input generator provided for tensor {}", id);
+  }
+
+  auto &state = *it->second;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.pool.empty()) {
+    // Derive a different seed for every input.
+    auto inputSeed = seed + std::distance(inputs.begin(), it);
+    logging::devicex::debug("[SyntheticStepIO] Generating {} batch(es) of {} "
+                            "element(s) for tensor {}",
+                            poolSize,
+                            numElements,
+                            id);
+    state.pool = state.generator.generate(numElements, poolSize, inputSeed);
+    state.numElements = numElements;
+  } else if (state.numElements != numElements) {
+    throw error("SyntheticStepIO generated {} element(s) per batch for tensor "
+                "{} but {} were requested",
+                state.numElements,
+                id,
+                numElements);
+  }
+  return state;
+}
+
+ConstVoidData SyntheticStepIO::in(TensorId id, int64_t numElements, bool) {
+  auto &state = getInput(id, numElements);
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const int64_t batchBytes =
+      numElements * dataTypeSize(state.generator.dataType());
+  ConstVoidData data;
+  data.data = state.pool.data() + state.next * batchBytes;
+  data.info = TensorInfo(state.generator.dataType(), {numElements});
+  return data;
+}
+
+void SyntheticStepIO::inComplete(TensorId id, int64_t numElements) {
+  auto &state = getInput(id, numElements);
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.next = (state.next + 1) % poolSize;
+}
+
+MutableVoidData SyntheticStepIO::out(TensorId id, int64_t numElements) {
+  std::lock_guard<std::mutex> lock(outputMutex);
+  auto it = outputInfos.find(id);
+  if (it == outputInfos.end()) {
+    throw error("SyntheticStepIO does not know the data type of output {}. "
+                "It is taken from the Ir in assertNumElements, which is "
+                "skipped if runtime asserts are disabled",
+                id);
+  }
+
+  MutableVoidData data;
+  data.info = TensorInfo(it->second.dataType(), {numElements});
+
+  // The contents are never read, so all replicas of a tensor share one
+  // scratch buffer.
+  auto &scratch = outputScratch[id];
+  if (scratch.size() < data.info.nbytes()) {
+    scratch.resize(data.info.nbytes());
+  }
+  data.data = scratch.data();
+  return data;
+}
+
+void SyntheticStepIO::assertNumElements(const Ir &ir) const {
+  std::lock_guard<std::mutex> lock(outputMutex);
+  for (auto &id : ir.getDataFlow().anchors()) {
+    if (ir.containsTensor(id)) {
+      outputInfos[id] = ir.getTensor(id)->info;
+    }
+  }
+}
+
+} // namespace popart
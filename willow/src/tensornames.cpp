@@ -72,6 +72,7 @@ std::vector<std::string> reservedPrefixes() {
                                     reservedStashedPrefix(),
                                     reservedRestoredPrefix(),
                                     reservedRandomSeedPrefix(),
+                                    reservedGradientOverflowPrefix(),
                                     anchorSumPrefix(),
                                     cycleCountPrefix(),
                                     reservedRemoteArgPrefix()};
@@ -1,5 +1,6 @@
 #include <popart/ir.hpp>
 #include <popart/op.hpp>
+#include <popart/op/init.hpp>
 #include <popart/op/remote.hpp>
 #include <popart/tensorindex.hpp>
 #include <popart/topocons.hpp>
@@ -238,6 +239,13 @@ bool AccumulateOuterFragmentParallelizer::apply(Graph &graph) const {
     clustersMap.erase(vgid);
   }
 
+  if (settings.schedule ==
+      AccumulateOuterFragmentSchedule::OverlapStreamedUpdates) {
+    for (auto &clustersMapEntry : clustersMap) {
+      addStreamingConstraints(graph, clustersMapEntry.second);
+    }
+  }
+
   // Now we add things to the schedule to try and schedule
   // RemoteLoadOp/RemoteStoreOp together.
   while (!clustersMap.empty()) {
@@ -248,7 +256,9 @@ bool AccumulateOuterFragmentParallelizer::apply(Graph &graph) const {
     // to ensure the loop terminates.
 
     if (settings.schedule ==
-        AccumulateOuterFragmentSchedule::OverlapCycleOptimized) {
+            AccumulateOuterFragmentSchedule::OverlapCycleOptimized ||
+        settings.schedule ==
+            AccumulateOuterFragmentSchedule::OverlapStreamedUpdates) {
       // If we're optimizing for time we just want to schedule one from each
       // virtual graph in parallel in each step, in increasing order of memory.
       for (auto it1 = clustersMap.begin(); it1 != clustersMap.end();) {
@@ -484,6 +494,50 @@ void AccumulateOuterFragmentParallelizer::addOpConstraints(
   }
 }
 
+void AccumulateOuterFragmentParallelizer::addStreamingConstraints(
+    Graph &graph,
+    const OpClusters &opClusters) const {
+  // The ops which update a cluster, as opposed to those which initialise,
+  // load or store its remote tensors
+  auto isUpdateOp = [](Op *op) {
+    return !op->isConvertibleTo<InitOp>() &&
+           !op->isConvertibleTo<RemoteLoadOp>() &&
+           !op->isConvertibleTo<RemoteStoreOp>() &&
+           !op->isConvertibleTo<RemoteExchangeOp>();
+  };
+
+  std::vector<const OpCluster *> clusters;
+  for (const auto &cluster : opClusters) {
+    clusters.push_back(&cluster);
+  }
+
+  for (size_t k = 0; k + 1 < clusters.size(); ++k) {
+    const auto &current = *clusters.at(k);
+    const auto &next    = *clusters.at(k + 1);
+    // Load the next cluster after the current one, but before the current
+    // one is updated, so that the loads overlap with the update.
+    for (auto nextLoad : next.remoteLoadOps) {
+      for (auto load : current.remoteLoadOps) {
+        graph.topoCons->insert(load, nextLoad, false);
+      }
+      for (auto op : current.ops) {
+        if (isUpdateOp(op)) {
+          graph.topoCons->insert(nextLoad, op, false);
+        }
+      }
+    }
+    // Store the current cluster before the one after next is loaded, so that
+    // at most two clusters are loaded at once.
+    if (k + 2 < clusters.size()) {
+      for (auto store : current.remoteStoreOps) {
+        for (auto load : clusters.at(k + 2)->remoteLoadOps) {
+          graph.topoCons->insert(store, load, false);
+        }
+      }
+    }
+  }
+}
+
 namespace {
 bool init =
     Transform::registerTransform(new AccumulateOuterFragmentParallelizer);
@@ -5,10 +5,15 @@
 #include <popart/logging.hpp>
 #include <popart/names.hpp>
 #include <popart/op.hpp>
+#include <popart/recompute.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensorindex.hpp>
 #include <popart/transforms/auto_virtual_graph.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <limits>
+
 using SubgraphId = int;
 
 namespace popart {
@@ -104,6 +109,362 @@ float AutoVirtualGraph::costFn(Op *op,
   return total;
 }
 
+namespace {
+
+// The costs of the Ops of a graph, in schedule order, used to partition it
+struct PartitionCosts {
+  std::vector<double> weights;
+  std::vector<double> activations;
+  std::vector<double> liveBytes;
+  std::vector<double> compute;
+  // cutBytes[i] : bytes of tensors which cross a cut just before Op i
+  std::vector<double> cutBytes;
+  // Stage costs are relative to these totals
+  double memoryScale  = 1.0;
+  double computeScale = 1.0;
+};
+
+// The number of copies of a forward stage's activations which are stashed.
+// Forward stage s is restored in backwards stage 2 * numStages - 2 - s.
+double stashDepth(int64_t stage, int64_t numStages, bool pipelinedTraining) {
+  return pipelinedTraining ? 2.0 * static_cast<double>(numStages - stage) - 1.0
+                           : 1.0;
+}
+
+bool isPipelinedTraining(const Ir &ir) {
+  return ir.canTrain() && ir.getSessionOptions().enablePipelining;
+}
+
+// A partition of the schedule, stage k being Ops starts[k] to
+// starts[k + 1] - 1
+struct Partition {
+  bool feasible    = false;
+  double copyBytes = 0.0;
+  std::vector<int> starts;
+};
+
+// Split the schedule into numStages non-empty contiguous stages, each costing
+// at most maxLoad, such that the fewest bytes are copied between stages.
+// Dynamic programming over the schedule, where the Ops which can start a
+// stage ending at Op j form a sliding window.
+Partition partition(const PartitionCosts &costs,
+                    int64_t numStages,
+                    bool pipelinedTraining,
+                    double maxLoad) {
+  const int nOps   = static_cast<int>(costs.weights.size());
+  const double inf = std::numeric_limits<double>::infinity();
+
+  // prefix sums
+  std::vector<double> weights(nOps + 1, 0.0);
+  std::vector<double> activations(nOps + 1, 0.0);
+  std::vector<double> compute(nOps + 1, 0.0);
+  for (int i = 0; i < nOps; ++i) {
+    weights[i + 1]     = weights[i] + costs.weights[i];
+    activations[i + 1] = activations[i] + costs.activations[i];
+    compute[i + 1]     = compute[i] + costs.compute[i];
+  }
+
+  // best[k][j] : fewest bytes copied with Ops 0 to j - 1 in stages 0 to k - 1
+  std::vector<std::vector<double>> best(numStages + 1,
+                                        std::vector<double>(nOps + 1, inf));
+  std::vector<std::vector<int>> previous(numStages + 1,
+                                         std::vector<int>(nOps + 1, -1));
+  best[0][0] = 0.0;
+
+  for (int64_t k = 0; k < numStages; ++k) {
+    double depth = stashDepth(k, numStages, pipelinedTraining);
+    // The bytes copied if stage k starts at Op i
+    auto startCost = [&](int i) {
+      return best[k][i] + (k > 0 ? costs.cutBytes[i] : 0.0);
+    };
+    // Candidate first Ops of stage k, in increasing order of both the Op and
+    // its startCost
+    std::deque<int> starts;
+    // Ops of stage k, in increasing order of Op and decreasing liveBytes
+    std::deque<int> live;
+    int first = 0;
+    for (int j = 1; j <= nOps; ++j) {
+      int i = j - 1;
+      if (best[k][i] < inf) {
+        while (!starts.empty() && startCost(starts.back()) >= startCost(i)) {
+          starts.pop_back();
+        }
+        starts.push_back(i);
+      }
+      while (!live.empty() &&
+             costs.liveBytes[live.back()] <= costs.liveBytes[i]) {
+        live.pop_back();
+      }
+      live.push_back(i);
+
+      // A stage only gets more expensive as it grows, so first never
+      // decreases
+      auto load = [&](int from) {
+        double memory = weights[j] - weights[from] +
+                        depth * (activations[j] - activations[from]) +
+                        costs.liveBytes[live.front()];
+        return memory / costs.memoryScale +
+               (compute[j] - compute[from]) / costs.computeScale;
+      };
+      while (first < j && load(first) > maxLoad) {
+        ++first;
+        while (!live.empty() && live.front() < first) {
+          live.pop_front();
+        }
+      }
+      while (!starts.empty() && starts.front() < first) {
+        starts.pop_front();
+      }
+
+      if (first < j && !starts.empty()) {
+        previous[k + 1][j] = starts.front();
+        best[k + 1][j]     = startCost(starts.front());
+      }
+    }
+  }
+
+  Partition result;
+  if (best[numStages][nOps] == inf) {
+    return result;
+  }
+  result.feasible  = true;
+  result.copyBytes = best[numStages][nOps];
+  result.starts.resize(numStages);
+  for (int64_t k = numStages, j = nOps; k > 0; --k) {
+    j                    = previous[k][j];
+    result.starts[k - 1] = static_cast<int>(j);
+  }
+  return result;
+}
+
+// The largest stage cost of a partition
+double maxLoad(const PartitionCosts &costs,
+               const Partition &p,
+               bool pipelinedTraining) {
+  const int64_t numStages = static_cast<int64_t>(p.starts.size());
+  const int nOps          = static_cast<int>(costs.weights.size());
+  double result           = 0.0;
+  for (int64_t k = 0; k < numStages; ++k) {
+    double depth  = stashDepth(k, numStages, pipelinedTraining);
+    int end       = k + 1 < numStages ? p.starts[k + 1] : nOps;
+    double memory = 0.0;
+    double peak   = 0.0;
+    double comp   = 0.0;
+    for (int i = p.starts[k]; i < end; ++i) {
+      memory += costs.weights[i] + depth * costs.activations[i];
+      peak = std::max(peak, costs.liveBytes[i]);
+      comp += costs.compute[i];
+    }
+    result = std::max(result,
+                      (memory + peak) / costs.memoryScale +
+                          comp / costs.computeScale);
+  }
+  return result;
+}
+
+PartitionCosts getPartitionCosts(const AutoVirtualGraph &transform,
+                                 const Graph &graph,
+                                 const std::vector<Op *> &schedule) {
+  auto &ir            = graph.getIr();
+  auto &opts          = ir.getSessionOptions();
+  const bool training = ir.canTrain();
+  // Weights are doubled as there is an accumulator to match each.
+  float w_weights = opts.enableGradientAccumulation ? 2.0f : 1.0f;
+
+  const int nOps = static_cast<int>(schedule.size());
+  std::map<Op *, int> position;
+  for (int i = 0; i < nOps; ++i) {
+    position[schedule[i]] = i;
+  }
+
+  PartitionCosts costs;
+  // The liveness of tensors which are never consumed is not tracked
+  auto liveMemory = graph.getLiveMemory(schedule);
+  std::vector<double> crossing(nOps + 1, 0.0);
+  for (int i = 0; i < nOps; ++i) {
+    Op *op = schedule[i];
+    costs.weights.push_back(transform.costFn(op, training, w_weights, 0.0f));
+    costs.activations.push_back(transform.costFn(op, training, 0.0f, 1.0f));
+    costs.liveBytes.push_back(static_cast<double>(liveMemory[i]));
+    costs.compute.push_back(recompute::estimateRecomputeCost(*op));
+
+    // A tensor crosses every cut between its producer and last consumer
+    for (Tensor *t : op->output->tensors()) {
+      int last = i;
+      for (Op *consumer : t->consumers.getOps()) {
+        auto found = position.find(consumer);
+        if (found != position.end()) {
+          last = std::max(last, found->second);
+        }
+      }
+      if (last > i) {
+        auto bytes = static_cast<double>(t->info.nbytes());
+        crossing[i + 1] += bytes;
+        crossing[last + 1] -= bytes;
+      }
+    }
+  }
+
+  costs.cutBytes.resize(nOps, 0.0);
+  double running = 0.0;
+  for (int i = 0; i < nOps; ++i) {
+    running += crossing[i];
+    costs.cutBytes[i] = running;
+  }
+
+  double totalMemory  = 0.0;
+  double totalCompute = 0.0;
+  double peakLive     = 0.0;
+  for (int i = 0; i < nOps; ++i) {
+    totalMemory += costs.weights[i] + costs.activations[i];
+    totalCompute += costs.compute[i];
+    peakLive = std::max(peakLive, costs.liveBytes[i]);
+  }
+  totalMemory += peakLive;
+  costs.memoryScale  = totalMemory > 0.0 ? totalMemory : 1.0;
+  costs.computeScale = totalCompute > 0.0 ? totalCompute : 1.0;
+  return costs;
+}
+
+void logPlan(const AutoVirtualGraphPlan &plan) {
+  for (int64_t k = 0; k < plan.stages.size(); ++k) {
+    auto &stage = plan.stages[k];
+    logging::transform::info(
+        "[AutoVirtualGraph] Virtual graph {}: {} Ops, {} weight bytes, {} "
+        "activation bytes, {} peak live bytes, {} copied in bytes, compute {}",
+        k,
+        stage.numOps,
+        stage.weightBytes,
+        stage.activationBytes,
+        stage.peakLiveBytes,
+        stage.copyInBytes,
+        stage.computeCost);
+  }
+  logging::transform::info("[AutoVirtualGraph] {} bytes copied between "
+                           "virtual graphs",
+                           plan.totalCopyBytes);
+}
+
+} // namespace
+
+AutoVirtualGraphPlan AutoVirtualGraph::planBalanced(const Graph &graph,
+                                                    int64_t numIpus) const {
+  auto schedule = graph.getOpSchedule({});
+  if (schedule.size() < numIpus) {
+    throw error("[AutoVirtualGraph] Couldn't find enough splits for {} IPUs. "
+                "There are only {} Ops",
+                numIpus,
+                schedule.size());
+  }
+
+  auto costs             = getPartitionCosts(*this, graph, schedule);
+  bool pipelinedTraining = isPipelinedTraining(graph.getIr());
+
+  // Find the lowest possible largest stage cost, by bisection. No stage can
+  // cost more than all the Ops do on the first stage.
+  double lo = 0.0;
+  double hi = 0.0;
+  {
+    double depth  = stashDepth(0, numIpus, pipelinedTraining);
+    double memory = 0.0;
+    double peak   = 0.0;
+    double comp   = 0.0;
+    for (int i = 0; i < schedule.size(); ++i) {
+      memory += costs.weights[i] + depth * costs.activations[i];
+      peak = std::max(peak, costs.liveBytes[i]);
+      comp += costs.compute[i];
+    }
+    hi = (memory + peak) / costs.memoryScale + comp / costs.computeScale;
+    hi = hi * (1.0 + 1e-9) + 1e-9;
+  }
+  for (int iteration = 0; iteration < 40; ++iteration) {
+    double mid = 0.5 * (lo + hi);
+    if (partition(costs, numIpus, pipelinedTraining, mid).feasible) {
+      hi = mid;
+    } else {
+      lo = mid;
+    }
+  }
+
+  // Allow the largest stage to be slightly more expensive if that saves
+  // copying between stages. Copied bytes are relative to the graph memory.
+  Partition best;
+  double bestObjective = std::numeric_limits<double>::infinity();
+  for (double slack : {1.0, 1.01, 1.02, 1.05, 1.1, 1.25}) {
+    auto candidate = partition(costs, numIpus, pipelinedTraining, hi * slack);
+    if (!candidate.feasible) {
+      continue;
+    }
+    double objective = maxLoad(costs, candidate, pipelinedTraining) +
+                       candidate.copyBytes / costs.memoryScale;
+    if (objective < bestObjective) {
+      bestObjective = objective;
+      best          = std::move(candidate);
+    }
+  }
+  if (!best.feasible) {
+    throw internal_error("[AutoVirtualGraph] Failed to partition the graph "
+                         "over {} IPUs",
+                         numIpus);
+  }
+
+  std::map<OpId, VGraphId> placement;
+  VGraphId stage = 0;
+  for (int i = 0; i < schedule.size(); ++i) {
+    while (stage + 1 < numIpus && best.starts[stage + 1] == i) {
+      ++stage;
+    }
+    placement[schedule[i]->id] = stage;
+  }
+  return estimate(graph, placement, numIpus);
+}
+
+AutoVirtualGraphPlan
+AutoVirtualGraph::estimate(const Graph &graph,
+                           const std::map<OpId, VGraphId> &placement,
+                           int64_t numIpus) const {
+  auto schedule          = graph.getOpSchedule({});
+  auto costs             = getPartitionCosts(*this, graph, schedule);
+  bool pipelinedTraining = isPipelinedTraining(graph.getIr());
+
+  AutoVirtualGraphPlan plan;
+  plan.placement = placement;
+  plan.stages.resize(numIpus);
+
+  std::vector<double> activations(numIpus, 0.0);
+  for (int i = 0; i < schedule.size(); ++i) {
+    Op *op     = schedule[i];
+    auto vgid  = placement.at(op->id);
+    auto &cost = plan.stages.at(vgid);
+    cost.numOps++;
+    cost.weightBytes += static_cast<int64_t>(costs.weights[i]);
+    activations[vgid] += costs.activations[i];
+    cost.peakLiveBytes = std::max(cost.peakLiveBytes,
+                                  static_cast<int64_t>(costs.liveBytes[i]));
+    cost.computeCost += costs.compute[i];
+
+    // Tensors are copied once to each other virtual graph which consumes them
+    for (Tensor *t : op->output->tensors()) {
+      std::set<VGraphId> consumerVGraphs;
+      for (Op *consumer : t->consumers.getOps()) {
+        auto found = placement.find(consumer->id);
+        if (found != placement.end() && found->second != vgid) {
+          consumerVGraphs.insert(found->second);
+        }
+      }
+      for (auto consumerVGraph : consumerVGraphs) {
+        plan.stages.at(consumerVGraph).copyInBytes += t->info.nbytes();
+        plan.totalCopyBytes += t->info.nbytes();
+      }
+    }
+  }
+  for (int64_t k = 0; k < numIpus; ++k) {
+    plan.stages[k].activationBytes = static_cast<int64_t>(
+        stashDepth(k, numIpus, pipelinedTraining) * activations[k]);
+  }
+  return plan;
+}
+
 // Splits the graph for model parallelism. To do this it needs to do 3 things:
 // 1) Find potential split nodes.
 // 2) Calculate a cost model for each split node
@@ -157,6 +518,16 @@ bool AutoVirtualGraph::apply(Graph &graph) const {
   logging::transform::info("[AutoVirtualGraph] Auto virtual graph with {} IPUs",
                            num_ipus);
 
+  if (opts.virtualGraphMode == VirtualGraphMode::Balanced) {
+    auto plan = planBalanced(graph, num_ipus);
+    for (Op *op : graph.getOpSchedule({})) {
+      op->setVirtualGraphId(plan.placement.at(op->id));
+    }
+    logPlan(plan);
+    ir.setAutoVirtualGraphPlan(plan);
+    return true;
+  }
+
   float cumulative_cost = 0.f;
   std::vector<Subgraph> subgraphs;
   std::map<OpId, SubgraphId> node_subgraph_map;
@@ -367,16 +738,22 @@ bool AutoVirtualGraph::apply(Graph &graph) const {
   }
 
   // Add sharding information to graph.
+  std::map<OpId, VGraphId> placement;
   for (Op *op : graph.getOpSchedule({})) {
     // Find potential split nodes
     auto &subgraph = subgraphs.at(node_subgraph_map.find(op->id)->second);
     op->setVirtualGraphId(subgraph.virtual_graph_id);
+    placement[op->id] = subgraph.virtual_graph_id;
     if (subgraph.final_splits.erase(op->id)) {
       // Does the op go on the previous or next graph? For now previous.
       subgraph.virtual_graph_id++;
     }
   }
 
+  auto plan = estimate(graph, placement, num_ipus);
+  logPlan(plan);
+  ir.setAutoVirtualGraphPlan(plan);
+
   return true;
 }
 
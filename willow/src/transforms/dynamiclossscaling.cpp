@@ -0,0 +1,228 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <map>
+#include <memory>
+#include <set>
+#include <popart/error.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/op/accumulatorupdate.hpp>
+#include <popart/op/call.hpp>
+#include <popart/op/copyvarupdate.hpp>
+#include <popart/op/gradientoverflowcheck.hpp>
+#include <popart/op/sgd1acclupdate.hpp>
+#include <popart/optimizer.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+#include <popart/topocons.hpp>
+#include <popart/transforms/dynamiclossscaling.hpp>
+
+namespace popart {
+
+namespace {
+
+void validate(const Ir &ir) {
+  auto &opts = ir.getSessionOptions();
+  opts.dynamicLossScalingSettings.validate();
+
+  if (ir.getOptimizer().lossScaling().isConst()) {
+    throw error("Dynamic loss scaling requires a non-const loss scaling");
+  }
+  if (opts.enablePipelining && !opts.enableGradientAccumulation) {
+    throw error("Dynamic loss scaling with pipelining requires gradient "
+                "accumulation");
+  }
+  if (opts.hostAllReduce) {
+    throw error("Dynamic loss scaling is not supported with hostAllReduce, "
+                "the gradients are not available on the device");
+  }
+  if (opts.virtualGraphMode == VirtualGraphMode::ExecutionPhases &&
+      opts.executionPhaseSettings.phases > 1) {
+    throw error("Dynamic loss scaling is not supported with execution "
+                "phases");
+  }
+}
+
+// The Ops which depend on any of the ops
+std::set<Op *, POpCmp> getDownstream(const std::vector<Op *> &ops) {
+  std::set<Op *, POpCmp> downstream;
+  std::vector<Op *> frontier(ops.begin(), ops.end());
+  while (!frontier.empty()) {
+    auto current = frontier.back();
+    frontier.pop_back();
+    std::vector<Op *> successors =
+        current->getGraph().topoCons->getAfters(current);
+    for (auto out : current->output->tensors()) {
+      for (auto consumer : out->consumers.getOps()) {
+        successors.push_back(consumer);
+      }
+    }
+    for (auto successor : successors) {
+      if (downstream.insert(successor).second) {
+        frontier.push_back(successor);
+      }
+    }
+  }
+  return downstream;
+}
+
+bool isChecked(const Tensor *tensor,
+               const std::set<Op *, POpCmp> &skipped,
+               const std::set<Op *, POpCmp> &downstream) {
+  auto dataType = tensor->info.dataType();
+  if (dataType != DataType::FLOAT && dataType != DataType::FLOAT16) {
+    return false;
+  }
+  // Variables and optimizer tensors have no producer
+  if (!tensor->hasProducer()) {
+    return false;
+  }
+  auto producer = tensor->getProducer();
+  return skipped.count(producer) == 0 && downstream.count(producer) == 0 &&
+         !producer->copiesOptimizerTensors();
+}
+
+} // namespace
+
+std::size_t DynamicLossScaling::id() {
+  return typeid(DynamicLossScaling).hash_code();
+}
+
+bool DynamicLossScaling::isSkippedOnOverflow(const Op *op) {
+  auto &opts = op->getIr().getSessionOptions();
+  if (!opts.dynamicLossScalingSettings.enabled) {
+    return false;
+  }
+
+  if (op->isConvertibleTo<CallOp>()) {
+    for (auto graph : op->getCalledGraphs()) {
+      for (auto &id_op : graph->getOps()) {
+        if (!isSkippedOnOverflow(id_op.second.get())) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  if (!op->isOptimizerOp() || op->isConvertibleTo<CopyVarUpdateOp>()) {
+    return false;
+  }
+
+  // With gradient accumulation, the accumulators are updated every
+  // micro-batch, and are reset after the weight update even if it is skipped
+  if (opts.enableGradientAccumulation) {
+    if (op->settings.executionContext !=
+        ExecutionContext::AccumulateOuterFragment) {
+      return false;
+    }
+    auto accumulatorUpdate = dynamic_cast<const AccumulatorUpdateOp *>(op);
+    if (accumulatorUpdate && accumulatorUpdate->getFactor().isConst() &&
+        accumulatorUpdate->getFactor().val() == 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DynamicLossScaling::apply(Graph &graph) const {
+  auto &ir = graph.getIr();
+  validate(ir);
+
+  std::vector<Op *> skipped;
+  for (auto op : graph.getOpSchedule({})) {
+    if (isSkippedOnOverflow(op)) {
+      if (ir.getSessionOptions().enableGradientAccumulation &&
+          op->isConvertibleTo<SGD1AcclUpdateOp>()) {
+        throw error("Dynamic loss scaling with gradient accumulation is not "
+                    "supported by SGD, which accumulates the gradients into "
+                    "its velocity. It can not be restored when the gradients "
+                    "overflow.");
+      }
+      skipped.push_back(op);
+    }
+  }
+  if (skipped.empty()) {
+    throw error("Dynamic loss scaling is enabled, but there is no weight "
+                "update");
+  }
+
+  std::set<Op *, POpCmp> skippedSet(skipped.begin(), skipped.end());
+  auto downstream = getDownstream(skipped);
+
+  // The gradients to check on each virtual graph, and the first skipped Op
+  // there, whose settings the check takes
+  std::map<VGraphId, std::vector<TensorId>> gradients;
+  std::map<VGraphId, Op *> firstOps;
+  std::set<TensorId> seen;
+  for (auto op : skipped) {
+    VGraphId vgid =
+        op->hasVirtualGraphId() ? op->getVirtualGraphId() : unusedVGraphId;
+    for (auto tensor : op->input->tensors()) {
+      if (isChecked(tensor, skippedSet, downstream) &&
+          seen.insert(tensor->id).second) {
+        gradients[vgid].push_back(tensor->id);
+        firstOps.insert({vgid, op});
+      }
+    }
+  }
+  if (gradients.empty()) {
+    throw error("Dynamic loss scaling found no gradients to check");
+  }
+
+  auto addCheck = [&graph](Op *settingsOp,
+                           const std::vector<TensorId> &inIds,
+                           const TensorId &outId) {
+    Op::Settings settings = settingsOp->settings;
+    settings.name         = outId;
+    auto checkOpUp        = std::make_unique<GradientOverflowCheckOp>(settings);
+    auto checkOp          = checkOpUp.get();
+    graph.moveIntoGraph(std::move(checkOpUp));
+
+    for (InIndex i = 0; i < inIds.size(); ++i) {
+      checkOp->connectInTensor(i, inIds.at(i));
+    }
+    checkOp->createAndConnectOutTensor(GradientOverflowCheckOp::getOutIndex(),
+                                       outId);
+    checkOp->setup();
+    // Nothing consumes the result in the Ir, the device does
+    checkOp->pruneable = false;
+
+    logging::transform::debug("[DynamicLossScaling] {} checks {} tensors",
+                              checkOp->debugName(),
+                              inIds.size());
+    return checkOp;
+  };
+
+  Op *checkOp;
+  auto overflowId = GradientOverflowCheckOp::getOverflowTensorId();
+  if (gradients.size() == 1) {
+    auto &vgid_ids = *gradients.begin();
+    checkOp =
+        addCheck(firstOps.at(vgid_ids.first), vgid_ids.second, overflowId);
+  } else {
+    std::vector<TensorId> partialIds;
+    for (auto &vgid_ids : gradients) {
+      auto partialId =
+          GradientOverflowCheckOp::getPartialOverflowTensorId(vgid_ids.first);
+      addCheck(firstOps.at(vgid_ids.first), vgid_ids.second, partialId);
+      partialIds.push_back(partialId);
+    }
+    checkOp = addCheck(firstOps.begin()->second, partialIds, overflowId);
+  }
+
+  for (auto op : skipped) {
+    graph.topoCons->insert(checkOp, op);
+  }
+
+  logging::transform::debug("[DynamicLossScaling] {} Ops are skipped on "
+                            "overflow",
+                            skipped.size());
+  return true;
+}
+
+namespace {
+bool init = Transform::registerTransform(new DynamicLossScaling);
+}
+
+} // namespace popart
@@ -0,0 +1,394 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/op/adamupdater.hpp>
+#include <popart/op/adamvarupdate.hpp>
+#include <popart/op/lamb.hpp>
+#include <popart/op/multitensorupdate.hpp>
+#include <popart/op/remote.hpp>
+#include <popart/op/sgd0varupdate.hpp>
+#include <popart/op/sgd1varupdate.hpp>
+#include <popart/opidentifier.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+#include <popart/topocons.hpp>
+#include <popart/transforms/fuseoptimizerupdates.hpp>
+
+namespace popart {
+
+namespace {
+
+void appendOptimizerValue(std::stringstream &ss,
+                          const std::string &name,
+                          const Op *op,
+                          const OptimizerValue &value,
+                          InIndex index) {
+  if (value.isConst()) {
+    ss << "_const" << name << "_" << value.val();
+  } else {
+    ss << "_nonConst" << name << "_" << op->inId(index);
+  }
+}
+
+// Ops with the same partition id may be fused. Ops which can not be fused
+// have an empty partition id.
+std::string getPartitionId(const Op *op) {
+  std::stringstream ss;
+
+  if (op->opid == Onnx::CustomOperators::SGD0VarUpdate) {
+    auto sgd0 = dynamic_cast<const SGD0VarUpdateOp *>(op);
+    ss << "SGD0";
+    appendOptimizerValue(
+        ss, "Slr0", op, sgd0->initSlr0, SGD0VarUpdateOp::getSlr0InIndex());
+    appendOptimizerValue(
+        ss, "Wdsf0", op, sgd0->initWdsf0, SGD0VarUpdateOp::getWdsf0InIndex());
+  } else if (op->opid == Onnx::CustomOperators::SGD1VarUpdate) {
+    auto sgd1 = dynamic_cast<const SGD1VarUpdateOp *>(op);
+    ss << "SGD1";
+    appendOptimizerValue(
+        ss, "Slr1", op, sgd1->initSlr1, SGD1VarUpdateOp::getSlr1InIndex());
+  } else if (op->opid == Onnx::CustomOperators::AdamUpdater) {
+    auto adam = dynamic_cast<const AdamUpdaterOp *>(op);
+    ss << "AdamUpdater_mode_" << static_cast<int>(adam->mode);
+    appendOptimizerValue(
+        ss, "Wd", op, adam->initWd, AdamUpdaterOp::getWdInIndex());
+    appendOptimizerValue(
+        ss, "B1", op, adam->initB1, AdamUpdaterOp::getBeta1InIndex());
+    appendOptimizerValue(
+        ss, "B2", op, adam->initB2, AdamUpdaterOp::getBeta2InIndex());
+    appendOptimizerValue(
+        ss, "Eps", op, adam->initEps, AdamUpdaterOp::getEpsInIndex());
+  } else if (op->opid == Onnx::CustomOperators::AdamVarUpdate) {
+    auto adam    = dynamic_cast<const AdamVarUpdateOp *>(op);
+    bool hasR1Sq = op->hasInput(AdamVarUpdateOp::getLambR1SqInIndex());
+    bool hasR2Sq = op->hasInput(AdamVarUpdateOp::getLambR2SqInIndex());
+    if (hasR1Sq != hasR2Sq) {
+      return "";
+    }
+    ss << "AdamVarUpdate_lamb_" << hasR1Sq;
+    appendOptimizerValue(
+        ss, "Lr", op, adam->initLr, AdamVarUpdateOp::getLrInIndex());
+    if (hasR1Sq) {
+      appendOptimizerValue(
+          ss, "Mwn", op, adam->initMwn, AdamVarUpdateOp::getMwnInIndex());
+    }
+  } else if (op->opid == Onnx::CustomOperators::LambSquare) {
+    ss << "LambSquare";
+  } else {
+    return "";
+  }
+
+  ss << "_vg_" << op->settings.vgraphId << "_ps_" << op->settings.pipelineStage
+     << "_ep_" << op->settings.executionPhase << "_bsp_"
+     << op->settings.batchSerializedPhase << "_ts_" << op->settings.tileSet
+     << "_ec_" << op->settings.executionContext << "_rt_"
+     << op->settings.recomputeType << "_dt_" << op->inInfo(0).dataType();
+  return ss.str();
+}
+
+// The number of inputs of the single tensor Op, and which of them are given
+// for every tensor. The others are the hyper parameters shared by the tensors.
+int getNumSingleInputs(const Op *op) {
+  if (op->opid == Onnx::CustomOperators::SGD0VarUpdate) {
+    return SGD0VarUpdateOp::getWdsf0InIndex() + 1;
+  } else if (op->opid == Onnx::CustomOperators::SGD1VarUpdate) {
+    return SGD1VarUpdateOp::getSlr1InIndex() + 1;
+  } else if (op->opid == Onnx::CustomOperators::AdamUpdater) {
+    return AdamUpdaterOp::getEpsInIndex() + 1;
+  } else if (op->opid == Onnx::CustomOperators::AdamVarUpdate) {
+    return AdamVarUpdateOp::getMwnInIndex() + 1;
+  } else {
+    return 1;
+  }
+}
+
+bool isPerTensorInIndex(const Op *op, InIndex index) {
+  if (op->opid == Onnx::CustomOperators::SGD0VarUpdate) {
+    return index < SGD0VarUpdateOp::getSlr0InIndex();
+  } else if (op->opid == Onnx::CustomOperators::SGD1VarUpdate) {
+    return index != SGD1VarUpdateOp::getSlr1InIndex();
+  } else if (op->opid == Onnx::CustomOperators::AdamUpdater) {
+    return index <= AdamUpdaterOp::getStepInIndex();
+  } else if (op->opid == Onnx::CustomOperators::AdamVarUpdate) {
+    return index <= AdamVarUpdateOp::getLambR2SqInIndex();
+  } else {
+    return true;
+  }
+}
+
+std::unique_ptr<Op> createFusedOp(const std::vector<Op *> &ops,
+                                  const Op::Settings &settings) {
+  auto front = ops.front();
+  std::vector<TensorId> varIds;
+  for (auto op : ops) {
+    varIds.push_back(op->inId(VarUpdateOp::getVarToUpdateInIndex()));
+  }
+  int numTensors = static_cast<int>(ops.size());
+
+  if (front->opid == Onnx::CustomOperators::SGD0VarUpdate) {
+    auto sgd0 = dynamic_cast<const SGD0VarUpdateOp *>(front);
+    return std::make_unique<MultiSGD0VarUpdateOp>(
+        varIds, sgd0->initSlr0, sgd0->initWdsf0, settings);
+  } else if (front->opid == Onnx::CustomOperators::SGD1VarUpdate) {
+    auto sgd1 = dynamic_cast<const SGD1VarUpdateOp *>(front);
+    return std::make_unique<MultiSGD1VarUpdateOp>(
+        varIds, sgd1->initSlr1, settings);
+  } else if (front->opid == Onnx::CustomOperators::AdamUpdater) {
+    auto adam = dynamic_cast<const AdamUpdaterOp *>(front);
+    return std::make_unique<MultiAdamUpdaterOp>(numTensors,
+                                                adam->mode,
+                                                adam->initWd,
+                                                adam->initB1,
+                                                adam->initB2,
+                                                adam->initEps,
+                                                settings);
+  } else if (front->opid == Onnx::CustomOperators::AdamVarUpdate) {
+    auto adam = dynamic_cast<const AdamVarUpdateOp *>(front);
+    return std::make_unique<MultiAdamVarUpdateOp>(
+        varIds, adam->initLr, adam->initMwn, settings);
+  } else {
+    return std::make_unique<MultiLambSquareOp>(numTensors, settings);
+  }
+}
+
+// The Ops of a partition, in schedule order, which can be fused: an Op which
+// depends on another Op of the partition, or which shares a per-tensor input
+// with one, is left out.
+std::vector<Op *> getFusable(const std::vector<Op *> &ops) {
+  std::vector<Op *> fusable;
+  std::set<Op *, POpCmp> downstream;
+  std::set<TensorId> inputs;
+
+  for (auto op : ops) {
+    if (downstream.count(op) > 0) {
+      continue;
+    }
+
+    bool sharesInput = false;
+    for (auto &index_id : op->input->tensorIdMap()) {
+      if (isPerTensorInIndex(op, index_id.first) &&
+          inputs.count(index_id.second) > 0) {
+        sharesInput = true;
+      }
+    }
+    if (sharesInput) {
+      continue;
+    }
+
+    fusable.push_back(op);
+    for (auto &index_id : op->input->tensorIdMap()) {
+      if (isPerTensorInIndex(op, index_id.first)) {
+        inputs.insert(index_id.second);
+      }
+    }
+
+    // Everything which depends on op can not be fused with it
+    std::vector<Op *> frontier{op};
+    while (!frontier.empty()) {
+      auto current = frontier.back();
+      frontier.pop_back();
+      std::vector<Op *> successors =
+          current->getGraph().topoCons->getAfters(current);
+      for (auto out : current->output->tensors()) {
+        for (auto consumer : out->consumers.getOps()) {
+          successors.push_back(consumer);
+        }
+      }
+      for (auto successor : successors) {
+        if (downstream.insert(successor).second) {
+          frontier.push_back(successor);
+        }
+      }
+    }
+  }
+  return fusable;
+}
+
+bool isRemoteOp(const Op *op) {
+  return op->isConvertibleTo<RemoteLoadOp>() ||
+         op->isConvertibleTo<RemoteStoreOp>() ||
+         op->isConvertibleTo<RemoteExchangeOp>();
+}
+
+// The Ops of the accumulate outer fragment which are connected, through the
+// (non-optimizer) tensors they share there, to a remote load or store. With
+// the overlapping AccumulateOuterFragmentSchedules, the
+// AccumulateOuterFragmentParallelizer schedules each such cluster, one per
+// weight, as a separate chunk. Fusing the Ops of different clusters would
+// merge them all into one.
+std::set<Op *, POpCmp> getStreamedUpdates(Graph &graph) {
+  auto schedule = graph.getIr()
+                      .getSessionOptions()
+                      .accumulateOuterFragmentSettings.schedule;
+  if (schedule != AccumulateOuterFragmentSchedule::OverlapCycleOptimized &&
+      schedule != AccumulateOuterFragmentSchedule::OverlapMemoryOptimized &&
+      schedule != AccumulateOuterFragmentSchedule::OverlapStreamedUpdates) {
+    return {};
+  }
+
+  auto inFragment = [](const Op *op) {
+    return op->settings.executionContext ==
+           ExecutionContext::AccumulateOuterFragment;
+  };
+
+  std::set<Op *, POpCmp> streamed;
+  std::vector<Op *> frontier;
+  for (auto &id_op : graph.getOps()) {
+    auto op = id_op.second.get();
+    if (inFragment(op) && isRemoteOp(op)) {
+      streamed.insert(op);
+      frontier.push_back(op);
+    }
+  }
+
+  while (!frontier.empty()) {
+    auto op = frontier.back();
+    frontier.pop_back();
+    std::vector<Tensor *> tensors = op->input->tensors();
+    for (auto t : op->output->tensors()) {
+      tensors.push_back(t);
+    }
+    for (auto t : tensors) {
+      if (t->isOptimizerTensor()) {
+        continue;
+      }
+      std::vector<Op *> neighbours = t->consumers.getOps();
+      if (t->hasProducer()) {
+        neighbours.push_back(t->getProducer());
+      }
+      for (auto neighbour : neighbours) {
+        if (inFragment(neighbour) && streamed.insert(neighbour).second) {
+          frontier.push_back(neighbour);
+        }
+      }
+    }
+  }
+  return streamed;
+}
+
+void fuse(Graph &graph, const std::vector<Op *> &ops) {
+  auto front = ops.front();
+
+  Op::Settings settings = front->settings;
+  settings.name         = "Multi" + front->opid.type + "_" + front->name();
+
+  auto fusedOpUp = createFusedOp(ops, settings);
+  auto fusedOp   = fusedOpUp.get();
+  graph.moveIntoGraph(std::move(fusedOpUp));
+
+  int numSingleInputs = getNumSingleInputs(front);
+
+  std::map<InIndex, TensorId> inIds;
+  std::vector<TensorId> outIds;
+  std::set<Op *, POpCmp> befores;
+  std::set<Op *, POpCmp> afters;
+
+  for (int i = 0; i < ops.size(); ++i) {
+    auto op = ops.at(i);
+    for (auto &index_id : op->input->tensorIdMap()) {
+      if (i == 0 || isPerTensorInIndex(op, index_id.first)) {
+        inIds[i * numSingleInputs + index_id.first] = index_id.second;
+      }
+    }
+    outIds.push_back(op->outId(0));
+    for (auto before : graph.topoCons->getBefores(op)) {
+      befores.insert(before);
+    }
+    for (auto after : graph.topoCons->getAfters(op)) {
+      afters.insert(after);
+    }
+  }
+
+  for (auto op : ops) {
+    befores.erase(op);
+    afters.erase(op);
+    graph.topoCons->remove(op);
+    op->disconnectAllInputs();
+    op->disconnectAllOutputs();
+    graph.eraseOp(op->id);
+  }
+
+  for (auto &index_id : inIds) {
+    fusedOp->connectInTensor(index_id.first, index_id.second);
+  }
+  for (int i = 0; i < outIds.size(); ++i) {
+    fusedOp->connectOutTensor(i, outIds.at(i));
+  }
+  fusedOp->setup();
+
+  for (auto before : befores) {
+    graph.topoCons->insert(before, fusedOp);
+  }
+  for (auto after : afters) {
+    graph.topoCons->insert(fusedOp, after);
+  }
+
+  logging::transform::debug("[FuseOptimizerUpdates] {} updates {} tensors",
+                            fusedOp->debugName(),
+                            ops.size());
+}
+
+} // namespace
+
+std::size_t FuseOptimizerUpdates::id() {
+  return typeid(FuseOptimizerUpdates).hash_code();
+}
+
+bool FuseOptimizerUpdates::apply(Graph &graph) const {
+  // Fusing Ops does not connect them to any more remote Ops, so this does not
+  // change as partitions are fused
+  auto streamed = getStreamedUpdates(graph);
+  auto getFusablePartitionId = [&streamed](Op *op) -> std::string {
+    if (streamed.count(op) > 0) {
+      return "";
+    }
+    return getPartitionId(op);
+  };
+
+  // The partitions, in the order their first Op is scheduled
+  std::vector<std::string> partitionIds;
+  for (auto op : graph.getOpSchedule({})) {
+    auto partitionId = getFusablePartitionId(op);
+    if (!partitionId.empty() &&
+        std::find(partitionIds.begin(), partitionIds.end(), partitionId) ==
+            partitionIds.end()) {
+      partitionIds.push_back(partitionId);
+    }
+  }
+
+  bool changed = false;
+  for (auto &partitionId : partitionIds) {
+    // Fusing a partition can add paths between the Ops of the others, so
+    // the schedule is recomputed for each
+    std::vector<Op *> ops;
+    for (auto op : graph.getOpSchedule({})) {
+      if (getFusablePartitionId(op) == partitionId) {
+        ops.push_back(op);
+      }
+    }
+
+    auto fusable = getFusable(ops);
+    logging::transform::debug("[FuseOptimizerUpdates] {}: {} of {} Ops fused",
+                              partitionId,
+                              fusable.size() > 1 ? fusable.size() : 0,
+                              ops.size());
+    if (fusable.size() > 1) {
+      fuse(graph, fusable);
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+namespace {
+bool init = Transform::registerTransform(new FuseOptimizerUpdates);
+}
+
+} // namespace popart
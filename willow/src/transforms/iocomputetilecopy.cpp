@@ -102,12 +102,24 @@ void IoComputeTileCopy::insertIoTileCopy(Graph &graph,
       !isPhased || sessionOptions.executionPhaseSettings.schedule ==
                        ExecutionPhaseSchedule::Interleaving;
 
+  // With prefetching, tensors loaded onto the IO tiles in an earlier phase
+  // are held there until the phase which consumes them
+  bool copyInConsumerPhase =
+      isPhased &&
+      sessionOptions.executionPhaseSettings.onDemandPrefetchPhases > 0 &&
+      fromOp->hasExecutionPhase() && toOp->hasExecutionPhase() &&
+      fromOp->getExecutionPhase() < toOp->getExecutionPhase();
+
   if (fromOp->settings.tileSet == TileSet::IO) {
     // Copy direction: From IO tiles
-    graph.topoCons->insert(fromOp, ioCopy, tiedTopoCon);
+    graph.topoCons->insert(
+        fromOp, ioCopy, tiedTopoCon && !copyInConsumerPhase);
     ioCopy->settings         = fromOp->settings;
     ioCopy->settings.name    = "";
     ioCopy->settings.tileSet = TileSet::Compute;
+    if (copyInConsumerPhase) {
+      ioCopy->setExecutionPhase(toOp->getExecutionPhase());
+    }
   }
 
   if (toOp->settings.tileSet == TileSet::IO) {
@@ -1,4 +1,6 @@
 // Copyright (c) 2019 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <tuple>
 #include <popart/graph.hpp>
@@ -27,6 +29,29 @@ std::string getConcatGradsPrefix() { return "concatGrads___"; }
 std::string getReshapedPrefix() { return "flattened___"; }
 
 std::string getSlicedPrefix() { return "sliced___"; }
+
+// The costs for MergeCostModel, and for the benefits reported for the groups
+// of every MergeVarUpdates transform. Every VarUpdate program has the fixed
+// cost of CostModelSettings::programCycles. The elementwise update itself
+// costs the same whether merged or not, so it is left out. Merging copies the
+// Variables and updaters into the concatenated layout, and the updated
+// Variables back out of it: 3 bytes per byte of Variable.
+double getGroupCycles(const CostModelSettings &costs,
+                      int64_t numVarUpdates,
+                      int64_t bytes) {
+  if (numVarUpdates <= 1) {
+    return costs.programCycles;
+  }
+  return costs.programCycles +
+         3.0 * static_cast<double>(bytes) / costs.onChipCopyBytesPerCycle;
+}
+
+double getGroupBenefit(const CostModelSettings &costs,
+                       int64_t numVarUpdates,
+                       int64_t bytes) {
+  return static_cast<double>(numVarUpdates) * costs.programCycles -
+         getGroupCycles(costs, numVarUpdates, bytes);
+}
 } // namespace
 
 std::size_t MergeAllVarUpdates::id() {
@@ -41,6 +66,8 @@ std::size_t MergeLooseThreshold::id() {
   return typeid(MergeLooseThreshold).hash_code();
 }
 
+std::size_t MergeCostModel::id() { return typeid(MergeCostModel).hash_code(); }
+
 MergeVarUpdates::PartitionId MergeVarUpdates::getPartitionId(Op *op) const {
   std::stringstream ss;
 
@@ -151,12 +178,12 @@ int64_t MergeAuto::getThresholdMemory(const Graph &g) const {
   return thresholdMemory;
 }
 
-int64_t MergeLooseThreshold::getMemToPlayWithAtPeak(const Graph &g) const {
+int64_t MergeAuto::getMemToPlayWithAtPeak(const Graph &g) const {
 
   int64_t thresholdMemory = g.getIr().getSessionOptions().looseThresholdAtPeak;
 
   if (thresholdMemory < 0) {
-    throw error("Negative memory {} threshold detected in MergeLoose. The "
+    throw error("Negative memory {} threshold detected in MergeAuto. The "
                 "option looseThresholdAtPeak must be non-negative. ",
                 thresholdMemory);
   }
@@ -164,6 +191,92 @@ int64_t MergeLooseThreshold::getMemToPlayWithAtPeak(const Graph &g) const {
   return thresholdMemory;
 }
 
+std::vector<int64_t>
+MergeAuto::getMemToPlayWith(const Graph &g,
+                            const std::vector<Op *> &opSched,
+                            const std::map<Op *, int> &schedIndex) const {
+
+  // find the point at which the forward part of the compute graph ends
+  int switchIndex = -1;
+  for (int i = 0; i < opSched.size(); ++i) {
+    if (opSched[i]->toLoss == PathToLoss::Yes) {
+      switchIndex = i;
+    }
+  }
+  if (switchIndex < 0) {
+    throw internal_error(
+        "failed to set switchIndex, is the graph in training mode?");
+  }
+
+  // for every tensor which is
+  // 1) created on the forward path and
+  // 2) consumed on the backward path,
+  // insert "+mem" at creation point and "-mem" at final consumption.
+  // This vector will look something like,
+  // ..+...+.+..+...+..S...-.-...-...-.-,
+  //
+  // where S above is switchIndex.
+  //
+  std::vector<int64_t> deltaMemFwdLiveForBwd(opSched.size(), 0);
+  for (int i = 0; i < switchIndex; ++i) {
+    for (Tensor *t : opSched[i]->output->tensors()) {
+      // final consumption time
+      int fct = -1;
+      for (Op *consumer : t->consumers.getOps()) {
+        fct = std::max<int>(fct, schedIndex.at(consumer));
+      }
+      if (fct > switchIndex) {
+        deltaMemFwdLiveForBwd[i] += t->info.nbytes();
+        deltaMemFwdLiveForBwd[fct] -= t->info.nbytes();
+      }
+    }
+  }
+
+  // cumulative sum of deltaMemFwdLiveForBwd
+  std::vector<int64_t> cumMemFwdLiveForBwd(opSched.size(), 0);
+  int64_t maxCumMemFwdLiveForBwd = 0;
+  cumMemFwdLiveForBwd[0]         = deltaMemFwdLiveForBwd[0];
+  for (int i = 1; i < opSched.size(); ++i) {
+    cumMemFwdLiveForBwd[i] =
+        deltaMemFwdLiveForBwd[i] + cumMemFwdLiveForBwd[i - 1];
+    maxCumMemFwdLiveForBwd =
+        std::max<int64_t>(maxCumMemFwdLiveForBwd, cumMemFwdLiveForBwd[i]);
+  }
+
+  if (cumMemFwdLiveForBwd[opSched.size() - 1] != 0) {
+    throw internal_error("expected final cumulative memory to be zero");
+  }
+
+  // An estimate of how much memory there is,  to use for delaying weight
+  // updates without effecting max-liveness, looks something like
+  //
+  // clang-format off
+  //
+  // *                         *
+  // *                         *
+  // **                       **
+  // ****                 ******
+  // *******        ************
+  // **********   **************
+  // ***************************  (this final line: memToPlayWith at peak liveness)
+  //
+  // clang-format on
+  //
+  // -----------------------------> schedule index
+  // where above: vertical is memory to play with
+  // and horizontal is schedule position
+
+  // At peak, can delay scheduling while below this number of bytes:
+  int64_t memToPlayWithAtPeak = getMemToPlayWithAtPeak(g);
+
+  std::vector<int64_t> memToPlayWith(opSched.size(), 0);
+  for (int i = 0; i < opSched.size(); ++i) {
+    memToPlayWith[i] =
+        maxCumMemFwdLiveForBwd - cumMemFwdLiveForBwd[i] + memToPlayWithAtPeak;
+  }
+  return memToPlayWith;
+}
+
 MergeVarUpdates::PartitionMap
 MergeTightThreshold::getFinal(const Graph &g) const {
 
@@ -302,84 +415,7 @@ MergeLooseThreshold::getFinal(const Graph &g) const {
     schedIndex[opSched[i]] = i;
   }
 
-  // find the point at which the forward part of the compute graph ends
-  int switchIndex = -1;
-  for (int i = 0; i < opSched.size(); ++i) {
-    if (opSched[i]->toLoss == PathToLoss::Yes) {
-      switchIndex = i;
-    }
-  }
-  if (switchIndex < 0) {
-    throw internal_error(
-        "failed to set switchIndex, is the graph in training mode?");
-  }
-
-  // for every tensor which is
-  // 1) created on the forward path and
-  // 2) consumed on the backward path,
-  // insert "+mem" at creation point and "-mem" at final consumption.
-  // This vector will look something like,
-  // ..+...+.+..+...+..S...-.-...-...-.-,
-  //
-  // where S above is switchIndex.
-  //
-  std::vector<int64_t> deltaMemFwdLiveForBwd(opSched.size(), 0);
-  for (int i = 0; i < switchIndex; ++i) {
-    for (Tensor *t : opSched[i]->output->tensors()) {
-      // final consumption time
-      int fct = -1;
-      for (Op *consumer : t->consumers.getOps()) {
-        fct = std::max<int>(fct, schedIndex.at(consumer));
-      }
-      if (fct > switchIndex) {
-        deltaMemFwdLiveForBwd[i] += t->info.nbytes();
-        deltaMemFwdLiveForBwd[fct] -= t->info.nbytes();
-      }
-    }
-  }
-
-  // cumulative sum of deltaMemFwdLiveForBwd
-  std::vector<int64_t> cumMemFwdLiveForBwd(opSched.size(), 0);
-  int64_t maxCumMemFwdLiveForBwd = 0;
-  cumMemFwdLiveForBwd[0]         = deltaMemFwdLiveForBwd[0];
-  for (int i = 1; i < opSched.size(); ++i) {
-    cumMemFwdLiveForBwd[i] =
-        deltaMemFwdLiveForBwd[i] + cumMemFwdLiveForBwd[i - 1];
-    maxCumMemFwdLiveForBwd =
-        std::max<int64_t>(maxCumMemFwdLiveForBwd, cumMemFwdLiveForBwd[i]);
-  }
-
-  if (cumMemFwdLiveForBwd[opSched.size() - 1] != 0) {
-    throw internal_error("expected final cumulative memory to be zero");
-  }
-
-  // An estimate of how much memory there is,  to use for delaying weight
-  // updates without effecting max-liveness, looks something like
-  //
-  // clang-format off
-  //
-  // *                         *
-  // *                         *
-  // **                       **
-  // ****                 ******
-  // *******        ************
-  // **********   **************
-  // ***************************  (this final line: memToPlayWith at peak liveness)
-  //
-  // clang-format on
-  //
-  // -----------------------------> schedule index
-  // where above: vertical is memory to play with
-  // and horizontal is schedule position
-
-  // At peak, can delay scheduling while below this number of bytes:
-  int64_t memToPlayWithAtPeak = getMemToPlayWithAtPeak(g);
-
-  std::vector<int64_t> memToPlayWith(opSched.size(), 0);
-  for (int i = 0; i < opSched.size(); ++i) {
-    memToPlayWith[i] =
-        maxCumMemFwdLiveForBwd - cumMemFwdLiveForBwd[i] + memToPlayWithAtPeak;
-  }
+  auto memToPlayWith = getMemToPlayWith(g, opSched, schedIndex);
 
   std::map<VarUpdateOp *, PartitionId> parentPartitionId;
   std::vector<std::tuple<int, VarUpdateOp *>> bySchedIndex;
@@ -493,6 +529,137 @@ MergeLooseThreshold::getFinal(const Graph &g) const {
   return childPartitions;
 }
 
+MergeVarUpdates::PartitionMap MergeCostModel::getFinal(const Graph &g) const {
+
+  auto parentPartitions = getLargestGroupTargetsMap(g);
+
+  bool isNonTrivialPartition = false;
+  for (auto x : parentPartitions) {
+    if (x.second.size() > 1) {
+      isNonTrivialPartition = true;
+      break;
+    }
+  }
+  if (!isNonTrivialPartition) {
+    return parentPartitions;
+  }
+
+  auto opSched = g.getOpSchedule({});
+  std::map<Op *, int> schedIndex;
+  for (int i = 0; i < opSched.size(); ++i) {
+    schedIndex[opSched[i]] = i;
+  }
+
+  // The memory left at every schedule position, reduced by the groups of the
+  // partitions planned so far
+  auto memToPlayWith = getMemToPlayWith(g, opSched, schedIndex);
+
+  const auto &costs = g.getIr().getSessionOptions().costModelSettings;
+  if (costs.programCycles < 0.0 || costs.onChipCopyBytesPerCycle <= 0.0) {
+    throw error("The session options costModelSettings.programCycles must be "
+                "non-negative and costModelSettings.onChipCopyBytesPerCycle "
+                "must be positive for MergeVarUpdateType::AutoCost");
+  }
+
+  PartitionMap childPartitions;
+
+  for (auto &x : parentPartitions) {
+    auto &parPartId = x.first;
+
+    std::vector<std::tuple<int, VarUpdateOp *>> bySchedIndex;
+    for (auto &op_start_end : x.second) {
+      bySchedIndex.push_back(
+          std::make_tuple(schedIndex.at(op_start_end.vop), op_start_end.vop));
+    }
+    std::sort(bySchedIndex.begin(), bySchedIndex.end());
+    int n = static_cast<int>(bySchedIndex.size());
+
+    // cumBytes[i] is the memory of the first i Variables
+    std::vector<int64_t> cumBytes(n + 1, 0);
+    // the memory to play with from each VarUpdateOp's schedule position to the
+    // next one's, and at each VarUpdateOp's schedule position
+    std::vector<int64_t> minToPlayWithTilNext(n, 0);
+    std::vector<int64_t> toPlayWithAt(n, 0);
+    for (int i = 0; i < n; ++i) {
+      auto vop        = std::get<1>(bySchedIndex[i]);
+      auto &varInfo   = vop->inInfo(VarUpdateOp::getVarToUpdateInIndex());
+      cumBytes[i + 1] = cumBytes[i] + varInfo.nbytes();
+      toPlayWithAt[i] = memToPlayWith[std::get<0>(bySchedIndex[i])];
+      if (i + 1 < n) {
+        minToPlayWithTilNext[i] = std::numeric_limits<int64_t>::max();
+        for (int j = std::get<0>(bySchedIndex[i]);
+             j < std::get<0>(bySchedIndex[i + 1]);
+             ++j) {
+          minToPlayWithTilNext[i] =
+              std::min<int64_t>(minToPlayWithTilNext[i], memToPlayWith[j]);
+        }
+      }
+    }
+
+    // minCycles[j] is the minimum cycles of the first j VarUpdateOps, when the
+    // last group of them starts at groupStart[j]
+    std::vector<double> minCycles(n + 1, std::numeric_limits<double>::max());
+    std::vector<int> groupStart(n + 1, 0);
+    minCycles[0] = 0.0;
+    for (int j = 1; j <= n; ++j) {
+      // The largest excess, over i <= k < j - 1, of cumBytes[k + 1] over the
+      // memory to play with after VarUpdate k. The updaters of VarUpdates i to
+      // k are pending there, which fits if the excess is at most cumBytes[i].
+      int64_t maxExcess = std::numeric_limits<int64_t>::lowest();
+      for (int i = j - 1; i >= 0; --i) {
+        int64_t groupBytes = cumBytes[j] - cumBytes[i];
+        if (i < j - 1) {
+          maxExcess = std::max<int64_t>(
+              maxExcess, cumBytes[i + 1] - minToPlayWithTilNext[i]);
+          // Extending the group to earlier VarUpdates only uses more memory
+          if (maxExcess > cumBytes[i] || 2 * groupBytes > toPlayWithAt[j - 1]) {
+            break;
+          }
+        }
+        double cycles =
+            minCycles[i] + getGroupCycles(costs, j - i, groupBytes);
+        if (cycles < minCycles[j]) {
+          minCycles[j]  = cycles;
+          groupStart[j] = i;
+        }
+      }
+    }
+
+    // Insert the groups, and use the memory they hold
+    std::vector<std::vector<VarUpdateStartEnd>> groups;
+    for (int j = n; j > 0; j = groupStart[j]) {
+      int i = groupStart[j];
+      std::vector<VarUpdateStartEnd> group;
+      for (int k = i; k < j; ++k) {
+        auto vop = std::get<1>(bySchedIndex[k]);
+        auto end = vop->inInfo(VarUpdateOp::getVarToUpdateInIndex()).nelms();
+        group.push_back({vop, 0, end});
+        if (j - i > 1 && k < j - 1) {
+          for (int pos = std::get<0>(bySchedIndex[k]);
+               pos < std::get<0>(bySchedIndex[k + 1]);
+               ++pos) {
+            memToPlayWith[pos] -= cumBytes[k + 1] - cumBytes[i];
+          }
+        }
+      }
+      if (j - i > 1) {
+        memToPlayWith[std::get<0>(bySchedIndex[j - 1])] -=
+            2 * (cumBytes[j] - cumBytes[i]);
+      }
+      groups.push_back(group);
+    }
+    std::reverse(groups.begin(), groups.end());
+
+    for (auto &group : groups) {
+      auto newSubPartitionName =
+          parPartId + "__spn__" + std::to_string(childPartitions.size());
+      childPartitions.insert({newSubPartitionName, group});
+    }
+  }
+
+  return childPartitions;
+}
+
 bool MergeVarUpdates::apply(Graph &graph) const {
 
   // does this call to "apply" change the Graph input?
@@ -506,6 +673,39 @@ bool MergeVarUpdates::apply(Graph &graph) const {
   logging::transform::debug("The number of VarUpdate groups to merge is {}",
                             targetsMap.size());
 
+  MergeVarUpdateReport report;
+  for (auto &targetMap : targetsMap) {
+    if (targetMap.second.empty()) {
+      continue;
+    }
+    MergeVarUpdateGroup group;
+    for (auto &opStartEnd : targetMap.second) {
+      auto weightIn =
+          opStartEnd.vop->inTensor(VarUpdateOp::getVarToUpdateInIndex());
+      group.tensors.push_back(weightIn->id);
+      group.bytes += (opStartEnd.end - opStartEnd.start) *
+                     weightIn->info.getDataTypeInfo()->nbytes();
+    }
+    group.benefit = getGroupBenefit(
+        graph.getIr().getSessionOptions().costModelSettings,
+        group.tensors.size(),
+        group.bytes);
+    report.totalBenefit += group.benefit;
+    logging::transform::debug("VarUpdate group {}: {} Variables, {} bytes, "
+                              "estimated benefit {} cycles",
+                              targetMap.first,
+                              group.tensors.size(),
+                              group.bytes,
+                              group.benefit);
+    report.groups.insert({targetMap.first, group});
+  }
+  logging::transform::info("{} merged VarUpdates into {} groups, with an "
+                           "estimated benefit of {} cycles",
+                           getName(),
+                           report.groups.size(),
+                           report.totalBenefit);
+  graph.getIr().setMergeVarUpdateReport(report);
+
   // the replaced VarUpdateOps which are replaced will be removed at the end
   std::set<VarUpdateOp *> toRemove;
 
@@ -750,6 +950,7 @@ namespace {
 bool initAll   = Transform::registerTransform(new MergeAllVarUpdates);
 bool initAuto  = Transform::registerTransform(new MergeTightThreshold);
 bool initAuto2 = Transform::registerTransform(new MergeLooseThreshold);
+bool initAuto3 = Transform::registerTransform(new MergeCostModel);
 } // namespace
 
 } // namespace popart
@@ -16,6 +16,7 @@
 #include <popart/op/restore.hpp>
 #include <popart/op/stash.hpp>
 #include <popart/patterns/contiguateipucopyindices.hpp>
+#include <popart/recompute.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensors.hpp>
 #include <popart/topocons.hpp>
@@ -639,6 +640,140 @@ void setRecomputation(Graph &graph,
   }
 }
 
+struct StashCandidate {
+  PipelineStage stage;
+  VGraphId vGraphId;
+  // The size of the stash, or 0 if the tensor needs no restoring
+  int64_t bytes;
+};
+
+StashCandidate getStashCandidate(Tensor *t) {
+  auto stashRef   = getStashReferenceOp(t);
+  auto restoreRef = searchForRestoreReferenceOp(t, stashRef);
+  int64_t bytes   = 0;
+  if (restoreRef != nullptr) {
+    auto stashSize =
+        restoreRef->getPipelineStage() - stashRef->getPipelineStage() + 1;
+    bytes = t->info.nbytes() * stashSize;
+  }
+  return {stashRef->getPipelineStage(),
+          getVirtualGraphIdOrSourceIpu(stashRef),
+          bytes};
+}
+
+// The estimated cost of recomputing the Tensor t in the backwards pass, given
+// the Tensors which are stashed. Ops in 'visited' are not counted again.
+double getRecomputeCost(Tensor *t,
+                        const std::set<TensorId> &stashed,
+                        std::set<Op *> &visited) {
+  double cost = 0.0;
+  std::vector<Tensor *> toVisit{t};
+  while (!toVisit.empty()) {
+    auto tensor = toVisit.back();
+    toVisit.pop_back();
+    if (!tensor->hasProducer()) {
+      continue;
+    }
+    auto producer = tensor->getProducer();
+    if (producer->settings.recomputeType != RecomputeType::Recompute ||
+        !visited.insert(producer).second) {
+      continue;
+    }
+    cost += recompute::estimateRecomputeCost(*producer);
+    for (auto input : producer->input->tensors()) {
+      if (stashed.find(input->id) == stashed.end()) {
+        toVisit.push_back(input);
+      }
+    }
+  }
+  return cost;
+}
+
+// With RecomputationType::Budgeted, the stashes which must be kept are
+// complemented by recomputable candidates, while the stashes of each IPU fit
+// in SessionOptions::autoRecomputationMemoryBudget. Candidates which save the
+// most recomputation per stashed byte are chosen first. Returns the chosen
+// candidates, whose producers are still Recompute.
+std::vector<TensorId>
+addStashesWithinBudget(Graph &graph,
+                       const std::vector<TensorId> &candidates,
+                       std::vector<TensorId> &toStashTensors) {
+  auto &ir    = graph.getIr();
+  auto budget = ir.getSessionOptions().autoRecomputationMemoryBudget;
+
+  std::set<TensorId> stashed(toStashTensors.begin(), toStashTensors.end());
+  std::map<VGraphId, int64_t> used;
+  for (auto &tid : toStashTensors) {
+    auto candidate = getStashCandidate(graph.getTensors().get(tid));
+    used[candidate.vGraphId] += candidate.bytes;
+  }
+
+  struct Option {
+    TensorId id;
+    VGraphId vGraphId;
+    int64_t bytes;
+    double saving;
+  };
+  std::vector<Option> options;
+  for (auto &tid : candidates) {
+    auto tensor = graph.getTensors().get(tid);
+    // Stashes of tensors consumed by recomputed Ops must be restored inplace,
+    // which is not possible for anchors.
+    if (stashed.find(tid) != stashed.end() || !tensor->hasProducer() ||
+        tensor->getProducer()->settings.recomputeType !=
+            RecomputeType::Recompute ||
+        ir.isAnchored(tid)) {
+      continue;
+    }
+    auto candidate = getStashCandidate(tensor);
+    if (candidate.bytes == 0) {
+      continue;
+    }
+    std::set<Op *> visited;
+    options.push_back({tid,
+                       candidate.vGraphId,
+                       candidate.bytes,
+                       getRecomputeCost(tensor, stashed, visited)});
+  }
+
+  std::stable_sort(
+      options.begin(), options.end(), [](const Option &a, const Option &b) {
+        return a.saving * static_cast<double>(b.bytes) >
+               b.saving * static_cast<double>(a.bytes);
+      });
+
+  std::vector<TensorId> chosen;
+  for (auto &option : options) {
+    if (used[option.vGraphId] + option.bytes <= budget) {
+      used[option.vGraphId] += option.bytes;
+      toStashTensors.push_back(option.id);
+      chosen.push_back(option.id);
+      logging::transform::debug("Stashing recomputable {} ({} bytes) on "
+                                "virtual graph {}, saving {} recompute cost",
+                                option.id,
+                                option.bytes,
+                                option.vGraphId,
+                                option.saving);
+    }
+  }
+  return chosen;
+}
+
+void logStashReport(const PipelineStashReport &report) {
+  for (auto &stage_stash : report.stages) {
+    auto &stash = stage_stash.second;
+    logging::transform::info("Pipeline stage {}: {} stash candidate(s) of {} "
+                             "bytes, {} stash(es) of {} bytes",
+                             stage_stash.first,
+                             stash.numCandidates,
+                             stash.candidateBytes,
+                             stash.numStashes,
+                             stash.stashBytes);
+  }
+  logging::transform::info("Estimated pipeline recompute cost: {}",
+                           report.recomputeCost);
+}
+
 GetRandomSeedOp *findGetRandomSeedOp(Graph &graph) {
   for (auto &id_op : graph.getOps()) {
     auto op = id_op.second.get();
@@ -857,6 +992,14 @@ bool Pipeline::apply(Graph &graph) const {
     toStashCandidateTensors.push_back(stashableRandomSeed);
   }
 
+  PipelineStashReport stashReport;
+  for (auto &tid : toStashCandidateTensors) {
+    auto candidate = getStashCandidate(graph.getTensors().get(tid));
+    auto &stage    = stashReport.stages[candidate.stage];
+    ++stage.numCandidates;
+    stage.candidateBytes += candidate.bytes;
+  }
+
   std::vector<TensorId> toStashTensors;
   // StashTensorId -> std::pair<StashRefOp, RestoreRefOp>
   std::map<TensorId, std::pair<Op *, Op *>> stashRestoreRefOps;
@@ -906,11 +1049,25 @@ bool Pipeline::apply(Graph &graph) const {
       }
     }
 
+    std::vector<TensorId> budgetStashes;
+    if (ir.getSessionOptions().autoRecomputation ==
+        RecomputationType::Budgeted) {
+      budgetStashes = addStashesWithinBudget(
+          graph, toStashCandidateTensors, toStashTensors);
+    }
+
     // If the set of stash candidates has been reduced, recomputation needs to
     // be reset.
     if (toStashTensors.size() != toStashCandidateTensors.size()) {
       setRecomputation(graph, toStashTensors);
     }
+
+    // The tensors stashed within the budget are restored instead of being
+    // recomputed, so their producers are not rerun.
+    for (auto &tid : budgetStashes) {
+      graph.getTensors().get(tid)->getProducer()->settings.recomputeType =
+          RecomputeType::Checkpoint;
+    }
   }
 
   logging::transform::debug("Final Stash Tensors");
@@ -959,6 +1116,10 @@ bool Pipeline::apply(Graph &graph) const {
     stashOp->createAndConnectOutTensor(StashOp::getOutIndex(), stashId);
     stashOp->setup();
 
+    auto &stashStage = stashReport.stages[stashOp->getPipelineStage()];
+    ++stashStage.numStashes;
+    stashStage.stashBytes += tensor->info.nbytes() * stashSize;
+
     logging::transform::debug("Adding stash of size {} of activations {} for "
                               "pipelining. Stash stage: {}, Restore stage {}",
                               stashOp->getStashSize(),
@@ -1124,6 +1285,16 @@ bool Pipeline::apply(Graph &graph) const {
       }
     }
   }
+
+  for (auto &id_op : graph.getOps()) {
+    auto op = id_op.second.get();
+    if (op->settings.recomputeType == RecomputeType::Recompute) {
+      stashReport.recomputeCost += recompute::estimateRecomputeCost(*op);
+    }
+  }
+  logStashReport(stashReport);
+  ir.setPipelineStashReport(stashReport);
+
   return true;
 }
 
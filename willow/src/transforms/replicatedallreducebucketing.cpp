@@ -0,0 +1,359 @@
+// Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <popart/error.hpp>
+#include <popart/graph.hpp>
+#include <popart/ir.hpp>
+#include <popart/logging.hpp>
+#include <popart/op/collectives/replicatedallreduce.hpp>
+#include <popart/op/concat.hpp>
+#include <popart/op/reshape.hpp>
+#include <popart/op/slice.hpp>
+#include <popart/opidentifier.hpp>
+#include <popart/tensor.hpp>
+#include <popart/tensorindex.hpp>
+#include <popart/tensors.hpp>
+#include <popart/topocons.hpp>
+#include <popart/transforms/replicatedallreducebucketing.hpp>
+
+namespace popart {
+
+namespace {
+
+bool isInplace(const Op *op) {
+  return op->opid == Onnx::CustomOperators::ReplicatedAllReduceInplace;
+}
+
+bool isBucketable(const Op *op) {
+  return (op->opid == Onnx::CustomOperators::ReplicatedAllReduce ||
+          isInplace(op)) &&
+         op->input->hasIndex(ReplicatedAllReduceOp::getInIndex()) &&
+         !op->input->hasIndex(
+             ReplicatedAllReduceOp::getCollectiveLinkedIndex()) &&
+         op->output->hasIndex(ReplicatedAllReduceOp::getOutIndex());
+}
+
+// All-reduces with the same partition id may share a bucket. Inplace
+// all-reduces, of the accumulators of SGD1 and Adam, only share buckets with
+// each other.
+std::string getPartitionId(const Op *op) {
+  std::stringstream ss;
+  ss << op->opid.type << "_vg_" << op->settings.vgraphId << "_ps_"
+     << op->settings.pipelineStage << "_ep_" << op->settings.executionPhase
+     << "_bsp_" << op->settings.batchSerializedPhase << "_ts_"
+     << op->settings.tileSet << "_ec_" << op->settings.executionContext
+     << "_rt_" << op->settings.recomputeType << "_dt_"
+     << op->inInfo(ReplicatedAllReduceOp::getInIndex()).dataType();
+  return ss.str();
+}
+
+// Add the Ops reachable from op to reached, following the consumers and the
+// topological constraints after each Op (downstream), or the producers and
+// the topological constraints before each Op (upstream)
+void addReachable(Op *op, bool downstream, std::set<Op *, POpCmp> &reached) {
+  std::vector<Op *> frontier{op};
+  while (!frontier.empty()) {
+    auto current = frontier.back();
+    frontier.pop_back();
+    std::vector<Op *> next;
+    if (downstream) {
+      next = current->getGraph().topoCons->getAfters(current);
+      for (auto out : current->output->tensors()) {
+        for (auto consumer : out->consumers.getOps()) {
+          next.push_back(consumer);
+        }
+      }
+    } else {
+      next = current->getGraph().topoCons->getBefores(current);
+      for (auto in : current->input->tensors()) {
+        if (in->hasProducer()) {
+          next.push_back(in->getProducer());
+        }
+      }
+    }
+    for (auto nextOp : next) {
+      if (reached.insert(nextOp).second) {
+        frontier.push_back(nextOp);
+      }
+    }
+  }
+}
+
+std::string getBucketPrefix(int bucket) {
+  return "bucket" + std::to_string(bucket) + "___";
+}
+
+// Replace the all-reduces of a bucket by one all-reduce of their
+// concatenated, flattened inputs. The reduced buffer is sliced and reshaped
+// into the outputs of the replaced all-reduces. The concatenation, slices and
+// reshapes are all inplace, so that an inplace bucket still updates the
+// tensors its all-reduces updated.
+void mergeBucket(Graph &graph, const std::vector<Op *> &reduceOps, int bucket) {
+  auto prefix = getBucketPrefix(bucket);
+
+  const bool inplace    = isInplace(reduceOps.front());
+  Op::Settings settings = reduceOps.front()->settings;
+  settings.name         = prefix + "allReduce";
+  // Issue the all-reduce as soon as the last gradient of the bucket is ready
+  Op::Settings bucketSettings     = settings;
+  bucketSettings.schedulePriority = std::numeric_limits<double>::max();
+
+  std::vector<TensorId> inIds;
+  std::vector<TensorId> outIds;
+  std::vector<Shape> outShapes;
+  std::set<Op *, POpCmp> befores;
+  std::set<Op *, POpCmp> afters;
+
+  for (auto reduceOp : reduceOps) {
+    inIds.push_back(reduceOp->inId(ReplicatedAllReduceOp::getInIndex()));
+    outIds.push_back(reduceOp->outId(ReplicatedAllReduceOp::getOutIndex()));
+    outShapes.push_back(
+        reduceOp->outShape(ReplicatedAllReduceOp::getOutIndex()));
+    for (auto before : graph.topoCons->getBefores(reduceOp)) {
+      befores.insert(before);
+    }
+    for (auto after : graph.topoCons->getAfters(reduceOp)) {
+      afters.insert(after);
+    }
+  }
+
+  for (auto reduceOp : reduceOps) {
+    befores.erase(reduceOp);
+    afters.erase(reduceOp);
+    reduceOp->disconnectAllInputs();
+    reduceOp->disconnectAllOutputs();
+    graph.eraseOp(reduceOp->id);
+  }
+
+  // Flatten and concatenate the gradients
+  auto concatOp = graph.createOp<ConcatInplaceOp>(0, bucketSettings);
+  for (int i = 0; i < inIds.size(); ++i) {
+    auto &inId  = inIds.at(i);
+    auto nelms  = graph.getTensors().get(inId)->info.nelms();
+    auto flatOp = graph.createOp<ReshapeInplaceOp>(
+        Onnx::CustomOperators::ReshapeInplace, Shape{nelms}, bucketSettings);
+    flatOp->connectInTensor(ReshapeBaseOp::getInIndex(), inId);
+    flatOp->createAndConnectOutTensor(ReshapeBaseOp::getOutIndex(),
+                                      prefix + "flattened___" + inId);
+    flatOp->setup();
+    concatOp->connectInTensor(i, flatOp->outId(ReshapeBaseOp::getOutIndex()));
+  }
+  concatOp->createAndConnectOutTensor(ConcatOp::getOutIndex(),
+                                      prefix + "concatGrads");
+  concatOp->setup();
+
+  // Reduce the flat buffer
+  Op *reduceOp;
+  if (inplace) {
+    reduceOp = graph.createOp<ReplicatedAllReduceInplaceOp>(
+        Onnx::CustomOperators::ReplicatedAllReduceInplace, bucketSettings);
+  } else {
+    reduceOp = graph.createOp<ReplicatedAllReduceOp>(
+        Onnx::CustomOperators::ReplicatedAllReduce, bucketSettings);
+  }
+  reduceOp->connectInTensor(ReplicatedAllReduceOp::getInIndex(),
+                            concatOp->outId(ConcatOp::getOutIndex()));
+  reduceOp->createAndConnectOutTensor(ReplicatedAllReduceOp::getOutIndex(),
+                                      prefix + "reduced");
+  reduceOp->setup();
+
+  // Scatter the reduced buffer back into the reduced gradients
+  int64_t start = 0;
+  for (int i = 0; i < outIds.size(); ++i) {
+    auto &outId = outIds.at(i);
+    auto &shape = outShapes.at(i);
+    auto end    = start + graph.getTensors().get(outId)->info.nelms();
+
+    auto sliceOp = graph.createOp<SliceInplaceOp>(
+        Onnx::CustomOperators::SliceInplace,
+        std::vector<int64_t>{start}, // starts
+        std::vector<int64_t>{end},   // ends
+        std::vector<int64_t>{0},     // axes
+        std::vector<int64_t>{},      // flips
+        settings);
+    sliceOp->connectInTensor(
+        BaseSliceOp::getInIndex(),
+        reduceOp->outId(ReplicatedAllReduceOp::getOutIndex()));
+    sliceOp->createAndConnectOutTensor(BaseSliceOp::getOutIndex(),
+                                       prefix + "sliced___" + outId);
+    sliceOp->setup();
+
+    auto reshapeOp = graph.createOp<ReshapeInplaceOp>(
+        Onnx::CustomOperators::ReshapeInplace, shape, settings);
+    reshapeOp->connectInTensor(ReshapeBaseOp::getInIndex(),
+                               sliceOp->outId(BaseSliceOp::getOutIndex()));
+    reshapeOp->connectOutTensor(ReshapeBaseOp::getOutIndex(), outId);
+    reshapeOp->setup();
+
+    start = end;
+  }
+
+  // The constraints of the replaced all-reduces are not tied, so that the
+  // bucket is not scheduled next to any one of their consumers. As no
+  // all-reduce of a bucket depends on another, these can not form a cycle.
+  for (auto before : befores) {
+    graph.topoCons->insert(before, reduceOp);
+  }
+  for (auto after : afters) {
+    graph.topoCons->insert(reduceOp, after);
+  }
+
+  logging::transform::debug("[ReplicatedAllReduceBucketing] {} reduces {} "
+                            "gradients",
+                            reduceOp->debugName(),
+                            inIds.size());
+}
+
+} // namespace
+
+std::size_t ReplicatedAllReduceBucketing::id() {
+  return typeid(ReplicatedAllReduceBucketing).hash_code();
+}
+
+bool ReplicatedAllReduceBucketing::apply(Graph &graph) const {
+  auto &ir = graph.getIr();
+  const int64_t bucketSize =
+      ir.getSessionOptions().replicatedAllReduceBucketSize;
+
+  // Every all-reduce has a fixed latency, and the tensors of a bucket are
+  // copied into a flat buffer
+  auto &costs = ir.getSessionOptions().costModelSettings;
+  if (costs.collectiveLatencyCycles < 0 || costs.onChipCopyBytesPerCycle <= 0) {
+    throw error("[ReplicatedAllReduceBucketing] "
+                "CostModelSettings::collectiveLatencyCycles must not be "
+                "negative, and onChipCopyBytesPerCycle must be positive");
+  }
+
+  // The partitions, in the order their first all-reduce is scheduled
+  std::vector<std::string> partitionIds;
+  ReplicatedAllReduceBucketReport report;
+  for (auto op : graph.getOpSchedule({})) {
+    if (isBucketable(op)) {
+      ++report.numAllReducesBefore;
+      auto partitionId = getPartitionId(op);
+      if (std::find(partitionIds.begin(), partitionIds.end(), partitionId) ==
+          partitionIds.end()) {
+        partitionIds.push_back(partitionId);
+      }
+    }
+  }
+
+  bool changed = false;
+  auto addBucket = [&](const std::vector<Op *> &bucket, int64_t bytes) {
+    auto i = static_cast<int>(report.buckets.size());
+
+    ReplicatedAllReduceBucket reportBucket;
+    reportBucket.bytes = bytes;
+    for (auto op : bucket) {
+      reportBucket.tensors.push_back(
+          op->inId(ReplicatedAllReduceOp::getInIndex()));
+    }
+
+    if (bucket.size() > 1) {
+      reportBucket.benefit =
+          static_cast<double>(bucket.size() - 1) *
+              costs.collectiveLatencyCycles -
+          static_cast<double>(reportBucket.bytes) /
+              costs.onChipCopyBytesPerCycle;
+      mergeBucket(graph, bucket, i);
+      changed = true;
+    }
+
+    logging::transform::debug("[ReplicatedAllReduceBucketing] Bucket {}: {} "
+                              "gradients, {} bytes, estimated benefit {}",
+                              i,
+                              reportBucket.tensors.size(),
+                              reportBucket.bytes,
+                              reportBucket.benefit);
+
+    report.totalBenefit += reportBucket.benefit;
+    report.buckets.push_back(reportBucket);
+  };
+
+  for (auto &partitionId : partitionIds) {
+    // Merging a bucket adds paths between the all-reduces which depended on
+    // any one of its all-reduces, so the schedule is recomputed for each
+    // partition, and each bucket is merged before the next is filled
+    auto schedule = graph.getOpSchedule({});
+    std::map<Op *, int, POpCmp> position;
+    for (int i = 0; i < schedule.size(); ++i) {
+      position[schedule.at(i)] = i;
+    }
+
+    // Order the all-reduces by when their gradients are produced
+    std::vector<std::pair<int, Op *>> reduceOps;
+    for (auto op : schedule) {
+      if (isBucketable(op) && getPartitionId(op) == partitionId) {
+        auto grad = op->inTensor(ReplicatedAllReduceOp::getInIndex());
+        reduceOps.push_back(
+            {grad->hasProducer() ? position.at(grad->getProducer()) : -1, op});
+      }
+    }
+    std::stable_sort(
+        reduceOps.begin(),
+        reduceOps.end(),
+        [](const std::pair<int, Op *> &a, const std::pair<int, Op *> &b) {
+          return a.first < b.first;
+        });
+
+    std::vector<Op *> remaining;
+    for (auto &positionAndOp : reduceOps) {
+      remaining.push_back(positionAndOp.second);
+    }
+
+    // Fill the buckets in turn. A bucket which would exceed the bucket size
+    // is closed, unless it is empty. An all-reduce which depends on one of
+    // the bucket, or on which one of the bucket depends, can not be merged
+    // with it without a cycle, and is left for the next buckets.
+    while (!remaining.empty()) {
+      std::vector<Op *> deferred;
+      std::vector<Op *> bucket;
+      int64_t bucketBytes = 0;
+      std::set<Op *, POpCmp> downstream;
+      std::set<Op *, POpCmp> upstream;
+      for (auto op : remaining) {
+        if (downstream.count(op) > 0 || upstream.count(op) > 0) {
+          deferred.push_back(op);
+          continue;
+        }
+        auto bytes = op->inInfo(ReplicatedAllReduceOp::getInIndex()).nbytes();
+        if (!bucket.empty() && bucketBytes + bytes > bucketSize) {
+          addBucket(bucket, bucketBytes);
+          bucket.clear();
+          bucketBytes = 0;
+          downstream.clear();
+          upstream.clear();
+        }
+        bucket.push_back(op);
+        bucketBytes += bytes;
+        addReachable(op, true, downstream);
+        addReachable(op, false, upstream);
+      }
+      addBucket(bucket, bucketBytes);
+      remaining = deferred;
+    }
+  }
+
+  report.numAllReducesAfter = static_cast<int64_t>(report.buckets.size());
+
+  logging::transform::info(
+      "[ReplicatedAllReduceBucketing] {} all-reduces bucketed into {}, "
+      "estimated benefit {} cycles",
+      report.numAllReducesBefore,
+      report.numAllReducesAfter,
+      report.totalBenefit);
+
+  ir.setReplicatedAllReduceBucketReport(report);
+
+  return changed;
+}
+
+namespace {
+bool init = Transform::registerTransform(new ReplicatedAllReduceBucketing);
+}
+
+} // namespace popart
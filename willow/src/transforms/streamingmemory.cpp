@@ -1,4 +1,7 @@
 // Copyright (c) 2020 Graphcore Ltd. All rights reserved.
+#include <algorithm>
+#include <limits>
+#include <set>
 #include <popart/error.hpp>
 #include <popart/graph.hpp>
 #include <popart/ir.hpp>
@@ -15,6 +18,7 @@
 #include <popart/op/remote.hpp>
 #include <popart/op/sgd0varupdate.hpp>
 #include <popart/op/varupdate.hpp>
+#include <popart/recompute.hpp>
 #include <popart/tensor.hpp>
 #include <popart/tensornames.hpp>
 #include <popart/tensors.hpp>
@@ -29,6 +33,117 @@ std::size_t StreamingMemory::id(int pass) {
   return typeid(StreamingMemory).hash_code() + pass;
 }
 
+namespace {
+
+bool isWeight(const Tensor *t) {
+  return t->tensorType() == TensorType::Variable ||
+         t->tensorType() == TensorType::Const;
+}
+
+// The cost of the phase holding the Ops [begin, end) of a schedule, built up
+// by adding Ops at the front, from end - 1 down to begin. The memory only
+// grows as Ops are added, as an output which was an input of the phase is
+// counted once either way.
+class PhaseCostAccumulator {
+public:
+  PhaseCostAccumulator(const std::vector<Op *> &ops_,
+                       const std::map<Op *, int> &position_,
+                       const std::set<Tensor *> &remote_,
+                       const CostModelSettings &costs_)
+      : ops(ops_), position(position_), remote(remote_), costs(costs_) {}
+
+  void addFront(int begin) {
+    Op *op = ops.at(begin);
+    cost.numOps++;
+    cost.computeCost += recompute::estimateRecomputeCost(*op);
+
+    for (Tensor *t : op->output->tensors()) {
+      cost.activationBytes += t->info.nbytes();
+      if (incoming.erase(t) > 0) {
+        cost.activationBytes -= t->info.nbytes();
+        addTraffic(t, -t->info.nbytes());
+      }
+    }
+
+    for (Tensor *t : op->input->tensors()) {
+      if (isWeight(t)) {
+        if (weights.insert(t).second) {
+          cost.weightBytes += t->info.nbytes();
+          if (remote.find(t) != remote.end()) {
+            cost.remoteBytes += t->info.nbytes();
+          }
+        }
+      } else if (!isProducedAfter(t, begin) && incoming.insert(t).second) {
+        cost.activationBytes += t->info.nbytes();
+        addTraffic(t, t->info.nbytes());
+      }
+    }
+  }
+
+  int64_t memory() const { return cost.weightBytes + cost.activationBytes; }
+
+  double traffic() const {
+    return static_cast<double>(cost.remoteBytes) / costs.remoteBytesPerCycle +
+           static_cast<double>(cost.copyBytes) /
+               costs.interIpuCopyBytesPerCycle;
+  }
+
+  // Copies of one phase overlap with compute of another
+  double time() const {
+    return std::max(cost.computeCost / costs.macsPerCycle, traffic());
+  }
+
+  ExecutionPhaseCost cost;
+
+private:
+  bool isProducedAfter(const Tensor *t, int begin) const {
+    if (!t->hasProducer()) {
+      return false;
+    }
+    auto found = position.find(t->getProducer());
+    return found != position.end() && found->second > begin;
+  }
+
+  // Activations streamed from the host are not traffic between phases
+  void addTraffic(Tensor *t, int64_t bytes) {
+    if (remote.find(t) != remote.end()) {
+      cost.remoteBytes += bytes;
+    } else if (t->hasProducer()) {
+      cost.copyBytes += bytes;
+    }
+  }
+
+  const std::vector<Op *> &ops;
+  const std::map<Op *, int> &position;
+  const std::set<Tensor *> &remote;
+  const CostModelSettings &costs;
+  std::set<Tensor *> weights;
+  std::set<Tensor *> incoming;
+};
+
+void logPlan(const ExecutionPhasePlan &plan) {
+  for (int phase = 0; phase < plan.costs.size(); ++phase) {
+    auto &cost = plan.costs[phase];
+    logging::transform::info("[StreamingMemory] Phase {}: {} Ops, {} weight "
+                             "bytes, {} activation bytes, compute {}, {} "
+                             "remote bytes, {} copied bytes",
+                             phase,
+                             cost.numOps,
+                             cost.weightBytes,
+                             cost.activationBytes,
+                             cost.computeCost,
+                             cost.remoteBytes,
+                             cost.copyBytes);
+  }
+  for (int stage = 0; stage < plan.stageComputeCosts.size(); ++stage) {
+    logging::transform::info("[StreamingMemory] Stage {}: compute {}",
+                             stage,
+                             plan.stageComputeCosts[stage]);
+  }
+}
+
+} // namespace
+
 // The cost of an Op, simplified to only account for weights
 float StreamingMemory::costFn(Op *op) const {
   float w_weights = 1.f;
@@ -95,6 +210,144 @@ void StreamingMemory::verifyExecutionPhases(Graph &graph) const {
   }
 }
 
+ExecutionPhasePlan StreamingMemory::planExecutionPhases(Graph &graph) const {
+  auto &ir                    = graph.getIr();
+  auto &sessionOptions        = ir.getSessionOptions();
+  auto &settings              = sessionOptions.executionPhaseSettings;
+  const int replicationFactor = sessionOptions.enableReplicatedGraphs
+                                    ? sessionOptions.replicatedGraphCount
+                                    : 1;
+  const int numPhases = settings.phases;
+  const int numStages = std::max(settings.stages, 1);
+  const auto budget   = settings.autoMemoryBudget;
+  auto &costs         = sessionOptions.costModelSettings;
+
+  if (costs.macsPerCycle <= 0 || costs.remoteBytesPerCycle <= 0 ||
+      costs.interIpuCopyBytesPerCycle <= 0) {
+    throw error("[StreamingMemory] CostModelSettings::macsPerCycle, "
+                "remoteBytesPerCycle and interIpuCopyBytesPerCycle must be "
+                "positive");
+  }
+  if (settings.autoTimeSlack < 1.0) {
+    throw error("[StreamingMemory] ExecutionPhaseSettings::autoTimeSlack must "
+                "be at least 1, not {}",
+                settings.autoTimeSlack);
+  }
+
+  StreamingMemoryOpInserter opInserter{
+      graph, replicationFactor, numStages, numPhases};
+
+  // The Ops to plan, in schedule order, and which of their inputs are in
+  // remote buffers
+  std::vector<Op *> ops;
+  std::map<Op *, int> position;
+  std::set<Tensor *> remote;
+  for (Op *op : graph.getOpSchedule({})) {
+    if (op->settings.executionContext != ExecutionContext::Normal ||
+        op->hasExecutionPhase()) {
+      continue;
+    }
+    position[op] = static_cast<int>(ops.size());
+    ops.push_back(op);
+    for (Tensor *t : op->input->tensors()) {
+      if ((t->tensorType() == TensorType::Variable ||
+           t->tensorType() == TensorType::ActGrad) &&
+          opInserter.determineTensorLocation(t).isRemote()) {
+        remote.insert(t);
+      }
+    }
+  }
+
+  ExecutionPhasePlan plan;
+  plan.stageComputeCosts.resize(numStages, 0.0);
+  const int n = static_cast<int>(ops.size());
+  if (n == 0) {
+    return plan;
+  }
+
+  const double infinity = std::numeric_limits<double>::infinity();
+
+  // Dynamic programs over the number of phases p and the number of Ops j in
+  // them, where the last phase holds the Ops [i, j). The first minimises the
+  // time of the slowest phase, the second the traffic while no phase is more
+  // than ExecutionPhaseSettings::autoTimeSlack times slower than that.
+  auto solve = [&](double maxTime, std::vector<std::vector<int>> &starts) {
+    std::vector<std::vector<double>> best(
+        numPhases + 1, std::vector<double>(n + 1, infinity));
+    starts.assign(numPhases + 1, std::vector<int>(n + 1, -1));
+    best[0][0] = 0.0;
+    for (int j = 1; j <= n; ++j) {
+      PhaseCostAccumulator acc(ops, position, remote, costs);
+      for (int i = j - 1; i >= 0; --i) {
+        acc.addFront(i);
+        if (acc.memory() > budget) {
+          break;
+        }
+        double time = acc.time();
+        if (time > maxTime) {
+          continue;
+        }
+        for (int p = 1; p <= numPhases; ++p) {
+          if (best[p - 1][i] == infinity) {
+            continue;
+          }
+          double value = maxTime == infinity
+                             ? std::max(best[p - 1][i], time)
+                             : best[p - 1][i] + acc.traffic();
+          if (value < best[p][j]) {
+            best[p][j]   = value;
+            starts[p][j] = i;
+          }
+        }
+      }
+    }
+    int bestPhases = 0;
+    for (int p = 1; p <= numPhases; ++p) {
+      if (best[p][n] < infinity &&
+          (bestPhases == 0 || best[p][n] < best[bestPhases][n])) {
+        bestPhases = p;
+      }
+    }
+    return std::make_pair(bestPhases,
+                          bestPhases > 0 ? best[bestPhases][n] : infinity);
+  };
+
+  std::vector<std::vector<int>> starts;
+  auto fastest = solve(infinity, starts);
+  if (fastest.first == 0) {
+    throw error("[StreamingMemory] The {} Ops without an execution phase can "
+                "not be split into at most {} phases of at most {} bytes of "
+                "weights and activations each. Increase "
+                "ExecutionPhaseSettings::autoMemoryBudget or "
+                "ExecutionPhaseSettings::phases",
+                n,
+                numPhases,
+                budget);
+  }
+  auto leastTraffic = solve(fastest.second * settings.autoTimeSlack, starts);
+  if (leastTraffic.first == 0) {
+    throw internal_error("[StreamingMemory] Failed to plan execution phases");
+  }
+
+  // Walk back through the phases, from the last one
+  plan.costs.resize(leastTraffic.first);
+  int end = n;
+  for (int phase = leastTraffic.first - 1; phase >= 0; --phase) {
+    int begin = starts[phase + 1][end];
+    PhaseCostAccumulator acc(ops, position, remote, costs);
+    for (int i = end - 1; i >= begin; --i) {
+      acc.addFront(i);
+      plan.phases[ops[i]->id] = phase;
+    }
+    plan.costs[phase] = acc.cost;
+    plan.stageComputeCosts[phase % numStages] += acc.cost.computeCost;
+    plan.totalRemoteBytes += acc.cost.remoteBytes;
+    plan.totalCopyBytes += acc.cost.copyBytes;
+    end = begin;
+  }
+  return plan;
+}
+
 bool StreamingMemory::apply(Graph &graph) const {
 
   auto &ir                    = graph.getIr();
@@ -118,6 +371,11 @@ bool StreamingMemory::apply(Graph &graph) const {
       graph, replicationFactor, num_stages, num_phases};
 
   if (pass == 1 || pass == 2) {
+    if (sessionOptions.replicatedTensorShardingMemoryBudget > 0) {
+      ir.setReplicatedTensorShardingPlan(
+          opInserter.planReplicatedTensorSharding());
+    }
+
     for (Tensor *tensor : graph.getTensors().getOfType(TensorType::Variable)) {
       // The mechanism by which we handle offloaded (off-chip) tensors of type
       // TensorType::Variable is setting a flag in tensorLocationInfo.
@@ -142,6 +400,14 @@ bool StreamingMemory::apply(Graph &graph) const {
     auto schedule = graph.getOpSchedule({});
 
     if (pass == 1) {
+      std::map<OpId, ExecutionPhase> plannedPhases;
+      if (sessionOptions.executionPhaseSettings.autoMemoryBudget > 0) {
+        auto plan = planExecutionPhases(graph);
+        logPlan(plan);
+        plannedPhases = plan.phases;
+        ir.setExecutionPhasePlan(plan);
+      }
+
       float cumulative_cost = 0.f;
 
       for (Op *op : schedule) {
@@ -175,8 +441,13 @@ bool StreamingMemory::apply(Graph &graph) const {
               op->getExecutionPhase());
         }
 
-        opInserter.sanitizePlacementAnnotation(
-            op, has_phase ? op->getExecutionPhase() : phase);
+        auto planned = plannedPhases.find(op->id);
+        if (!has_phase && planned != plannedPhases.end()) {
+          opInserter.sanitizePlacementAnnotation(op, planned->second);
+        } else {
+          opInserter.sanitizePlacementAnnotation(
+              op, has_phase ? op->getExecutionPhase() : phase);
+        }
       }
 
       // Recomputation annotation
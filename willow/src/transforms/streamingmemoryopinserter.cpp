@@ -358,6 +358,13 @@ void StreamingMemoryOpInserter::apply() {
     applyTensor(tensor, rtsTensors);
   }
 
+  if (isPhasedExecution() &&
+      graph.getIr()
+              .getSessionOptions()
+              .executionPhaseSettings.onDemandPrefetchPhases > 0) {
+    logPrefetchOverlap();
+  }
+
   updateReplicatedOperations();
   updateOptimizerOperations();
 
@@ -996,6 +1003,16 @@ void StreamingMemoryOpInserter::getTensorConfig(Tensor *tensor) {
   // Determine how the new ops should be scheduled
   getTensorOpSchedule(tensor, tensorConfig);
 
+  // Prefetched tensors land on the IO tiles, if there are any, so that they
+  // are held there, and not on the compute tiles, until they are consumed
+  auto &sessionOptions = graph.getIr().getSessionOptions();
+  if (isPhasedExecution() &&
+      tensorConfig.ioSchedule == ExecutionPhaseIOSchedule::OnDemand &&
+      sessionOptions.executionPhaseSettings.onDemandPrefetchPhases > 0 &&
+      sessionOptions.numIOTiles > 0) {
+    tensorConfig.location.loadTileSet = TileSet::IO;
+  }
+
   if (tensorConfig.location.replicatedTensorSharding ==
       ReplicatedTensorSharding::On) {
     tensor->tensorLocationInfo.setSharded(true);
@@ -1418,9 +1435,13 @@ void StreamingMemoryOpInserter::setLoadingOpPhaseAndPriority(
   if (context.context == ExecutionContext::Normal && isPhasedExecution()) {
     if (tensorConfig.ioSchedule == ExecutionPhaseIOSchedule::OnDemand) {
       if (context.phase) {
-        // RemoteLoad in current phase
-        op->setExecutionPhase(context.phase);
+        // RemoteLoad in current phase, or prefetched in an earlier one
+        auto loadPhase = getOnDemandLoadPhase(tensorConfig, context);
+        op->setExecutionPhase(loadPhase);
         op->settings.schedulePriority = 0.0f;
+        if (loadPhase < *(context.phase)) {
+          setPriority(op, isPhasedExecution(), false, tensorConfig.schedule);
+        }
       }
       // Optimizer states OnDemand are given a priority that delays the load
       // until the optimizer needs it
@@ -1443,6 +1464,100 @@ void StreamingMemoryOpInserter::setLoadingOpPhaseAndPriority(
   }
 }
 
+ExecutionPhase StreamingMemoryOpInserter::getOnDemandLoadPhase(
+    const TensorConfig &tensorConfig,
+    const TensorStreamingContext &context) {
+  ExecutionPhase phase = *(context.phase);
+  auto key             = std::make_pair(tensorConfig.tensor, phase);
+  auto found           = onDemandLoadPhases.find(key);
+  if (found != onDemandLoadPhases.end()) {
+    return found->second;
+  }
+
+  auto &settings = graph.getIr().getSessionOptions().executionPhaseSettings;
+  auto streamingVGID = tensorConfig.streamingMap.at(context).streamingVGID;
+  VGraphId vgid      = streamingVGID ? *streamingVGID : unusedVGraphId;
+  int64_t bytes      = tensorConfig.tensor->info.nbytes();
+  if (tensorConfig.location.replicatedTensorSharding ==
+      ReplicatedTensorSharding::On) {
+    bytes = (bytes - 1) / replicationFactor + 1;
+  }
+
+  // As far ahead as fits, but not before the phase in which Preload tensors
+  // are loaded for the first phase
+  ExecutionPhase loadPhase = phase;
+  for (int distance = settings.onDemandPrefetchPhases; distance > 0;
+       --distance) {
+    ExecutionPhase candidate = std::max<ExecutionPhase>(phase - distance, -1);
+    if (candidate >= phase) {
+      break;
+    }
+    bool fits = true;
+    if (settings.onDemandPrefetchMemoryBudget > 0) {
+      for (ExecutionPhase p = candidate; p < phase; ++p) {
+        auto held = prefetchedBytes.find({vgid, p});
+        if ((held == prefetchedBytes.end() ? 0 : held->second) + bytes >
+            settings.onDemandPrefetchMemoryBudget) {
+          fits = false;
+        }
+      }
+    }
+    if (fits) {
+      loadPhase = candidate;
+      break;
+    }
+  }
+
+  for (ExecutionPhase p = loadPhase; p < phase; ++p) {
+    prefetchedBytes[{vgid, p}] += bytes;
+  }
+  if (loadPhase < phase) {
+    onDemandLoadBytes[phase].second += bytes;
+    logging::transform::trace("[StreamingMemory] Prefetching {} in phase {} "
+                              "for phase {}",
+                              tensorConfig.tensor->id,
+                              loadPhase,
+                              phase);
+  } else {
+    onDemandLoadBytes[phase].first += bytes;
+  }
+  onDemandLoadPhases.insert({key, loadPhase});
+  return loadPhase;
+}
+
+void StreamingMemoryOpInserter::logPrefetchOverlap() const {
+  int64_t totalOnDemand = 0;
+  int64_t totalPrefetch = 0;
+  for (auto &phase_bytes : onDemandLoadBytes) {
+    auto phase      = phase_bytes.first;
+    auto inPhase    = phase_bytes.second.first;
+    auto prefetched = phase_bytes.second.second;
+    int64_t held    = 0;
+    for (auto &vgid_phase_bytes : prefetchedBytes) {
+      if (vgid_phase_bytes.first.second == phase) {
+        held = std::max(held, vgid_phase_bytes.second);
+      }
+    }
+    logging::transform::info("[StreamingMemory] Phase {}: {} of {} bytes "
+                             "loaded on demand are prefetched, {} prefetched "
+                             "bytes held on the fullest virtual graph",
+                             phase,
+                             prefetched,
+                             inPhase + prefetched,
+                             held);
+    totalOnDemand += inPhase;
+    totalPrefetch += prefetched;
+  }
+  if (totalOnDemand + totalPrefetch > 0) {
+    logging::transform::info(
+        "[StreamingMemory] {} of {} bytes loaded on demand overlap with "
+        "compute ({}%)",
+        totalPrefetch,
+        totalOnDemand + totalPrefetch,
+        100 * totalPrefetch / (totalOnDemand + totalPrefetch));
+  }
+}
+
 RemoteLoadOp *StreamingMemoryOpInserter::insertRemoteLoadOp(
     const TensorConfig &tensorConfig,
     const TensorStreamingContext context,
@@ -1940,6 +2055,12 @@ StreamingMemoryOpInserter::determineTensorLocation(Tensor *tensor) const {
       }
     }
 
+    auto planned = rtsPlan.locations.find(id);
+    if (planned != rtsPlan.locations.end()) {
+      result.replicatedTensorSharding =
+          planned->second.replicatedTensorSharding;
+    }
+
     if (result.replicatedTensorSharding == ReplicatedTensorSharding::On) {
       if ((!sessionOptions.enableReplicatedGraphs) ||
           (sessionOptions.replicatedGraphCount <= 1)) {
@@ -1987,6 +2108,135 @@ StreamingMemoryOpInserter::determineTensorLocation(Tensor *tensor) const {
   return result;
 }
 
+const ReplicatedTensorShardingPlan &
+StreamingMemoryOpInserter::planReplicatedTensorSharding() {
+  auto &ir             = graph.getIr();
+  auto &sessionOptions = ir.getSessionOptions();
+  auto budget          = sessionOptions.replicatedTensorShardingMemoryBudget;
+  auto &costs          = sessionOptions.costModelSettings;
+
+  rtsPlan = ReplicatedTensorShardingPlan();
+  if (budget <= 0 || replicationFactor <= 1) {
+    return rtsPlan;
+  }
+  if (costs.collectiveLatencyCycles < 0 || costs.collectiveBytesPerCycle <= 0) {
+    throw error("[StreamingMemory] CostModelSettings::collectiveLatencyCycles "
+                "must not be negative, and collectiveBytesPerCycle must be "
+                "positive");
+  }
+
+  // The candidates, and the location they would have without the plan. The
+  // accumulators, the tensors in tensorLocationSettingsOverride, those with
+  // fewer elements than the minElementsForReplicatedTensorSharding of their
+  // TensorLocationSettings and those too small to split between the replicas
+  // keep their location, but still count towards the budget
+  std::vector<std::pair<Tensor *, TensorLocation>> candidates;
+  for (Tensor *tensor : graph.getTensors().getOfType(TensorType::Variable)) {
+    if (tensor->isOptimizerTensor() || isConstOrCopyOfConst(tensor)) {
+      continue;
+    }
+    auto &locationSettings =
+        tensor->isOptimizerStateTensor()
+            ? sessionOptions.optimizerStateTensorLocationSettings
+            : sessionOptions.weightTensorLocationSettings;
+    if (tensor->isAccumulatorTensor() ||
+        sessionOptions.tensorLocationSettingsOverride.count(tensor->id) ||
+        tooSmallForReplicatedTensorSharding(locationSettings, tensor) ||
+        tensor->info.nelms() < replicationFactor) {
+      auto vgid     = tensor->getVirtualGraphIdUnsafe();
+      int64_t bytes = tensor->info.nbytes();
+      if (determineTensorLocation(tensor).replicatedTensorSharding ==
+          ReplicatedTensorSharding::On) {
+        bytes = (bytes - 1) / replicationFactor + 1;
+      }
+      rtsPlan.fixedBytes[vgid] += bytes;
+      rtsPlan.bytes[vgid] += bytes;
+      continue;
+    }
+    candidates.push_back({tensor, determineTensorLocation(tensor)});
+  }
+
+  // A sharded weight is gathered when it is loaded, and its gradient is
+  // reduce-scattered instead of all-reduced; a sharded optimizer state only
+  // needs the updated weight to be gathered
+  for (auto &candidate : candidates) {
+    Tensor *tensor = candidate.first;
+    ReplicatedTensorShardingDecision decision;
+    decision.vgid       = tensor->getVirtualGraphIdUnsafe();
+    decision.bytes      = tensor->info.nbytes();
+    decision.savedBytes = decision.bytes - ((decision.bytes - 1) /
+                                                replicationFactor +
+                                            1);
+    int numCollectives =
+        (ir.canTrain() && !tensor->isOptimizerStateTensor()) ? 2 : 1;
+    decision.collectiveBytes = numCollectives * decision.savedBytes;
+    decision.collectiveCycles =
+        numCollectives * costs.collectiveLatencyCycles +
+        decision.collectiveBytes / costs.collectiveBytesPerCycle;
+    rtsPlan.tensors.insert({tensor->id, decision});
+    rtsPlan.bytes[decision.vgid] += decision.bytes;
+  }
+
+  // Shard the tensors with the most memory saved per collective cycle first,
+  // while their virtual graph does not fit in the budget
+  std::vector<TensorId> order;
+  for (auto &id_decision : rtsPlan.tensors) {
+    order.push_back(id_decision.first);
+  }
+  std::stable_sort(
+      order.begin(), order.end(), [this](const TensorId &a, const TensorId &b) {
+        auto &da = rtsPlan.tensors.at(a);
+        auto &db = rtsPlan.tensors.at(b);
+        return da.savedBytes * db.collectiveCycles >
+               db.savedBytes * da.collectiveCycles;
+      });
+  for (auto &id : order) {
+    auto &decision = rtsPlan.tensors.at(id);
+    if (rtsPlan.bytes.at(decision.vgid) > budget && decision.savedBytes > 0) {
+      decision.sharded = true;
+      rtsPlan.bytes.at(decision.vgid) -= decision.savedBytes;
+      rtsPlan.savedBytes += decision.savedBytes;
+      rtsPlan.collectiveBytes += decision.collectiveBytes;
+      rtsPlan.collectiveCycles += decision.collectiveCycles;
+    }
+  }
+
+  for (auto &candidate : candidates) {
+    auto location = candidate.second;
+    location.replicatedTensorSharding =
+        rtsPlan.tensors.at(candidate.first->id).sharded
+            ? ReplicatedTensorSharding::On
+            : ReplicatedTensorSharding::Off;
+    rtsPlan.locations.insert({candidate.first->id, location});
+  }
+
+  for (auto &vgid_bytes : rtsPlan.bytes) {
+    if (vgid_bytes.second > budget) {
+      logging::transform::warn("[StreamingMemory] The weights, optimizer "
+                               "state and accumulators of virtual graph {} "
+                               "need {} bytes per replica after sharding, over "
+                               "the budget of {} bytes",
+                               vgid_bytes.first,
+                               vgid_bytes.second,
+                               budget);
+    }
+  }
+  logging::transform::info("[StreamingMemory] Replicated tensor sharding "
+                           "saves {} bytes per replica, and adds {} bytes "
+                           "({} cycles) of collectives per step",
+                           rtsPlan.savedBytes,
+                           rtsPlan.collectiveBytes,
+                           rtsPlan.collectiveCycles);
+  for (auto &id_decision : rtsPlan.tensors) {
+    logging::transform::debug("[StreamingMemory] {} ({} bytes) sharded: {}",
+                              id_decision.first,
+                              id_decision.second.bytes,
+                              id_decision.second.sharded);
+  }
+
+  return rtsPlan;
+}
+
 // Make sure the op has a valid placement annotation
 void StreamingMemoryOpInserter::sanitizePlacementAnnotation(
     Op *op,
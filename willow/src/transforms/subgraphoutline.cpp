@@ -19,6 +19,7 @@
 #include <popart/subgraph/prunematches.hpp>
 #include <popart/subgraph/subgraphutil.hpp>
 #include <popart/topocons.hpp>
+#include <popart/transforms/dynamiclossscaling.hpp>
 #include <popart/transforms/subgraphoutline.hpp>
 #include <popart/vendored/optional.hpp>
 
@@ -64,12 +65,17 @@ std::vector<int64_t> getBoundariesCrossed(const SessionOptions &opts,
   RecomputeType recompute      = RecomputeType::Undefined;
   RecomputeType last_recompute = RecomputeType::Undefined;
 
+  bool skipped      = false;
+  bool last_skipped = false;
+
   auto aof_schedule = opts.accumulateOuterFragmentSettings.schedule;
 
   bool check_vgid_in_aof =
       (aof_schedule !=
        AccumulateOuterFragmentSchedule::OverlapCycleOptimized) &&
-      (aof_schedule != AccumulateOuterFragmentSchedule::OverlapMemoryOptimized);
+      (aof_schedule !=
+       AccumulateOuterFragmentSchedule::OverlapMemoryOptimized) &&
+      (aof_schedule != AccumulateOuterFragmentSchedule::OverlapStreamedUpdates);
 
   bool overlap_phase = opts.executionPhaseSettings.phases > 1 &&
                        opts.executionPhaseSettings.schedule ==
@@ -89,6 +95,7 @@ std::vector<int64_t> getBoundariesCrossed(const SessionOptions &opts,
     last_exec_cont   = exec_cont;
     last_batchserial = batchserial;
     last_recompute   = recompute;
+    last_skipped     = skipped;
 
     // Enable barriers between different sections of the schedules:
     // - Improves subgraph structures by dividing the schedule into
@@ -116,13 +123,16 @@ std::vector<int64_t> getBoundariesCrossed(const SessionOptions &opts,
     recompute   = op->settings.recomputeType == RecomputeType::Recompute
                     ? RecomputeType::Recompute
                     : RecomputeType::Checkpoint;
+    // The Ops skipped when the gradients overflow are grown in their own
+    // program, so can only be outlined together
+    skipped = DynamicLossScaling::isSkippedOnOverflow(op);
 
     check_vgid &= check_vgid_in_aof ||
                   exec_cont != ExecutionContext::AccumulateOuterFragment;
 
     if (i > start &&
         ((exec_cont != last_exec_cont) || (recompute != last_recompute) ||
-         (check_vgid && vgid != last_vgid) ||
+         (skipped != last_skipped) || (check_vgid && vgid != last_vgid) ||
          (check_phase && phase != last_phase) ||
          (check_batchserial && batchserial != last_batchserial))) {
       crossing.push_back(i - start);